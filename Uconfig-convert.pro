@@ -0,0 +1,80 @@
+#-------------------------------------------------
+#
+# Command-line converter, built without Qt:
+#     qmake Uconfig-convert.pro && make
+#
+#-------------------------------------------------
+
+CONFIG += console thread
+CONFIG -= qt app_bundle
+
+TARGET = uconfig-convert
+TEMPLATE = app
+
+VERSION = 1.0.0
+
+
+SOURCES += converter/main.cpp \
+    parser/uconfigfile.cpp \
+    parser/uconfigentryobject.cpp \
+    parser/uconfigini.cpp \
+    parser/utils.cpp \
+    parser/uconfig2dtable.cpp \
+    parser/uconfigkeyvalue.cpp \
+    parser/uconfigjson.cpp \
+    parser/uconfigxml.cpp \
+    parser/uconfigio.cpp \
+    parser/uconfigcsv.cpp \
+    parser/uconfigarena.cpp \
+    parser/uconfigcolumns.cpp \
+    parser/uconfigentryindex.cpp \
+    parser/uconfigjsonscanner.cpp \
+    parser/uconfiginputbuffer.cpp \
+    parser/uconfiglinereader.cpp \
+    parser/uconfighandler.cpp \
+    parser/uconfigconverter.cpp \
+    parser/uconfigoutputbuffer.cpp \
+    parser/uconfignumber.cpp \
+    parser/uconfigbinary.cpp \
+    parser/uconfigcache.cpp \
+    parser/uconfiglineindex.cpp \
+    parser/uconfigwatcher.cpp
+
+HEADERS  += \
+    parser/uconfigentry.h \
+    parser/uconfigfile.h \
+    parser/uconfigentryobject.h \
+    parser/uconfigini.h \
+    parser/uconfigio.h \
+    parser/uconfigfile_metadata.h \
+    parser/utils.h \
+    parser/uconfig2dtable.h \
+    parser/uconfigkeyvalue.h \
+    parser/uconfigkeyvalue_p.h \
+    parser/uconfigini_p.h \
+    parser/uconfigjson.h \
+    parser/uconfigjson_p.h \
+    parser/uconfigxml.h \
+    parser/uconfigxml_p.h \
+    parser/uconfigcsv.h \
+    parser/uconfigarena.h \
+    parser/uconfigcolumns.h \
+    parser/uconfigentryindex.h \
+    parser/uconfigjsonscanner.h \
+    parser/uconfiginputbuffer.h \
+    parser/uconfiglinereader.h \
+    parser/uconfighandler.h \
+    parser/uconfigcsv_p.h \
+    parser/uconfigconverter.h \
+    parser/uconfigconverter_p.h \
+    parser/uconfigoutputbuffer.h \
+    parser/uconfignumber.h \
+    parser/uconfignumber_p.h \
+    parser/uconfigbinary.h \
+    parser/uconfigcache.h \
+    parser/uconfiglineindex.h \
+    parser/uconfigwatcher.h
+
+target.path = $${PREFIX}/bin/
+
+INSTALLS += target
@@ -27,6 +27,11 @@ DEFINES += QT_DEPRECATED_WARNINGS APP_VERSION=\\\"$$VERSION\\\"
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Run benchmarks after the tests with "qmake CONFIG+=benchmark"
+benchmark {
+    DEFINES += UCONFIG_BENCHMARK
+}
+
 
 SOURCES += main.cpp \
     parser/uconfigfile.cpp \
@@ -41,8 +46,23 @@ SOURCES += main.cpp \
     test/testbasic.cpp \
     test/testparser.cpp \
     test/testconversion.cpp \
+    test/testbenchmark.cpp \
     editor/uconfigeditor.cpp \
     parser/uconfigcsv.cpp \
+    parser/uconfigarena.cpp \
+    parser/uconfigcolumns.cpp \
+    parser/uconfigentryindex.cpp \
+    parser/uconfigjsonscanner.cpp \
+    parser/uconfiginputbuffer.cpp \
+    parser/uconfiglinereader.cpp \
+    parser/uconfighandler.cpp \
+    parser/uconfigconverter.cpp \
+    parser/uconfigoutputbuffer.cpp \
+    parser/uconfignumber.cpp \
+    parser/uconfigbinary.cpp \
+    parser/uconfigcache.cpp \
+    parser/uconfiglineindex.cpp \
+    parser/uconfigwatcher.cpp \
     editor/qhexedit2/commands.cpp \
     editor/qhexedit2/qhexedit.cpp \
     editor/qhexedit2/chunks.cpp \
@@ -67,6 +87,23 @@ HEADERS  += \
     parser/uconfigxml_p.h \
     editor/uconfigeditor.h \
     parser/uconfigcsv.h \
+    parser/uconfigarena.h \
+    parser/uconfigcolumns.h \
+    parser/uconfigentryindex.h \
+    parser/uconfigjsonscanner.h \
+    parser/uconfiginputbuffer.h \
+    parser/uconfiglinereader.h \
+    parser/uconfighandler.h \
+    parser/uconfigcsv_p.h \
+    parser/uconfigconverter.h \
+    parser/uconfigconverter_p.h \
+    parser/uconfigoutputbuffer.h \
+    parser/uconfignumber.h \
+    parser/uconfignumber_p.h \
+    parser/uconfigbinary.h \
+    parser/uconfigcache.h \
+    parser/uconfiglineindex.h \
+    parser/uconfigwatcher.h \
     editor/qhexedit2/qhexedit.h \
     editor/qhexedit2/commands.h \
     editor/qhexedit2/chunks.h \
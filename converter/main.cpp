@@ -0,0 +1,99 @@
+/*
+ * Command-line converter between the formats supported by Uconfig parser
+ * Files are converted in a single pass, without loading them into memory.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "parser/uconfigconverter.h"
+
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [-f FORMAT] [-t FORMAT] INPUT [OUTPUT]\n"
+            "Convert INPUT from one format to another, and write the result "
+            "into OUTPUT\n(or to the standard output if OUTPUT is not given)."
+            "\n\n"
+            "  -f FORMAT  format of INPUT\n"
+            "  -t FORMAT  format of OUTPUT\n\n"
+            "FORMAT is one of: keyvalue, ini, table, csv, json, xml.\n"
+            "Unless specified, formats are guessed from file extensions.\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* inputFilename = NULL;
+    const char* outputFilename = NULL;
+    UconfigConverter::Format inputFormat = UconfigConverter::UnknownFormat;
+    UconfigConverter::Format outputFormat = UconfigConverter::UnknownFormat;
+
+    for (int i=1; i<argc; i++)
+    {
+        if ((strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "-t") == 0) &&
+            i + 1 < argc)
+        {
+            UconfigConverter::Format format =
+                                UconfigConverter::getFormat(argv[i + 1]);
+            if (format == UconfigConverter::UnknownFormat)
+            {
+                fprintf(stderr, "Unknown format: %s\n", argv[i + 1]);
+                return 1;
+            }
+            if (argv[i][1] == 'f')
+                inputFormat = format;
+            else
+                outputFormat = format;
+            i++;
+        }
+        else if (argv[i][0] == '-')
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        else if (!inputFilename)
+            inputFilename = argv[i];
+        else if (!outputFilename)
+            outputFilename = argv[i];
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!inputFilename)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (inputFormat == UconfigConverter::UnknownFormat)
+        inputFormat = UconfigConverter::guessFormat(inputFilename);
+    if (outputFormat == UconfigConverter::UnknownFormat)
+        outputFormat = UconfigConverter::guessFormat(outputFilename);
+    if (inputFormat == UconfigConverter::UnknownFormat ||
+        outputFormat == UconfigConverter::UnknownFormat)
+    {
+        fprintf(stderr, "Cannot guess the format of %s; "
+                        "please specify it with -f or -t.\n",
+                inputFormat == UconfigConverter::UnknownFormat ?
+                    inputFilename :
+                    (outputFilename ? outputFilename : "the output"));
+        return 1;
+    }
+
+    bool success;
+    if (outputFilename)
+        success = UconfigConverter::convert(inputFilename, outputFilename,
+                                            inputFormat, outputFormat);
+    else
+        success = UconfigConverter::fconvert(inputFilename, inputFormat,
+                                             stdout, outputFormat);
+    if (!success)
+    {
+        fprintf(stderr, "Failed to convert %s\n", inputFilename);
+        return 1;
+    }
+    return 0;
+}
@@ -63,9 +63,6 @@ UconfigEditor::~UconfigEditor()
 {
     delete ui;
     delete valueEditor;
-
-    if (currentEntry)
-        delete currentEntry;
 }
 
 void UconfigEditor::reset()
@@ -78,7 +75,7 @@ void UconfigEditor::reset()
     currentFile.rootEntry.reset();
     currentFile.metadata.reset();
 
-    currentEntry = NULL;
+    currentEntry = UconfigEntryRef();
 
     resetEntryList();
     resetKeyList();
@@ -219,32 +216,27 @@ void UconfigEditor::reloadEntryList()
     entryListRoot->removeRows(0, entryListRoot->rowCount());
 
     // Append the subentries as child nodes
-    UconfigEntryObject* subentryList = currentFile.rootEntry.subentries();
-    if (subentryList)
-    {
-        for (int i=0; i<currentFile.rootEntry.subentryCount(); i++)
-            loadEntry(entryListRoot, subentryList[i]);
-        delete[] subentryList;
-    }
+    for (UconfigEntryRef subentry : currentFile.rootEntry.childRange())
+        loadEntry(entryListRoot, subentry);
 }
 
 bool UconfigEditor::addSubentry(const QModelIndex& parentIndex,
-                                const UconfigEntryObject* newEntry)
+                                const UconfigEntryRef& newEntry)
 {
-    UconfigEntryObject* parent = modelIndexToEntry(parentIndex);
-    if (!parent)
-        parent = &currentFile.rootEntry;
+    UconfigEntryRef parent = modelIndexToEntry(parentIndex);
+    if (parent.isNull())
+        parent = currentFile.rootEntry;
 
-    if (newEntry)
+    if (!newEntry.isNull())
     {
-        parent->addSubentry(newEntry);
-        loadEntry(modelEntryList.itemFromIndex(parentIndex), *newEntry);
+        parent.addSubentry(&newEntry);
+        loadEntry(modelEntryList.itemFromIndex(parentIndex), newEntry);
     }
     else
     {
         UconfigEntryObject tempEntry;
         tempEntry.setName(UCONFIG_EDITOR_TREEVIEW_TEXT_NEW);
-        parent->addSubentry(&tempEntry);
+        parent.addSubentry(&tempEntry);
         loadEntry(modelEntryList.itemFromIndex(parentIndex), tempEntry);
     }
 
@@ -257,11 +249,11 @@ bool UconfigEditor::removeEntry(const QModelIndex& index)
     if (!index.isValid() || index == entryListRoot->index())
         return false;
 
-    UconfigEntryObject* entry = modelIndexToEntry(index);
-    if (entry)
+    UconfigEntryRef entry = modelIndexToEntry(index);
+    if (!entry.isNull())
     {
         // First assign the entry a temporary but unique name
-        UconfigEntryObject parent = entry->parentEntry();
+        UconfigEntryRef parent = entry.parentEntry();
         QByteArray tempName;
         while (true)
         {
@@ -270,7 +262,7 @@ bool UconfigEditor::removeEntry(const QModelIndex& index)
             if (!parent.existSubentry(tempName.constData(), tempName.size()))
                 break;
         }
-        entry->setName(tempName.constData(), tempName.size());
+        entry.setName(tempName.constData(), tempName.size());
 
         // Then delete the entry by its name
         parent.deleteSubentry(tempName.constData(), tempName.size());
@@ -281,34 +273,29 @@ bool UconfigEditor::removeEntry(const QModelIndex& index)
     return true;
 }
 
-void UconfigEditor::reloadKeyList(UconfigEntryObject& entry)
+void UconfigEditor::reloadKeyList(const UconfigEntryRef& entry)
 {
     resetKeyList();
 
-    UconfigKeyObject* keyList = entry.keys();
-    if (keyList)
-    {
-        for (int i=0; i<entry.keyCount(); i++)
-            loadKey(keyList[i]);
-        delete[] keyList;
-    }
+    for (UconfigKeyRef key : entry.keyRange())
+        loadKey(key);
 }
 
-bool UconfigEditor::addKey(const UconfigKeyObject* newKey)
+bool UconfigEditor::addKey(const UconfigKeyRef& newKey)
 {
-    if (!currentEntry)
+    if (currentEntry.isNull())
         return false;
 
-    if (newKey)
+    if (!newKey.isNull())
     {
-        currentEntry->addKey(newKey);
-        loadKey(*newKey);
+        currentEntry.addKey(&newKey);
+        loadKey(newKey);
     }
     else
     {
         UconfigKeyObject tempKey;
         tempKey.setName(UCONFIG_EDITOR_LISTVIEW_TEXT_NEW);
-        currentEntry->addKey(&tempKey);
+        currentEntry.addKey(&tempKey);
         loadKey(tempKey);
     }
 
@@ -321,8 +308,8 @@ bool UconfigEditor::removeKey(const QModelIndex& index)
     if (!index.isValid())
         return false;
 
-    UconfigKeyObject* key = modelIndexToKey(index);
-    if (key && currentEntry)
+    UconfigKeyRef key = modelIndexToKey(index);
+    if (!key.isNull() && !currentEntry.isNull())
     {
         // First assign the key a temporary but unique name
         QByteArray tempName;
@@ -330,13 +317,13 @@ bool UconfigEditor::removeKey(const QModelIndex& index)
         {
             tempName = UCONFIG_EDITOR_KEY_NAME_PREFIX;
             tempName.append(QByteArray::number(qrand()));
-            if (!currentEntry->existKey(tempName.constData(), tempName.size()))
+            if (!currentEntry.existKey(tempName.constData(), tempName.size()))
                 break;
         }
-        key->setName(tempName.constData(), tempName.size());
+        key.setName(tempName.constData(), tempName.size());
 
         // Then delete the key by its name
-        currentEntry->deleteKey(tempName.constData(), tempName.size());
+        currentEntry.deleteKey(tempName.constData(), tempName.size());
     }
     modelKeyList.removeRow(index.row(), index.parent());
 
@@ -374,7 +361,7 @@ QString UconfigEditor::keyTypeToString(int valueType)
     return text;
 }
 
-QString UconfigEditor::keyValueToString(const UconfigKeyObject& key)
+QString UconfigEditor::keyValueToString(const UconfigKeyRef& key)
 {
     typedef UconfigIO::ValueType ValueType;
 
@@ -430,7 +417,7 @@ void UconfigEditor::resetKeyList()
 }
 
 void UconfigEditor::loadEntry(QStandardItem* parent,
-                              const UconfigEntryObject& entry)
+                              const UconfigEntryRef& entry)
 {
     // Load entries into node recursively
     static QString nodeName;
@@ -446,18 +433,12 @@ void UconfigEditor::loadEntry(QStandardItem* parent,
     parent->appendRow(childNode);
 
     // Deal with subentries...
-    UconfigEntryObject* subentryList =
-                        const_cast<UconfigEntryObject&>(entry).subentries();
-    if (subentryList)
-    {
-        for (int i=0; i<entry.subentryCount(); i++)
-            loadEntry(childNode, subentryList[i]);
-        delete[] subentryList;
-    }
+    for (UconfigEntryRef subentry : entry.childRange())
+        loadEntry(childNode, subentry);
 }
 
 
-void UconfigEditor::loadKey(const UconfigKeyObject& key)
+void UconfigEditor::loadKey(const UconfigKeyRef& key)
 {
     static QString rowName;
     static QList<QStandardItem*> itemList;
@@ -478,7 +459,7 @@ void UconfigEditor::loadKey(const UconfigKeyObject& key)
     modelKeyList.appendRow(itemList);
 }
 
-void UconfigEditor::updateKey(const UconfigKeyObject& key, int row)
+void UconfigEditor::updateKey(const UconfigKeyRef& key, int row)
 {
     if (modelKeyList.rowCount() <= row)
         return;
@@ -496,7 +477,7 @@ void UconfigEditor::updateKey(const UconfigKeyObject& key, int row)
                         setEditable(key.type() != UconfigIO::ValueType::Raw);
 }
 
-UconfigEntryObject* UconfigEditor::modelIndexToEntry(const QModelIndex& index)
+UconfigEntryRef UconfigEditor::modelIndexToEntry(const QModelIndex& index)
 {
     // Reverse mapping from a QStandardItemModel index to an Uconfig entry
 
@@ -512,46 +493,26 @@ UconfigEntryObject* UconfigEditor::modelIndexToEntry(const QModelIndex& index)
     }
 
     // Then locate the entry in file by reversing the row indexes
-    UconfigEntryObject* currentEntry = NULL;
-    UconfigEntryObject* subentryList = currentFile.rootEntry.subentries();
-    while (!rowIndexes.isEmpty() && subentryList)
+    // At each level, keep a handle to the entry found
+    // (a null handle is returned for the root entry)
+    UconfigEntryRef currentEntry;
+    UconfigEntryRange subentryRange = currentFile.rootEntry.childRange();
+    while (!rowIndexes.isEmpty() && subentryRange.size() > 0)
     {
-        // At each level, create a new copy of the reference of
-        // the entry found, as the original reference in subentryList
-        // will be destroyed once subentryList is deleted.
-        // Here we use the copy-assignment operator "=" to create a copy,
-        // which generates a new reference to the original reference.
-        if (!currentEntry)
-            currentEntry = new UconfigEntryObject;
-        *currentEntry = subentryList[rowIndexes.pop()];
+        currentEntry = subentryRange[rowIndexes.pop()];
 
         // Step into next level
-        delete[] subentryList;
-        subentryList = currentEntry->subentries();
+        subentryRange = currentEntry.childRange();
     }
 
-    if (subentryList)
-        delete[] subentryList;
-
     return currentEntry;
 }
 
-UconfigKeyObject* UconfigEditor::modelIndexToKey(const QModelIndex& index)
+UconfigKeyRef UconfigEditor::modelIndexToKey(const QModelIndex& index)
 {
     // Reverse mapping from a QStandardItemModel index to an Uconfig key
-    UconfigKeyObject* currentKey = NULL;
-
-    if (!currentEntry)
-        return currentKey;
-
-    UconfigKeyObject* keyList = currentEntry->keys();
-    if (keyList)
-    {
-        currentKey = new UconfigKeyObject;
-        *currentKey = keyList[index.row()]; // Do a shallow copy
-        delete[] keyList;
-    }
-    return currentKey;
+    // (a null handle if there is no such key)
+    return currentEntry.keyRange()[index.row()];
 }
 
 void UconfigEditor::closeEvent(QCloseEvent* event)
@@ -709,21 +670,21 @@ void UconfigEditor::on_listKey_doubleClicked(const QModelIndex &index)
     else if (index.column() == 2)
     {
         // Value content is clicked
-        UconfigKeyObject* key = modelIndexToKey(index);
-        if (key->type() == UconfigIO::ValueType::Raw)
+        UconfigKeyRef key = modelIndexToKey(index);
+        if (key.type() == UconfigIO::ValueType::Raw)
         {
             // Launch QHexEdit Dialog
             if (!hexEditor)
                 hexEditor = new HexEditDialog(this);
-            hexEditor->setData(QByteArray(key->value(), key->valueSize()));
+            hexEditor->setData(QByteArray(key.value(), key.valueSize()));
             hexEditor->exec();
 
             if (hexEditor->isModified())
             {
                 // Update the value
                 QByteArray newData = hexEditor->getData();
-                key->setValue(newData.constData(), newData.size());
-                updateKey(*key, index.row());
+                key.setValue(newData.constData(), newData.size());
+                updateKey(key, index.row());
             }
         }
     }
@@ -734,23 +695,21 @@ void UconfigEditor::onEntryListItemClicked(const QModelIndex& index)
     if (!index.isValid())
         return;
 
-    UconfigEntryObject* entry = modelIndexToEntry(index);
-    if (entry)
-        reloadKeyList(*entry);
+    UconfigEntryRef entry = modelIndexToEntry(index);
+    if (!entry.isNull())
+        reloadKeyList(entry);
     else
         resetKeyList();
 
-    if (currentEntry)
-        delete currentEntry;
     currentEntry = entry;
 }
 
 void UconfigEditor::onEntryListItemChanged(QStandardItem* item)
 {
-    // Subentry name has been modified: write it back to UconfigEntryObject
+    // Subentry name has been modified: write it back to the entry
     QByteArray newName = item->text().toLocal8Bit();
-    modelIndexToEntry(item->index())->setName(newName.constData(),
-                                              newName.size());
+    modelIndexToEntry(item->index()).setName(newName.constData(),
+                                             newName.size());
     modified = true;
 }
 
@@ -763,8 +722,8 @@ void UconfigEditor::onKeyListItemChanged(QStandardItem* item)
         {
             // Key renamed
             QByteArray newName = item->text().toLocal8Bit();
-            modelIndexToKey(index)->setName(newName.constData(),
-                                            newName.size());
+            modelIndexToKey(index).setName(newName.constData(),
+                                           newName.size());
             modified = true;
             break;
         }
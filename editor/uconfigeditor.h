@@ -48,17 +48,17 @@ public:
     // Entry list operations
     void reloadEntryList();
     bool addSubentry(const QModelIndex& parentIndex,
-                     const UconfigEntryObject* newEntry = NULL);
+                     const UconfigEntryRef& newEntry = UconfigEntryRef());
     bool removeEntry(const QModelIndex& index);
 
     // Key list operations
-    void reloadKeyList(UconfigEntryObject& entry);
-    bool addKey(const UconfigKeyObject* newKey = NULL);
+    void reloadKeyList(const UconfigEntryRef& entry);
+    bool addKey(const UconfigKeyRef& newKey = UconfigKeyRef());
     bool removeKey(const QModelIndex& index);
 
     // Helper functions
     static QString keyTypeToString(int valueType);
-    static QString keyValueToString(const UconfigKeyObject& key);
+    static QString keyValueToString(const UconfigKeyRef& key);
 
 private:
     Ui::UconfigEditor *ui;
@@ -71,7 +71,7 @@ private:
 protected:
     bool modified = false;
     UconfigFile currentFile;
-    UconfigEntryObject* currentEntry;
+    UconfigEntryRef currentEntry;
 
     QStandardItem* entryListRoot;
     QStandardItemModel modelEntryList;
@@ -81,12 +81,12 @@ protected:
     void resetEntryList();
     void resetKeyList();
 
-    void loadEntry(QStandardItem* parent, const UconfigEntryObject &entry);
-    void loadKey(const UconfigKeyObject& key);
-    void updateKey(const UconfigKeyObject& key, int row);
+    void loadEntry(QStandardItem* parent, const UconfigEntryRef& entry);
+    void loadKey(const UconfigKeyRef& key);
+    void updateKey(const UconfigKeyRef& key, int row);
 
-    UconfigEntryObject* modelIndexToEntry(const QModelIndex& item);
-    UconfigKeyObject* modelIndexToKey(const QModelIndex& index);
+    UconfigEntryRef modelIndexToEntry(const QModelIndex& item);
+    UconfigKeyRef modelIndexToKey(const QModelIndex& index);
 
     void closeEvent(QCloseEvent* event);
 
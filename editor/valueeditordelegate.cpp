@@ -21,8 +21,8 @@ QWidget* ValueEditorDelegate::createEditor(QWidget* parent,
 {
     QWidget* newEditor;
     using ValueType = UconfigIO::ValueType;
-    UconfigKeyObject* key = mainEditor->modelIndexToKey(index);
-    switch (key->type())
+    UconfigKeyRef key = mainEditor->modelIndexToKey(index);
+    switch (key.type())
     {
         case ValueType::Bool:
         {
@@ -59,28 +59,28 @@ QWidget* ValueEditorDelegate::createEditor(QWidget* parent,
 void ValueEditorDelegate::setEditorData(QWidget* editor,
                                         const QModelIndex& index) const
 {
-    // Load value directly from UconfigKeyObject
+    // Load value directly from the key
     using ValueType = UconfigIO::ValueType;
-    UconfigKeyObject* key = mainEditor->modelIndexToKey(index);
-    switch (key->type())
+    UconfigKeyRef key = mainEditor->modelIndexToKey(index);
+    switch (key.type())
     {
         case ValueType::Bool:
             bool boolValue;
-            memcpy(&boolValue, key->value(), key->valueSize());
+            memcpy(&boolValue, key.value(), key.valueSize());
             static_cast<QComboBox*>(editor)->setCurrentIndex(boolValue ? 1 : 0);
             break;
         case ValueType::Chars:
             static_cast<QLineEdit*>(editor)->
-                            setText(QByteArray(key->value(), key->valueSize()));
+                            setText(QByteArray(key.value(), key.valueSize()));
             break;
         case ValueType::Integer:
             int intValue;
-            memcpy(&intValue, key->value(), key->valueSize());
+            memcpy(&intValue, key.value(), key.valueSize());
             static_cast<QSpinBox*>(editor)->setValue(intValue);
             break;
         case ValueType::Double:
             double doubleValue;
-            memcpy(&doubleValue, key->value(), key->valueSize());
+            memcpy(&doubleValue, key.value(), key.valueSize());
             static_cast<QSpinBox*>(editor)->setValue(doubleValue);
             break;
         default:;
@@ -91,36 +91,36 @@ void ValueEditorDelegate::setModelData(QWidget* editor,
                                        QAbstractItemModel* model,
                                        const QModelIndex& index) const
 {
-    // Write the new value back to UconfigKeyObject
+    // Write the new value back to the key
     using ValueType = UconfigIO::ValueType;
-    UconfigKeyObject* key = mainEditor->modelIndexToKey(index);
-    switch (key->type())
+    UconfigKeyRef key = mainEditor->modelIndexToKey(index);
+    switch (key.type())
     {
         case ValueType::Bool:
         {
             bool boolValue =
                     static_cast<QComboBox*>(editor)->currentIndex() > 0;
-            key->setValue((char*)(&boolValue), sizeof(bool));
+            key.setValue((char*)(&boolValue), sizeof(bool));
             break;
         }
         case ValueType::Chars:
         {
             QByteArray charValue =
                     static_cast<QLineEdit*>(editor)->text().toLocal8Bit();
-            key->setValue(charValue.constData(),
-                          charValue.size() * sizeof(char));
+            key.setValue(charValue.constData(),
+                         charValue.size() * sizeof(char));
             break;
         }
         case ValueType::Integer:
         {
             int intValue = static_cast<QSpinBox*>(editor)->value();
-            key->setValue((char*)(&intValue), sizeof(int));
+            key.setValue((char*)(&intValue), sizeof(int));
             break;
         }
         case ValueType::Double:
         {
             double doubleValue = static_cast<QDoubleSpinBox*>(editor)->value();
-            key->setValue((char*)(&doubleValue), sizeof(double));
+            key.setValue((char*)(&doubleValue), sizeof(double));
             break;
         }
         default:;
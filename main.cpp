@@ -17,6 +17,9 @@ void testParser();
 // ./test/testconversion.cpp
 void testConversion();
 
+// ./test/testbenchmark.cpp
+void testBenchmark();
+
 void testEditor(int argc, char* argv[])
 {
     QApplication a(argc, argv);
@@ -34,6 +37,9 @@ int main(int argc, char *argv[])
     testBasic();
     testParser();
     testConversion();
+#ifdef UCONFIG_BENCHMARK
+    testBenchmark();
+#endif
     testEditor(argc, argv);
 
     return 0;
@@ -1,23 +1,239 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <utility>
 #include "uconfig2dtable.h"
 #include "uconfigfile_metadata.h"
+#include "uconfiginputbuffer.h"
+#include "uconfiglineindex.h"
+#include "uconfignumber.h"
 #include "utils.h"
 
 #define UCONFIG_IO_2DTABLE_DELIMITER_ROW    "\n"
 #define UCONFIG_IO_2DTABLE_DELIMITER_COL    " "
 #define UCONFIG_IO_2DTABLE_TYPE_COMMENT     "Comment"
 #define UCONFIG_IO_2DTABLE_TYPE_TABLE       "Table"
+#define UCONFIG_IO_2DTABLE_CHAR_STRING      '"'
+#define UCONFIG_IO_2DTABLE_BOOL_TRUE        "true"
+#define UCONFIG_IO_2DTABLE_BOOL_FALSE       "false"
+#define UCONFIG_IO_2DTABLE_CHAR_POINT       '.'
+#define UCONFIG_IO_2DTABLE_CHAR_ZERO        '0'
+
+// Rows read to infer the types of columns, after the first one
+#define UCONFIG_IO_2DTABLE_SAMPLE_ROWS      16
+#define UCONFIG_IO_2DTABLE_TYPE_UNKNOWN     -1  // No cell sampled yet
+#define UCONFIG_IO_2DTABLE_TYPE_VARIOUS     -2  // Cells of different types
+
+// Longest integers that fit in a "uint64_t" in any case
+#define UCONFIG_IO_2DTABLE_INTEGER_DIGITS   18
+
+// Cells whose types are guessed at once
+#define UCONFIG_IO_2DTABLE_BATCH_SIZE       32
+
+
+// Read a cell made of decimal digits only, e.g. "1950"
+// Numbers with leading zeros are left to the guess, which reads them
+// as octal numbers; so are those that do not fit in an "int"
+static bool Uconfig_parseIntegerCell(const char* expression,
+                                     int length,
+                                     int* value)
+{
+    if (length <= 0 || length > UCONFIG_IO_2DTABLE_INTEGER_DIGITS ||
+        (length > 1 && expression[0] == UCONFIG_IO_2DTABLE_CHAR_ZERO))
+        return false;
+
+    uint64_t digits;
+    if (Uconfig_parseDigits(expression, length, &digits) < length ||
+        digits > uint64_t(INT_MAX))
+        return false;
+
+    *value = int(digits);
+    return true;
+}
+
+// Read a cell made of decimal digits and a single point, e.g. "2536.721"
+// Other forms (e.g. with a sign or an exponent) are left to the guess
+static bool Uconfig_parseRealCell(const char* expression,
+                                  int length,
+                                  double* value)
+{
+    // Check all the chars at once, after the loop
+    int pointCount = 0;
+    unsigned int digit, invalid = 0;
+    for (int i=0; i<length; i++)
+    {
+        digit = (unsigned char)(expression[i]) - UCONFIG_IO_2DTABLE_CHAR_ZERO;
+        pointCount += expression[i] == UCONFIG_IO_2DTABLE_CHAR_POINT;
+        invalid |= digit > 9 && expression[i] != UCONFIG_IO_2DTABLE_CHAR_POINT;
+    }
+    if (invalid || pointCount != 1)
+        return false;
+
+    return Uconfig_parseDouble(expression, length, value) == length;
+}
+
+// Convert a cell of a column of a known type without guessing its type
+// Return false if the cell does not have the plain form of that type:
+// it is then guessed as usual, and may be of another type
+static bool Uconfig_convertCell(UconfigKeyObject& key,
+                                const char* expression,
+                                int length,
+                                int type)
+{
+    switch (type)
+    {
+        case UconfigIO::Integer:
+        {
+            int tempInt;
+            if (!Uconfig_parseIntegerCell(expression, length, &tempInt))
+                return false;
+            key.setValue((char*)(&tempInt), sizeof(int));
+            break;
+        }
+        case UconfigIO::Double:
+        {
+            double tempDouble;
+            if (!Uconfig_parseRealCell(expression, length, &tempDouble))
+                return false;
+            key.setValue((char*)(&tempDouble), sizeof(double));
+            break;
+        }
+        default:
+            return false;
+    }
+    key.setType(type);
+    return true;
+}
+
+// Merge the types of the cells of a row into the types of the columns
+static void Uconfig_sampleColumnTypes(std::vector<int>& columnTypes,
+                                      const std::vector<UconfigKeyObject>& keys,
+                                      int keyCount)
+{
+    if (int(columnTypes.size()) < keyCount)
+        columnTypes.resize(keyCount, UCONFIG_IO_2DTABLE_TYPE_UNKNOWN);
+    for (int i=0; i<keyCount; i++)
+    {
+        int type = keys[i].type();
+        if (columnTypes[i] == UCONFIG_IO_2DTABLE_TYPE_UNKNOWN)
+            columnTypes[i] = type;
+        else if (columnTypes[i] != type)
+            columnTypes[i] = UCONFIG_IO_2DTABLE_TYPE_VARIOUS;
+    }
+}
+
+// Append the position (ROW, column) of each cell of a row whose type
+// is not that of its column to EXCEPTIONCELLS
+static void Uconfig_findTypeExceptions(std::vector<int>& exceptionCells,
+                                       const std::vector<int>& columnTypes,
+                                       const std::vector<UconfigKeyObject>& keys,
+                                       int keyCount,
+                                       int row)
+{
+    int count = std::min(keyCount, int(columnTypes.size()));
+    for (int i=0; i<count; i++)
+    {
+        if (columnTypes[i] >= 0 && keys[i].type() != columnTypes[i])
+        {
+            exceptionCells.push_back(row);
+            exceptionCells.push_back(i);
+        }
+    }
+}
+
+// Guess the types of COUNT cells at once, then store them
+// in the keys of the given indexes
+static void Uconfig_storeCells(std::vector<UconfigKeyObject>& keys,
+                               const int* keyIndexes,
+                               const UconfigIO::ValueSpan* spans,
+                               int count)
+{
+    typedef UconfigIO::ValueType ValueType;
+    ValueType types[UCONFIG_IO_2DTABLE_BATCH_SIZE];
+    UconfigIO::classifyValues(spans, count, types);
+
+    for (int i=0; i<count; i++)
+    {
+        UconfigKeyObject& tempKey = keys[keyIndexes[i]];
+        const char* expression = spans[i].value;
+        int length = spans[i].length;
+        switch (types[i])
+        {
+            case ValueType::Chars:
+                // Ignore wrapping quotes when storing
+                tempKey.setValue(&expression[1], length - sizeof(char) * 2);
+                break;
+            case ValueType::Integer:
+            {
+                // Store the number as an "int"
+                long tempLong;
+                if (Uconfig_parseInteger(expression, length, &tempLong) > 0)
+                {
+                    int tempInt = int(tempLong);
+                    tempKey.setValue((char*)(&tempInt), sizeof(int));
+                }
+                break;
+            }
+            case ValueType::Float:
+            case ValueType::Double:
+            {
+                // Store the number as a "double"
+                double tempDouble;
+                if (Uconfig_parseDouble(expression, length, &tempDouble) > 0)
+                    tempKey.setValue((char*)(&tempDouble), sizeof(double));
+                break;
+            }
+            case ValueType::Raw:
+            default:
+                tempKey.setValue(expression, length);
+
+        }
+        tempKey.setType(types[i]);
+    }
+}
 
+// Report a row of KEYCOUNT values to HANDLER, which takes them over
+static void Uconfig_reportRow(UconfigHandler* handler,
+                              std::vector<UconfigKeyObject>& rowKeys,
+                              int keyCount)
+{
+    handler->onEntryBegin(NULL, 0, Uconfig2DTable::Row);
+    for (int i=0; i<keyCount; i++)
+    {
+        handler->onKey(rowKeys[i]);
+        rowKeys[i].reset();
+    }
+    handler->onEntryEnd();
+}
+
+// Report a "line" without values to HANDLER as RAW content
+static void Uconfig_reportRaw(UconfigHandler* handler,
+                              UconfigKeyObject& tempKey,
+                              const char* buffer,
+                              int length)
+{
+    handler->onEntryBegin(NULL, 0, Uconfig2DTable::Raw);
+    tempKey.setType(UconfigIO::Raw);
+    tempKey.setValue(buffer, length);
+    handler->onKey(tempKey);
+    tempKey.reset();
+    handler->onEntryEnd();
+}
+
+// Whether a delimiter may overlap itself (e.g. "--"), so that the "lines"
+// found depend on where the splitting begins
+static bool Uconfig_isOverlapping(const char* delimiter, size_t length)
+{
+    for (size_t i=1; i<length; i++)
+    {
+        if (memcmp(delimiter, &delimiter[i], length - i) == 0)
+            return true;
+    }
+    return false;
+}
 
-static bool Uconfig_fwrite2DTableEntry(FILE* file,
-                                       UconfigEntryObject& entry,
-                                       const char* rowDelimiter,
-                                       const char* columnDelimiter);
-static bool Uconfig_fwrite2DTableSubentry(FILE* file,
-                                          UconfigEntryObject& subentry,
-                                          const char* columnDelimiter);
 
 bool Uconfig2DTable::readUconfig(const char* filename, UconfigFile* config)
 {
@@ -29,17 +245,10 @@ bool Uconfig2DTable::readUconfig(const char* filename, UconfigFile* config)
 bool Uconfig2DTable::writeUconfig(const char* filename, UconfigFile* config)
 {
     // If there are delimiters previously specified during file parsing,
-    // then take them directly
-    const char* rowDelimiter =
-            config->metadata.searchKey(UCONFIG_METADATA_KEY_ROWDELIM).value();
-    const char* columnDelimitor =
-            config->metadata.searchKey(UCONFIG_METADATA_KEY_COLDELIM).value();
-
-    // Otherwise, use default delimiters
-    if (!rowDelimiter)
-        rowDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_ROW;
-    if (!columnDelimitor)
-        columnDelimitor = UCONFIG_IO_2DTABLE_DELIMITER_COL;
+    // then take them directly; otherwise, use default delimiters
+    const char* rowDelimiter = NULL;
+    const char* columnDelimitor = NULL;
+    getDelimiters(config, &rowDelimiter, &columnDelimitor);
 
     return writeUconfig(filename, config, rowDelimiter, columnDelimitor);
 }
@@ -58,98 +267,436 @@ bool Uconfig2DTable::readUconfig(const char* filename,
     if (!inputFile)
         return false;
 
-    config->rootEntry.reset();
+    UconfigInputBuffer input(inputFile);
+    UconfigTreeBuilder builder(config->rootEntry);
+    if (config->columnarEnabled())
+        builder.setColumnarType(Uconfig2DTable::NormalEntry);
+    bool success = readTable(input, filename, config, &builder,
+                             rowDelimiter, columnDelimiter,
+                             skipEmptyRow, skipEmptyColumn);
 
-    UconfigEntryObject tempEntry, tempSubentry;
-    UconfigKeyObject tempKey;
-    tempEntry.setType(Uconfig2DTable::UnknownEntry);
+    fclose(inputFile);
+    return success;
+}
+
+// Read LENGTH bytes of DATA in place, e.g. a block received from
+// another process
+bool Uconfig2DTable::readUconfig(const char* data,
+                                 size_t length,
+                                 UconfigFile* config,
+                                 const char* rowDelimiter,
+                                 const char* columnDelimiter,
+                                 bool skipEmptyRow,
+                                 bool skipEmptyColumn)
+{
+    if (!data || !config)
+        return false;
+
+    UconfigInputBuffer input(data, length);
+    UconfigTreeBuilder builder(config->rootEntry);
+    if (config->columnarEnabled())
+        builder.setColumnarType(Uconfig2DTable::NormalEntry);
+    return readTable(input, NULL, config, &builder,
+                     rowDelimiter, columnDelimiter,
+                     skipEmptyRow, skipEmptyColumn);
+}
 
-    // Read a 2D table file and parse its content "line" by "line"
+// Report the content of a file to HANDLER instead of building a tree
+bool Uconfig2DTable::parseUconfig(const char* filename,
+                                  UconfigHandler* handler)
+{
+    return parseUconfig(filename, handler,
+                        UCONFIG_IO_2DTABLE_DELIMITER_ROW,
+                        UCONFIG_IO_2DTABLE_DELIMITER_COL);
+}
+
+bool Uconfig2DTable::parseUconfig(const char* filename,
+                                  UconfigHandler* handler,
+                                  const char* rowDelimiter,
+                                  const char* columnDelimiter,
+                                  bool skipEmptyRow,
+                                  bool skipEmptyColumn)
+{
+    if (!handler)
+        return false;
+
+    FILE* inputFile = fopen(filename, "rb");
+    if (!inputFile)
+        return false;
+
+    UconfigInputBuffer input(inputFile);
+    bool success = parseTable(input, handler,
+                              rowDelimiter, columnDelimiter,
+                              skipEmptyRow, skipEmptyColumn);
+
+    fclose(inputFile);
+    return success;
+}
+
+bool Uconfig2DTable::parseUconfig(const char* data,
+                                  size_t length,
+                                  UconfigHandler* handler,
+                                  const char* rowDelimiter,
+                                  const char* columnDelimiter,
+                                  bool skipEmptyRow,
+                                  bool skipEmptyColumn)
+{
+    if (!data || !handler)
+        return false;
+
+    UconfigInputBuffer input(data, length);
+    return parseTable(input, handler,
+                      rowDelimiter, columnDelimiter,
+                      skipEmptyRow, skipEmptyColumn);
+}
+
+// Update the tree of a file read before with INDEX, parsing again only
+// the rows changed since then (see UconfigLineIndex)
+// The delimiters and the options must be those of the first reading.
+bool Uconfig2DTable::updateUconfig(const char* filename,
+                                   UconfigFile* config,
+                                   UconfigLineIndex* index,
+                                   const char* rowDelimiter,
+                                   const char* columnDelimiter,
+                                   bool skipEmptyRow,
+                                   bool skipEmptyColumn)
+{
+    if (!config || !index)
+        return false;
+
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
+
+    updateTable(data, length, filename, config, index,
+                rowDelimiter, columnDelimiter, skipEmptyRow, skipEmptyColumn);
+
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
+
+bool Uconfig2DTable::updateUconfig(const char* data,
+                                   size_t length,
+                                   UconfigFile* config,
+                                   UconfigLineIndex* index,
+                                   const char* rowDelimiter,
+                                   const char* columnDelimiter,
+                                   bool skipEmptyRow,
+                                   bool skipEmptyColumn)
+{
+    if (!data || !config || !index)
+        return false;
+
+    updateTable(data, length, NULL, config, index,
+                rowDelimiter, columnDelimiter, skipEmptyRow, skipEmptyColumn);
+    return true;
+}
+
+// Report a 2D table to HANDLER "line" by "line":
+// rows are reported as subentries of a table entry,
+// preceded by an entry of raw "lines" if the input does not begin
+// with a row
+// If EXCEPTIONCELLS is given, the positions of the cells that do not fit
+// the type of their column are appended to it as pairs of
+// (index of subentry in the table, index of key)
+bool Uconfig2DTable::parseTable(UconfigInputBuffer& input,
+                                UconfigHandler* handler,
+                                const char* rowDelimiter,
+                                const char* columnDelimiter,
+                                bool skipEmptyRow,
+                                bool skipEmptyColumn,
+                                std::vector<int>* exceptionCells)
+{
+    std::vector<UconfigKeyObject> rowKeys;
+    UconfigKeyObject tempKey;
+    tempKey.setArena(handler->arena());
+    int entryType = Uconfig2DTable::UnknownEntry;
+
+    // Types of the columns of the table, inferred from its first rows
+    // (except the very first one, which is often a header)
+    std::vector<int> columnTypes;
+    int rowIndex = 0;
+    int tableRowCount = 0;
+
+    // Parse the content "line" by "line", in place in the buffer
+    // of the input
+    const char* buffer;
+    size_t recordLength;
     int readLen;
-    char* buffer;
+    int keyCount;
     if (!rowDelimiter)
         rowDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_ROW;
     if (!columnDelimiter)
         columnDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_COL;
-    while(!feof(inputFile))
+    const size_t rowDelimiterLength = strlen(rowDelimiter);
+    while (input.readRecord(rowDelimiter, rowDelimiterLength,
+                            &buffer, &recordLength))
     {
-        readLen = 0;
-        buffer = NULL;
-        readLen = Uconfig_getdelim(&buffer, &readLen, rowDelimiter, inputFile);
+        readLen = int(recordLength);
 
         // Omit empty (incomplete) "lines" if required
         if (readLen < 1 && skipEmptyRow)
             continue;
 
-        parseValues(buffer, tempSubentry, readLen,
-                    columnDelimiter, skipEmptyColumn);
+        // Values are parsed into keys allocated like the reported ones,
+        // so that the handler can take them over without copying
+        keyCount = parseValues(buffer, rowKeys, handler->arena(), readLen,
+                               columnDelimiter, skipEmptyColumn,
+                               rowIndex > UCONFIG_IO_2DTABLE_SAMPLE_ROWS ?
+                                   &columnTypes : NULL);
 
-        if (tempSubentry.keyCount() > 0)
+        if (keyCount > 0)
         {
-            if (tempEntry.type() == Uconfig2DTable::CommentEntry)
+            if (entryType != Uconfig2DTable::NormalEntry)
             {
-                // Save previous entry, then create a new entry
-                config->rootEntry.addSubentry(&tempEntry);
-                tempEntry.reset();
+                // Close previous entry, then open the table
+                if (entryType == Uconfig2DTable::CommentEntry)
+                    handler->onEntryEnd();
+                entryType = Uconfig2DTable::NormalEntry;
+                handler->onEntryBegin(UCONFIG_IO_2DTABLE_TYPE_TABLE,
+                                      sizeof(UCONFIG_IO_2DTABLE_TYPE_TABLE),
+                                      entryType);
             }
-            tempEntry.setName(UCONFIG_IO_2DTABLE_TYPE_TABLE);
-            tempEntry.setType(Uconfig2DTable::NormalEntry);
+
+            if (rowIndex > 0 && rowIndex <= UCONFIG_IO_2DTABLE_SAMPLE_ROWS)
+                Uconfig_sampleColumnTypes(columnTypes, rowKeys, keyCount);
+            else if (rowIndex > 0 && exceptionCells)
+                Uconfig_findTypeExceptions(*exceptionCells, columnTypes,
+                                           rowKeys, keyCount, tableRowCount);
+            rowIndex++;
+            tableRowCount++;
+
+            Uconfig_reportRow(handler, rowKeys, keyCount);
         }
         else
         {
-            // See the whole "line" as RAW content
-            tempKey.setType(ValueType::Raw);
-            tempKey.setValue(buffer, readLen);
-            tempSubentry.addKey(&tempKey);
-            tempSubentry.setType(Uconfig2DTable::Raw);
-
-            if (tempEntry.type() == Uconfig2DTable::UnknownEntry)
+            if (entryType == Uconfig2DTable::UnknownEntry)
             {
                 // Standalone comment entry or raw content block
                 // (at the beginning of the file)
-                tempEntry.setName(UCONFIG_IO_2DTABLE_TYPE_COMMENT);
-                tempEntry.setType(Uconfig2DTable::CommentEntry);
+                entryType = Uconfig2DTable::CommentEntry;
+                handler->onEntryBegin(UCONFIG_IO_2DTABLE_TYPE_COMMENT,
+                                      sizeof(UCONFIG_IO_2DTABLE_TYPE_COMMENT),
+                                      entryType);
             }
+
+            // See the whole "line" as RAW content
+            if (entryType == Uconfig2DTable::NormalEntry)
+                tableRowCount++;
+            Uconfig_reportRaw(handler, tempKey, buffer, readLen);
         }
-        tempEntry.addSubentry(&tempSubentry);
-        tempSubentry.reset();
     }
 
-    if (tempEntry.type() != Uconfig2DTable::UnknownEntry)
+    if (entryType != Uconfig2DTable::UnknownEntry)
     {
-        // Save the last entry
-        config->rootEntry.addSubentry(&tempEntry);
+        // Close the last entry
+        handler->onEntryEnd();
     }
 
+    return true;
+}
+
+// Report a 2D table to HANDLER, then add its meta-data to CONFIG,
+// so that derived parsers can put their own handler in the way
+// FILENAME is the file that the table is read from, if any
+bool Uconfig2DTable::readTable(UconfigInputBuffer& input,
+                               const char* filename,
+                               UconfigFile* config,
+                               UconfigHandler* handler,
+                               const char* rowDelimiter,
+                               const char* columnDelimiter,
+                               bool skipEmptyRow,
+                               bool skipEmptyColumn)
+{
+    if (!rowDelimiter)
+        rowDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_ROW;
+    if (!columnDelimiter)
+        columnDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_COL;
+    std::vector<int> exceptionCells;
+    if (!parseTable(input, handler,
+                    rowDelimiter, columnDelimiter,
+                    skipEmptyRow, skipEmptyColumn, &exceptionCells))
+        return false;
+
     // Add meta-data
     /* Basic information */
-    tempKey.reset();
-    tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
-    tempKey.setType(ValueType::Chars);
-    tempKey.setValue(filename, strlen(filename) + 1);
-    config->metadata.addKey(&tempKey);
-    tempKey.reset();
+    UconfigKeyObject tempKey;
+    if (filename)
+    {
+        tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+        tempKey.setType(ValueType::Chars);
+        tempKey.setValue(filename, strlen(filename) + 1);
+        config->metadata.addKey(std::move(tempKey));
+    }
     tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
     tempKey.setType(ValueType::Chars);
     tempKey.setValue(UCONFIG_METADATA_VALUE_2DTABLE,
                      strlen(UCONFIG_METADATA_VALUE_2DTABLE) + 1);
-    config->metadata.addKey(&tempKey);
+    config->metadata.addKey(std::move(tempKey));
     /* Delimiter strings */
-    tempKey.reset();
     tempKey.setName(UCONFIG_METADATA_KEY_ROWDELIM);
     tempKey.setType(ValueType::Chars);
     tempKey.setValue(rowDelimiter, strlen(rowDelimiter) + 1);
-    config->metadata.addKey(&tempKey);
-    tempKey.reset();
+    config->metadata.addKey(std::move(tempKey));
     tempKey.setName(UCONFIG_METADATA_KEY_COLDELIM);
     tempKey.setType(ValueType::Chars);
     tempKey.setValue(columnDelimiter, strlen(columnDelimiter) + 1);
-    config->metadata.addKey(&tempKey);
+    config->metadata.addKey(std::move(tempKey));
+    /* Cells whose type differs from that of their column */
+    if (!exceptionCells.empty())
+    {
+        tempKey.setName(UCONFIG_METADATA_KEY_TYPEEXCEPT);
+        tempKey.setType(ValueType::Raw);
+        tempKey.setValue((const char*)(exceptionCells.data()),
+                         int(exceptionCells.size() * sizeof(int)));
+        config->metadata.addKey(std::move(tempKey));
+    }
 
-    fclose(inputFile);
+    // Nodes edited from now on are no longer allocated from the arena
+    config->freezeArena();
     return true;
 }
 
+// Report the rows found in LENGTH bytes of DATA to HANDLER, if any,
+// and store the position where each of them begins in OFFSETS
+// DATA must begin with a row of a table; unless ENDING is true,
+// it must end with a row delimiter, which does not begin another row.
+void Uconfig2DTable::parseRows(const char* data,
+                               size_t length,
+                               bool ending,
+                               UconfigHandler* handler,
+                               std::vector<size_t>& offsets,
+                               const char* rowDelimiter,
+                               const char* columnDelimiter,
+                               bool skipEmptyRow,
+                               bool skipEmptyColumn)
+{
+    std::vector<UconfigKeyObject> rowKeys;
+    UconfigKeyObject tempKey;
+    if (handler)
+        tempKey.setArena(handler->arena());
+
+    // Column types only spare guessing, thus rows are parsed alike
+    // without them
+    UconfigInputBuffer input(data, length);
+    const char* buffer;
+    size_t recordLength;
+    size_t offset = input.position();
+    int readLen;
+    int keyCount;
+    const size_t rowDelimiterLength = strlen(rowDelimiter);
+    while ((ending || offset < length) &&
+           input.readRecord(rowDelimiter, rowDelimiterLength,
+                            &buffer, &recordLength))
+    {
+        size_t rowOffset = offset;
+        readLen = int(recordLength);
+        offset = input.position();
+        if (readLen < 1 && skipEmptyRow)
+            continue;
+
+        offsets.push_back(rowOffset);
+        if (!handler)
+            continue;
+
+        keyCount = parseValues(buffer, rowKeys, handler->arena(), readLen,
+                               columnDelimiter, skipEmptyColumn);
+        if (keyCount > 0)
+            Uconfig_reportRow(handler, rowKeys, keyCount);
+        else
+            Uconfig_reportRaw(handler, tempKey, buffer, readLen);
+    }
+}
+
+// Replace the rows of the table that changed in the new block of text,
+// or build the whole tree again if they cannot be found
+// Changes before the second row (e.g. to the header) and tables stored
+// by column are always read as a whole.
+void Uconfig2DTable::updateTable(const char* data,
+                                 size_t length,
+                                 const char* filename,
+                                 UconfigFile* config,
+                                 UconfigLineIndex* index,
+                                 const char* rowDelimiter,
+                                 const char* columnDelimiter,
+                                 bool skipEmptyRow,
+                                 bool skipEmptyColumn)
+{
+    if (!rowDelimiter)
+        rowDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_ROW;
+    if (!columnDelimiter)
+        columnDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_COL;
+
+    UconfigEntryRef table =
+            config->rootEntry.searchSubentry(UCONFIG_IO_2DTABLE_TYPE_TABLE);
+    size_t rowDelimiterLength = strlen(rowDelimiter);
+    UconfigLineChange change;
+    std::vector<size_t> offsets;
+    if (index->format() == UconfigConverter::TableFormat &&
+        !table.isNull() && !table.columnarEnabled() &&
+        index->entryCount() == table.subentryCount() &&
+        rowDelimiterLength > 0 &&
+        !Uconfig_isOverlapping(rowDelimiter, rowDelimiterLength) &&
+        index->findChange(data, length, false, &change))
+    {
+        const char* range = &data[change.begin];
+        size_t rangeLength = change.end - change.begin;
+        UconfigEntryObject rows;
+        rows.setArena(table.arena());
+        UconfigTreeBuilder builder(rows);
+        bool ending = change.firstEntry + change.entryCount ==
+                      index->entryCount();
+        parseRows(range, rangeLength, ending, &builder,
+                  offsets, rowDelimiter, columnDelimiter,
+                  skipEmptyRow, skipEmptyColumn);
+        if (index->apply(data, length, change, table, rows, offsets))
+        {
+            // Rows read again have their types guessed, and may have moved
+            config->metadata.deleteKey(UCONFIG_METADATA_KEY_TYPEEXCEPT);
+            return;
+        }
+        offsets.clear();
+    }
+
+    // Read the whole content again, then index the rows following
+    // the comment entry, if any
+    config->metadata.reset();
+    UconfigInputBuffer input(data, length);
+    UconfigTreeBuilder builder(config->rootEntry);
+    if (config->columnarEnabled())
+        builder.setColumnarType(Uconfig2DTable::NormalEntry);
+    readTable(input, filename, config, &builder,
+              rowDelimiter, columnDelimiter, skipEmptyRow, skipEmptyColumn);
+    parseRows(data, length, true, NULL, offsets,
+              rowDelimiter, columnDelimiter, skipEmptyRow, skipEmptyColumn);
+    UconfigEntryRef comment =
+            config->rootEntry.searchSubentry(UCONFIG_IO_2DTABLE_TYPE_COMMENT);
+    offsets.erase(offsets.begin(),
+                  offsets.begin() + std::min(size_t(comment.subentryCount()),
+                                             offsets.size()));
+    index->assign(data, length, UconfigConverter::TableFormat, offsets);
+}
+
+// Take the delimiters that are not given (NULL) from the meta-data
+// of CONFIG, i.e. those the table was read with; they remain NULL
+// if they cannot be found
+void Uconfig2DTable::getDelimiters(UconfigFile* config,
+                                   const char** rowDelimiter,
+                                   const char** columnDelimiter)
+{
+    if (!config)
+        return;
+
+    if (!*rowDelimiter)
+        *rowDelimiter =
+            config->metadata.searchKey(UCONFIG_METADATA_KEY_ROWDELIM).value();
+    if (!*columnDelimiter)
+        *columnDelimiter =
+            config->metadata.searchKey(UCONFIG_METADATA_KEY_COLDELIM).value();
+}
+
 bool Uconfig2DTable::writeUconfig(const char* filename,
                                   UconfigFile* config,
                                   const char* rowDelimiter,
@@ -162,31 +709,65 @@ bool Uconfig2DTable::writeUconfig(const char* filename,
     if (!outputFile)
         return false;
 
-    bool success = true;
-    UconfigEntryObject* entryList = config->rootEntry.subentries();
-    for (int i=0; i<config->rootEntry.subentryCount(); i++)
-    {
-        success = Uconfig_fwrite2DTableEntry(outputFile,
-                                             entryList[i],
-                                             rowDelimiter,
-                                             columnDelimiter);
-        if (!success)
-            break;
-    }
+    Uconfig2DTableWriter writer(outputFile, rowDelimiter, columnDelimiter);
+    walkEntry(config->rootEntry, &writer);
 
-    if (entryList)
-        delete[] entryList;
+    bool success = writer.flush();
     fclose(outputFile);
-
     return success;
 }
 
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+// Delimiters not given are taken from the meta-data of CONFIG if any,
+// as when writing to a file without delimiters
+bool Uconfig2DTable::writeUconfig(char** data,
+                                  size_t* length,
+                                  UconfigFile* config,
+                                  const char* rowDelimiter,
+                                  const char* columnDelimiter)
+{
+    if (!data || !length || !config)
+        return false;
+
+    getDelimiters(config, &rowDelimiter, &columnDelimiter);
+
+    UconfigSink sink(data, length);
+    Uconfig2DTableWriter writer(sink, rowDelimiter, columnDelimiter);
+    walkEntry(config->rootEntry, &writer);
+    return writer.flush();
+}
+
 // Parse an expression containing values separated by delimiters
 int Uconfig2DTable::parseValues(const char* expression,
                                 UconfigEntryObject& entry,
                                 int expressionLength,
                                 const char* delimiter,
                                 bool skipEmptyValue)
+{
+    std::vector<UconfigKeyObject> keys;
+    int keyCount = parseValues(expression, keys, entry.arena(),
+                               expressionLength, delimiter, skipEmptyValue);
+    if (keyCount > 0)
+        entry.setType(Uconfig2DTable::Row);
+    for (int i=0; i<keyCount; i++)
+        entry.addKey(std::move(keys[i]));
+
+    return keyCount;
+}
+
+// Parse the values of an expression into the first keys of KEYS,
+// which are reused from one call to another; new keys are allocated
+// from ARENA. Return the number of values parsed.
+// Values of the columns whose type is given by COLUMNTYPES are converted
+// directly to that type if they fit; others have their type guessed.
+int Uconfig2DTable::parseValues(const char* expression,
+                                std::vector<UconfigKeyObject>& keys,
+                                UconfigArena* arena,
+                                int expressionLength,
+                                const char* delimiter,
+                                bool skipEmptyValue,
+                                const std::vector<int>* columnTypes)
 {
     if (!expression)
         return 0;
@@ -196,11 +777,23 @@ int Uconfig2DTable::parseValues(const char* expression,
     int p1 = 0, p2, substrLen;
     int keyCount = 0;
     int delimiterLength = strlen(delimiter);
-    UconfigKeyObject tempKey;
+
+    // Cells whose types are still to be guessed
+    ValueSpan spans[UCONFIG_IO_2DTABLE_BATCH_SIZE];
+    int spanKeys[UCONFIG_IO_2DTABLE_BATCH_SIZE];
+    int spanCount = 0;
 
     while (p1 < expressionLength)
     {
-        substrLen = Uconfig_strpos(&expression[p1], delimiter);
+        // Values may not be terminated by "\0"
+        const char* pos;
+        if (delimiterLength == 1)
+            pos = (const char*)(memchr(&expression[p1], delimiter[0],
+                                       expressionLength - p1));
+        else
+            pos = Uconfig_strnstr(&expression[p1], delimiter,
+                                  expressionLength - p1);
+        substrLen = pos ? int(pos - &expression[p1]) : -1;
         p2 = p1 + substrLen;
         if (substrLen < 0 || p2 + 1 >= expressionLength)
         {
@@ -215,142 +808,135 @@ int Uconfig2DTable::parseValues(const char* expression,
 
         if (substrLen > 0 || !skipEmptyValue)
         {
+            if (keyCount >= int(keys.size()))
+            {
+                keys.emplace_back();
+                keys.back().setArena(arena);
+            }
+            UconfigKeyObject& tempKey = keys[keyCount];
             tempKey.reset();
 
-            ValueType valueType = guessValueType(&expression[p1], substrLen);
-            char* pTail;
-            switch (valueType)
+            if (!columnTypes || keyCount >= int(columnTypes->size()) ||
+                !Uconfig_convertCell(tempKey, &expression[p1], substrLen,
+                                     (*columnTypes)[keyCount]))
             {
-                case ValueType::Chars:
-                    // Ignore wrapping quotes when storing
-                    tempKey.setValue(&expression[p1 + 1],
-                                     substrLen - sizeof(char) * 2);
-                    break;
-                case ValueType::Integer:
+                spans[spanCount].value = &expression[p1];
+                spans[spanCount].length = substrLen;
+                spanKeys[spanCount] = keyCount;
+                if (++spanCount == UCONFIG_IO_2DTABLE_BATCH_SIZE)
                 {
-                    // Store the number as an "int"
-                    int tempInt = int(strtol(&expression[p1], &pTail, 0));
-                    if (pTail > expression)
-                        tempKey.setValue((char*)(&tempInt), sizeof(int));
-                    break;
+                    Uconfig_storeCells(keys, spanKeys, spans, spanCount);
+                    spanCount = 0;
                 }
-                case ValueType::Float:
-                case ValueType::Double:
-                {
-                    // Store the number as a "double"
-                    double tempDouble = strtod(&expression[p1], &pTail);
-                    if (pTail > expression)
-                        tempKey.setValue((char*)(&tempDouble), sizeof(double));
-                    break;
-                }
-                case ValueType::Raw:
-                default:
-                    tempKey.setValue(&expression[p1], substrLen);
-
             }
-            tempKey.setType(valueType);
-
-            entry.setType(Uconfig2DTable::Row);
-            entry.addKey(&tempKey);
             keyCount++;
         }
 
         p1 = p2 + delimiterLength;
     }
 
+    if (spanCount > 0)
+        Uconfig_storeCells(keys, spanKeys, spans, spanCount);
+
     return keyCount;
 }
 
-bool Uconfig_fwrite2DTableEntry(FILE* file,
-                                UconfigEntryObject& entry,
-                                const char* rowDelimiter,
-                                const char* columnDelimiter)
+
+Uconfig2DTableWriter::Uconfig2DTableWriter(const UconfigSink& sink,
+                                           const char* rowDelimiter,
+                                           const char* columnDelimiter) :
+    UconfigWriter(sink)
 {
-    if (entry.subentryCount() < 1)
-        return true;
+    if (!rowDelimiter)
+        rowDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_ROW;
+    if (!columnDelimiter)
+        columnDelimiter = UCONFIG_IO_2DTABLE_DELIMITER_COL;
 
-    int i, j;
-    int entryType = entry.type();
-    int delimiterLength = strlen(rowDelimiter);
-    UconfigKeyObject* keyList = NULL;
-    UconfigEntryObject* subentryList = entry.subentries();
+    this->rowDelimiter = rowDelimiter;
+    this->columnDelimiter = columnDelimiter;
+    level = 0;
+    tableType = Uconfig2DTable::UnknownEntry;
+    rowType = Uconfig2DTable::Raw;
+    keyIndex = 0;
+}
 
-    if (entryType == Uconfig2DTable::NormalEntry)
-    {
-        for (i=0; i<entry.subentryCount(); i++)
-        {
-            if (subentryList[i].type() == Uconfig2DTable::Row)
-            {
-                // Write keys as columns
-                Uconfig_fwrite2DTableSubentry(file,
-                                              subentryList[i],
-                                              columnDelimiter);
-            }
-            else
-            {
-                // Write raw content directly
-                keyList = subentryList[i].keys();
-                for (j=0; j<subentryList[i].keyCount(); j++)
-                {
-                    fwrite(keyList[0].value(),
-                           sizeof(char),
-                           keyList[0].valueSize(),
-                           file);
-                }
-                delete[] keyList;
-            }
-            fwrite(rowDelimiter, sizeof(char), delimiterLength, file);
-        }
-    }
-    else if (entryType == Uconfig2DTable::CommentEntry)
+void Uconfig2DTableWriter::onEntryBegin(const char*, int, int type)
+{
+    level++;
+    if (level == 1)
+        tableType = type;
+    else if (level == 2)
     {
-        for (i=0; i<entry.subentryCount(); i++)
-        {
-            // Write raw content directly
-            keyList = subentryList[i].keys();
-            for (j=0; j<subentryList[i].keyCount(); j++)
-            {
-                fwrite(keyList[0].value(),
-                       sizeof(char),
-                       keyList[0].valueSize(),
-                       file);
-            }
-            delete[] keyList;
-
-            fwrite(rowDelimiter, sizeof(char), delimiterLength, file);
-        }
+        rowType = type;
+        keyIndex = 0;
     }
-
-    if (subentryList)
-        delete[] subentryList;
-    return true;
 }
 
-bool Uconfig_fwrite2DTableSubentry(FILE* file,
-                                   UconfigEntryObject& subentry,
-                                   const char* columnDelimiter)
+void Uconfig2DTableWriter::onKey(UconfigKeyObject& key)
 {
-    if (subentry.keyCount() > 0)
+    if (level != 2)
+        return;
+
+    if (tableType == Uconfig2DTable::NormalEntry &&
+        rowType == Uconfig2DTable::Row)
     {
-        int delimiterLength = strlen(columnDelimiter);
-        UconfigKeyObject* keyList = subentry.keys();
-        for (int i=0; i<subentry.keyCount(); i++)
-        {
-            fwrite(keyList[i].value(),
-                   sizeof(char),
-                   keyList[i].valueSize(),
-                   file);
-            if (i + 1 < subentry.keyCount())
-            {
-                // Only write column delimiters between values
-                fwrite(columnDelimiter,
-                       sizeof(char),
-                       delimiterLength,
-                       file);
-            }
-        }
-        delete[] keyList;
+        // Write keys as columns,
+        // with column delimiters between values only
+        if (keyIndex > 0)
+            output.write(columnDelimiter);
+    }
+    else if (tableType != Uconfig2DTable::CommentEntry &&
+             tableType != Uconfig2DTable::NormalEntry)
+        return;
+
+    // Write values in the way they are parsed:
+    // numbers and booleans as text, strings between quotes;
+    // other content (raw "lines") is written directly
+    const char* value = key.value();
+    int valueSize = key.valueSize();
+    switch (UconfigIO::ValueType(key.type()))
+    {
+        case UconfigIO::Bool:
+            if (valueSize == sizeof(bool))
+                output.write(*(bool*)(value) ? UCONFIG_IO_2DTABLE_BOOL_TRUE :
+                                               UCONFIG_IO_2DTABLE_BOOL_FALSE);
+            else
+                output.write(value, valueSize);
+            break;
+        case UconfigIO::Integer:
+            if (valueSize == sizeof(int))
+                output.writeInteger(*(int*)(value));
+            else
+                output.write(value, valueSize);
+            break;
+        case UconfigIO::Float:
+        case UconfigIO::Double:
+            if (valueSize == sizeof(double))
+                output.writeDouble(*(double*)(value));
+            else if (valueSize == sizeof(float))
+                output.writeFloat(*(float*)(value));
+            else
+                output.write(value, valueSize);
+            break;
+        case UconfigIO::Chars:
+            output.put(UCONFIG_IO_2DTABLE_CHAR_STRING);
+            output.write(value, Uconfig_nameLength(value, valueSize));
+            output.put(UCONFIG_IO_2DTABLE_CHAR_STRING);
+            break;
+        case UconfigIO::Raw:
+        default:
+            output.write(value, valueSize);
     }
+    keyIndex++;
+}
 
-    return true;
+void Uconfig2DTableWriter::onEntryEnd()
+{
+    if (level <= 0)
+        return;
+
+    if (level == 2 && (tableType == Uconfig2DTable::NormalEntry ||
+                       tableType == Uconfig2DTable::CommentEntry))
+        output.write(rowDelimiter);
+    level--;
 }
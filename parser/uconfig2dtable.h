@@ -1,9 +1,14 @@
 #ifndef UCONFIG2DTABLE_H
 #define UCONFIG2DTABLE_H
 
+#include <vector>
 #include "uconfigio.h"
 
 
+typedef struct _IO_FILE FILE;
+class UconfigInputBuffer;
+class UconfigLineIndex;
+
 class Uconfig2DTable : public UconfigIO
 {
 public:
@@ -33,11 +38,126 @@ public:
                              const char* rowDelimiter,
                              const char* columnDelimiter);
 
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config,
+                            const char* rowDelimiter = NULL,
+                            const char* columnDelimiter = NULL,
+                            bool skipEmptyRow = true,
+                            bool skipEmptyColumn = true);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config,
+                             const char* rowDelimiter = NULL,
+                             const char* columnDelimiter = NULL);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler,
+                             const char* rowDelimiter,
+                             const char* columnDelimiter,
+                             bool skipEmptyRow = true,
+                             bool skipEmptyColumn = true);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler,
+                             const char* rowDelimiter = NULL,
+                             const char* columnDelimiter = NULL,
+                             bool skipEmptyRow = true,
+                             bool skipEmptyColumn = true);
+
+    static bool updateUconfig(const char* filename,
+                              UconfigFile* config,
+                              UconfigLineIndex* index,
+                              const char* rowDelimiter = NULL,
+                              const char* columnDelimiter = NULL,
+                              bool skipEmptyRow = true,
+                              bool skipEmptyColumn = true);
+    static bool updateUconfig(const char* data,
+                              size_t length,
+                              UconfigFile* config,
+                              UconfigLineIndex* index,
+                              const char* rowDelimiter = NULL,
+                              const char* columnDelimiter = NULL,
+                              bool skipEmptyRow = true,
+                              bool skipEmptyColumn = true);
+
     static int parseValues(const char* expression,
                            UconfigEntryObject& entry,
                            int expressionLength = 0,
                            const char* delimiter = NULL,
                            bool skipEmptyValue = true);
+
+protected:
+    static int parseValues(const char* expression,
+                           std::vector<UconfigKeyObject>& keys,
+                           UconfigArena* arena,
+                           int expressionLength,
+                           const char* delimiter,
+                           bool skipEmptyValue,
+                           const std::vector<int>* columnTypes = NULL);
+
+    static bool readTable(UconfigInputBuffer& input,
+                          const char* filename,
+                          UconfigFile* config,
+                          UconfigHandler* handler,
+                          const char* rowDelimiter,
+                          const char* columnDelimiter,
+                          bool skipEmptyRow,
+                          bool skipEmptyColumn);
+    static bool parseTable(UconfigInputBuffer& input,
+                           UconfigHandler* handler,
+                           const char* rowDelimiter,
+                           const char* columnDelimiter,
+                           bool skipEmptyRow,
+                           bool skipEmptyColumn,
+                           std::vector<int>* exceptionCells = NULL);
+
+    static void parseRows(const char* data,
+                          size_t length,
+                          bool ending,
+                          UconfigHandler* handler,
+                          std::vector<size_t>& offsets,
+                          const char* rowDelimiter,
+                          const char* columnDelimiter,
+                          bool skipEmptyRow,
+                          bool skipEmptyColumn);
+    static void updateTable(const char* data,
+                            size_t length,
+                            const char* filename,
+                            UconfigFile* config,
+                            UconfigLineIndex* index,
+                            const char* rowDelimiter,
+                            const char* columnDelimiter,
+                            bool skipEmptyRow,
+                            bool skipEmptyColumn);
+
+    static void getDelimiters(UconfigFile* config,
+                              const char** rowDelimiter,
+                              const char** columnDelimiter);
+};
+
+// Write the reported rows (subentries of tables) to a file
+// as soon as they arrive
+class Uconfig2DTableWriter : public UconfigWriter
+{
+public:
+    Uconfig2DTableWriter(const UconfigSink& sink,
+                         const char* rowDelimiter = NULL,
+                         const char* columnDelimiter = NULL);
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+protected:
+    const char* rowDelimiter;
+    const char* columnDelimiter;
+    int level;
+    int tableType;
+    int rowType;
+    int keyIndex;
 };
 
 #endif // UCONFIG2DTABLE_H
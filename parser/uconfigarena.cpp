@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <string.h>
+#include "uconfigarena.h"
+#include "utils.h"
+
+#define UCONFIG_ARENA_CHUNK_SIZE_MIN    65536
+#define UCONFIG_ARENA_CHUNK_SIZE_MAX    4194304
+#define UCONFIG_ARENA_ALIGNMENT         sizeof(void*)
+#define UCONFIG_ARENA_NAME_CAPACITY_MIN 64
+
+
+struct UconfigArenaChunk
+{
+    UconfigArenaChunk* next;
+    size_t size;  // Number of bytes available after the header
+    size_t used;  // Number of bytes already handed out
+};
+
+struct UconfigArenaName
+{
+    const char* name;  // NULL for an empty slot
+    int size;
+    unsigned int hash;
+};
+
+
+UconfigArena::UconfigArena()
+{
+    chunks = NULL;
+    nextChunkSize = UCONFIG_ARENA_CHUNK_SIZE_MIN;
+    totalUsedSize = 0;
+    frozen = false;
+    nameTable = NULL;
+    nameCapacity = 0;
+    nameCount = 0;
+}
+
+UconfigArena::~UconfigArena()
+{
+    release();
+}
+
+// Allocate SIZE bytes, aligned for any of the tree's structures.
+// The block comes from the current chunk unless the arena is frozen.
+void* UconfigArena::allocate(size_t size)
+{
+    if (size == 0)
+        size = 1;
+
+    if (frozen)
+    {
+        void* block = malloc(size);
+        if (block)
+            heapBlocks.insert(block);
+        return block;
+    }
+
+    size = (size + UCONFIG_ARENA_ALIGNMENT - 1) &
+           ~(UCONFIG_ARENA_ALIGNMENT - 1);
+    if (!chunks || chunks->used + size > chunks->size)
+    {
+        if (!allocateChunk(size))
+            return NULL;
+    }
+
+    void* block = reinterpret_cast<char*>(chunks + 1) + chunks->used;
+    chunks->used += size;
+    totalUsedSize += size;
+    return block;
+}
+
+// Resize a block allocated by this function, or allocate one if POINTER
+// is NULL. Chunks cannot grow: such blocks always come from the heap,
+// and are tracked like those allocated after the arena was frozen.
+void* UconfigArena::reallocate(void* pointer, size_t size)
+{
+    if (pointer && heapBlocks.erase(pointer) == 0)
+        return NULL;
+
+    void* block = realloc(pointer, size > 0 ? size : 1);
+    if (!block)
+    {
+        if (pointer)
+            heapBlocks.insert(pointer);
+        return NULL;
+    }
+    heapBlocks.insert(block);
+    return block;
+}
+
+// Free a block allocated from the heap (by reallocate(), or after
+// the arena was frozen).
+// Blocks carved out of chunks are kept until release().
+void UconfigArena::deallocate(void* pointer)
+{
+    if (!pointer)
+        return;
+
+    if (heapBlocks.erase(pointer) > 0)
+        free(pointer);
+}
+
+// Free all the memory held by the arena at once,
+// and make it ready for loading a new tree
+void UconfigArena::release()
+{
+    UconfigArenaChunk* chunk;
+    while (chunks)
+    {
+        chunk = chunks;
+        chunks = chunks->next;
+        free(chunk);
+    }
+
+    std::unordered_set<void*>::const_iterator i;
+    for (i=heapBlocks.begin(); i!=heapBlocks.end(); i++)
+        free(*i);
+    heapBlocks.clear();
+
+    free(nameTable);
+    nameTable = NULL;
+    nameCapacity = 0;
+    nameCount = 0;
+
+    nextChunkSize = UCONFIG_ARENA_CHUNK_SIZE_MIN;
+    totalUsedSize = 0;
+    frozen = false;
+}
+
+bool UconfigArena::isFrozen() const
+{
+    return frozen;
+}
+
+// Send further allocations to the heap, e.g. for nodes edited after load
+void UconfigArena::freeze()
+{
+    frozen = true;
+}
+
+// Get the shared copy of a name of SIZE bytes, storing the name
+// in the arena if it has not been seen yet
+// Return NULL if the name is not shared and the arena is frozen:
+// the caller shall then store the name by itself
+const char* UconfigArena::shareName(const char* name, int size)
+{
+    if (!name || size <= 0)
+        return NULL;
+
+    unsigned int hash = Uconfig_hashName(name, size);
+    int i = searchName(name, size, hash);
+    if (i >= 0 && nameTable[i].name)
+        return nameTable[i].name;
+    if (frozen)
+        return NULL;
+
+    // Keep the load factor under 1/2
+    if ((nameCount + 1) * 2 > nameCapacity)
+    {
+        if (!growNameTable())
+            return NULL;
+        i = searchName(name, size, hash);
+    }
+
+    char* copy = static_cast<char*>(allocate(size));
+    if (!copy)
+        return NULL;
+    memcpy(copy, name, size);
+
+    nameTable[i].name = copy;
+    nameTable[i].size = size;
+    nameTable[i].hash = hash;
+    nameCount++;
+    return copy;
+}
+
+// Get the shared copy of a name without storing it
+// Return NULL if the name is not shared
+const char* UconfigArena::sharedName(const char* name, int size) const
+{
+    if (!name || size <= 0 || nameCount == 0)
+        return NULL;
+
+    int i = searchName(name, size, Uconfig_hashName(name, size));
+    return i >= 0 ? nameTable[i].name : NULL;
+}
+
+int UconfigArena::chunkCount() const
+{
+    int count = 0;
+    for (UconfigArenaChunk* chunk = chunks; chunk; chunk = chunk->next)
+        count++;
+    return count;
+}
+
+size_t UconfigArena::usedSize() const
+{
+    return totalUsedSize;
+}
+
+int UconfigArena::sharedNameCount() const
+{
+    return nameCount;
+}
+
+// Put a new chunk at the head of the list, large enough for SIZE bytes.
+// Chunks grow geometrically so that their number stays logarithmic
+// until the maximum chunk size is reached.
+void* UconfigArena::allocateChunk(size_t size)
+{
+    size_t chunkSize = nextChunkSize;
+    if (chunkSize < size)
+        chunkSize = size;
+
+    UconfigArenaChunk* chunk = static_cast<UconfigArenaChunk*>(
+                            malloc(sizeof(UconfigArenaChunk) + chunkSize));
+    if (!chunk)
+        return NULL;
+
+    chunk->next = chunks;
+    chunk->size = chunkSize;
+    chunk->used = 0;
+    chunks = chunk;
+
+    if (nextChunkSize < UCONFIG_ARENA_CHUNK_SIZE_MAX)
+        nextChunkSize *= 2;
+
+    return chunk;
+}
+
+// Find the slot of a name in the table with linear probing
+// Return the empty slot where the name would go if it is not found,
+// or -1 if the table is not allocated yet
+int UconfigArena::searchName(const char* name,
+                             int size,
+                             unsigned int hash) const
+{
+    if (nameCapacity == 0)
+        return -1;
+
+    int mask = nameCapacity - 1;
+    int i = hash & mask;
+    while (nameTable[i].name)
+    {
+        if (nameTable[i].hash == hash && nameTable[i].size == size &&
+            memcmp(nameTable[i].name, name, size) == 0)
+            break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// Double the capacity of the name table, and put the names
+// back into their slots
+bool UconfigArena::growNameTable()
+{
+    int capacity = nameCapacity > 0 ? nameCapacity * 2 :
+                                      UCONFIG_ARENA_NAME_CAPACITY_MIN;
+    UconfigArenaName* table = static_cast<UconfigArenaName*>(
+                            calloc(capacity, sizeof(UconfigArenaName)));
+    if (!table)
+        return false;
+
+    int mask = capacity - 1;
+    for (int i=0; i<nameCapacity; i++)
+    {
+        if (!nameTable[i].name)
+            continue;
+
+        int j = nameTable[i].hash & mask;
+        while (table[j].name)
+            j = (j + 1) & mask;
+        table[j] = nameTable[i];
+    }
+
+    free(nameTable);
+    nameTable = table;
+    nameCapacity = capacity;
+    return true;
+}
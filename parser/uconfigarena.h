@@ -0,0 +1,62 @@
+#ifndef UCONFIGARENA_H
+#define UCONFIGARENA_H
+
+/*
+ * This class offers a bump allocator backing a whole configuration tree.
+ * Names, values, keys and entries are carved out of large chunks, and are
+ * never freed one by one: the whole tree is released at once by freeing
+ * the chunks.
+ * Once the arena is frozen (normally when a parser finishes loading),
+ * further allocations fall back to the heap. Such blocks are tracked,
+ * so that they can be freed either individually or along with the chunks.
+ * The arena also keeps a table of shared names: a name that repeats
+ * across the tree (a column of a table, the tag of an element, etc.)
+ * is stored once in a chunk, and its address is used by every node
+ * of that name, so that such nodes can be compared by pointer.
+ */
+
+#include <stddef.h>
+#include <unordered_set>
+
+
+struct UconfigArenaChunk;
+struct UconfigArenaName;
+
+class UconfigArena
+{
+public:
+    UconfigArena();
+    ~UconfigArena();
+
+    void* allocate(size_t size);
+    void* reallocate(void* pointer, size_t size);
+    void deallocate(void* pointer);
+    void release();
+
+    bool isFrozen() const;
+    void freeze();
+
+    const char* shareName(const char* name, int size);
+    const char* sharedName(const char* name, int size) const;
+
+    // Statistics
+    int chunkCount() const;
+    size_t usedSize() const;
+    int sharedNameCount() const;
+
+protected:
+    UconfigArenaChunk* chunks;
+    size_t nextChunkSize;
+    size_t totalUsedSize;
+    bool frozen;
+    std::unordered_set<void*> heapBlocks;
+    UconfigArenaName* nameTable;
+    int nameCapacity;
+    int nameCount;
+
+    void* allocateChunk(size_t size);
+    int searchName(const char* name, int size, unsigned int hash) const;
+    bool growNameTable();
+};
+
+#endif // UCONFIGARENA_H
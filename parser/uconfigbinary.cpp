@@ -0,0 +1,778 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uconfigbinary.h"
+#include "utils.h"
+
+// All tables begin on this boundary
+#define UCONFIG_BINARY_ALIGNMENT        8
+
+// Initial number of slots of the hash table of names
+#define UCONFIG_BINARY_NAME_SLOTS       64
+
+// The layout of a snapshot must not depend on the compiler
+static_assert(sizeof(UconfigBinaryHeader) == 88,
+              "Unexpected size of snapshot header");
+static_assert(sizeof(UconfigBinaryEntryRecord) == 32,
+              "Unexpected size of snapshot entries");
+static_assert(sizeof(UconfigBinaryKeyRecord) == 24,
+              "Unexpected size of snapshot keys");
+
+
+static uint64_t Uconfig_alignSize(uint64_t size)
+{
+    return (size + UCONFIG_BINARY_ALIGNMENT - 1) &
+           ~uint64_t(UCONFIG_BINARY_ALIGNMENT - 1);
+}
+
+// Check that a table of COUNT records lies within a snapshot of SIZE bytes
+static bool Uconfig_checkTable(uint64_t size,
+                               uint64_t offset,
+                               uint64_t count,
+                               uint64_t recordSize,
+                               bool aligned = true)
+{
+    if (aligned && offset % UCONFIG_BINARY_ALIGNMENT != 0)
+        return false;
+    if (offset < sizeof(UconfigBinaryHeader) || offset > size)
+        return false;
+    return count <= (size - offset) / recordSize;
+}
+
+// Check that COUNT items beginning at FIRST lie within a table of TOTAL
+static bool Uconfig_checkRange(uint32_t first, int32_t count, uint32_t total)
+{
+    return count >= 0 && uint64_t(first) + uint64_t(count) <= total;
+}
+
+
+UconfigBinaryKey::UconfigBinaryKey(const UconfigBinaryView* view,
+                                   const UconfigBinaryKeyRecord* record)
+{
+    this->view = view;
+    this->record = record;
+}
+
+bool UconfigBinaryKey::isNull() const
+{
+    return record == NULL;
+}
+
+const char* UconfigBinaryKey::name() const
+{
+    if (!record)
+        return NULL;
+    return view->string(record->nameOffset, record->nameSize);
+}
+
+int UconfigBinaryKey::nameSize() const
+{
+    return name() ? record->nameSize : 0;
+}
+
+int UconfigBinaryKey::type() const
+{
+    return record ? record->type : 0;
+}
+
+// Short values are read from the key, others from the string table
+const char* UconfigBinaryKey::value() const
+{
+    if (!record || record->valueSize <= 0)
+        return NULL;
+    if (record->valueSize <= UCONFIG_BINARY_VALUE_INLINE)
+        return record->value.bytes;
+    return view->string(record->value.offset, record->valueSize);
+}
+
+int UconfigBinaryKey::valueSize() const
+{
+    return value() ? record->valueSize : 0;
+}
+
+
+UconfigBinaryEntry::UconfigBinaryEntry(const UconfigBinaryView* view,
+                                       const UconfigBinaryEntryRecord* record)
+{
+    this->view = view;
+    this->record = record;
+}
+
+bool UconfigBinaryEntry::isNull() const
+{
+    return record == NULL;
+}
+
+const char* UconfigBinaryEntry::name() const
+{
+    if (!record)
+        return NULL;
+    return view->string(record->nameOffset, record->nameSize);
+}
+
+int UconfigBinaryEntry::nameSize() const
+{
+    return name() ? record->nameSize : 0;
+}
+
+int UconfigBinaryEntry::type() const
+{
+    return record ? record->type : 0;
+}
+
+int UconfigBinaryEntry::keyCount() const
+{
+    if (!record ||
+        !Uconfig_checkRange(record->firstKey,
+                            record->keyCount,
+                            view->header->keyCount))
+        return 0;
+    return record->keyCount;
+}
+
+UconfigBinaryKey UconfigBinaryEntry::key(int index) const
+{
+    if (index < 0 || index >= keyCount())
+        return UconfigBinaryKey();
+    return UconfigBinaryKey(view, &view->keys[record->firstKey + index]);
+}
+
+// Search a key by its name; NAMESIZE is strlen()+1 if not given
+UconfigBinaryKey UconfigBinaryEntry::searchKey(const char* keyName,
+                                               int nameSize) const
+{
+    if (!keyName)
+        return UconfigBinaryKey();
+    if (nameSize <= 0)
+        nameSize = strlen(keyName) + 1;
+
+    UconfigBinaryKey key;
+    int count = keyCount();
+    for (int i=0; i<count; i++)
+    {
+        key = UconfigBinaryKey(view, &view->keys[record->firstKey + i]);
+        if (key.nameSize() == nameSize &&
+            memcmp(key.name(), keyName, nameSize) == 0)
+            return key;
+    }
+    return UconfigBinaryKey();
+}
+
+int UconfigBinaryEntry::subentryCount() const
+{
+    if (!record ||
+        !Uconfig_checkRange(record->firstChild,
+                            record->subentryCount,
+                            view->header->childCount))
+        return 0;
+    return record->subentryCount;
+}
+
+// Entries are stored after their parent: a subentry of a lower index
+// is refused, so that a damaged snapshot cannot make a loop
+UconfigBinaryEntry UconfigBinaryEntry::subentry(int index) const
+{
+    if (index < 0 || index >= subentryCount())
+        return UconfigBinaryEntry();
+
+    uint32_t childIndex = view->children[record->firstChild + index];
+    if (childIndex <= uint32_t(record - view->entries))
+        return UconfigBinaryEntry();
+    return UconfigBinaryEntry(view, view->entry(childIndex));
+}
+
+// Search a direct subentry by its name; NAMESIZE is strlen()+1 if not given
+UconfigBinaryEntry UconfigBinaryEntry::searchSubentry(const char* entryName,
+                                                      int nameSize) const
+{
+    if (!entryName)
+        return UconfigBinaryEntry();
+    if (nameSize <= 0)
+        nameSize = strlen(entryName) + 1;
+
+    UconfigBinaryEntry subentry;
+    int count = subentryCount();
+    for (int i=0; i<count; i++)
+    {
+        subentry = this->subentry(i);
+        if (subentry.nameSize() == nameSize &&
+            memcmp(subentry.name(), entryName, nameSize) == 0)
+            return subentry;
+    }
+    return UconfigBinaryEntry();
+}
+
+UconfigBinaryEntry UconfigBinaryEntry::parentEntry() const
+{
+    if (!record)
+        return UconfigBinaryEntry();
+    return UconfigBinaryEntry(view, view->entry(record->parent));
+}
+
+
+UconfigBinaryView::UconfigBinaryView()
+{
+    data = NULL;
+    length = 0;
+    mapped = false;
+    header = NULL;
+    entries = NULL;
+    keys = NULL;
+    children = NULL;
+    strings = NULL;
+}
+
+UconfigBinaryView::~UconfigBinaryView()
+{
+    close();
+}
+
+// Map a snapshot file into memory
+bool UconfigBinaryView::open(const char* filename)
+{
+    close();
+
+    size_t fileLength;
+    const char* fileData = Uconfig_mapFile(filename, &fileLength);
+    if (!fileData)
+        return false;
+
+    if (!open(fileData, fileLength))
+    {
+        Uconfig_unmapFile(fileData, fileLength);
+        return false;
+    }
+    mapped = true;
+    return true;
+}
+
+// Use LENGTH bytes of DATA as a snapshot, without copying them
+// DATA must be aligned to 8 bytes (as returned by malloc()), and must
+// remain unchanged until the view is closed.
+bool UconfigBinaryView::open(const char* data, size_t length)
+{
+    close();
+
+    if (!data || length < sizeof(UconfigBinaryHeader) ||
+        uintptr_t(data) % UCONFIG_BINARY_ALIGNMENT != 0)
+        return false;
+
+    const UconfigBinaryHeader* header = (const UconfigBinaryHeader*)(data);
+    if (memcmp(header->magic,
+               UCONFIG_BINARY_MAGIC,
+               UCONFIG_BINARY_MAGIC_SIZE) != 0 ||
+        header->version != UCONFIG_BINARY_VERSION ||
+        header->byteOrder != UCONFIG_BINARY_BYTE_ORDER ||
+        header->size > length)
+        return false;
+
+    if (!Uconfig_checkTable(header->size,
+                            header->entryOffset,
+                            header->entryCount,
+                            sizeof(UconfigBinaryEntryRecord)) ||
+        !Uconfig_checkTable(header->size,
+                            header->keyOffset,
+                            header->keyCount,
+                            sizeof(UconfigBinaryKeyRecord)) ||
+        !Uconfig_checkTable(header->size,
+                            header->childOffset,
+                            header->childCount,
+                            sizeof(uint32_t)) ||
+        !Uconfig_checkTable(header->size,
+                            header->stringOffset,
+                            header->stringSize,
+                            1, false))
+        return false;
+
+    if (header->rootEntry >= header->entryCount ||
+        (header->metadataEntry != UCONFIG_BINARY_NO_ENTRY &&
+         header->metadataEntry >= header->entryCount))
+        return false;
+
+    this->data = data;
+    this->length = length;
+    this->header = header;
+    entries = (const UconfigBinaryEntryRecord*)(data + header->entryOffset);
+    keys = (const UconfigBinaryKeyRecord*)(data + header->keyOffset);
+    children = (const uint32_t*)(data + header->childOffset);
+    strings = data + header->stringOffset;
+    return true;
+}
+
+void UconfigBinaryView::close()
+{
+    if (mapped)
+        Uconfig_unmapFile(data, length);
+
+    data = NULL;
+    length = 0;
+    mapped = false;
+    header = NULL;
+    entries = NULL;
+    keys = NULL;
+    children = NULL;
+    strings = NULL;
+}
+
+bool UconfigBinaryView::isOpen() const
+{
+    return header != NULL;
+}
+
+UconfigBinaryEntry UconfigBinaryView::rootEntry() const
+{
+    if (!header)
+        return UconfigBinaryEntry();
+    return UconfigBinaryEntry(this, entry(header->rootEntry));
+}
+
+UconfigBinaryEntry UconfigBinaryView::metadata() const
+{
+    if (!header)
+        return UconfigBinaryEntry();
+    return UconfigBinaryEntry(this, entry(header->metadataEntry));
+}
+
+const UconfigBinaryEntryRecord* UconfigBinaryView::entry(uint32_t index) const
+{
+    if (!header || index >= header->entryCount)
+        return NULL;
+    return &entries[index];
+}
+
+const char* UconfigBinaryView::string(uint64_t offset, int size) const
+{
+    if (!header || size <= 0 ||
+        offset > header->stringSize ||
+        uint64_t(size) > header->stringSize - offset)
+        return NULL;
+    return strings + offset;
+}
+
+
+// Open a view over DATA, or over a copy of it stored in *COPY
+// if DATA is not aligned to 8 bytes
+static bool Uconfig_openView(UconfigBinaryView& view,
+                             const char* data,
+                             size_t length,
+                             char** copy)
+{
+    *copy = NULL;
+    if (uintptr_t(data) % UCONFIG_BINARY_ALIGNMENT == 0)
+        return view.open(data, length);
+
+    *copy = (char*)(malloc(length));
+    if (!*copy)
+        return false;
+    memcpy(*copy, data, length);
+    return view.open(*copy, length);
+}
+
+// Report the tree and the meta-data of a file to a snapshot writer
+static bool Uconfig_writeSnapshot(UconfigBinaryWriter& writer,
+                                  UconfigFile* config)
+{
+    writer.setRootEntry(config->rootEntry.name(),
+                        config->rootEntry.nameSize(),
+                        config->rootEntry.type());
+    UconfigIO::walkEntry(config->rootEntry, &writer);
+    writer.writeMetadata(config->metadata);
+    return writer.flush();
+}
+
+// Load a snapshot file into CONFIG
+// The meta-data are those of the file that the snapshot was made from.
+bool UconfigBinary::readUconfig(const char* filename, UconfigFile* config)
+{
+    if (!config)
+        return false;
+
+    UconfigBinaryView view;
+    if (!view.open(filename))
+        return false;
+    return readView(view, config);
+}
+
+bool UconfigBinary::readUconfig(const char* data,
+                                size_t length,
+                                UconfigFile* config)
+{
+    if (!data || !config)
+        return false;
+
+    char* copy;
+    UconfigBinaryView view;
+    bool success = Uconfig_openView(view, data, length, &copy) &&
+                   readView(view, config);
+    view.close();
+    free(copy);
+    return success;
+}
+
+bool UconfigBinary::writeUconfig(const char* filename, UconfigFile* config)
+{
+    if (!config)
+        return false;
+
+    FILE* outputFile = fopen(filename, "wb");
+    if (!outputFile)
+        return false;
+
+    UconfigBinaryWriter writer(outputFile);
+    bool success = Uconfig_writeSnapshot(writer, config);
+    fclose(outputFile);
+    return success;
+}
+
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigBinary::writeUconfig(char** data,
+                                 size_t* length,
+                                 UconfigFile* config)
+{
+    if (!data || !length || !config)
+        return false;
+
+    UconfigSink sink(data, length);
+    UconfigBinaryWriter writer(sink);
+    return Uconfig_writeSnapshot(writer, config);
+}
+
+// Report the tree of a snapshot file to HANDLER, without its meta-data
+bool UconfigBinary::parseUconfig(const char* filename,
+                                 UconfigHandler* handler)
+{
+    if (!handler)
+        return false;
+
+    UconfigBinaryView view;
+    if (!view.open(filename))
+        return false;
+
+    walkEntry(view.rootEntry(), handler);
+    return true;
+}
+
+bool UconfigBinary::parseUconfig(const char* data,
+                                 size_t length,
+                                 UconfigHandler* handler)
+{
+    if (!data || !handler)
+        return false;
+
+    char* copy;
+    UconfigBinaryView view;
+    bool success = Uconfig_openView(view, data, length, &copy);
+    if (success)
+        walkEntry(view.rootEntry(), handler);
+    view.close();
+    free(copy);
+    return success;
+}
+
+// Report the keys and the subentries of a snapshot entry to HANDLER,
+// e.g. to copy a part of a snapshot into a mutable tree
+void UconfigBinary::walkEntry(const UconfigBinaryEntry& entry,
+                              UconfigHandler* handler)
+{
+    UconfigKeyObject tempKey;
+    tempKey.setArena(handler->arena());
+
+    UconfigBinaryKey key;
+    int count = entry.keyCount();
+    for (int i=0; i<count; i++)
+    {
+        key = entry.key(i);
+        tempKey.setName(key.name(), key.nameSize());
+        tempKey.setType(key.type());
+        tempKey.setValue(key.value(), key.valueSize());
+        handler->onKey(tempKey);
+        tempKey.reset();
+    }
+
+    UconfigBinaryEntry subentry;
+    count = entry.subentryCount();
+    for (int i=0; i<count; i++)
+    {
+        subentry = entry.subentry(i);
+        if (subentry.isNull())
+            continue;
+
+        handler->onEntryBegin(subentry.name(),
+                              subentry.nameSize(),
+                              subentry.type());
+        walkEntry(subentry, handler);
+        handler->onEntryEnd();
+    }
+}
+
+// Turn a whole snapshot into a mutable tree, with its meta-data
+bool UconfigBinary::readView(const UconfigBinaryView& view,
+                             UconfigFile* config)
+{
+    if (!view.isOpen() || !config)
+        return false;
+
+    UconfigBinaryEntry root = view.rootEntry();
+    UconfigTreeBuilder builder(config->rootEntry);
+    walkEntry(root, &builder);
+    config->rootEntry.setType(root.type());
+    if (root.name())
+        config->rootEntry.setName(root.name(), root.nameSize());
+
+    UconfigBinaryEntry metadata = view.metadata();
+    if (!metadata.isNull())
+    {
+        UconfigTreeBuilder metadataBuilder(config->metadata);
+        walkEntry(metadata, &metadataBuilder);
+    }
+
+    config->freezeArena();
+    return true;
+}
+
+
+UconfigBinaryWriter::UconfigBinaryWriter(const UconfigSink& sink) :
+    UconfigWriter(sink)
+{
+    nameCount = 0;
+    level = -1;
+    metadataEntry = UCONFIG_BINARY_NO_ENTRY;
+    written = false;
+    rootEntry = beginEntry(NULL, 0, 0);
+}
+
+void UconfigBinaryWriter::onEntryBegin(const char* name, int nameSize, int type)
+{
+    if (level < 0)
+        return;
+    beginEntry(name, nameSize, type);
+}
+
+void UconfigBinaryWriter::onKey(UconfigKeyObject& key)
+{
+    if (level < 0)
+        return;
+
+    UconfigBinaryKeyRecord record;
+    memset(&record, 0, sizeof(record));
+    record.nameSize = key.name() ? key.nameSize() : 0;
+    record.nameOffset = addName(key.name(), record.nameSize);
+    record.type = key.type();
+
+    const char* value = key.value();
+    if (value && key.valueSize() > 0)
+    {
+        record.valueSize = key.valueSize();
+        if (record.valueSize <= UCONFIG_BINARY_VALUE_INLINE)
+            memcpy(record.value.bytes, value, record.valueSize);
+        else
+            record.value.offset = addString(value, record.valueSize);
+    }
+    levels[level].keys.push_back(record);
+}
+
+void UconfigBinaryWriter::onEntryEnd()
+{
+    // The root entry is closed when the writer is flushed
+    if (level <= 0)
+        return;
+    endEntry();
+}
+
+// Set the name and the type of the root entry, which are not reported
+void UconfigBinaryWriter::setRootEntry(const char* name,
+                                       int nameSize,
+                                       int type)
+{
+    if (written)
+        return;
+
+    UconfigBinaryEntryRecord& record = entries[rootEntry];
+    if (name && nameSize <= 0)
+        nameSize = strlen(name) + 1;
+    record.nameSize = name ? nameSize : 0;
+    record.nameOffset = addName(name, record.nameSize);
+    record.type = type;
+}
+
+// Close the tree reported so far, then store the meta-data of its file
+// Nodes reported afterwards are ignored.
+void UconfigBinaryWriter::writeMetadata(const UconfigEntryRef& metadata)
+{
+    if (written || metadataEntry != UCONFIG_BINARY_NO_ENTRY)
+        return;
+
+    while (level >= 0)
+        endEntry();
+
+    metadataEntry = beginEntry(metadata.name(),
+                               metadata.nameSize(),
+                               metadata.type());
+    UconfigIO::walkEntry(metadata, this);
+    while (level >= 0)
+        endEntry();
+}
+
+bool UconfigBinaryWriter::flush()
+{
+    if (!written)
+    {
+        while (level >= 0)
+            endEntry();
+        writeSnapshot();
+        written = true;
+    }
+    return UconfigWriter::flush();
+}
+
+// Add an entry to the table, as a subentry of the current one if any,
+// and make it the current entry
+uint32_t UconfigBinaryWriter::beginEntry(const char* name,
+                                         int nameSize,
+                                         int type)
+{
+    UconfigBinaryEntryRecord record;
+    memset(&record, 0, sizeof(record));
+    if (name && nameSize <= 0)
+        nameSize = strlen(name) + 1;
+    record.nameSize = name ? nameSize : 0;
+    record.nameOffset = addName(name, record.nameSize);
+    record.type = type;
+
+    uint32_t index = entries.size();
+    if (level >= 0)
+    {
+        record.parent = levels[level].entry;
+        levels[level].children.push_back(index);
+    }
+    else
+        record.parent = UCONFIG_BINARY_NO_ENTRY;
+    entries.push_back(record);
+
+    // Levels are kept for the next entries, with their buffers
+    level++;
+    if (level >= int(levels.size()))
+        levels.emplace_back();
+    levels[level].entry = index;
+    levels[level].keys.clear();
+    levels[level].children.clear();
+    return index;
+}
+
+// Move the keys and the subentries of the current entry to the tables,
+// then go back to its parent
+void UconfigBinaryWriter::endEntry()
+{
+    Level& current = levels[level];
+    UconfigBinaryEntryRecord& record = entries[current.entry];
+
+    record.firstKey = keys.size();
+    record.keyCount = current.keys.size();
+    keys.insert(keys.end(), current.keys.begin(), current.keys.end());
+
+    record.firstChild = children.size();
+    record.subentryCount = current.children.size();
+    children.insert(children.end(),
+                    current.children.begin(),
+                    current.children.end());
+
+    level--;
+}
+
+// Store a name in the string table, once for all the nodes of that name
+// Return its position in the table.
+uint32_t UconfigBinaryWriter::addName(const char* name, int nameSize)
+{
+    if (!name || nameSize <= 0)
+        return 0;
+
+    // Keep the hash table at most half full
+    if ((nameCount + 1) * 2 > names.size())
+    {
+        std::vector<NameSlot> oldNames;
+        oldNames.swap(names);
+        names.assign(oldNames.empty() ? UCONFIG_BINARY_NAME_SLOTS :
+                                        oldNames.size() * 2,
+                     NameSlot{0, -1});
+
+        unsigned int mask = names.size() - 1;
+        for (const NameSlot& slot : oldNames)
+        {
+            if (slot.size < 0)
+                continue;
+
+            unsigned int i = Uconfig_hashName(&strings[slot.offset],
+                                              slot.size) & mask;
+            while (names[i].size >= 0)
+                i = (i + 1) & mask;
+            names[i] = slot;
+        }
+    }
+
+    unsigned int mask = names.size() - 1;
+    unsigned int i = Uconfig_hashName(name, nameSize) & mask;
+    while (names[i].size >= 0)
+    {
+        if (names[i].size == nameSize &&
+            memcmp(&strings[names[i].offset], name, nameSize) == 0)
+            return names[i].offset;
+        i = (i + 1) & mask;
+    }
+
+    uint32_t offset = strings.size();
+    strings.insert(strings.end(), name, name + nameSize);
+    names[i].offset = offset;
+    names[i].size = nameSize;
+    nameCount++;
+    return offset;
+}
+
+// Store a long value in the string table, aligned as if it were
+// allocated, so that numbers can be read in place
+uint64_t UconfigBinaryWriter::addString(const char* string, int size)
+{
+    strings.resize(Uconfig_alignSize(strings.size()), '\0');
+    uint64_t offset = strings.size();
+    strings.insert(strings.end(), string, string + size);
+    return offset;
+}
+
+// Write the header, then all the tables
+void UconfigBinaryWriter::writeSnapshot()
+{
+    UconfigBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, UCONFIG_BINARY_MAGIC, UCONFIG_BINARY_MAGIC_SIZE);
+    header.version = UCONFIG_BINARY_VERSION;
+    header.byteOrder = UCONFIG_BINARY_BYTE_ORDER;
+    header.rootEntry = rootEntry;
+    header.metadataEntry = metadataEntry;
+    header.entryCount = entries.size();
+    header.keyCount = keys.size();
+    header.childCount = children.size();
+
+    header.entryOffset = Uconfig_alignSize(sizeof(header));
+    header.keyOffset = header.entryOffset +
+                       entries.size() * sizeof(UconfigBinaryEntryRecord);
+    header.childOffset = header.keyOffset +
+                         keys.size() * sizeof(UconfigBinaryKeyRecord);
+    header.stringOffset = Uconfig_alignSize(header.childOffset +
+                                            children.size() * sizeof(uint32_t));
+    header.stringSize = strings.size();
+    header.size = header.stringOffset + header.stringSize;
+
+    static const char padding[UCONFIG_BINARY_ALIGNMENT] = {0};
+    int paddingSize = header.stringOffset - header.childOffset -
+                      children.size() * sizeof(uint32_t);
+
+    output.write((const char*)(&header), sizeof(header));
+    output.write((const char*)(entries.data()),
+                 entries.size() * sizeof(UconfigBinaryEntryRecord));
+    output.write((const char*)(keys.data()),
+                 keys.size() * sizeof(UconfigBinaryKeyRecord));
+    output.write((const char*)(children.data()),
+                 children.size() * sizeof(uint32_t));
+    output.write(padding, paddingSize);
+    output.write(strings.data(), strings.size());
+}
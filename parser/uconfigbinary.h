@@ -0,0 +1,243 @@
+#ifndef UCONFIGBINARY_H
+#define UCONFIGBINARY_H
+
+/*
+ * Native binary snapshot of a configuration (its entry tree and its
+ * meta-data), which is loaded without any parsing.
+ * All nodes are stored in flat tables and refer to each other by index:
+ * entries, keys, subentry lists (indexes of entries) and a table
+ * of strings holding the names (once each) and the long values.
+ * Values of up to 8 bytes (numbers, booleans, short strings) are stored
+ * in the key itself, so that they are aligned as in memory.
+ * A snapshot is read through a view, either by mapping a file or over
+ * a block of memory, and its nodes are read in place through handles.
+ * It can be turned back into a mutable tree at any time, in whole
+ * or in part. Snapshots are written in the byte order of the machine,
+ * and views refuse those of another byte order or another version.
+ */
+
+#include <stdint.h>
+#include <vector>
+#include "uconfigio.h"
+
+
+#define UCONFIG_BINARY_MAGIC            "UCFGSNAP"
+#define UCONFIG_BINARY_MAGIC_SIZE       8
+#define UCONFIG_BINARY_VERSION          1
+#define UCONFIG_BINARY_BYTE_ORDER       0x01020304
+#define UCONFIG_BINARY_VALUE_INLINE     8   // Values stored in their key
+#define UCONFIG_BINARY_NO_ENTRY         0xFFFFFFFF
+
+// Beginning of a snapshot; offsets are counted from the beginning
+// of the snapshot, and all tables are aligned to 8 bytes
+struct UconfigBinaryHeader
+{
+    char magic[UCONFIG_BINARY_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t size;          // Size of the whole snapshot
+    uint32_t rootEntry;     // Indexes of the root entry
+    uint32_t metadataEntry; // and of the meta-data, if any
+    uint32_t entryCount;
+    uint32_t keyCount;
+    uint32_t childCount;
+    uint32_t reserved;
+    uint64_t entryOffset;
+    uint64_t keyOffset;
+    uint64_t childOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+};
+
+struct UconfigBinaryEntryRecord
+{
+    uint32_t nameOffset;    // Position of the name in the string table
+    int32_t nameSize;
+    int32_t type;
+    uint32_t parent;        // Index of the parent entry, if any
+    uint32_t firstKey;      // Index of the first key in the key table
+    int32_t keyCount;
+    uint32_t firstChild;    // Position of the subentries in the child table
+    int32_t subentryCount;
+};
+
+struct UconfigBinaryKeyRecord
+{
+    uint32_t nameOffset;
+    int32_t nameSize;
+    int32_t type;
+    int32_t valueSize;
+    union
+    {
+        uint64_t offset;    // Position in the string table of long values
+        char bytes[UCONFIG_BINARY_VALUE_INLINE];
+    } value;
+};
+
+
+class UconfigBinaryView;
+
+// Handles to the nodes of a snapshot, which are cheap to copy and
+// remain valid as long as their view is open. A handle is null if
+// nothing was found: reading it gives an empty node.
+class UconfigBinaryKey
+{
+public:
+    UconfigBinaryKey(const UconfigBinaryView* view = NULL,
+                     const UconfigBinaryKeyRecord* record = NULL);
+
+    bool isNull() const;
+
+    const char* name() const;
+    int nameSize() const;
+    int type() const;
+    const char* value() const;
+    int valueSize() const;
+
+protected:
+    const UconfigBinaryView* view;
+    const UconfigBinaryKeyRecord* record;
+};
+
+class UconfigBinaryEntry
+{
+public:
+    UconfigBinaryEntry(const UconfigBinaryView* view = NULL,
+                       const UconfigBinaryEntryRecord* record = NULL);
+
+    bool isNull() const;
+
+    const char* name() const;
+    int nameSize() const;
+    int type() const;
+
+    int keyCount() const;
+    UconfigBinaryKey key(int index) const;
+    UconfigBinaryKey searchKey(const char* keyName, int nameSize = 0) const;
+
+    int subentryCount() const;
+    UconfigBinaryEntry subentry(int index) const;
+    UconfigBinaryEntry searchSubentry(const char* entryName,
+                                      int nameSize = 0) const;
+
+    UconfigBinaryEntry parentEntry() const;
+
+protected:
+    const UconfigBinaryView* view;
+    const UconfigBinaryEntryRecord* record;
+};
+
+// Read-only access to a snapshot, without copying it
+// The header and the bounds of the tables are checked when the view
+// is opened; indexes and offsets are checked as the nodes are read.
+class UconfigBinaryView
+{
+public:
+    UconfigBinaryView();
+    UconfigBinaryView(const UconfigBinaryView&) = delete;
+    ~UconfigBinaryView();
+
+    UconfigBinaryView& operator=(const UconfigBinaryView&) = delete;
+
+    bool open(const char* filename);
+    bool open(const char* data, size_t length);
+    void close();
+    bool isOpen() const;
+
+    UconfigBinaryEntry rootEntry() const;
+    UconfigBinaryEntry metadata() const;
+
+protected:
+    const char* data;
+    size_t length;
+    bool mapped;
+    const UconfigBinaryHeader* header;
+    const UconfigBinaryEntryRecord* entries;
+    const UconfigBinaryKeyRecord* keys;
+    const uint32_t* children;
+    const char* strings;
+
+    const UconfigBinaryEntryRecord* entry(uint32_t index) const;
+    const char* string(uint64_t offset, int size) const;
+
+    friend class UconfigBinaryKey;
+    friend class UconfigBinaryEntry;
+};
+
+class UconfigBinary : public UconfigIO
+{
+public:
+    static bool readUconfig(const char* filename,
+                            UconfigFile* config);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config);
+    static bool writeUconfig(const char* filename,
+                             UconfigFile* config);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler);
+
+    using UconfigIO::walkEntry;
+    static void walkEntry(const UconfigBinaryEntry& entry,
+                          UconfigHandler* handler);
+    static bool readView(const UconfigBinaryView& view,
+                         UconfigFile* config);
+};
+
+// Gather the reported entries into tables, then write them
+// as a snapshot when flushed
+// Keys and subentries of each entry are kept aside until the entry ends,
+// so that they are stored together; the whole tree is kept in memory.
+class UconfigBinaryWriter : public UconfigWriter
+{
+public:
+    UconfigBinaryWriter(const UconfigSink& sink);
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+    void setRootEntry(const char* name, int nameSize, int type);
+    void writeMetadata(const UconfigEntryRef& metadata);
+    bool flush();
+
+protected:
+    struct Level
+    {
+        uint32_t entry;
+        std::vector<UconfigBinaryKeyRecord> keys;
+        std::vector<uint32_t> children;
+    };
+    struct NameSlot
+    {
+        uint32_t offset;
+        int32_t size; // -1 if the slot is free
+    };
+
+    std::vector<UconfigBinaryEntryRecord> entries;
+    std::vector<UconfigBinaryKeyRecord> keys;
+    std::vector<uint32_t> children;
+    std::vector<char> strings;
+    std::vector<NameSlot> names; // Hash table of the names in strings
+    uint32_t nameCount;
+    std::vector<Level> levels;   // Open entries, beginning with a root
+    int level;
+    uint32_t rootEntry;
+    uint32_t metadataEntry;
+    bool written;
+
+    uint32_t beginEntry(const char* name, int nameSize, int type);
+    void endEntry();
+    uint32_t addName(const char* name, int nameSize);
+    uint64_t addString(const char* string, int size);
+    void writeSnapshot();
+};
+
+#endif // UCONFIGBINARY_H
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "uconfigcache.h"
+#include "uconfigbinary.h"
+#include "uconfigfile_metadata.h"
+#include "utils.h"
+
+#define UCONFIG_CACHE_MAGIC             "UCFGCACH"
+#define UCONFIG_CACHE_MAGIC_SIZE        8
+#define UCONFIG_CACHE_VERSION           2
+#define UCONFIG_CACHE_ALIGNMENT         8
+
+#define UCONFIG_CACHE_DIRECTORY         "uconfig"
+#define UCONFIG_CACHE_HOME_DIRECTORY    ".cache"
+#define UCONFIG_CACHE_EXTENSION         ".snapshot"
+#define UCONFIG_CACHE_TEMP_SUFFIX       ".XXXXXX"
+#define UCONFIG_CACHE_NAME_LENGTH       16  // Hash of the path, in hex
+
+// Beginning of a cached file, followed by the real path of the source
+// file, then by the snapshot (both aligned to 8 bytes)
+struct UconfigCacheHeader
+{
+    char magic[UCONFIG_CACHE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t format;
+    uint64_t sourceSize;
+    int64_t sourceTime;     // Time of modification, in seconds
+    int64_t sourceTimeNsec; // and nanoseconds
+    int64_t changeTime;     // Time of the last change of status
+    int64_t changeTimeNsec;
+    uint64_t sourceInode;
+    uint64_t sourceDevice;
+    uint64_t contentHash;
+    uint32_t pathSize;      // Including "\0"
+    uint32_t reserved;
+};
+
+static_assert(sizeof(UconfigCacheHeader) % UCONFIG_CACHE_ALIGNMENT == 0,
+              "Snapshots in cache must be aligned");
+
+
+static size_t Uconfig_alignCacheSize(size_t size)
+{
+    return (size + UCONFIG_CACHE_ALIGNMENT - 1) &
+           ~size_t(UCONFIG_CACHE_ALIGNMENT - 1);
+}
+
+// Concatenate two parts of a path, with a "/" between them
+// The returned string must be freed with delete[]
+static char* Uconfig_joinPath(const char* directory, const char* name)
+{
+    size_t directoryLength = strlen(directory);
+    size_t nameLength = strlen(name);
+    char* path = new char[directoryLength + nameLength + 2];
+    memcpy(path, directory, directoryLength);
+    path[directoryLength] = '/';
+    memcpy(path + directoryLength + 1, name, nameLength + 1);
+    return path;
+}
+
+// Create a directory and its parents if they do not exist
+static bool Uconfig_makeDirectory(const char* directory)
+{
+    struct stat directoryStat;
+    if (stat(directory, &directoryStat) == 0)
+        return S_ISDIR(directoryStat.st_mode);
+
+    char* path = new char[strlen(directory) + 1];
+    strcpy(path, directory);
+    for (char* pos = strchr(path + 1, '/'); pos; pos = strchr(pos + 1, '/'))
+    {
+        *pos = '\0';
+        mkdir(path, 0700);
+        *pos = '/';
+    }
+    bool success = mkdir(path, 0700) == 0;
+    delete[] path;
+    return success;
+}
+
+// Build the key of a source file from its status, without the hash
+// of its content
+static bool Uconfig_makeCacheKey(const char* path,
+                                 UconfigConverter::Format format,
+                                 UconfigCacheHeader* key)
+{
+    struct stat sourceStat;
+    if (stat(path, &sourceStat) != 0)
+        return false;
+
+    memset(key, 0, sizeof(*key));
+    memcpy(key->magic, UCONFIG_CACHE_MAGIC, UCONFIG_CACHE_MAGIC_SIZE);
+    key->version = UCONFIG_CACHE_VERSION;
+    key->format = format;
+    key->sourceSize = sourceStat.st_size;
+    key->sourceTime = sourceStat.st_mtim.tv_sec;
+    key->sourceTimeNsec = sourceStat.st_mtim.tv_nsec;
+    key->changeTime = sourceStat.st_ctim.tv_sec;
+    key->changeTimeNsec = sourceStat.st_ctim.tv_nsec;
+    key->sourceInode = sourceStat.st_ino;
+    key->sourceDevice = sourceStat.st_dev;
+    key->pathSize = strlen(path) + 1;
+    return true;
+}
+
+// Add the hash of the content of the file to its key
+static bool Uconfig_hashCacheKey(const char* path, UconfigCacheHeader* key)
+{
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(path, &length, &mapped);
+    if (!data)
+        return false;
+
+    key->contentHash = Uconfig_hashContent(data, length);
+
+    Uconfig_releaseFile(data, length, mapped);
+    return key->sourceSize == length;
+}
+
+// Whether two keys describe the same status of a file
+// Any write to a file changes its time of status change, which cannot
+// be set back, even if its time of modification is.
+static bool Uconfig_compareCacheKeys(const UconfigCacheHeader& key1,
+                                     const UconfigCacheHeader& key2)
+{
+    return key1.sourceSize == key2.sourceSize &&
+           key1.sourceTime == key2.sourceTime &&
+           key1.sourceTimeNsec == key2.sourceTimeNsec &&
+           key1.changeTime == key2.changeTime &&
+           key1.changeTimeNsec == key2.changeTimeNsec &&
+           key1.sourceInode == key2.sourceInode &&
+           key1.sourceDevice == key2.sourceDevice;
+}
+
+// Check that the file has not changed since its key was built
+static bool Uconfig_checkCacheKey(const char* path,
+                                  UconfigConverter::Format format,
+                                  const UconfigCacheHeader& key)
+{
+    UconfigCacheHeader newKey;
+    return Uconfig_makeCacheKey(path, format, &newKey) &&
+           Uconfig_compareCacheKeys(newKey, key);
+}
+
+// Load a snapshot from cache if its key matches the file
+// The content of the file is hashed only if the status of the file
+// differs from that of the snapshot; then HASHED is set to true,
+// and KEY gets the hash. Otherwise KEY gets the hash of the snapshot.
+static bool Uconfig_readCache(const char* cacheFilename,
+                              UconfigCacheHeader* key,
+                              const char* path,
+                              UconfigFile* config,
+                              bool* hashed)
+{
+    *hashed = false;
+
+    // Blocks read rather than mapped are allocated by malloc(),
+    // and are aligned as well
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(cacheFilename, &length, &mapped);
+    if (!data)
+        return false;
+
+    bool success = false;
+    size_t offset = Uconfig_alignCacheSize(sizeof(*key) + key->pathSize);
+    UconfigCacheHeader cachedKey;
+    if (length >= offset)
+        memcpy(&cachedKey, data, sizeof(cachedKey));
+    if (length >= offset &&
+        memcmp(cachedKey.magic, key->magic, UCONFIG_CACHE_MAGIC_SIZE) == 0 &&
+        cachedKey.version == key->version &&
+        cachedKey.format == key->format &&
+        cachedKey.pathSize == key->pathSize &&
+        memcmp(data + sizeof(cachedKey), path, key->pathSize) == 0)
+    {
+        bool matched = Uconfig_compareCacheKeys(cachedKey, *key);
+        if (matched)
+            key->contentHash = cachedKey.contentHash;
+        else if (cachedKey.sourceSize == key->sourceSize)
+        {
+            // Same content with another status, e.g. a file touched
+            // or copied again
+            *hashed = Uconfig_hashCacheKey(path, key);
+            matched = *hashed && key->contentHash == cachedKey.contentHash;
+        }
+
+        UconfigBinaryView view;
+        success = matched &&
+                  view.open(data + offset, length - offset) &&
+                  UconfigBinary::readView(view, config);
+    }
+
+    Uconfig_releaseFile(data, length, mapped);
+    return success;
+}
+
+// Store the key and the snapshot of a file in cache, replacing
+// the previous one at once
+static bool Uconfig_writeCache(const char* cacheFilename,
+                               const UconfigCacheHeader& key,
+                               const char* path,
+                               UconfigFile* config)
+{
+    char* snapshot = NULL;
+    size_t snapshotLength = 0;
+    if (!UconfigBinary::writeUconfig(&snapshot, &snapshotLength, config))
+        return false;
+
+    char* tempFilename = new char[strlen(cacheFilename) +
+                                  sizeof(UCONFIG_CACHE_TEMP_SUFFIX)];
+    strcpy(tempFilename, cacheFilename);
+    strcat(tempFilename, UCONFIG_CACHE_TEMP_SUFFIX);
+
+    bool success = false;
+    int fd = mkstemp(tempFilename);
+    FILE* file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (file)
+    {
+        static const char padding[UCONFIG_CACHE_ALIGNMENT] = {0};
+        size_t paddingSize = Uconfig_alignCacheSize(sizeof(key) +
+                                                    key.pathSize) -
+                             sizeof(key) - key.pathSize;
+
+        success = fwrite(&key, sizeof(key), 1, file) == 1 &&
+                  fwrite(path, 1, key.pathSize, file) == key.pathSize &&
+                  fwrite(padding, 1, paddingSize, file) == paddingSize &&
+                  fwrite(snapshot, 1, snapshotLength, file) ==
+                                                        snapshotLength;
+        success &= fclose(file) == 0;
+        success = success && rename(tempFilename, cacheFilename) == 0;
+    }
+    else if (fd >= 0)
+        close(fd);
+    if (!success && fd >= 0)
+        unlink(tempFilename);
+
+    delete[] tempFilename;
+    free(snapshot);
+    return success;
+}
+
+
+// Keep snapshots in DIRECTORY, which is created when needed
+// The default directory is "$XDG_CACHE_HOME/uconfig", or
+// "$HOME/.cache/uconfig"; if there is no such directory, files are
+// always parsed.
+UconfigCache::UconfigCache(const char* directory)
+{
+    hits = 0;
+    misses = 0;
+    cacheDirectory = NULL;
+
+    if (directory)
+    {
+        cacheDirectory = new char[strlen(directory) + 1];
+        strcpy(cacheDirectory, directory);
+        return;
+    }
+
+    const char* home = getenv("XDG_CACHE_HOME");
+    if (home && home[0] == '/')
+    {
+        cacheDirectory = Uconfig_joinPath(home, UCONFIG_CACHE_DIRECTORY);
+        return;
+    }
+
+    home = getenv("HOME");
+    if (home && home[0] == '/')
+    {
+        char* cacheHome = Uconfig_joinPath(home, UCONFIG_CACHE_HOME_DIRECTORY);
+        cacheDirectory = Uconfig_joinPath(cacheHome, UCONFIG_CACHE_DIRECTORY);
+        delete[] cacheHome;
+    }
+}
+
+UconfigCache::~UconfigCache()
+{
+    delete[] cacheDirectory;
+}
+
+const char* UconfigCache::directory() const
+{
+    return cacheDirectory;
+}
+
+// Load a file from cache, or parse it and store it in cache
+// The format is guessed from the name of the file if not given.
+bool UconfigCache::readUconfig(const char* filename,
+                               UconfigFile* config,
+                               UconfigConverter::Format format)
+{
+    if (!filename || !config)
+        return false;
+    if (format == UconfigConverter::UnknownFormat)
+        format = UconfigConverter::guessFormat(filename);
+    if (format == UconfigConverter::UnknownFormat)
+        return false;
+
+    char* path = realpath(filename, NULL);
+    if (!path)
+        return false;
+
+    UconfigCacheHeader key;
+    char* cachePath = cacheFilename(path);
+    if (!Uconfig_makeCacheKey(path, format, &key) || !cachePath)
+    {
+        misses++;
+        free(path);
+        delete[] cachePath;
+        return UconfigConverter::readUconfig(filename, format, config);
+    }
+
+    bool success;
+    bool hashed;
+    if (Uconfig_readCache(cachePath, &key, path, config, &hashed))
+    {
+        hits++;
+        success = true;
+
+        // The snapshot may have been made through another path
+        UconfigKeyRef filenameKey =
+                config->metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME);
+        if (filenameKey.nameSize() > 0)
+            filenameKey.setValue(filename, strlen(filename) + 1);
+
+        // Store the new status of the file, so that its content
+        // is not hashed again
+        if (hashed && Uconfig_checkCacheKey(path, format, key))
+            Uconfig_writeCache(cachePath, key, path, config);
+    }
+    else
+    {
+        misses++;
+        hashed = hashed || Uconfig_hashCacheKey(path, &key);
+        success = UconfigConverter::readUconfig(filename, format, config);
+
+        // Do not keep a tree that may not match the key
+        if (success && hashed && Uconfig_checkCacheKey(path, format, key) &&
+            Uconfig_makeDirectory(cacheDirectory))
+            Uconfig_writeCache(cachePath, key, path, config);
+    }
+
+    free(path);
+    delete[] cachePath;
+    return success;
+}
+
+// Remove the snapshot of a file from cache
+bool UconfigCache::remove(const char* filename)
+{
+    char* path = filename ? realpath(filename, NULL) : NULL;
+    if (!path)
+        return false;
+
+    char* cachePath = cacheFilename(path);
+    bool success = cachePath && unlink(cachePath) == 0;
+
+    free(path);
+    delete[] cachePath;
+    return success;
+}
+
+unsigned long UconfigCache::hitCount() const
+{
+    return hits;
+}
+
+unsigned long UconfigCache::missCount() const
+{
+    return misses;
+}
+
+void UconfigCache::resetCounters()
+{
+    hits = 0;
+    misses = 0;
+}
+
+// Name of the snapshot of a file in cache, from the hash of its real path
+// The returned string must be freed with delete[]
+char* UconfigCache::cacheFilename(const char* path) const
+{
+    if (!cacheDirectory)
+        return NULL;
+
+    char name[UCONFIG_CACHE_NAME_LENGTH + sizeof(UCONFIG_CACHE_EXTENSION)];
+    snprintf(name, sizeof(name), "%016llx" UCONFIG_CACHE_EXTENSION,
+             (unsigned long long)(Uconfig_hashContent(path, strlen(path))));
+    return Uconfig_joinPath(cacheDirectory, name);
+}
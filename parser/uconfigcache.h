@@ -0,0 +1,50 @@
+#ifndef UCONFIGCACHE_H
+#define UCONFIGCACHE_H
+
+/*
+ * Cache of parsed files, for files that are loaded again and again
+ * (e.g. those under /etc): the tree of each file is kept as a binary
+ * snapshot, which is loaded without parsing the file.
+ * A snapshot is stored in a directory of cache along with the key
+ * of its file: the real path, the format, the status of the file (size,
+ * times of modification and of status change, inode) and a hash of
+ * the content (XXH64). It is used at once if the status matches the file;
+ * otherwise the content is hashed, and the snapshot is still used if the
+ * hash matches. Else the file is parsed and the snapshot is replaced.
+ * Snapshots are written into a temporary file, then renamed,
+ * so that processes sharing a directory never read a partial snapshot.
+ */
+
+#include "uconfigconverter.h"
+
+
+class UconfigCache
+{
+public:
+    UconfigCache(const char* directory = NULL);
+    UconfigCache(const UconfigCache&) = delete;
+    ~UconfigCache();
+
+    UconfigCache& operator=(const UconfigCache&) = delete;
+
+    const char* directory() const;
+
+    bool readUconfig(const char* filename,
+                     UconfigFile* config,
+                     UconfigConverter::Format format =
+                                        UconfigConverter::UnknownFormat);
+    bool remove(const char* filename);
+
+    unsigned long hitCount() const;
+    unsigned long missCount() const;
+    void resetCounters();
+
+protected:
+    char* cacheDirectory;
+    unsigned long hits;
+    unsigned long misses;
+
+    char* cacheFilename(const char* path) const;
+};
+
+#endif // UCONFIGCACHE_H
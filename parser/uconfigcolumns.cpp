@@ -0,0 +1,847 @@
+#include <stdlib.h>
+#include <string.h>
+#include "uconfigcolumns.h"
+#include "uconfigarena.h"
+#include "uconfigio.h"
+
+#define UCONFIG_COLUMN_CAPACITY_MIN     16
+#define UCONFIG_COLUMN_DATA_SIZE_MIN    64
+
+
+// Declaration of private functions
+static void* Uconfig_resizeBlock(UconfigArena* arena, void* block, size_t size);
+static void* Uconfig_copyBlock(UconfigArena* arena,
+                               const void* block,
+                               size_t size);
+static void Uconfig_freeBlock(UconfigArena* arena, void* block);
+static int Uconfig_cellStorage(int type, int size);
+static size_t Uconfig_cellSize(int storage);
+static int Uconfig_valueSize(int storage);
+static void Uconfig_initColumn(UconfigColumn* column);
+static void Uconfig_freeColumn(UconfigArena* arena, UconfigColumn* column);
+static bool Uconfig_copyColumn(UconfigArena* arena,
+                               UconfigColumn* dest,
+                               const UconfigColumn* src);
+static bool Uconfig_reserveCells(UconfigArena* arena,
+                                 UconfigColumn* column,
+                                 int count);
+static bool Uconfig_reserveData(UconfigArena* arena,
+                                UconfigColumn* column,
+                                int size);
+static bool Uconfig_putCell(UconfigArena* arena,
+                            UconfigColumn* column,
+                            int type,
+                            const char* value,
+                            int size);
+static bool Uconfig_setCell(UconfigArena* arena,
+                            UconfigColumn* column,
+                            int row,
+                            int type,
+                            const char* value,
+                            int size);
+static bool Uconfig_padColumn(UconfigArena* arena,
+                              UconfigColumn* column,
+                              int count);
+static bool Uconfig_addException(UconfigArena* arena,
+                                 UconfigColumn* column,
+                                 int row,
+                                 int type,
+                                 const char* value,
+                                 int size);
+static bool Uconfig_putException(UconfigArena* arena,
+                                 UconfigColumn* column,
+                                 int type,
+                                 const char* value,
+                                 int size);
+static bool Uconfig_retypeColumn(UconfigArena* arena,
+                                 UconfigColumn* column,
+                                 int type,
+                                 int storage);
+static int Uconfig_findException(const UconfigColumn* column, int row);
+static const char* Uconfig_cellValue(const UconfigColumn* column,
+                                     int index,
+                                     int* type,
+                                     int* size,
+                                     char* buffer);
+static bool Uconfig_addColumn(UconfigColumns* columns,
+                              const char* name,
+                              int nameSize);
+static bool Uconfig_dropHeader(UconfigColumns* columns);
+
+
+// Store the rows of an entry by column, starting with no row
+UconfigColumns* Uconfig_newColumns(UconfigEntry* entry)
+{
+    if (entry->columns)
+        return entry->columns;
+
+    UconfigColumns* columns = static_cast<UconfigColumns*>(
+                Uconfig_resizeBlock(entry->arena, NULL, sizeof(UconfigColumns)));
+    if (!columns)
+        return NULL;
+
+    columns->rowCount = 0;
+    columns->rowCapacity = 0;
+    columns->rowType = 0;
+    columns->cellCounts = NULL;
+    columns->header = false;
+    columns->columnCount = 0;
+    columns->columnCapacity = 0;
+    columns->columns = NULL;
+    Uconfig_initColumn(&columns->rowNames);
+    columns->rowNames.type = UconfigIO::Raw;
+    columns->rowNames.storage = UCONFIG_COLUMN_STORAGE_BYTES;
+    columns->openRow = false;
+    columns->rowEntries = NULL;
+    columns->rowEntryCount = 0;
+    columns->arena = entry->arena;
+
+    entry->columns = columns;
+    return columns;
+}
+
+void Uconfig_deleteColumns(UconfigEntry* entry)
+{
+    UconfigColumns* columns = entry->columns;
+    if (!columns)
+        return;
+
+    UconfigArena* arena = columns->arena;
+    for (int i=0; i<columns->columnCount; i++)
+        Uconfig_freeColumn(arena, &columns->columns[i]);
+    Uconfig_freeColumn(arena, &columns->rowNames);
+    Uconfig_freeBlock(arena, columns->columns);
+    Uconfig_freeBlock(arena, columns->cellCounts);
+    Uconfig_freeBlock(arena, columns);
+    entry->columns = NULL;
+}
+
+// Deep copy of the columns of SRC into DEST,
+// allocated in the same way as DEST
+bool Uconfig_copyColumns(UconfigEntry* dest, const UconfigEntry* src)
+{
+    dest->columns = NULL;
+    if (!src->columns)
+        return true;
+
+    const UconfigColumns* from = src->columns;
+    UconfigColumns* columns = Uconfig_newColumns(dest);
+    if (!columns)
+        return false;
+    UconfigArena* arena = columns->arena;
+
+    bool success = true;
+    columns->rowType = from->rowType;
+    columns->header = from->header;
+    columns->openRow = from->openRow;
+    if (from->rowCount > 0)
+    {
+        columns->cellCounts = static_cast<int*>(
+                Uconfig_copyBlock(arena, from->cellCounts,
+                                  sizeof(int) * from->rowCount));
+        success &= columns->cellCounts != NULL;
+        columns->rowCount = from->rowCount;
+        columns->rowCapacity = from->rowCount;
+    }
+    if (from->columnCount > 0)
+    {
+        columns->columns = static_cast<UconfigColumn*>(
+                Uconfig_resizeBlock(arena, NULL,
+                                    sizeof(UconfigColumn) * from->columnCount));
+        if (!columns->columns)
+        {
+            Uconfig_deleteColumns(dest);
+            return false;
+        }
+        for (int i=0; i<from->columnCount; i++)
+            success &= Uconfig_copyColumn(arena, &columns->columns[i],
+                                          &from->columns[i]);
+        columns->columnCount = from->columnCount;
+        columns->columnCapacity = from->columnCount;
+    }
+    success &= Uconfig_copyColumn(arena, &columns->rowNames, &from->rowNames);
+
+    if (!success)
+        Uconfig_deleteColumns(dest);
+    return success;
+}
+
+// Start a new row; all rows must be of the same type
+bool Uconfig_beginColumnRow(UconfigEntry* entry,
+                            const char* name,
+                            int nameSize,
+                            int type)
+{
+    UconfigColumns* columns = entry->columns;
+    if (!columns)
+        return false;
+    if (columns->rowCount > 0 && type != columns->rowType)
+        return false;
+
+    if (columns->rowCount >= columns->rowCapacity)
+    {
+        int capacity = columns->rowCapacity > 0 ?
+                       columns->rowCapacity * 2 :
+                       UCONFIG_COLUMN_CAPACITY_MIN;
+        int* cellCounts = static_cast<int*>(
+                Uconfig_resizeBlock(columns->arena, columns->cellCounts,
+                                    sizeof(int) * capacity));
+        if (!cellCounts)
+            return false;
+        columns->cellCounts = cellCounts;
+        columns->rowCapacity = capacity;
+    }
+
+    if (!name)
+        nameSize = 0;
+    if (!Uconfig_putCell(columns->arena, &columns->rowNames,
+                         UconfigIO::Raw, name, nameSize))
+        return false;
+
+    // The first row is seen as the header until one of its cells
+    // is not its own name
+    columns->rowType = type;
+    columns->cellCounts[columns->rowCount] = 0;
+    columns->rowCount++;
+    columns->openRow = true;
+    if (columns->rowCount == 1)
+        columns->header = true;
+    return true;
+}
+
+// Append a key to the current row as the cell of the next column
+bool Uconfig_appendColumnCell(UconfigEntry* entry, const UconfigKey* key)
+{
+    UconfigColumns* columns = entry->columns;
+    if (!columns || columns->rowCount <= 0)
+        return false;
+
+    UconfigArena* arena = columns->arena;
+    int row = columns->rowCount - 1;
+    int index = columns->cellCounts[row];
+    if (columns->header && row == 0)
+    {
+        if (key->name && key->value &&
+            key->valueSize == key->nameSize &&
+            memcmp(key->value, key->name, key->nameSize) == 0)
+        {
+            // Only keep the name of the column
+            if (!Uconfig_addColumn(columns, key->name, key->nameSize))
+                return false;
+            columns->columns[index].headerType = key->valueType;
+            columns->cellCounts[row]++;
+            return true;
+        }
+        if (!Uconfig_dropHeader(columns))
+            return false;
+    }
+
+    if (index >= columns->columnCount &&
+        !Uconfig_addColumn(columns, key->name, key->nameSize))
+        return false;
+
+    // Keys must be named after their column
+    UconfigColumn* column = &columns->columns[index];
+    if (key->name != column->name &&
+        (key->nameSize != column->nameSize ||
+         memcmp(key->name, column->name, key->nameSize) != 0))
+        return false;
+
+    if (!Uconfig_setCell(arena, column, row,
+                         key->valueType, key->value, key->valueSize))
+        return false;
+    columns->cellCounts[row]++;
+    return true;
+}
+
+// Complete the columns missing in the current row,
+// so that each column holds a value for each row
+void Uconfig_endColumnRow(UconfigEntry* entry)
+{
+    UconfigColumns* columns = entry->columns;
+    if (!columns || columns->rowCount <= 0)
+        return;
+
+    columns->openRow = false;
+    if (columns->header && columns->columnCount == 0)
+        columns->header = false;
+    for (int i=0; i<columns->columnCount; i++)
+        Uconfig_padColumn(columns->arena, &columns->columns[i],
+                          columns->rowCount);
+}
+
+bool Uconfig_readColumnCell(const UconfigColumns* columns,
+                            int row,
+                            int column,
+                            UconfigKey* key)
+{
+    if (row < 0 || row >= columns->rowCount ||
+        column < 0 || column >= columns->cellCounts[row])
+        return false;
+
+    const UconfigColumn& cells = columns->columns[column];
+    key->name = cells.name;
+    key->nameSize = cells.nameSize;
+    key->parentEntry = NULL;
+    key->arena = NULL;
+    if (columns->header && row == 0)
+    {
+        key->valueType = cells.headerType;
+        key->value = cells.name;
+        key->valueSize = cells.nameSize;
+    }
+    else
+        key->value = const_cast<char*>(
+                        Uconfig_cellValue(&cells, row,
+                                          &key->valueType, &key->valueSize,
+                                          key->inlineValue.chars));
+    return true;
+}
+
+const char* Uconfig_readColumnRowName(const UconfigColumns* columns,
+                                      int row,
+                                      int* nameSize)
+{
+    int type;
+    char buffer[sizeof(double)];
+    *nameSize = 0;
+    if (row < 0 || row >= columns->rowNames.count)
+        return NULL;
+    return Uconfig_cellValue(&columns->rowNames, row,
+                             &type, nameSize, buffer);
+}
+
+// Resize a block of the heap, through ARENA if it is not NULL
+void* Uconfig_resizeBlock(UconfigArena* arena, void* block, size_t size)
+{
+    if (arena)
+        return arena->reallocate(block, size);
+    else
+        return realloc(block, size > 0 ? size : 1);
+}
+
+void* Uconfig_copyBlock(UconfigArena* arena, const void* block, size_t size)
+{
+    if (!block || size == 0)
+        return NULL;
+
+    void* copy = Uconfig_resizeBlock(arena, NULL, size);
+    if (copy)
+        memcpy(copy, block, size);
+    return copy;
+}
+
+// Free a block allocated by Uconfig_resizeBlock()
+void Uconfig_freeBlock(UconfigArena* arena, void* block)
+{
+    if (!block)
+        return;
+    if (arena)
+        arena->deallocate(block);
+    else
+        free(block);
+}
+
+// Storage of a value of a given type and size:
+// numbers and booleans are stored as such if they have the size
+// given by parsers (int, double and bool), otherwise as bytes
+int Uconfig_cellStorage(int type, int size)
+{
+    switch (type)
+    {
+        case UconfigIO::Integer:
+            if (size == sizeof(int))
+                return UCONFIG_COLUMN_STORAGE_INTEGER;
+            break;
+        case UconfigIO::Float:
+        case UconfigIO::Double:
+            if (size == sizeof(double))
+                return UCONFIG_COLUMN_STORAGE_REAL;
+            break;
+        case UconfigIO::Bool:
+            if (size == sizeof(bool))
+                return UCONFIG_COLUMN_STORAGE_BOOL;
+            break;
+        default:;
+    }
+    return UCONFIG_COLUMN_STORAGE_BYTES;
+}
+
+// Size of an element of the array of values
+size_t Uconfig_cellSize(int storage)
+{
+    switch (storage)
+    {
+        case UCONFIG_COLUMN_STORAGE_INTEGER:
+            return sizeof(long long);
+        case UCONFIG_COLUMN_STORAGE_REAL:
+            return sizeof(double);
+        case UCONFIG_COLUMN_STORAGE_BOOL:
+            return sizeof(bool);
+        default:
+            return sizeof(int);
+    }
+}
+
+// Size of the value of a key read from a cell
+int Uconfig_valueSize(int storage)
+{
+    switch (storage)
+    {
+        case UCONFIG_COLUMN_STORAGE_INTEGER:
+            return sizeof(int);
+        case UCONFIG_COLUMN_STORAGE_REAL:
+            return sizeof(double);
+        case UCONFIG_COLUMN_STORAGE_BOOL:
+            return sizeof(bool);
+        default:
+            return 0;
+    }
+}
+
+void Uconfig_initColumn(UconfigColumn* column)
+{
+    column->name = NULL;
+    column->nameSize = 0;
+    column->headerType = UconfigIO::Raw;
+    column->type = UCONFIG_COLUMN_TYPE_NONE;
+    column->storage = UCONFIG_COLUMN_STORAGE_BYTES;
+    column->count = 0;
+    column->capacity = 0;
+    column->values = NULL;
+    column->data = NULL;
+    column->dataSize = 0;
+    column->dataCapacity = 0;
+    column->types = NULL;
+    column->exceptions = NULL;
+    column->exceptionRows = NULL;
+    column->exceptionCapacity = 0;
+}
+
+void Uconfig_freeColumn(UconfigArena* arena, UconfigColumn* column)
+{
+    Uconfig_freeBlock(arena, column->name);
+    Uconfig_freeBlock(arena, column->values);
+    Uconfig_freeBlock(arena, column->data);
+    Uconfig_freeBlock(arena, column->types);
+    if (column->exceptions)
+    {
+        Uconfig_freeColumn(arena, column->exceptions);
+        Uconfig_freeBlock(arena, column->exceptions);
+    }
+    Uconfig_freeBlock(arena, column->exceptionRows);
+    Uconfig_initColumn(column);
+}
+
+// Copy a column with arrays of the exact size of its cells
+bool Uconfig_copyColumn(UconfigArena* arena,
+                        UconfigColumn* dest,
+                        const UconfigColumn* src)
+{
+    Uconfig_initColumn(dest);
+    dest->nameSize = src->nameSize;
+    dest->headerType = src->headerType;
+    dest->type = src->type;
+    dest->storage = src->storage;
+
+    bool success = true;
+    if (src->name)
+    {
+        dest->name = static_cast<char*>(
+                        Uconfig_copyBlock(arena, src->name, src->nameSize));
+        success &= dest->name != NULL;
+    }
+    if (src->count > 0)
+    {
+        size_t size = src->storage == UCONFIG_COLUMN_STORAGE_BYTES ?
+                      sizeof(int) * (src->count + 1) :
+                      Uconfig_cellSize(src->storage) * src->count;
+        dest->values = Uconfig_copyBlock(arena, src->values, size);
+        success &= dest->values != NULL;
+        dest->count = src->count;
+        dest->capacity = src->count;
+    }
+    if (src->dataSize > 0)
+    {
+        dest->data = static_cast<char*>(
+                        Uconfig_copyBlock(arena, src->data, src->dataSize));
+        success &= dest->data != NULL;
+        dest->dataSize = src->dataSize;
+        dest->dataCapacity = src->dataSize;
+    }
+    if (src->types && src->count > 0)
+    {
+        dest->types = static_cast<unsigned char*>(
+                        Uconfig_copyBlock(arena, src->types, src->count));
+        success &= dest->types != NULL;
+    }
+    if (src->exceptions)
+    {
+        int count = src->exceptions->count;
+        dest->exceptions = static_cast<UconfigColumn*>(
+                Uconfig_resizeBlock(arena, NULL, sizeof(UconfigColumn)));
+        if (dest->exceptions)
+            success &= Uconfig_copyColumn(arena, dest->exceptions,
+                                          src->exceptions);
+        else
+            success = false;
+        dest->exceptionRows = static_cast<int*>(
+                Uconfig_copyBlock(arena, src->exceptionRows,
+                                  sizeof(int) * count));
+        success &= count == 0 || dest->exceptionRows != NULL;
+        dest->exceptionCapacity = count;
+    }
+    return success;
+}
+
+// Make sure that COLUMN can hold COUNT cells without reallocation
+bool Uconfig_reserveCells(UconfigArena* arena, UconfigColumn* column, int count)
+{
+    if (count <= column->capacity)
+        return true;
+
+    int capacity = column->capacity > 0 ? column->capacity :
+                                          UCONFIG_COLUMN_CAPACITY_MIN;
+    while (capacity < count)
+        capacity *= 2;
+
+    // Cells stored as bytes need one more offset for the end of the data
+    bool isBytes = column->storage == UCONFIG_COLUMN_STORAGE_BYTES;
+    size_t size = isBytes ? sizeof(int) * (capacity + 1) :
+                            Uconfig_cellSize(column->storage) * capacity;
+    void* values = Uconfig_resizeBlock(arena, column->values, size);
+    if (!values)
+        return false;
+    if (isBytes && !column->values)
+        static_cast<int*>(values)[0] = 0;
+    column->values = values;
+
+    if (column->type == UCONFIG_COLUMN_TYPE_MIXED)
+    {
+        unsigned char* types = static_cast<unsigned char*>(
+                        Uconfig_resizeBlock(arena, column->types, capacity));
+        if (!types)
+            return false;
+        column->types = types;
+    }
+
+    column->capacity = capacity;
+    return true;
+}
+
+// Make sure that the data of COLUMN can hold SIZE bytes
+bool Uconfig_reserveData(UconfigArena* arena, UconfigColumn* column, int size)
+{
+    if (size <= column->dataCapacity)
+        return true;
+
+    int capacity = column->dataCapacity > 0 ? column->dataCapacity :
+                                              UCONFIG_COLUMN_DATA_SIZE_MIN;
+    while (capacity < size)
+        capacity *= 2;
+
+    char* data = static_cast<char*>(
+                        Uconfig_resizeBlock(arena, column->data, capacity));
+    if (!data)
+        return false;
+    column->data = data;
+    column->dataCapacity = capacity;
+    return true;
+}
+
+// Append a cell to a column; the first cell gives the type of the column,
+// and cells of other types are appended as exceptions
+bool Uconfig_putCell(UconfigArena* arena,
+                     UconfigColumn* column,
+                     int type,
+                     const char* value,
+                     int size)
+{
+    if (!value)
+        size = 0;
+
+    int storage = Uconfig_cellStorage(type, size);
+    if (column->type == UCONFIG_COLUMN_TYPE_NONE)
+    {
+        column->type = type;
+        column->storage = storage;
+    }
+    else if (column->type != UCONFIG_COLUMN_TYPE_MIXED &&
+             (type != column->type || storage != column->storage))
+    {
+        // A first cell of text above numbers (e.g. an unnamed header)
+        // does not give the type of the column
+        if (column->count == 1 && !column->exceptions &&
+            column->storage == UCONFIG_COLUMN_STORAGE_BYTES &&
+            storage != UCONFIG_COLUMN_STORAGE_BYTES)
+        {
+            if (!Uconfig_retypeColumn(arena, column, type, storage))
+                return false;
+        }
+        else
+            return Uconfig_putException(arena, column, type, value, size);
+    }
+
+    int i = column->count;
+    if (!Uconfig_reserveCells(arena, column, i + 1))
+        return false;
+
+    switch (column->storage)
+    {
+        case UCONFIG_COLUMN_STORAGE_INTEGER:
+        {
+            int integer;
+            memcpy(&integer, value, sizeof(int));
+            static_cast<long long*>(column->values)[i] = integer;
+            break;
+        }
+        case UCONFIG_COLUMN_STORAGE_REAL:
+            memcpy(&static_cast<double*>(column->values)[i],
+                   value, sizeof(double));
+            break;
+        case UCONFIG_COLUMN_STORAGE_BOOL:
+            memcpy(&static_cast<bool*>(column->values)[i],
+                   value, sizeof(bool));
+            break;
+        default:
+        {
+            if (!Uconfig_reserveData(arena, column, column->dataSize + size))
+                return false;
+            if (size > 0)
+                memcpy(&column->data[column->dataSize], value, size);
+            column->dataSize += size;
+            static_cast<int*>(column->values)[i + 1] = column->dataSize;
+        }
+    }
+    if (column->types)
+        column->types[i] = type;
+
+    column->count++;
+    return true;
+}
+
+// Put a cell in a given row of a column, which may have been
+// left empty in the previous rows
+bool Uconfig_setCell(UconfigArena* arena,
+                     UconfigColumn* column,
+                     int row,
+                     int type,
+                     const char* value,
+                     int size)
+{
+    if (column->type == UCONFIG_COLUMN_TYPE_NONE)
+    {
+        column->type = type;
+        column->storage = Uconfig_cellStorage(type, value ? size : 0);
+    }
+    if (!Uconfig_padColumn(arena, column, row))
+        return false;
+    return Uconfig_putCell(arena, column, type, value, size);
+}
+
+// Fill a column with empty cells until it has COUNT cells
+// Columns without any cell yet are filled once their type is known
+bool Uconfig_padColumn(UconfigArena* arena, UconfigColumn* column, int count)
+{
+    if (column->type == UCONFIG_COLUMN_TYPE_NONE)
+        return true;
+
+    static const char zero[sizeof(double)] = {};
+    int type = column->type;
+    int size = Uconfig_valueSize(column->storage);
+    while (column->count < count)
+    {
+        if (!Uconfig_putCell(arena, column, type, zero, size))
+            return false;
+    }
+    return true;
+}
+
+// Append a cell of another type than the column to its exceptions
+bool Uconfig_addException(UconfigArena* arena,
+                          UconfigColumn* column,
+                          int row,
+                          int type,
+                          const char* value,
+                          int size)
+{
+    if (!column->exceptions)
+    {
+        column->exceptions = static_cast<UconfigColumn*>(
+                Uconfig_resizeBlock(arena, NULL, sizeof(UconfigColumn)));
+        if (!column->exceptions)
+            return false;
+        Uconfig_initColumn(column->exceptions);
+        column->exceptions->type = UCONFIG_COLUMN_TYPE_MIXED;
+    }
+
+    UconfigColumn* exceptions = column->exceptions;
+    int i = exceptions->count;
+    if (i >= column->exceptionCapacity)
+    {
+        int capacity = column->exceptionCapacity > 0 ?
+                       column->exceptionCapacity * 2 :
+                       UCONFIG_COLUMN_CAPACITY_MIN;
+        int* rows = static_cast<int*>(
+                Uconfig_resizeBlock(arena, column->exceptionRows,
+                                    sizeof(int) * capacity));
+        if (!rows)
+            return false;
+        column->exceptionRows = rows;
+        column->exceptionCapacity = capacity;
+    }
+
+    if (!Uconfig_putCell(arena, exceptions, type, value, size))
+        return false;
+    column->exceptionRows[i] = row;
+    return true;
+}
+
+// Append an exception as the next cell, leaving an empty cell in its place
+bool Uconfig_putException(UconfigArena* arena,
+                          UconfigColumn* column,
+                          int type,
+                          const char* value,
+                          int size)
+{
+    if (!Uconfig_addException(arena, column, column->count,
+                              type, value, size))
+        return false;
+    return Uconfig_padColumn(arena, column, column->count + 1);
+}
+
+// Make the only cell of a column an exception,
+// and give the column another type
+bool Uconfig_retypeColumn(UconfigArena* arena,
+                          UconfigColumn* column,
+                          int type,
+                          int storage)
+{
+    int oldType, oldSize;
+    char buffer[sizeof(double)];
+    const char* oldValue = Uconfig_cellValue(column, 0, &oldType, &oldSize,
+                                             buffer);
+    if (!Uconfig_addException(arena, column, 0, oldType, oldValue, oldSize))
+        return false;
+
+    Uconfig_freeBlock(arena, column->values);
+    Uconfig_freeBlock(arena, column->data);
+    column->values = NULL;
+    column->data = NULL;
+    column->count = 0;
+    column->capacity = 0;
+    column->dataSize = 0;
+    column->dataCapacity = 0;
+    column->type = type;
+    column->storage = storage;
+    return Uconfig_padColumn(arena, column, 1);
+}
+
+// Index of the cell of a given row among the exceptions of a column,
+// or -1 if that cell is not an exception
+int Uconfig_findException(const UconfigColumn* column, int row)
+{
+    if (!column->exceptions)
+        return -1;
+
+    int low = 0;
+    int high = column->exceptions->count - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int middleRow = column->exceptionRows[middle];
+        if (middleRow == row)
+            return middle;
+        if (middleRow < row)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return -1;
+}
+
+// Value of a cell as it is stored in a key
+// BUFFER receives the values that are stored differently
+const char* Uconfig_cellValue(const UconfigColumn* column,
+                              int index,
+                              int* type,
+                              int* size,
+                              char* buffer)
+{
+    int exception = Uconfig_findException(column, index);
+    if (exception >= 0)
+        return Uconfig_cellValue(column->exceptions, exception,
+                                 type, size, buffer);
+
+    *type = column->types ? column->types[index] : column->type;
+    *size = Uconfig_valueSize(column->storage);
+    switch (column->storage)
+    {
+        case UCONFIG_COLUMN_STORAGE_INTEGER:
+        {
+            int integer = int(static_cast<long long*>(column->values)[index]);
+            memcpy(buffer, &integer, sizeof(int));
+            return buffer;
+        }
+        case UCONFIG_COLUMN_STORAGE_REAL:
+            return reinterpret_cast<const char*>(
+                        &static_cast<double*>(column->values)[index]);
+        case UCONFIG_COLUMN_STORAGE_BOOL:
+            return reinterpret_cast<const char*>(
+                        &static_cast<bool*>(column->values)[index]);
+        default:
+        {
+            const int* offsets = static_cast<int*>(column->values);
+            *size = offsets[index + 1] - offsets[index];
+            return *size > 0 ? &column->data[offsets[index]] : NULL;
+        }
+    }
+}
+
+bool Uconfig_addColumn(UconfigColumns* columns,
+                       const char* name,
+                       int nameSize)
+{
+    UconfigArena* arena = columns->arena;
+    if (columns->columnCount >= columns->columnCapacity)
+    {
+        int capacity = columns->columnCapacity > 0 ?
+                       columns->columnCapacity * 2 :
+                       UCONFIG_COLUMN_CAPACITY_MIN;
+        UconfigColumn* list = static_cast<UconfigColumn*>(
+                Uconfig_resizeBlock(arena, columns->columns,
+                                    sizeof(UconfigColumn) * capacity));
+        if (!list)
+            return false;
+        columns->columns = list;
+        columns->columnCapacity = capacity;
+    }
+
+    UconfigColumn* column = &columns->columns[columns->columnCount];
+    Uconfig_initColumn(column);
+    if (name && nameSize > 0)
+    {
+        column->name = static_cast<char*>(
+                            Uconfig_copyBlock(arena, name, nameSize));
+        if (!column->name)
+            return false;
+        column->nameSize = nameSize;
+    }
+    columns->columnCount++;
+    return true;
+}
+
+// Store the names given by the first row as its cells,
+// since they are not all its own names
+bool Uconfig_dropHeader(UconfigColumns* columns)
+{
+    columns->header = false;
+    for (int i=0; i<columns->columnCount; i++)
+    {
+        UconfigColumn* column = &columns->columns[i];
+        if (!Uconfig_setCell(columns->arena, column, 0, column->headerType,
+                             column->name, column->nameSize))
+            return false;
+    }
+    return true;
+}
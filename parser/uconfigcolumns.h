@@ -0,0 +1,104 @@
+#ifndef UCONFIGCOLUMNS_H
+#define UCONFIGCOLUMNS_H
+
+/*
+ * Optional storage of the rows of a table entry by column.
+ * Instead of one entry per row and one key per cell, each column keeps
+ * its cells in a contiguous array: 64-bit integers, doubles or booleans
+ * for a column of a numeric or boolean type, and offsets into a block
+ * of bytes for strings. The first cell gives the type of the column;
+ * cells of other types are kept aside as exceptions, in their own
+ * (mixed) column, so that the type of a column never changes.
+ * A first row whose cells hold their own names (e.g. the header of a CSV
+ * file) only gives the names of the columns.
+ * Rows are appended cell by cell; a row or a cell that cannot be stored
+ * this way (e.g. a key not named after its column) is refused, so that
+ * the caller can turn the table back into subentries.
+ * Arrays come from the heap, through the arena of the entry if any.
+ * Rows read as subentries are built on first use and kept in rowEntries;
+ * they are owned (and freed) by the entry objects, not by this module.
+ */
+
+#include "uconfigentry.h"
+
+#define UCONFIG_COLUMN_TYPE_NONE        -1  // No cell stored yet
+#define UCONFIG_COLUMN_TYPE_MIXED       -2  // Cells of any type (exceptions)
+
+#define UCONFIG_COLUMN_STORAGE_BYTES    0
+#define UCONFIG_COLUMN_STORAGE_INTEGER  1
+#define UCONFIG_COLUMN_STORAGE_REAL     2
+#define UCONFIG_COLUMN_STORAGE_BOOL     3
+
+
+struct UconfigColumn
+{
+    char* name; // Name of the keys of the column, if any
+    int nameSize;
+    int headerType; // Type of the cell in the header row, if any
+
+    int type;    // Value type of all the cells, or one of the above
+    int storage; // Storage of the cells, as given above
+    int count;   // Number of cells stored (including missing ones)
+    int capacity;
+
+    // For integer, real and boolean storage: one long long, double
+    // or bool per cell; otherwise offsets of the cells in data,
+    // the size of a cell being given by the next offset
+    void* values;
+    char* data;
+    int dataSize;
+    int dataCapacity;
+    unsigned char* types; // Value type of each cell of mixed columns
+
+    // Cells of another type than the column, and their rows (in order);
+    // their place in the values above is left empty
+    UconfigColumn* exceptions;
+    int* exceptionRows;
+    int exceptionCapacity;
+};
+
+struct UconfigColumns
+{
+    int rowCount;
+    int rowCapacity;
+    int rowType;     // Type of all the rows
+    int* cellCounts; // Number of cells in each row
+    bool header;     // The first row holds the names of the columns
+
+    int columnCount;
+    int columnCapacity;
+    UconfigColumn* columns;
+    UconfigColumn rowNames; // Names of the rows, stored as raw cells
+    bool openRow;    // The last row is still being appended
+
+    // Rows built as entries, or NULL for those not built yet
+    UconfigEntry** rowEntries;
+    int rowEntryCount;
+
+    UconfigArena* arena;
+};
+
+extern UconfigColumns* Uconfig_newColumns(UconfigEntry* entry);
+extern void Uconfig_deleteColumns(UconfigEntry* entry);
+extern bool Uconfig_copyColumns(UconfigEntry* dest, const UconfigEntry* src);
+
+extern bool Uconfig_beginColumnRow(UconfigEntry* entry,
+                                   const char* name,
+                                   int nameSize,
+                                   int type);
+extern bool Uconfig_appendColumnCell(UconfigEntry* entry,
+                                     const UconfigKey* key);
+extern void Uconfig_endColumnRow(UconfigEntry* entry);
+
+// Fill KEY with the cell of a given row and column, without copying:
+// its name and value refer to the columns (or to the key itself),
+// so that it must not be freed nor modified
+extern bool Uconfig_readColumnCell(const UconfigColumns* columns,
+                                   int row,
+                                   int column,
+                                   UconfigKey* key);
+extern const char* Uconfig_readColumnRowName(const UconfigColumns* columns,
+                                             int row,
+                                             int* nameSize);
+
+#endif // UCONFIGCOLUMNS_H
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include "uconfigconverter.h"
+#include "uconfigconverter_p.h"
+#include "uconfigini.h"
+#include "uconfigcsv.h"
+#include "uconfigjson.h"
+#include "uconfigxml.h"
+
+#define UCONFIG_CONVERTER_CHAR_DIRECTORY    '/'
+#define UCONFIG_CONVERTER_CHAR_EXTENSION    '.'
+
+
+static const char* const Uconfig_formatNames[] =
+{
+    NULL,
+    "keyvalue",
+    "ini",
+    "table",
+    "csv",
+    "json",
+    "xml"
+};
+
+// Name of a file without its directory and its extension
+// The returned string must be freed with delete[]
+static char* Uconfig_baseName(const char* filename)
+{
+    const char* begin = strrchr(filename, UCONFIG_CONVERTER_CHAR_DIRECTORY);
+    begin = begin ? begin + 1 : filename;
+
+    const char* end = strrchr(begin, UCONFIG_CONVERTER_CHAR_EXTENSION);
+    if (!end || end == begin)
+        end = begin + strlen(begin);
+
+    char* name = new char[end - begin + 1];
+    memcpy(name, begin, end - begin);
+    name[end - begin] = '\0';
+    return name;
+}
+
+
+// Get a format by its name, e.g. "json"; the case is ignored
+UconfigConverter::Format UconfigConverter::getFormat(const char* name)
+{
+    if (!name)
+        return UnknownFormat;
+
+    for (int i=KeyValueFormat; i<=XMLFormat; i++)
+    {
+        if (strcasecmp(name, Uconfig_formatNames[i]) == 0)
+            return Format(i);
+    }
+    return UnknownFormat;
+}
+
+// Guess the format of a file from its extension, e.g. "config.xml"
+UconfigConverter::Format UconfigConverter::guessFormat(const char* filename)
+{
+    if (!filename)
+        return UnknownFormat;
+
+    const char* name = strrchr(filename, UCONFIG_CONVERTER_CHAR_DIRECTORY);
+    const char* extension = strrchr(name ? name : filename,
+                                    UCONFIG_CONVERTER_CHAR_EXTENSION);
+    if (!extension)
+        return UnknownFormat;
+
+    return getFormat(extension + 1);
+}
+
+// Convert a file to another one; unknown formats are guessed
+// from the extensions of the files
+bool UconfigConverter::convert(const char* inputFilename,
+                               const char* outputFilename,
+                               Format inputFormat,
+                               Format outputFormat)
+{
+    if (!inputFilename || !outputFilename)
+        return false;
+
+    if (inputFormat == UnknownFormat)
+        inputFormat = guessFormat(inputFilename);
+    if (outputFormat == UnknownFormat)
+        outputFormat = guessFormat(outputFilename);
+    if (inputFormat == UnknownFormat || outputFormat == UnknownFormat)
+        return false;
+
+    FILE* outputFile = fopen(outputFilename, "w");
+    if (!outputFile)
+        return false;
+
+    bool success = fconvert(inputFilename, inputFormat,
+                            outputFile, outputFormat);
+    fclose(outputFile);
+    return success;
+}
+
+bool UconfigConverter::fconvert(const char* inputFilename,
+                                Format inputFormat,
+                                FILE* outputFile,
+                                Format outputFormat)
+{
+    if (!inputFilename || !outputFile)
+        return false;
+
+    UconfigWriter* writer = createWriter(outputFile, outputFormat);
+    if (!writer)
+        return false;
+
+    UconfigConverterHandler converter(writer);
+    char* baseName = Uconfig_baseName(inputFilename);
+    int wrapperType = -1;
+
+    // Adjust the hierarchy of data to the syntax of the target format
+    switch (outputFormat)
+    {
+        case KeyValueFormat:
+            // Extract all lines of sections (or rows of tables)
+            // into the root entry
+            if (inputFormat == INIFormat ||
+                inputFormat == TableFormat ||
+                inputFormat == CSVFormat)
+                converter.setTopLevelUnwrapped(true);
+            break;
+        case INIFormat:
+            // Put lines into a section named after the file
+            if (inputFormat == JSONFormat)
+                converter.setTopLevelName(baseName);
+            else if (inputFormat != INIFormat &&
+                     inputFormat != XMLFormat)
+                wrapperType = UconfigINI::NormalEntry;
+            break;
+        case JSONFormat:
+            // Remove all prologue sections of XML, or
+            // wrap all entries into a pseudo root entry (object)
+            if (inputFormat == XMLFormat)
+                converter.setTopLevelType(UconfigXML::NormalEntry);
+            else if (inputFormat != JSONFormat)
+                wrapperType = UconfigJSON::ObjectEntry;
+            break;
+        case XMLFormat:
+            // Give the outer element a name
+            if (inputFormat == JSONFormat)
+                converter.setTopLevelName(baseName);
+            else if (inputFormat != XMLFormat)
+                wrapperType = UconfigXML::NormalEntry;
+            break;
+        default:;
+    }
+
+    if (wrapperType >= 0)
+        writer->onEntryBegin(baseName, strlen(baseName), wrapperType);
+
+    bool success = parseUconfig(inputFilename, inputFormat, &converter);
+
+    if (wrapperType >= 0)
+        writer->onEntryEnd();
+    success &= writer->flush();
+
+    delete writer;
+    delete[] baseName;
+    return success;
+}
+
+// Read a file of a given format into CONFIG
+bool UconfigConverter::readUconfig(const char* filename,
+                                   Format format,
+                                   UconfigFile* config)
+{
+    switch (format)
+    {
+        case KeyValueFormat:
+            return UconfigKeyValue::readUconfig(filename, config);
+        case INIFormat:
+            return UconfigINI::readUconfig(filename, config);
+        case TableFormat:
+            return Uconfig2DTable::readUconfig(filename, config);
+        case CSVFormat:
+            return UconfigCSV::readUconfig(filename, config);
+        case JSONFormat:
+            return UconfigJSON::readUconfig(filename, config);
+        case XMLFormat:
+            return UconfigXML::readUconfig(filename, config);
+        default:
+            return false;
+    }
+}
+
+// Read LENGTH bytes of DATA of a given format into CONFIG
+bool UconfigConverter::readUconfig(const char* data,
+                                   size_t length,
+                                   Format format,
+                                   UconfigFile* config)
+{
+    switch (format)
+    {
+        case KeyValueFormat:
+            return UconfigKeyValue::readUconfig(data, length, config);
+        case INIFormat:
+            return UconfigINI::readUconfig(data, length, config);
+        case TableFormat:
+            return Uconfig2DTable::readUconfig(data, length, config);
+        case CSVFormat:
+            return UconfigCSV::readUconfig(data, length, config);
+        case JSONFormat:
+            return UconfigJSON::readUconfig(data, length, config);
+        case XMLFormat:
+            return UconfigXML::readUconfig(data, length, config);
+        default:
+            return false;
+    }
+}
+
+// Report the content of a file of a given format to HANDLER
+bool UconfigConverter::parseUconfig(const char* filename,
+                                    Format format,
+                                    UconfigHandler* handler)
+{
+    switch (format)
+    {
+        case KeyValueFormat:
+            return UconfigKeyValue::parseUconfig(filename, handler);
+        case INIFormat:
+            return UconfigINI::parseUconfig(filename, handler);
+        case TableFormat:
+            return Uconfig2DTable::parseUconfig(filename, handler);
+        case CSVFormat:
+            return UconfigCSV::parseUconfig(filename, handler);
+        case JSONFormat:
+            return UconfigJSON::parseUconfig(filename, handler);
+        case XMLFormat:
+            return UconfigXML::parseUconfig(filename, handler);
+        default:
+            return false;
+    }
+}
+
+// Create a handler writing the reported entries to SINK
+// in a given format; the handler must be freed with delete
+UconfigWriter* UconfigConverter::createWriter(const UconfigSink& sink,
+                                              Format format)
+{
+    switch (format)
+    {
+        case KeyValueFormat:
+            return new UconfigKeyValueWriter(sink);
+        case INIFormat:
+            return new UconfigINIWriter(sink);
+        case TableFormat:
+            return new Uconfig2DTableWriter(sink);
+        case CSVFormat:
+            return new UconfigCSVWriter(sink);
+        case JSONFormat:
+            return new UconfigJSONWriter(sink);
+        case XMLFormat:
+            return new UconfigXMLWriter(sink);
+        default:
+            return NULL;
+    }
+}
+
+
+UconfigConverterHandler::UconfigConverterHandler(UconfigHandler* handler)
+{
+    this->handler = handler;
+    topLevelName = NULL;
+    topLevelType = -1;
+    topLevelUnwrapped = false;
+    level = 0;
+    skipLevel = 0;
+}
+
+UconfigArena* UconfigConverterHandler::arena()
+{
+    return handler->arena();
+}
+
+void UconfigConverterHandler::onEntryBegin(const char* name,
+                                           int nameSize,
+                                           int type)
+{
+    level++;
+    if (skipLevel > 0 ||
+        (level == 1 && topLevelType >= 0 && type != topLevelType))
+    {
+        skipLevel++;
+        return;
+    }
+
+    if (level == 1)
+    {
+        if (topLevelUnwrapped)
+            return;
+        if (!name && topLevelName)
+        {
+            name = topLevelName;
+            nameSize = strlen(topLevelName);
+        }
+    }
+    handler->onEntryBegin(name, nameSize, type);
+}
+
+void UconfigConverterHandler::onKey(UconfigKeyObject& key)
+{
+    if (skipLevel > 0)
+        return;
+
+    handler->onKey(key);
+}
+
+void UconfigConverterHandler::onEntryEnd()
+{
+    if (level <= 0)
+        return;
+
+    if (skipLevel > 0)
+        skipLevel--;
+    else if (level > 1 || !topLevelUnwrapped)
+        handler->onEntryEnd();
+    level--;
+}
+
+void UconfigConverterHandler::setTopLevelName(const char* name)
+{
+    topLevelName = name;
+}
+
+void UconfigConverterHandler::setTopLevelType(int type)
+{
+    topLevelType = type;
+}
+
+void UconfigConverterHandler::setTopLevelUnwrapped(bool unwrapped)
+{
+    topLevelUnwrapped = unwrapped;
+}
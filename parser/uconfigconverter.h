@@ -0,0 +1,59 @@
+#ifndef UCONFIGCONVERTER_H
+#define UCONFIGCONVERTER_H
+
+/*
+ * Conversion of a file from one format to another in a single pass:
+ * the entries reported by the parser of the source format are passed
+ * straight to the writer of the target format, without building a tree.
+ * Only the entries being open are kept in memory (and, for XML, a bounded
+ * part of their content; see UconfigXMLWriter), so that the memory usage
+ * depends on the depth of nesting rather than on the file size.
+ */
+
+#include "uconfighandler.h"
+
+
+typedef struct _IO_FILE FILE;
+class UconfigFile;
+
+class UconfigConverter
+{
+public:
+    enum Format
+    {
+        UnknownFormat = 0,
+        KeyValueFormat = 1,
+        INIFormat = 2,
+        TableFormat = 3,
+        CSVFormat = 4,
+        JSONFormat = 5,
+        XMLFormat = 6
+    };
+
+    static Format getFormat(const char* name);
+    static Format guessFormat(const char* filename);
+
+    static bool convert(const char* inputFilename,
+                        const char* outputFilename,
+                        Format inputFormat = UnknownFormat,
+                        Format outputFormat = UnknownFormat);
+    static bool fconvert(const char* inputFilename,
+                         Format inputFormat,
+                         FILE* outputFile,
+                         Format outputFormat);
+
+    static bool readUconfig(const char* filename,
+                            Format format,
+                            UconfigFile* config);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            Format format,
+                            UconfigFile* config);
+    static bool parseUconfig(const char* filename,
+                             Format format,
+                             UconfigHandler* handler);
+    static UconfigWriter* createWriter(const UconfigSink& sink,
+                                       Format format);
+};
+
+#endif // UCONFIGCONVERTER_H
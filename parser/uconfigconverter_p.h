@@ -0,0 +1,33 @@
+#ifndef UCONFIGCONVERTER_P_H
+#define UCONFIGCONVERTER_P_H
+
+#include "uconfighandler.h"
+
+
+// Adjust the hierarchy of the reported entries to the target format
+// before passing them to a writer
+class UconfigConverterHandler : public UconfigHandler
+{
+public:
+    UconfigConverterHandler(UconfigHandler* handler);
+
+    UconfigArena* arena();
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+    void setTopLevelName(const char* name);
+    void setTopLevelType(int type);
+    void setTopLevelUnwrapped(bool unwrapped);
+
+protected:
+    UconfigHandler* handler;
+    const char* topLevelName; // Name given to unnamed top-level entries
+    int topLevelType;         // Only type of top-level entries kept if >= 0
+    bool topLevelUnwrapped;   // Report the content of top-level entries only
+    int level;
+    int skipLevel;            // Depth of nesting in a dropped entry
+};
+
+#endif // UCONFIGCONVERTER_P_H
@@ -1,5 +1,7 @@
+#include <stdio.h>
 #include "uconfigcsv.h"
-#include "uconfigfile_metadata.h"
+#include "uconfigcsv_p.h"
+#include "uconfiginputbuffer.h"
 
 #define UCONFIG_IO_CSV_DELIMITER_ROW    "\n"
 #define UCONFIG_IO_CSV_DELIMITER_COL    ","
@@ -18,10 +20,9 @@ bool UconfigCSV::writeUconfig(const char* filename, UconfigFile* config)
 {
     // If there are delimiters previously specified during file parsing,
     // then take them directly
-    const char* rowDelimiter =
-            config->metadata.searchKey(UCONFIG_METADATA_KEY_ROWDELIM).value();
-    const char* columnDelimitor =
-            config->metadata.searchKey(UCONFIG_METADATA_KEY_COLDELIM).value();
+    const char* rowDelimiter = NULL;
+    const char* columnDelimitor = NULL;
+    getDelimiters(config, &rowDelimiter, &columnDelimitor);
 
     // Otherwise, use default delimiters
     if (!rowDelimiter)
@@ -33,6 +34,41 @@ bool UconfigCSV::writeUconfig(const char* filename, UconfigFile* config)
                                         rowDelimiter, columnDelimitor);
 }
 
+// Read LENGTH bytes of DATA in place, e.g. a block received from
+// another process
+bool UconfigCSV::readUconfig(const char* data,
+                             size_t length,
+                             UconfigFile* config)
+{
+    if (!data || !config)
+        return false;
+
+    UconfigInputBuffer input(data, length);
+    return readCSV(input, NULL, config,
+                   UCONFIG_IO_CSV_DELIMITER_ROW,
+                   UCONFIG_IO_CSV_DELIMITER_COL,
+                   true, true);
+}
+
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigCSV::writeUconfig(char** data,
+                              size_t* length,
+                              UconfigFile* config)
+{
+    const char* rowDelimiter = NULL;
+    const char* columnDelimitor = NULL;
+    getDelimiters(config, &rowDelimiter, &columnDelimitor);
+
+    if (!rowDelimiter)
+        rowDelimiter = UCONFIG_IO_CSV_DELIMITER_ROW;
+    if (!columnDelimitor)
+        columnDelimitor = UCONFIG_IO_CSV_DELIMITER_COL;
+
+    return Uconfig2DTable::writeUconfig(data, length, config,
+                                        rowDelimiter, columnDelimitor);
+}
+
 bool UconfigCSV::readUconfig(const char* filename,
                              UconfigFile* config,
                              const char* rowDelimiter,
@@ -40,82 +76,186 @@ bool UconfigCSV::readUconfig(const char* filename,
                              bool readColumnNames,
                              bool readRowNames)
 {
-    if (!Uconfig2DTable::readUconfig(filename, config,
-                                     rowDelimiter, columnDelimiter,
-                                     true, true))
+    if (!config)
+        return false;
+
+    FILE* inputFile = fopen(filename, "rb");
+    if (!inputFile)
+        return false;
+
+    UconfigInputBuffer input(inputFile);
+    bool success = readCSV(input, filename, config,
+                           rowDelimiter, columnDelimiter,
+                           readColumnNames, readRowNames);
+
+    fclose(inputFile);
+    return success;
+}
+
+// Report the content of a file to HANDLER instead of building a tree
+bool UconfigCSV::parseUconfig(const char* filename, UconfigHandler* handler)
+{
+    return parseUconfig(filename, handler,
+                        UCONFIG_IO_CSV_DELIMITER_ROW,
+                        UCONFIG_IO_CSV_DELIMITER_COL);
+}
+
+bool UconfigCSV::parseUconfig(const char* filename,
+                              UconfigHandler* handler,
+                              const char* rowDelimiter,
+                              const char* columnDelimiter,
+                              bool readColumnNames,
+                              bool readRowNames)
+{
+    if (!handler)
         return false;
 
-    // Extract row names and column names
-    int i, j, k;
-    int columnCount;
-    bool* hasColumnName;
-    UconfigKeyObject* firstLine;
-    UconfigKeyObject* valueList;
-    UconfigEntryObject* entryList = config->rootEntry.subentries();
-    UconfigEntryObject* rows;
-    if (readRowNames || readColumnNames)
+    UconfigCSVHandler csvHandler(handler, readColumnNames, readRowNames);
+    return Uconfig2DTable::parseUconfig(filename, &csvHandler,
+                                        rowDelimiter, columnDelimiter,
+                                        true, true);
+}
+
+bool UconfigCSV::parseUconfig(const char* data,
+                              size_t length,
+                              UconfigHandler* handler)
+{
+    if (!data || !handler)
+        return false;
+
+    UconfigCSVHandler csvHandler(handler, true, true);
+    return Uconfig2DTable::parseUconfig(data, length, &csvHandler,
+                                        UCONFIG_IO_CSV_DELIMITER_ROW,
+                                        UCONFIG_IO_CSV_DELIMITER_COL,
+                                        true, true);
+}
+
+// Build the tree of a table in CONFIG, with its rows and columns named
+bool UconfigCSV::readCSV(UconfigInputBuffer& input,
+                         const char* filename,
+                         UconfigFile* config,
+                         const char* rowDelimiter,
+                         const char* columnDelimiter,
+                         bool readColumnNames,
+                         bool readRowNames)
+{
+    UconfigTreeBuilder builder(config->rootEntry);
+    if (config->columnarEnabled())
+        builder.setColumnarType(UconfigCSV::NormalEntry);
+    UconfigCSVHandler csvHandler(&builder, readColumnNames, readRowNames);
+    return Uconfig2DTable::readTable(input, filename, config, &csvHandler,
+                                     rowDelimiter, columnDelimiter,
+                                     true, true);
+}
+
+
+UconfigCSVWriter::UconfigCSVWriter(const UconfigSink& sink,
+                                   const char* rowDelimiter,
+                                   const char* columnDelimiter) :
+    Uconfig2DTableWriter(sink,
+                         rowDelimiter ? rowDelimiter :
+                                        UCONFIG_IO_CSV_DELIMITER_ROW,
+                         columnDelimiter ? columnDelimiter :
+                                           UCONFIG_IO_CSV_DELIMITER_COL)
+{
+}
+
+
+UconfigCSVHandler::UconfigCSVHandler(UconfigHandler* handler,
+                                     bool readColumnNames,
+                                     bool readRowNames)
+{
+    this->handler = handler;
+    this->readColumnNames = readColumnNames;
+    this->readRowNames = readRowNames;
+    level = 0;
+    inTable = false;
+    rowIndex = 0;
+    rowType = 0;
+    keyIndex = 0;
+}
+
+UconfigArena* UconfigCSVHandler::arena()
+{
+    return handler->arena();
+}
+
+void UconfigCSVHandler::onEntryBegin(const char* name, int nameSize, int type)
+{
+    level++;
+    if (level == 1)
     {
-        for (i=0; i<config->rootEntry.subentryCount(); i++)
-        {
-            if (entryList[i].type() != EntryType::NormalEntry ||
-                entryList[i].subentryCount() < 1)
-                continue;
+        // Only rows of tables are named
+        inTable = type == UconfigCSV::NormalEntry;
+        rowIndex = 0;
+        header.reset();
+    }
+    else if (level == 2 && inTable)
+    {
+        // The name of the row is given by its first key
+        rowType = type;
+        keyIndex = 0;
+        return;
+    }
+    handler->onEntryBegin(name, nameSize, type);
+}
 
-            rows = entryList[i].subentries();
+void UconfigCSVHandler::onKey(UconfigKeyObject& key)
+{
+    if (level == 2 && inTable)
+    {
+        if (keyIndex == 0)
+            beginRow(&key);
 
-            if (readColumnNames)
-            {
-                // Use the key names of the first line as column names
-                firstLine = rows[0].keys();
-                columnCount = rows[0].keyCount();
-                hasColumnName = new bool[columnCount];
-
-                // Exclude key names of non-char type
-                for (j=0; j<columnCount; j++)
-                {
-                    hasColumnName[j] = firstLine[j].type() == ValueType::Raw ||
-                                       firstLine[j].type() == ValueType::Chars;
-                }
-            }
-            for (j=0; j<entryList[i].subentryCount(); j++)
-            {
-                if (rows[j].keyCount() < 1)
-                    continue;
-                valueList = rows[j].keys();
-
-                // Use the name of the first key as the row name
-                if (readRowNames &&
-                    (valueList[0].type() == ValueType::Raw ||
-                     valueList[0].type() == ValueType::Chars))
-                    rows[j].setName(valueList[0].value(),
-                                    valueList[0].valueSize());
-
-                // Apply column names to each key
-                if (readColumnNames)
-                {
-                    for (k=0; k<rows[j].keyCount(); k++)
-                    {
-                        if (k >= columnCount)
-                            break;
-                        if (hasColumnName[k])
-                            valueList[k].setName(firstLine[k].value(),
-                                                 firstLine[k].valueSize());
-                    }
-                }
-
-                delete[] valueList;
-            }
-            if (readColumnNames)
+        // Use the values of the first row as column names
+        if (readColumnNames)
+        {
+            if (rowIndex == 0)
+                header.addKey(&key);
+            if (keyIndex < header.keyCount())
             {
-                // Additional remark for the first row
-                rows[0].setName(UCONFIG_IO_CSV_TYPE_HEADER);
-                delete[] hasColumnName;
+                UconfigKeyRef column = header.keyRange()[keyIndex];
+                if (column.valueSize() > 0 &&
+                    (column.type() == UconfigCSV::Raw ||
+                     column.type() == UconfigCSV::Chars))
+                    key.setName(column.value(), column.valueSize());
             }
-
-            delete[] rows;
         }
+        keyIndex++;
+    }
+    handler->onKey(key);
+}
+
+void UconfigCSVHandler::onEntryEnd()
+{
+    if (level == 2 && inTable)
+    {
+        if (keyIndex == 0)
+            beginRow(NULL);
+        rowIndex++;
+    }
+    level--;
+    handler->onEntryEnd();
+}
+
+void UconfigCSVHandler::beginRow(const UconfigKeyObject* firstKey)
+{
+    if (rowIndex == 0 && readColumnNames)
+    {
+        // Additional remark for the first row
+        handler->onEntryBegin(UCONFIG_IO_CSV_TYPE_HEADER,
+                              sizeof(UCONFIG_IO_CSV_TYPE_HEADER),
+                              rowType);
+    }
+    else if (readRowNames && firstKey && firstKey->valueSize() > 0 &&
+             (firstKey->type() == UconfigCSV::Raw ||
+              firstKey->type() == UconfigCSV::Chars))
+    {
+        // Use the value of the first key as the row name
+        handler->onEntryBegin(firstKey->value(),
+                              firstKey->valueSize(),
+                              rowType);
     }
-    if (entryList)
-        delete[] entryList;
-    return true;
+    else
+        handler->onEntryBegin(NULL, 0, rowType);
 }
@@ -11,12 +11,48 @@ public:
     static bool readUconfig(const char* filename, UconfigFile* config);
     static bool writeUconfig(const char* filename, UconfigFile* config);
 
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config);
+
     static bool readUconfig(const char* filename,
                             UconfigFile* config,
                             const char* rowDelimiter,
                             const char* columnDelimiter,
                             bool readColumnNames = true,
                             bool readRowNames = true);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler,
+                             const char* rowDelimiter,
+                             const char* columnDelimiter,
+                             bool readColumnNames = true,
+                             bool readRowNames = true);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler);
+
+protected:
+    static bool readCSV(UconfigInputBuffer& input,
+                        const char* filename,
+                        UconfigFile* config,
+                        const char* rowDelimiter,
+                        const char* columnDelimiter,
+                        bool readColumnNames,
+                        bool readRowNames);
+};
+
+class UconfigCSVWriter : public Uconfig2DTableWriter
+{
+public:
+    UconfigCSVWriter(const UconfigSink& sink,
+                     const char* rowDelimiter = NULL,
+                     const char* columnDelimiter = NULL);
 };
 
 #endif // UCONFIGCSV_H
@@ -0,0 +1,36 @@
+#ifndef UCONFIGCSV_P_H
+#define UCONFIGCSV_P_H
+
+#include "uconfighandler.h"
+
+
+// Name the rows and the columns of tables reported by a 2D table parser
+// before passing them to another handler
+class UconfigCSVHandler : public UconfigHandler
+{
+public:
+    UconfigCSVHandler(UconfigHandler* handler,
+                      bool readColumnNames,
+                      bool readRowNames);
+
+    UconfigArena* arena();
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+protected:
+    UconfigHandler* handler;
+    bool readColumnNames;
+    bool readRowNames;
+    int level;
+    bool inTable;
+    int rowIndex;
+    int rowType;
+    int keyIndex;
+    UconfigEntryObject header; // Copy of the first row of the table
+
+    void beginRow(const UconfigKeyObject* firstKey);
+};
+
+#endif // UCONFIGCSV_P_H
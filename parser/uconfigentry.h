@@ -4,15 +4,42 @@
 // Use C-style coding, avoiding class definitions
 // Look after well your pointers XD
 
+// Entries and keys filled by the caller only need the fields of the original
+// structures: name, nameSize, type, keyCount, keys, subentryCount, subentries
+// for entries, and name, nameSize, valueType, valueSize, value for keys.
+// The other fields are read only from nodes made by the library itself.
+
+class UconfigArena;
+struct UconfigEntry;
+struct UconfigEntryIndex;
+struct UconfigColumns;
+
+// Short names and values are stored in the key itself
+#define UCONFIG_KEY_NAME_INLINE_SIZE    20
+#define UCONFIG_KEY_VALUE_INLINE_SIZE   8
 
 struct UconfigKey
 {
-    char* name;
-    int nameSize;  // Number of bytes required by the name
+    char* name; // Points to inlineName if the name is short enough
+    char* value; // Points to inlineValue if the value is short enough
+
+    UconfigEntry* parentEntry; // Entry holding the key, if any
 
+    UconfigArena* arena; // Allocator of the key itself, its name and value
+
+    int nameSize;  // Number of bytes required by the name
     int valueType; // Used by specific parser
     int valueSize; // Number of bytes required by the value
-    char* value;
+
+    char inlineName[UCONFIG_KEY_NAME_INLINE_SIZE];
+    union
+    {
+        char chars[UCONFIG_KEY_VALUE_INLINE_SIZE];
+        bool boolean;
+        int integer;
+        float singleReal;
+        double doubleReal;
+    } inlineValue; // Including integers, floating numbers and booleans
 };
 
 struct UconfigEntry
@@ -24,10 +51,16 @@ struct UconfigEntry
 
     int keyCount;   // Number of keys
     int subentryCount; // Number of subentries;
+    int keyCapacity; // Number of keys that can be held without reallocation
+    int subentryCapacity; // Same as above, for subentries
     UconfigKey** keys;
     UconfigEntry** subentries;
 
     UconfigEntry* parentEntry;
+
+    UconfigArena* arena; // Allocator of the entry's nodes; NULL for the heap
+    UconfigEntryIndex* index; // Name index of keys and subentries, if enabled
+    UconfigColumns* columns; // Rows of the entry stored by column, if enabled
 };
 
 #endif
@@ -0,0 +1,238 @@
+#include <string.h>
+#include "uconfigentryindex.h"
+#include "uconfigarena.h"
+#include "utils.h"
+
+#define UCONFIG_INDEX_CAPACITY_MIN  8
+
+
+// Declaration of private functions
+static int Uconfig_indexCapacity(int count);
+template <typename T>
+static T** Uconfig_newTable(UconfigArena* arena, int capacity);
+template <typename T>
+static void Uconfig_freeTable(UconfigArena* arena, T** table);
+template <typename T>
+static bool Uconfig_tableInsert(T** table, int capacity, T* node);
+template <typename T>
+static T* Uconfig_tableSearch(T** table,
+                              int capacity,
+                              const char* name,
+                              int nameSize);
+static bool Uconfig_buildKeyIndex(UconfigEntry* entry);
+static bool Uconfig_buildEntryIndex(UconfigEntry* entry);
+
+
+// Attach an empty index to an entry
+UconfigEntryIndex* Uconfig_newEntryIndex(UconfigEntry* entry)
+{
+    if (entry->index)
+        return entry->index;
+
+    UconfigEntryIndex* index;
+    if (entry->arena)
+        index = static_cast<UconfigEntryIndex*>(
+                        entry->arena->allocate(sizeof(UconfigEntryIndex)));
+    else
+        index = new UconfigEntryIndex;
+
+    index->keyCapacity = 0;
+    index->entryCapacity = 0;
+    index->keyTable = NULL;
+    index->entryTable = NULL;
+    entry->index = index;
+    return index;
+}
+
+// Detach the index from an entry and free it
+void Uconfig_deleteEntryIndex(UconfigEntry* entry)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index)
+        return;
+
+    Uconfig_freeTable(entry->arena, index->keyTable);
+    Uconfig_freeTable(entry->arena, index->entryTable);
+    if (entry->arena)
+        entry->arena->deallocate(index);
+    else
+        delete index;
+    entry->index = NULL;
+}
+
+UconfigKey* Uconfig_indexSearchKey(UconfigEntry* entry,
+                                   const char* name,
+                                   int nameSize)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index->keyTable && !Uconfig_buildKeyIndex(entry))
+        return NULL;
+
+    return Uconfig_tableSearch(index->keyTable, index->keyCapacity,
+                               name, nameSize);
+}
+
+UconfigEntry* Uconfig_indexSearchEntry(UconfigEntry* entry,
+                                       const char* name,
+                                       int nameSize)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index->entryTable && !Uconfig_buildEntryIndex(entry))
+        return NULL;
+
+    return Uconfig_tableSearch(index->entryTable, index->entryCapacity,
+                               name, nameSize);
+}
+
+// Keep the index up to date after KEY is appended to the entry
+void Uconfig_indexAddKey(UconfigEntry* entry, UconfigKey* key)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index || !index->keyTable)
+        return;
+
+    // Keep the load factor under 1/2; the table is rebuilt when needed
+    if (entry->keyCount * 2 > index->keyCapacity)
+        Uconfig_invalidateKeyIndex(entry);
+    else
+        Uconfig_tableInsert(index->keyTable, index->keyCapacity, key);
+}
+
+// Same as Uconfig_indexAddKey(), for subentries
+void Uconfig_indexAddEntry(UconfigEntry* entry, UconfigEntry* subentry)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index || !index->entryTable)
+        return;
+
+    if (entry->subentryCount * 2 > index->entryCapacity)
+        Uconfig_invalidateEntryIndex(entry);
+    else
+        Uconfig_tableInsert(index->entryTable, index->entryCapacity,
+                            subentry);
+}
+
+void Uconfig_invalidateKeyIndex(UconfigEntry* entry)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index)
+        return;
+
+    Uconfig_freeTable(entry->arena, index->keyTable);
+    index->keyTable = NULL;
+    index->keyCapacity = 0;
+}
+
+void Uconfig_invalidateEntryIndex(UconfigEntry* entry)
+{
+    UconfigEntryIndex* index = entry->index;
+    if (!index)
+        return;
+
+    Uconfig_freeTable(entry->arena, index->entryTable);
+    index->entryTable = NULL;
+    index->entryCapacity = 0;
+}
+
+// Smallest power of 2 holding COUNT nodes with a load factor under 1/2
+int Uconfig_indexCapacity(int count)
+{
+    int capacity = UCONFIG_INDEX_CAPACITY_MIN;
+    while (capacity < count * 2)
+        capacity *= 2;
+    return capacity;
+}
+
+template <typename T>
+T** Uconfig_newTable(UconfigArena* arena, int capacity)
+{
+    T** table;
+    if (arena)
+        table = static_cast<T**>(arena->allocate(sizeof(T*) * capacity));
+    else
+        table = new T*[capacity];
+    if (table)
+        memset(table, 0, sizeof(T*) * capacity);
+    return table;
+}
+
+template <typename T>
+void Uconfig_freeTable(UconfigArena* arena, T** table)
+{
+    if (!table)
+        return;
+    if (arena)
+        arena->deallocate(table);
+    else
+        delete[] table;
+}
+
+// Insert a node into an open-addressing table with linear probing
+// Nodes without name, and nodes whose name is already in the table
+// are not inserted
+template <typename T>
+bool Uconfig_tableInsert(T** table, int capacity, T* node)
+{
+    if (!node->name)
+        return false;
+
+    int mask = capacity - 1;
+    int i = Uconfig_hashName(node->name, node->nameSize) & mask;
+    while (table[i])
+    {
+        if (table[i]->nameSize == node->nameSize &&
+            memcmp(table[i]->name, node->name, node->nameSize) == 0)
+            return false;
+        i = (i + 1) & mask;
+    }
+    table[i] = node;
+    return true;
+}
+
+template <typename T>
+T* Uconfig_tableSearch(T** table,
+                       int capacity,
+                       const char* name,
+                       int nameSize)
+{
+    int mask = capacity - 1;
+    int i = Uconfig_hashName(name, nameSize) & mask;
+    while (table[i])
+    {
+        if (table[i]->nameSize == nameSize &&
+            memcmp(table[i]->name, name, nameSize) == 0)
+            return table[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+bool Uconfig_buildKeyIndex(UconfigEntry* entry)
+{
+    UconfigEntryIndex* index = entry->index;
+    int capacity = Uconfig_indexCapacity(entry->keyCount);
+    index->keyTable = Uconfig_newTable<UconfigKey>(entry->arena, capacity);
+    if (!index->keyTable)
+        return false;
+
+    index->keyCapacity = capacity;
+    for (int i=0; i<entry->keyCount; i++)
+        Uconfig_tableInsert(index->keyTable, capacity, entry->keys[i]);
+    return true;
+}
+
+bool Uconfig_buildEntryIndex(UconfigEntry* entry)
+{
+    UconfigEntryIndex* index = entry->index;
+    int capacity = Uconfig_indexCapacity(entry->subentryCount);
+    index->entryTable = Uconfig_newTable<UconfigEntry>(entry->arena,
+                                                       capacity);
+    if (!index->entryTable)
+        return false;
+
+    index->entryCapacity = capacity;
+    for (int i=0; i<entry->subentryCount; i++)
+        Uconfig_tableInsert(index->entryTable, capacity,
+                            entry->subentries[i]);
+    return true;
+}
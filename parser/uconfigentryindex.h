@@ -0,0 +1,40 @@
+#ifndef UCONFIGENTRYINDEX_H
+#define UCONFIGENTRYINDEX_H
+
+/*
+ * Optional hash index of the keys and subentries of an entry by name.
+ * Each table is built lazily by the first lookup, updated when nodes
+ * are appended, and simply dropped (to be rebuilt on demand) when nodes
+ * are removed, replaced or renamed.
+ * As with a linear scan, the first node of a given name is found.
+ */
+
+#include "uconfigentry.h"
+
+
+struct UconfigEntryIndex
+{
+    int keyCapacity;  // Number of slots in keyTable; 0 if not built
+    int entryCapacity; // Same as above, for entryTable
+    UconfigKey** keyTable;
+    UconfigEntry** entryTable;
+};
+
+extern UconfigEntryIndex* Uconfig_newEntryIndex(UconfigEntry* entry);
+extern void Uconfig_deleteEntryIndex(UconfigEntry* entry);
+
+extern UconfigKey* Uconfig_indexSearchKey(UconfigEntry* entry,
+                                          const char* name,
+                                          int nameSize);
+extern UconfigEntry* Uconfig_indexSearchEntry(UconfigEntry* entry,
+                                              const char* name,
+                                              int nameSize);
+
+extern void Uconfig_indexAddKey(UconfigEntry* entry, UconfigKey* key);
+extern void Uconfig_indexAddEntry(UconfigEntry* entry,
+                                  UconfigEntry* subentry);
+
+extern void Uconfig_invalidateKeyIndex(UconfigEntry* entry);
+extern void Uconfig_invalidateEntryIndex(UconfigEntry* entry);
+
+#endif // UCONFIGENTRYINDEX_H
@@ -1,8 +1,40 @@
 #include <string.h>
 #include "uconfigentryobject.h"
+#include "uconfigarena.h"
+#include "uconfigentryindex.h"
+#include "uconfigcolumns.h"
+
+#define UCONFIG_ENTRY_CAPACITY_MIN  4
 
 
 // Declaration of private functions
+template <typename T>
+static T* Uconfig_allocate(UconfigArena* arena, int count);
+template <typename T>
+static void Uconfig_free(UconfigArena* arena, T* data);
+static UconfigKey* Uconfig_newKey(UconfigArena* arena);
+static UconfigEntry* Uconfig_newEntry(UconfigArena* arena);
+static void Uconfig_freeEntryNode(UconfigEntry* entry);
+static bool Uconfig_copyEntry(UconfigEntry* dest,
+                              const UconfigEntry* src,
+                              bool recursive,
+                              UconfigArena* arena,
+                              bool columns);
+static char* Uconfig_copyName(UconfigArena* arena,
+                              const char* name,
+                              int size);
+static char* Uconfig_copyKeyName(UconfigKey* key, const char* name, int size);
+static char* Uconfig_allocateKeyValue(UconfigKey* key, int size);
+static void Uconfig_freeKeyName(UconfigKey* key);
+static void Uconfig_freeKeyValue(UconfigKey* key);
+static void Uconfig_moveKey(UconfigKey* dest, const UconfigKey* src);
+static bool Uconfig_isColumnRow(const UconfigEntry* entry);
+static int Uconfig_columnRowCount(const UconfigColumns* columns);
+static UconfigEntry* Uconfig_columnRow(UconfigEntry* entry, int index);
+static UconfigEntry** Uconfig_columnRows(UconfigEntry* entry, int* count);
+static void Uconfig_freeColumns(UconfigEntry* entry);
+bool Uconfig_reserveKeys(UconfigEntry* entry, int count);
+bool Uconfig_reserveSubentries(UconfigEntry* entry, int count);
 UconfigKey* Uconfig_searchKeyByName(const char* name,
                                     UconfigEntry* entry,
                                     int nameSize = 0);
@@ -12,141 +44,114 @@ UconfigEntry* Uconfig_searchEntryByName(const char* name,
                                         bool recursive = false);
 
 
-UconfigKeyObject::UconfigKeyObject()
-{
-    initialize();
-}
-
-UconfigKeyObject::UconfigKeyObject(UconfigKey* key, bool copy)
-{
-    if (key)
-    {
-        if (copy)
-        {
-            setReference(NULL);
-            copyKey(&propData, key);
-        }
-        else
-        {
-            initialize();
-            setReference(key);
-        }
-    }
-    else
-        initialize();
-}
-
-UconfigKeyObject::UconfigKeyObject(const UconfigKeyObject& key)
-{
-    setReference(NULL);
-    if (key.refData)
-        copyKey(&propData, key.refData);
-    else
-        copyKey(&propData, &key.propData);
-}
+// Nodes read through null handles
+static const UconfigKey Uconfig_emptyKey = {};
+static const UconfigEntry Uconfig_emptyEntry = {};
 
-UconfigKeyObject::~UconfigKeyObject()
-{
-    reset();
-}
 
-UconfigKeyObject& UconfigKeyObject::operator=(const UconfigKeyObject& key)
+UconfigKeyRef::UconfigKeyRef(UconfigKey* key)
 {
-    if (key.refData)
-        setReference(key.refData);
-    else
-        setReference(const_cast<UconfigKey*>(&key.propData));
-    return *this;
+    refData = key;
 }
 
-void UconfigKeyObject::reset()
+bool UconfigKeyRef::isNull() const
 {
-    refData = NULL;
-
-    if (propData.name)
-        delete[] propData.name;
-    propData.name = NULL;
-    propData.nameSize = 0;
-
-    if (propData.value)
-        delete[] propData.value;
-    propData.value = NULL;
-    propData.valueSize = 0;
-    propData.valueType = 0;
+    return refData == NULL;
 }
 
-const char* UconfigKeyObject::name() const
+const char* UconfigKeyRef::name() const
 {
-    const UconfigKey& data = refData ? *refData : propData;
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
     return data.name;
 }
 
-int UconfigKeyObject::nameSize() const
+int UconfigKeyRef::nameSize() const
 {
-    const UconfigKey& data = refData ? *refData : propData;
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
     return data.nameSize;
 }
 
-void UconfigKeyObject::setName(const char* name, int size)
+void UconfigKeyRef::setName(const char* name, int size)
 {
-    UconfigKey& data = refData ? *refData : propData;
+    if (!refData || Uconfig_isColumnRow(refData->parentEntry))
+        return;
+    UconfigKey& data = *refData;
 
-    if (data.name)
-        delete[] data.name;
+    Uconfig_freeKeyName(&data);
+    if (data.parentEntry)
+        Uconfig_invalidateKeyIndex(data.parentEntry);
 
     if (name)
     {
         if (size <= 0)
-        {
             size = strlen(name) + 1;
-            data.name = new char[size];
-            strcpy(data.name, name);
-        }
-        else
-        {
-            data.name = new char[size];
-            memcpy(data.name, name, size);
-        }
+        data.name = Uconfig_copyKeyName(&data, name, size);
         data.nameSize = size;
     }
     else
+    {
         data.name = NULL;
+        data.nameSize = 0;
+    }
+}
+
+UconfigArena* UconfigKeyRef::arena() const
+{
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
+    return data.arena;
+}
+
+// Make the name and the value of this (empty) key allocated
+// from the given arena
+bool UconfigKeyRef::setArena(UconfigArena* arena)
+{
+    if (!refData)
+        return false;
+    UconfigKey& data = *refData;
+    if (arena == data.arena)
+        return true;
+    if (data.name || data.value)
+        return false;
+
+    data.arena = arena;
+    return true;
 }
 
-int UconfigKeyObject::type() const
+int UconfigKeyRef::type() const
 {
-    const UconfigKey& data = refData ? *refData : propData;
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
     return data.valueType;
 }
 
-void UconfigKeyObject::setType(int type)
+void UconfigKeyRef::setType(int type)
 {
-    UconfigKey& data = refData ? *refData : propData;
-    data.valueType = type;
+    if (refData && !Uconfig_isColumnRow(refData->parentEntry))
+        refData->valueType = type;
 }
 
-const char* UconfigKeyObject::value() const
+const char* UconfigKeyRef::value() const
 {
-    const UconfigKey& data = refData ? *refData : propData;
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
     return data.value;
 }
 
-int UconfigKeyObject::valueSize() const
+int UconfigKeyRef::valueSize() const
 {
-    const UconfigKey& data = refData ? *refData : propData;
+    const UconfigKey& data = refData ? *refData : Uconfig_emptyKey;
     return data.valueSize;
 }
 
-void UconfigKeyObject::setValue(const char* value, int size)
+void UconfigKeyRef::setValue(const char* value, int size)
 {
-    UconfigKey& data = refData ? *refData : propData;
+    if (!refData || Uconfig_isColumnRow(refData->parentEntry))
+        return;
+    UconfigKey& data = *refData;
 
-    if (data.value)
-        delete[] data.value;
+    Uconfig_freeKeyValue(&data);
 
     if (value && size > 0)
     {
-        data.value = new char[size];
+        data.value = Uconfig_allocateKeyValue(&data, size);
         memcpy(data.value, value, size);
         data.valueSize = size;
     }
@@ -157,24 +162,117 @@ void UconfigKeyObject::setValue(const char* value, int size)
     }
 }
 
+
+UconfigKeyObject::UconfigKeyObject()
+{
+    initialize();
+}
+
+UconfigKeyObject::UconfigKeyObject(UconfigKey* key, bool copy)
+{
+    initialize();
+    if (key)
+    {
+        if (copy)
+            copyKey(&propData, key);
+        else
+            setReference(key);
+    }
+}
+
+// Refer to the key of a handle, without copying it
+UconfigKeyObject::UconfigKeyObject(const UconfigKeyRef& key)
+{
+    initialize();
+    setReference(key.refData);
+}
+
+UconfigKeyObject::UconfigKeyObject(const UconfigKeyObject& key) :
+    UconfigKeyRef()
+{
+    initialize();
+    copyKey(&propData, key.refData);
+}
+
+UconfigKeyObject::UconfigKeyObject(UconfigKeyObject&& key) noexcept :
+    UconfigKeyRef()
+{
+    initialize();
+    if (key.refData != &key.propData)
+        setReference(key.refData);
+    else
+        moveData(key);
+}
+
+UconfigKeyObject::~UconfigKeyObject()
+{
+    reset();
+}
+
+UconfigKeyObject& UconfigKeyObject::operator=(const UconfigKeyRef& key)
+{
+    setReference(key.refData);
+    return *this;
+}
+
+UconfigKeyObject& UconfigKeyObject::operator=(const UconfigKeyObject& key)
+{
+    setReference(key.refData);
+    return *this;
+}
+
+UconfigKeyObject& UconfigKeyObject::operator=(UconfigKeyObject&& key) noexcept
+{
+    if (&key == this)
+        return *this;
+
+    if (key.refData != &key.propData)
+        setReference(key.refData);
+    else
+    {
+        reset();
+        moveData(key);
+    }
+    return *this;
+}
+
+void UconfigKeyObject::reset()
+{
+    refData = &propData;
+
+    Uconfig_freeKeyName(&propData);
+    propData.name = NULL;
+    propData.nameSize = 0;
+
+    Uconfig_freeKeyValue(&propData);
+    propData.value = NULL;
+    propData.valueSize = 0;
+    propData.valueType = 0;
+}
+
 // Deep copy of a key
-bool UconfigKeyObject::copyKey(UconfigKey* dest, const UconfigKey* src)
+// The name and the value of the copy are allocated from ARENA,
+// or from the heap if ARENA is NULL
+bool UconfigKeyObject::copyKey(UconfigKey* dest,
+                               const UconfigKey* src,
+                               UconfigArena* arena)
 {
     // First do a shallow copy
     memcpy(dest, src, sizeof(UconfigKey));
+    dest->parentEntry = NULL;
+    dest->arena = arena;
 
     // Deep copy of the name
     if (src->name)
     {
-        dest->name = new char[src->nameSize];
-        memcpy(dest->name, src->name, src->nameSize);
+        dest->name = Uconfig_copyKeyName(dest, src->name, src->nameSize);
         dest->nameSize = src->nameSize;
     }
 
     // Deep copy of the value chunk
     if (src->value)
     {
-        dest->value = new char[src->valueSize];
+        dest->value = Uconfig_allocateKeyValue(dest, src->valueSize);
         memcpy(dest->value, src->value, src->valueSize);
         dest->valueSize = src->valueSize;
     }
@@ -184,301 +282,665 @@ bool UconfigKeyObject::copyKey(UconfigKey* dest, const UconfigKey* src)
 
 void UconfigKeyObject::deleteKey(UconfigKey* key)
 {
-    if (key->name)
-        delete[] key->name;
-    if (key->value)
-        delete[] key->value;
-    delete key;
+    UconfigArena* arena = key->arena;
+    Uconfig_freeKeyName(key);
+    Uconfig_freeKeyValue(key);
+    if (arena)
+        arena->deallocate(key);
+    else
+        delete key;
 }
 
 void UconfigKeyObject::initialize()
 {
-    refData = NULL;
+    refData = &propData;
 
     propData.name = NULL;
     propData.nameSize = 0;
     propData.value = NULL;
     propData.valueSize = 0;
     propData.valueType = 0;
+    propData.parentEntry = NULL;
+    propData.arena = NULL;
 }
 
+// Refer to another key, or to our own data if REFERENCE is NULL
 void UconfigKeyObject::setReference(UconfigKey* reference)
 {
-    refData = reference;
+    refData = reference ? reference : &propData;
 }
 
+// Take over the name and the value owned by KEY,
+// leaving it empty with the same allocator
+void UconfigKeyObject::moveData(UconfigKeyObject& key)
+{
+    Uconfig_moveKey(&propData, &key.propData);
+    propData.parentEntry = NULL;
+    refData = &propData;
+    key.initialize();
+    key.propData.arena = propData.arena;
+}
 
-UconfigEntryObject::UconfigEntryObject()
+
+UconfigKeyRange::Iterator::Iterator(UconfigKey** position)
 {
-    initialize();
+    this->position = position;
 }
 
-UconfigEntryObject::UconfigEntryObject(UconfigEntry* entry,
-                                       bool copy,
-                                       bool subentries)
+UconfigKeyRef UconfigKeyRange::Iterator::operator*() const
 {
-    if (entry)
-    {
-        if (copy)
-        {
-            setReference(NULL);
-            propData = new UconfigEntry;
-            copyEntry(propData, entry, subentries);
-        }
-        else
-        {
-            initialize();
-            setReference(entry);
-        }
-    }
-    else
-        initialize();
+    return UconfigKeyRef(*position);
 }
 
-UconfigEntryObject::UconfigEntryObject(const UconfigEntryObject& entry)
+UconfigKeyRange::Iterator& UconfigKeyRange::Iterator::operator++()
 {
-    setReference(NULL);
-    propData = new UconfigEntry;
-    if (entry.refData)
-        copyEntry(propData, entry.refData);
-    else
-        copyEntry(propData, entry.propData);
+    position++;
+    return *this;
 }
 
-UconfigEntryObject::~UconfigEntryObject()
+bool UconfigKeyRange::Iterator::operator==(const Iterator& iterator) const
 {
-    if (propData)
-    {
-        reset();
-        delete propData;
-    }
+    return position == iterator.position;
 }
 
-UconfigEntryObject&
-UconfigEntryObject::operator=(const UconfigEntryObject& entry)
+bool UconfigKeyRange::Iterator::operator!=(const Iterator& iterator) const
 {
-    if (entry.refData)
-        setReference(entry.refData);
-    else
-        setReference(const_cast<UconfigEntry*>(entry.propData));
+    return position != iterator.position;
+}
+
+UconfigKeyRange::UconfigKeyRange(UconfigKey** keys, int count)
+{
+    this->keys = keys;
+    this->count = keys ? count : 0;
+}
+
+UconfigKeyRange::Iterator UconfigKeyRange::begin() const
+{
+    return Iterator(keys);
+}
+
+UconfigKeyRange::Iterator UconfigKeyRange::end() const
+{
+    return Iterator(keys + count);
+}
+
+int UconfigKeyRange::size() const
+{
+    return count;
+}
+
+UconfigKeyRef UconfigKeyRange::operator[](int index) const
+{
+    if (index < 0 || index >= count)
+        return UconfigKeyRef();
+    return UconfigKeyRef(keys[index]);
+}
+
+
+UconfigEntryRange::Iterator::Iterator(UconfigEntry** position)
+{
+    this->position = position;
+}
+
+UconfigEntryRef UconfigEntryRange::Iterator::operator*() const
+{
+    return UconfigEntryRef(*position);
+}
+
+UconfigEntryRange::Iterator& UconfigEntryRange::Iterator::operator++()
+{
+    position++;
     return *this;
 }
 
-void UconfigEntryObject::reset()
+bool UconfigEntryRange::Iterator::operator==(const Iterator& iterator) const
 {
-    // Free manually allocated memory before re-initialization
-    if (propData)
-    {
-        if (propData->name)
-            delete[] propData->name;
-        if (propData->keys)
-        {
-            for (int i=0; i<propData->keyCount; i++)
-                UconfigKeyObject::deleteKey(propData->keys[i]);
-            delete[] propData->keys;
-        }
-        if (propData->subentries)
-        {
-            for (int i=0; i<propData->subentryCount; i++)
-                deleteEntry(propData->subentries[i]);
-            delete[] propData->subentries;
-        }
-        delete propData;
-    }
+    return position == iterator.position;
+}
 
-    initialize();
+bool UconfigEntryRange::Iterator::operator!=(const Iterator& iterator) const
+{
+    return position != iterator.position;
+}
+
+UconfigEntryRange::UconfigEntryRange(UconfigEntry** entries, int count)
+{
+    this->entries = entries;
+    this->count = entries ? count : 0;
+}
+
+UconfigEntryRange::Iterator UconfigEntryRange::begin() const
+{
+    return Iterator(entries);
+}
+
+UconfigEntryRange::Iterator UconfigEntryRange::end() const
+{
+    return Iterator(entries + count);
+}
+
+int UconfigEntryRange::size() const
+{
+    return count;
+}
+
+UconfigEntryRef UconfigEntryRange::operator[](int index) const
+{
+    if (index < 0 || index >= count)
+        return UconfigEntryRef();
+    return UconfigEntryRef(entries[index]);
+}
+
+
+UconfigEntryRef::UconfigEntryRef(UconfigEntry* entry)
+{
+    refData = entry;
+}
+
+bool UconfigEntryRef::isNull() const
+{
+    return refData == NULL;
 }
 
-const char* UconfigEntryObject::name() const
+const char* UconfigEntryRef::name() const
 {
-    const UconfigEntry& data = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
     return data.name;
 }
 
-int UconfigEntryObject::nameSize() const
+int UconfigEntryRef::nameSize() const
 {
-    const UconfigEntry& data = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
     return data.nameSize;
 }
 
-void UconfigEntryObject::setName(const char* name, int size)
+void UconfigEntryRef::setName(const char* name, int size)
 {
-    UconfigEntry& data = refData ? *refData : *propData;
+    if (!refData || Uconfig_isColumnRow(refData))
+        return;
+    UconfigEntry& data = *refData;
 
-    if (data.name)
-        delete[] data.name;
+    Uconfig_free(data.arena, data.name);
+    if (data.parentEntry)
+        Uconfig_invalidateEntryIndex(data.parentEntry);
 
     if (name)
     {
         if (size <= 0)
-        {
             size = strlen(name) + 1;
-            data.name = new char[size];
-            strcpy(data.name, name);
-        }
-        else
-        {
-            data.name = new char[size];
-            memcpy(data.name, name, size);
-        }
+        data.name = Uconfig_copyName(data.arena, name, size);
         data.nameSize = size;
     }
     else
+    {
         data.name = NULL;
+        data.nameSize = 0;
+    }
 }
 
-int UconfigEntryObject::type() const
+int UconfigEntryRef::type() const
 {
-    const UconfigEntry& data = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
     return data.type;
 }
 
-void UconfigEntryObject::setType(int type)
+void UconfigEntryRef::setType(int type)
+{
+    if (refData && !Uconfig_isColumnRow(refData))
+        refData->type = type;
+}
+
+UconfigArena* UconfigEntryRef::arena() const
 {
-    UconfigEntry& data = refData ? *refData : *propData;
-    data.type = type;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return data.arena;
 }
 
-int UconfigEntryObject::keyCount() const
+int UconfigEntryRef::keyCount() const
 {
-    const UconfigEntry& data = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
     return data.keyCount;
 }
 
-UconfigKeyObject* UconfigEntryObject::keys()
+// List of handles to the keys; the list must be freed with delete[]
+UconfigKeyRef* UconfigEntryRef::keys() const
 {
-    UconfigEntry& data = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
     if (data.keyCount < 1)
         return NULL;
 
-    UconfigKeyObject* keyList = new UconfigKeyObject[data.keyCount];
+    UconfigKeyRef* keyList = new UconfigKeyRef[data.keyCount];
     for (int i=0; i<data.keyCount; i++)
-        keyList[i].setReference(data.keys[i]);
+        keyList[i].refData = data.keys[i];
     return keyList;
 }
 
-bool UconfigEntryObject::existKey(const char* keyName, int nameSize) const
+bool UconfigEntryRef::nameIndexEnabled() const
 {
-    if (!keyName)
-        return false;
-    if (nameSize <= 0)
-        nameSize = strlen(keyName) + 1;
-
-    const UconfigEntry& entry = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return data.index != NULL;
+}
 
-    for (int i=0; i<entry.keyCount; i++)
-    {
-        if (entry.keys[i] &&
-            entry.keys[i]->name &&
-            memcmp(entry.keys[i]->name, keyName, nameSize) == 0)
-            return true;
-    }
-    return false;
+// Look up keys and direct subentries of this entry by name
+// through a hash index instead of a linear scan.
+// The index is built on the first lookup, then kept up to date.
+void UconfigEntryRef::setNameIndexEnabled(bool enabled)
+{
+    if (!refData)
+        return;
+    if (enabled)
+        Uconfig_newEntryIndex(refData);
+    else
+        Uconfig_deleteEntryIndex(refData);
 }
 
-// Find a key with given name under a given entry
-// Return NULL if no such key can be found
-UconfigKeyObject UconfigEntryObject::searchKey(const char* keyName,
-                                               int nameSize)
+bool UconfigEntryRef::columnarEnabled() const
 {
-    if (!keyName)
-        return UconfigKeyObject();
-    if (nameSize <= 0)
-        nameSize = strlen(keyName) + 1;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return data.columns != NULL;
+}
 
-    UconfigEntry& entry = refData ? *refData : *propData;
+// Store the subentries of this entry (rows of a table, made of keys only)
+// by column, then keep storing appended rows this way (see beginRow()).
+// Rows are still read as subentries: each of them is built from the
+// columns when first needed, then kept until the columns are dropped.
+// Such rows are read-only, and no subentry can be added nor removed:
+// disable the columns to change them. When disabled, rows become
+// subentries again.
+// Return false if some rows cannot be stored by column (e.g. if they have
+// subentries, or if their keys do not have the same names).
+bool UconfigEntryRef::setColumnarEnabled(bool enabled)
+{
+    if (!refData || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
 
-    UconfigKey* key = NULL;
-    for (int i=0; i<entry.keyCount; i++)
+    int i;
+    if (enabled)
     {
-        if (entry.keys[i] &&
-            entry.keys[i]->name &&
-            memcmp(entry.keys[i]->name, keyName, nameSize) == 0)
+        if (entry.columns)
+            return true;
+        if (!Uconfig_newColumns(&entry))
+            return false;
+
+        for (i=0; i<entry.subentryCount; i++)
         {
-            key = entry.keys[i];
-            break;
+            const UconfigEntry* row = entry.subentries[i];
+            bool success = row->subentryCount == 0 &&
+                           Uconfig_beginColumnRow(&entry, row->name,
+                                                  row->nameSize, row->type);
+            for (int j=0; success && j<row->keyCount; j++)
+                success = Uconfig_appendColumnCell(&entry, row->keys[j]);
+            if (!success)
+            {
+                Uconfig_freeColumns(&entry);
+                return false;
+            }
+            Uconfig_endColumnRow(&entry);
         }
+
+        for (i=0; i<entry.subentryCount; i++)
+            UconfigEntryObject::deleteEntry(entry.subentries[i]);
+        entry.subentryCount = 0;
+        Uconfig_invalidateEntryIndex(&entry);
     }
+    else
+    {
+        if (!entry.columns)
+            return true;
 
-    return UconfigKeyObject(key, false);
+        // Take over the rows (including one being appended) as subentries
+        int rowCount;
+        entry.columns->openRow = false;
+        UconfigEntry** rows = Uconfig_columnRows(&entry, &rowCount);
+        if (rowCount > 0 &&
+            (!rows || !Uconfig_reserveSubentries(&entry, rowCount)))
+            return false;
+        for (i=0; i<rowCount; i++)
+            entry.subentries[i] = rows[i];
+        entry.subentryCount = rowCount;
+        entry.columns->rowEntryCount = 0;
+        Uconfig_freeColumns(&entry);
+        Uconfig_invalidateEntryIndex(&entry);
+    }
+    return true;
 }
-bool UconfigEntryObject::addKey(const UconfigKeyObject* newKey)
+
+int UconfigEntryRef::rowCount() const
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return data.columns ? data.columns->rowCount : 0;
+}
+
+int UconfigEntryRef::columnCount() const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return data.columns ? data.columns->columnCount : 0;
+}
+
+// Index of the column whose keys have a given name, or -1 if not found
+int UconfigEntryRef::searchColumn(const char* columnName, int nameSize) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || !columnName)
+        return -1;
+    if (nameSize <= 0)
+        nameSize = strlen(columnName) + 1;
 
-    // Create a new list for the keys
+    const UconfigColumns* columns = data.columns;
+    for (int i=0; i<columns->columnCount; i++)
+    {
+        const UconfigColumn& column = columns->columns[i];
+        if (column.nameSize == nameSize &&
+            memcmp(column.name, columnName, nameSize) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Value type of the cells of a column (except its exceptions),
+// or a negative value if the column has no cell
+int UconfigEntryRef::columnType(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return UCONFIG_COLUMN_TYPE_NONE;
+    return data.columns->columns[index].type;
+}
+
+// Values of a column as an array of rowCount() integers,
+// or NULL if the column is not of integers
+// Missing cells, exceptions and the header row (if any) hold 0
+const long long* UconfigEntryRef::integerColumn(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return NULL;
+
+    const UconfigColumn& column = data.columns->columns[index];
+    if (column.storage != UCONFIG_COLUMN_STORAGE_INTEGER ||
+        column.count < data.columns->rowCount)
+        return NULL;
+    return static_cast<const long long*>(column.values);
+}
+
+// Same as above, for floating-point numbers
+const double* UconfigEntryRef::doubleColumn(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return NULL;
+
+    const UconfigColumn& column = data.columns->columns[index];
+    if (column.storage != UCONFIG_COLUMN_STORAGE_REAL ||
+        column.count < data.columns->rowCount)
+        return NULL;
+    return static_cast<const double*>(column.values);
+}
+
+// Same as above, for booleans
+const bool* UconfigEntryRef::boolColumn(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return NULL;
+
+    const UconfigColumn& column = data.columns->columns[index];
+    if (column.storage != UCONFIG_COLUMN_STORAGE_BOOL ||
+        column.count < data.columns->rowCount)
+        return NULL;
+    return static_cast<const bool*>(column.values);
+}
+
+// Number of cells of a column whose type is not the one of the column
+int UconfigEntryRef::exceptionCount(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return 0;
+
+    const UconfigColumn& column = data.columns->columns[index];
+    return column.exceptions ? column.exceptions->count : 0;
+}
+
+// Rows of such cells, in increasing order
+const int* UconfigEntryRef::exceptionRows(int index) const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    if (!data.columns || index < 0 || index >= data.columns->columnCount)
+        return NULL;
+    return data.columns->columns[index].exceptionRows;
+}
+
+// Copy a row stored by column into ROW, as an entry with one key per cell
+// The previous content of ROW is dropped, but not its allocator
+bool UconfigEntryRef::readRow(int index, UconfigEntryObject& row) const
+{
+    if (!refData || !refData->columns)
+        return false;
+    const UconfigColumns* columns = refData->columns;
+    if (index < 0 || index >= columns->rowCount)
+        return false;
+
+    row.reset();
+    int nameSize;
+    const char* name = Uconfig_readColumnRowName(columns, index, &nameSize);
+    if (name)
+        row.setName(name, nameSize);
+    row.setType(columns->rowType);
+
+    UconfigKey cell;
+    UconfigKeyRef key(&cell);
+    int cellCount = columns->cellCounts[index];
+    if (!row.reserveKeys(cellCount))
+        return false;
+    for (int i=0; i<cellCount; i++)
+    {
+        Uconfig_readColumnCell(columns, index, i, &cell);
+        if (!row.addKey(&key))
+            return false;
+    }
+    return true;
+}
+
+// Append a row to the columns, cell by cell
+// A cell is refused if it is not named after its column,
+// and a row if it is not of the same type as the previous ones
+bool UconfigEntryRef::beginRow(const char* name, int nameSize, int type)
+{
+    if (!refData)
+        return false;
+    if (name && nameSize <= 0)
+        nameSize = strlen(name) + 1;
+    return Uconfig_beginColumnRow(refData, name, nameSize, type);
+}
+
+bool UconfigEntryRef::appendCell(const UconfigKeyRef& key)
+{
+    if (!refData || !key.refData)
+        return false;
+    return Uconfig_appendColumnCell(refData, key.refData);
+}
+
+void UconfigEntryRef::endRow()
+{
+    if (refData)
+        Uconfig_endColumnRow(refData);
+}
+
+// Non-allocating view over the keys
+UconfigKeyRange UconfigEntryRef::keyRange() const
+{
+    const UconfigEntry& data = refData ? *refData : Uconfig_emptyEntry;
+    return UconfigKeyRange(data.keys, data.keyCount);
+}
+
+bool UconfigEntryRef::existKey(const char* keyName, int nameSize) const
+{
+    if (!keyName)
+        return false;
+
+    return Uconfig_searchKeyByName(keyName, refData, nameSize) != NULL;
+}
+
+// Find a key with given name under a given entry
+// Return a null handle if no such key can be found
+UconfigKeyRef UconfigEntryRef::searchKey(const char* keyName,
+                                         int nameSize) const
+{
+    if (!keyName)
+        return UconfigKeyRef();
+
+    return UconfigKeyRef(Uconfig_searchKeyByName(keyName, refData, nameSize));
+}
+
+// Make sure that the entry can hold at least COUNT keys
+// without reallocating its key list
+bool UconfigEntryRef::reserveKeys(int count)
+{
+    if (Uconfig_isColumnRow(refData))
+        return false;
+    return Uconfig_reserveKeys(refData, count);
+}
+
+bool UconfigEntryRef::addKey(const UconfigKeyRef* newKey)
+{
+    if (!refData || !newKey->refData || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
+
+    // Grow the key list geometrically if it is full
     int keyCount = entry.keyCount;
-    UconfigKey** newKeyList = new UconfigKey*[keyCount + 1];
-    if (keyCount > 0)
-        memcpy(newKeyList,
-               entry.keys,
-               sizeof(UconfigKey*) * keyCount);
+    if (keyCount >= entry.keyCapacity)
+    {
+        int newCapacity = entry.keyCapacity > 0 ?
+                          entry.keyCapacity * 2 :
+                          UCONFIG_ENTRY_CAPACITY_MIN;
+        if (!Uconfig_reserveKeys(&entry, newCapacity))
+            return false;
+    }
 
     // Insert the new key into list
-    newKeyList[keyCount] = new UconfigKey;
-    const UconfigKey* newData =
-                        newKey->refData ? newKey->refData : &newKey->propData;
-    if (!UconfigKeyObject::copyKey(newKeyList[keyCount], newData))
+    UconfigKey* tempKey = Uconfig_newKey(entry.arena);
+    if (!UconfigKeyObject::copyKey(tempKey, newKey->refData, entry.arena))
+    {
+        UconfigKeyObject::deleteKey(tempKey);
         return false;
-
-    // Update the key list for the entry
-    if (entry.keys)
-        delete[] entry.keys;
-    entry.keys = newKeyList;
+    }
+    tempKey->parentEntry = &entry;
+    entry.keys[keyCount] = tempKey;
     entry.keyCount++;
+    Uconfig_indexAddKey(&entry, tempKey);
+
+    return true;
+}
+
+// Add a key by moving its name and value into the entry, leaving NEWKEY
+// empty; keys referring to other nodes, or allocated differently,
+// are copied
+bool UconfigEntryRef::addKey(UconfigKeyObject&& newKey)
+{
+    if (!appendKey(&newKey))
+        return false;
 
+    newKey.reset();
     return true;
 }
 
-bool UconfigEntryObject::deleteKey(const char* keyName, int nameSize)
+// Append a key without copying its name and value:
+// their ownership is transferred to the entry, and NEWKEY becomes
+// a reference to the appended key
+bool UconfigEntryRef::appendKey(UconfigKeyObject* newKey)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
-    UconfigKey* key = Uconfig_searchKeyByName(keyName, &entry, nameSize);
-    if (!key)
+    if (!refData || Uconfig_isColumnRow(refData))
         return false;
+    UconfigEntry& entry = *refData;
+    if (newKey->refData != &newKey->propData ||
+        newKey->propData.arena != entry.arena)
+    {
+        // Keys owned by other entries or allocated differently: copy them
+        if (!addKey(newKey))
+            return false;
+        newKey->reset();
+        newKey->setReference(entry.keys[entry.keyCount - 1]);
+        return true;
+    }
 
-    // Create a new list for the keys
+    // Grow the key list geometrically if it is full
     int keyCount = entry.keyCount;
-    UconfigKey** newKeyList = new UconfigKey*[keyCount - 1];
+    if (keyCount >= entry.keyCapacity)
+    {
+        int newCapacity = entry.keyCapacity > 0 ?
+                          entry.keyCapacity * 2 :
+                          UCONFIG_ENTRY_CAPACITY_MIN;
+        if (!Uconfig_reserveKeys(&entry, newCapacity))
+            return false;
+    }
+
+    // Move the key data into a new node
+    UconfigKey* tempKey = Uconfig_newKey(entry.arena);
+    Uconfig_moveKey(tempKey, &newKey->propData);
+    tempKey->parentEntry = &entry;
+    entry.keys[keyCount] = tempKey;
+    entry.keyCount++;
+    Uconfig_indexAddKey(&entry, tempKey);
+
+    // Make the original object a reference to the key
+    newKey->initialize();
+    newKey->propData.arena = entry.arena;
+    newKey->setReference(tempKey);
+
+    return true;
+}
+
+bool UconfigEntryRef::deleteKey(const char* keyName, int nameSize)
+{
+    UconfigKey* key = Uconfig_searchKeyByName(keyName, refData, nameSize);
+    if (!key || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
+
+    // Remove the key from the list in place,
+    // keeping the order of the remaining keys
     int i, j = 0;
-    for (i=0; i<keyCount; i++)
+    for (i=0; i<entry.keyCount; i++)
     {
         if (entry.keys[i] != key)
-            newKeyList[j++] = entry.keys[i];
+            entry.keys[j++] = entry.keys[i];
     }
-
-    // Update the key list for the entry
-    if (entry.keys)
-        delete[] entry.keys;
-    entry.keys = newKeyList;
     entry.keyCount--;
+    UconfigKeyObject::deleteKey(key);
+    Uconfig_invalidateKeyIndex(&entry);
 
     return true;
 }
 
-bool UconfigEntryObject::modifyKey(const UconfigKeyObject* newKey,
-                                   const char* keyName,
-                                   int nameSize)
+bool UconfigEntryRef::modifyKey(const UconfigKeyRef* newKey,
+                                const char* keyName,
+                                int nameSize)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
-    UconfigKey* key = Uconfig_searchKeyByName(keyName, &entry, nameSize);
-    if (!key)
+    UconfigKey* key = Uconfig_searchKeyByName(keyName, refData, nameSize);
+    if (!key || !newKey->refData || Uconfig_isColumnRow(refData))
         return false;
+    UconfigEntry& entry = *refData;
 
     // Duplicate the given key
-    UconfigKey* tempKey = new UconfigKey;
-    const UconfigKey* newData =
-                        newKey->refData ? newKey->refData : &newKey->propData;
-    if (!UconfigKeyObject::copyKey(tempKey, newData))
+    UconfigKey* tempKey = Uconfig_newKey(entry.arena);
+    if (!UconfigKeyObject::copyKey(tempKey, newKey->refData, entry.arena))
+    {
+        UconfigKeyObject::deleteKey(tempKey);
         return false;
+    }
 
     // Update the key list for the entry
     for (int i=0; i<entry.keyCount; i++)
     {
         if (entry.keys[i] == key)
         {
+            tempKey->parentEntry = &entry;
             entry.keys[i] = tempKey;
             UconfigKeyObject::deleteKey(key);
+            Uconfig_invalidateKeyIndex(&entry);
             return true;
         }
     }
@@ -487,56 +949,63 @@ bool UconfigEntryObject::modifyKey(const UconfigKeyObject* newKey,
     return false;
 }
 
-int UconfigEntryObject::subentryCount() const
+int UconfigEntryRef::subentryCount() const
 {
-    const UconfigEntry& entry = refData ? *refData : *propData;
+    const UconfigEntry& entry = refData ? *refData : Uconfig_emptyEntry;
+    if (entry.columns)
+        return Uconfig_columnRowCount(entry.columns);
     return entry.subentryCount;
 }
 
-UconfigEntryObject* UconfigEntryObject::subentries()
+// List of handles to the subentries; the list must be freed with delete[]
+UconfigEntryRef* UconfigEntryRef::subentries() const
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
-    if (entry.subentryCount < 1)
+    UconfigEntryRange range = childRange();
+    if (range.size() < 1)
         return NULL;
 
-    UconfigEntryObject* entryList =
-                            new UconfigEntryObject[entry.subentryCount];
-    for (int i=0; i<entry.subentryCount; i++)
-        entryList[i].setReference(entry.subentries[i]);
+    UconfigEntryRef* entryList = new UconfigEntryRef[range.size()];
+    for (int i=0; i<range.size(); i++)
+        entryList[i] = range[i];
     return entryList;
 }
 
-bool UconfigEntryObject::existSubentry(const char* entryName,
-                                       int nameSize) const
+// Non-allocating view over the subentries
+// (rows stored by column are built on first use, though)
+UconfigEntryRange UconfigEntryRef::childRange() const
 {
-    const UconfigEntry* entry = refData ? refData : propData;
+    const UconfigEntry& entry = refData ? *refData : Uconfig_emptyEntry;
+    if (entry.columns)
+    {
+        int count;
+        UconfigEntry** rows = Uconfig_columnRows(refData, &count);
+        return UconfigEntryRange(rows, rows ? count : 0);
+    }
+    return UconfigEntryRange(entry.subentries, entry.subentryCount);
+}
 
-    if (!entry)
+bool UconfigEntryRef::existSubentry(const char* entryName,
+                                    int nameSize) const
+{
+    if (!refData || !entryName)
         return false;
     if (nameSize <= 0)
         nameSize = strlen(entryName) + 1;
 
-    if (Uconfig_searchEntryByName(entryName,
-                                  const_cast<UconfigEntry*>(entry),
-                                  nameSize,
-                                  false))
+    if (Uconfig_searchEntryByName(entryName, refData, nameSize, false))
         return true;
     else
         return false;
 }
 
 // Find an entry with given name under a given parent recursively
-// Return NULL if no such entry can be found
-UconfigEntryObject
-UconfigEntryObject::searchSubentry(const char* entryName,
-                                   const char* parentName,
-                                   bool recursive,
-                                   int entryNameSize,
-                                   int parentNameSize)
+// Return a null handle if no such entry can be found
+UconfigEntryRef UconfigEntryRef::searchSubentry(const char* entryName,
+                                                const char* parentName,
+                                                bool recursive,
+                                                int entryNameSize,
+                                                int parentNameSize) const
 {
-    UconfigEntryObject entryObject;
-
-    UconfigEntry* entry = refData ? refData : propData;
     UconfigEntry* parent;
     if (parentName)
     {
@@ -544,134 +1013,188 @@ UconfigEntryObject::searchSubentry(const char* entryName,
             parentNameSize = strlen(parentName) + 1;
 
         parent = Uconfig_searchEntryByName(parentName,
-                                           entry,
+                                           refData,
                                            parentNameSize,
                                            recursive);
     }
     else
-        parent = entry;
+        parent = refData;
 
-    if (parent)
-    {
-        if (entryNameSize <= 0)
-            entryNameSize = strlen(entryName) + 1;
+    if (!parent)
+        return UconfigEntryRef();
 
-        entry = Uconfig_searchEntryByName(entryName,
-                                          parent,
-                                          entryNameSize,
-                                          recursive);
-        if (entry)
-            entryObject.setReference(entry);
-    }
+    if (entryName && entryNameSize <= 0)
+        entryNameSize = strlen(entryName) + 1;
 
-    return entryObject;
+    return UconfigEntryRef(Uconfig_searchEntryByName(entryName,
+                                                     parent,
+                                                     entryNameSize,
+                                                     recursive));
 }
 
-bool UconfigEntryObject::addSubentry(const UconfigEntryObject* newEntry)
+// Make sure that the entry can hold at least COUNT subentries
+// without reallocating its subentry list
+bool UconfigEntryRef::reserveSubentries(int count)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
+    if (!refData || refData->columns || Uconfig_isColumnRow(refData))
+        return false;
+    return Uconfig_reserveSubentries(refData, count);
+}
+
+bool UconfigEntryRef::addSubentry(const UconfigEntryRef* newEntry)
+{
+    if (!refData || !newEntry->refData ||
+        refData->columns || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
 
-    // Create a new list for the subentries
+    // Grow the subentry list geometrically if it is full
     int entryCount = entry.subentryCount;
-    UconfigEntry** newEntryList = new UconfigEntry*[entryCount + 1];
-    if (entryCount > 0)
-        memcpy(newEntryList,
-               entry.subentries,
-               sizeof(UconfigEntry*) * entryCount);
+    if (entryCount >= entry.subentryCapacity)
+    {
+        int newCapacity = entry.subentryCapacity > 0 ?
+                          entry.subentryCapacity * 2 :
+                          UCONFIG_ENTRY_CAPACITY_MIN;
+        if (!Uconfig_reserveSubentries(&entry, newCapacity))
+            return false;
+    }
 
     // Insert the new entry into the list
-    const UconfigEntry* newData =
-                    newEntry->refData ? newEntry->refData : newEntry->propData;
-    newEntryList[entryCount] = new UconfigEntry;
-    if (!copyEntry(newEntryList[entryCount], newData, true))
+    UconfigEntry* tempEntry = Uconfig_newEntry(entry.arena);
+    if (!UconfigEntryObject::copyOwnEntry(tempEntry, newEntry->refData,
+                                          true, entry.arena))
+    {
+        Uconfig_freeEntryNode(tempEntry);
         return false;
-    else
-        newEntryList[entryCount]->parentEntry = &entry;
-
-    // Update the list for the parent
-    if (entry.subentries)
-        delete[] entry.subentries;
-    entry.subentries = newEntryList;
+    }
+    tempEntry->parentEntry = &entry;
+    entry.subentries[entryCount] = tempEntry;
     entry.subentryCount++;
+    Uconfig_indexAddEntry(&entry, tempEntry);
+
+    return true;
+}
+
+// Add a subentry by moving its nodes into the entry, leaving NEWENTRY
+// empty; entries referring to other nodes are copied
+bool UconfigEntryRef::addSubentry(UconfigEntryObject&& newEntry)
+{
+    if (newEntry.refData != newEntry.propData)
+        return addSubentry(&newEntry);
+
+    UconfigArena* arena = newEntry.propData->arena;
+    if (!appendSubentry(&newEntry))
+        return false;
 
+    newEntry.initialize();
+    newEntry.propData->arena = arena;
     return true;
 }
 
-bool UconfigEntryObject::appendSubentry(UconfigEntryObject* newEntry)
+bool UconfigEntryRef::appendSubentry(UconfigEntryObject* newEntry)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
+    if (!refData || refData->columns || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
 
-    // Create a new list for the subentries
+    // Grow the subentry list geometrically if it is full
     int entryCount = entry.subentryCount;
-    UconfigEntry** newEntryList = new UconfigEntry*[entryCount + 1];
-    if (entryCount > 0)
-        memcpy(newEntryList,
-               entry.subentries,
-               sizeof(UconfigEntry*) * entryCount);
+    if (entryCount >= entry.subentryCapacity)
+    {
+        int newCapacity = entry.subentryCapacity > 0 ?
+                          entry.subentryCapacity * 2 :
+                          UCONFIG_ENTRY_CAPACITY_MIN;
+        if (!Uconfig_reserveSubentries(&entry, newCapacity))
+            return false;
+    }
 
     // Append the entry into the list
-    if (!newEntry->refData)
+    if (newEntry->refData == newEntry->propData)
     {
+        UconfigEntry* data = newEntry->propData;
+        UconfigEntry* subentry;
+        if (data->arena != entry.arena || newEntry->ownArena)
+        {
+            // Nodes not allocated like their new parent: copy them
+            subentry = Uconfig_newEntry(entry.arena);
+            UconfigEntryObject::copyOwnEntry(subentry, data,
+                                             true, entry.arena);
+            newEntry->reset();
+            delete newEntry->propData;
+        }
+        else if (entry.arena)
+        {
+            // Nodes from the same arena: only move the header
+            // of the entry into the arena as well
+            subentry = Uconfig_newEntry(entry.arena);
+            memcpy(subentry, data, sizeof(UconfigEntry));
+            for (int i=0; i<subentry->keyCount; i++)
+                subentry->keys[i]->parentEntry = subentry;
+            for (int i=0; i<subentry->subentryCount; i++)
+                subentry->subentries[i]->parentEntry = subentry;
+            delete data;
+        }
+        else
+            subentry = data;
+
         // Make the original object a reference to the subentry
-        newEntry->refData = newEntry->propData;
+        newEntry->refData = subentry;
         newEntry->propData = NULL;
     }
-    newEntryList[entryCount] = newEntry->refData;
-    newEntryList[entryCount]->parentEntry = &entry;
-
-    // Update the list for the parent
-    if (entry.subentries)
-        delete[] entry.subentries;
-    entry.subentries = newEntryList;
+    entry.subentries[entryCount] = newEntry->refData;
+    entry.subentries[entryCount]->parentEntry = &entry;
     entry.subentryCount++;
+    Uconfig_indexAddEntry(&entry, newEntry->refData);
 
     return true;
 }
 
-bool UconfigEntryObject::deleteSubentry(const char* entryName, int nameSize)
+bool UconfigEntryRef::deleteSubentry(const char* entryName, int nameSize)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
+    if (!refData || refData->columns || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
     UconfigEntry* subentry =
                     Uconfig_searchEntryByName(entryName, &entry, nameSize);
     if (!subentry)
         return false;
-    deleteEntry(subentry);
 
-    // Create a new list for the subentries
-    int entryCount = entry.subentryCount;
-    UconfigEntry** newEntryList = new UconfigEntry*[entryCount - 1];
+    // Remove the subentry from the list in place,
+    // keeping the order of the remaining subentries
     int i, j = 0;
-    for (i=0; i<entryCount; i++)
+    for (i=0; i<entry.subentryCount; i++)
     {
         if (entry.subentries[i] != subentry)
-            newEntryList[j++] = entry.subentries[i];
+            entry.subentries[j++] = entry.subentries[i];
     }
-
-    // Update the list for the parent
-    if (entry.subentries)
-        delete[] entry.subentries;
-    entry.subentries = newEntryList;
     entry.subentryCount--;
+    UconfigEntryObject::deleteEntry(subentry);
+    Uconfig_invalidateEntryIndex(&entry);
 
     return true;
 }
 
-bool UconfigEntryObject::modifySubentry(const UconfigEntryObject* newEntry,
-                                        const char* entryName,
-                                        int nameSize)
+bool UconfigEntryRef::modifySubentry(const UconfigEntryRef* newEntry,
+                                     const char* entryName,
+                                     int nameSize)
 {
-    UconfigEntry& entry = refData ? *refData : *propData;
+    if (!refData || !newEntry->refData ||
+        refData->columns || Uconfig_isColumnRow(refData))
+        return false;
+    UconfigEntry& entry = *refData;
     UconfigEntry* subentry =
                     Uconfig_searchEntryByName(entryName, &entry, nameSize);
     if (!subentry)
         return false;
 
     // Duplicate the given entry
-    const UconfigEntry* newData =
-                    newEntry->refData ? newEntry->refData : newEntry->propData;
-    UconfigEntry* tempEntry = new UconfigEntry;
-    if (!copyEntry(tempEntry, newData, true))
+    UconfigEntry* tempEntry = Uconfig_newEntry(entry.arena);
+    if (!UconfigEntryObject::copyOwnEntry(tempEntry, newEntry->refData,
+                                          true, entry.arena))
+    {
+        Uconfig_freeEntryNode(tempEntry);
         return false;
+    }
 
     // Update the subentry list of parent
     for (int i=0; i<entry.subentryCount; i++)
@@ -680,7 +1203,8 @@ bool UconfigEntryObject::modifySubentry(const UconfigEntryObject* newEntry,
         {
             entry.subentries[i] = tempEntry;
             tempEntry->parentEntry = &entry;
-            deleteEntry(subentry);
+            UconfigEntryObject::deleteEntry(subentry);
+            Uconfig_invalidateEntryIndex(&entry);
             return true;
         }
     }
@@ -689,97 +1213,568 @@ bool UconfigEntryObject::modifySubentry(const UconfigEntryObject* newEntry,
     return false;
 }
 
-UconfigEntryObject UconfigEntryObject::parentEntry()
+// Replace COUNT subentries from INDEX with the subentries of SOURCE,
+// keeping the order of the others
+// The subentries are moved if SOURCE allocates its nodes like this entry,
+// leaving SOURCE without subentries; otherwise they are copied.
+bool UconfigEntryRef::replaceSubentries(int index,
+                                        int count,
+                                        UconfigEntryObject& source)
 {
-    UconfigEntry* entry = refData ? refData : propData;
-    return UconfigEntryObject(entry, false);
-}
+    if (!refData || !source.refData || source.refData == refData)
+        return false;
+    UconfigEntry& entry = *refData;
+    UconfigEntry& sourceData = *source.refData;
+    if (entry.columns || Uconfig_isColumnRow(&entry) ||
+        index < 0 || count < 0 || index + count > entry.subentryCount)
+        return false;
 
-// Deep copy of an entry and its subentries
-// Warning: do not free any allocated resource in the destination!
-bool UconfigEntryObject::copyEntry(UconfigEntry* dest,
-                                   const UconfigEntry* src,
-                                   bool recursive)
-{
-    if (!src || !dest)
+    int newCount = sourceData.subentryCount;
+    int totalCount = entry.subentryCount - count + newCount;
+    if (totalCount > entry.subentryCapacity &&
+        !Uconfig_reserveSubentries(&entry, totalCount))
         return false;
 
-    // First do a shallow copy
-    memcpy(dest, src, sizeof(UconfigEntry));
+    // Duplicate the new subentries before changing anything
+    bool moving = source.refData == source.propData && !source.ownArena &&
+                  sourceData.arena == entry.arena;
+    UconfigEntry** newEntries = sourceData.subentries;
+    UconfigEntry** copies = NULL;
+    if (!moving && newCount > 0)
+    {
+        copies = new UconfigEntry*[newCount];
+        for (int i=0; i<newCount; i++)
+        {
+            copies[i] = Uconfig_newEntry(entry.arena);
+            if (!UconfigEntryObject::copyOwnEntry(copies[i],
+                                                  sourceData.subentries[i],
+                                                  true, entry.arena))
+            {
+                Uconfig_freeEntryNode(copies[i]);
+                for (int j=0; j<i; j++)
+                    UconfigEntryObject::deleteEntry(copies[j]);
+                delete[] copies;
+                return false;
+            }
+        }
+        newEntries = copies;
+    }
 
-    // Deep copy of the name
-    if (src->name)
+    // Drop the replaced subentries, then shift the following ones
+    for (int i=index; i<index+count; i++)
+        UconfigEntryObject::deleteEntry(entry.subentries[i]);
+    memmove(entry.subentries + index + newCount,
+            entry.subentries + index + count,
+            (entry.subentryCount - index - count) * sizeof(UconfigEntry*));
+    for (int i=0; i<newCount; i++)
     {
-        dest->name = new char[src->nameSize];
-        memcpy(dest->name, src->name, src->nameSize);
+        entry.subentries[index + i] = newEntries[i];
+        newEntries[i]->parentEntry = &entry;
     }
+    entry.subentryCount = totalCount;
+    Uconfig_invalidateEntryIndex(&entry);
 
-    // Deep copy of keys
-    int i;
-    UconfigKey** newKeys = new UconfigKey*[src->keyCount];
-    for (i=0; i<src->keyCount; i++)
+    delete[] copies;
+    if (moving)
     {
-        newKeys[i] = new UconfigKey;
-        UconfigKeyObject::copyKey(newKeys[i], src->keys[i]);
+        sourceData.subentryCount = 0;
+        Uconfig_invalidateEntryIndex(&sourceData);
     }
-    dest->keys = newKeys;
+    return true;
+}
+
+UconfigEntryRef UconfigEntryRef::parentEntry() const
+{
+    return UconfigEntryRef(refData ? refData->parentEntry : NULL);
+}
 
-    if (recursive)
+
+UconfigEntryObject::UconfigEntryObject()
+{
+    ownArena = NULL;
+    initialize();
+}
+
+UconfigEntryObject::UconfigEntryObject(UconfigEntry* entry,
+                                       bool copy,
+                                       bool subentries)
+{
+    ownArena = NULL;
+    if (entry)
     {
-        // Deep copy of subentries
-        UconfigEntry** newEntries = new UconfigEntry*[src->subentryCount];
-        for (i=0; i<src->subentryCount; i++)
+        if (copy)
         {
-            newEntries[i] = new UconfigEntry;
-            copyEntry(newEntries[i], src->subentries[i], true);
+            propData = new UconfigEntry;
+            copyEntry(propData, entry, subentries);
+            refData = propData;
+        }
+        else
+        {
+            // A mere reference does not need its own data
+            propData = NULL;
+            setReference(entry);
         }
-        dest->subentries = newEntries;
     }
     else
-        dest->subentries = NULL;
+        initialize();
+}
+
+// Refer to the entry of a handle, without copying it
+UconfigEntryObject::UconfigEntryObject(const UconfigEntryRef& entry)
+{
+    ownArena = NULL;
+    propData = NULL;
+    setReference(entry.refData);
+}
+
+UconfigEntryObject::UconfigEntryObject(const UconfigEntryObject& entry) :
+    UconfigEntryRef()
+{
+    ownArena = NULL;
+    propData = new UconfigEntry;
+    copyOwnEntry(propData, entry.refData);
+    refData = propData;
+}
+
+UconfigEntryObject::UconfigEntryObject(UconfigEntryObject&& entry) noexcept :
+    UconfigEntryRef()
+{
+    refData = entry.refData;
+    propData = entry.propData;
+    ownArena = entry.ownArena;
+
+    // A mere reference is left as is; otherwise leave an empty entry
+    // behind, allocated in the same way unless the arena has been taken
+    if (propData)
+    {
+        entry.ownArena = NULL;
+        entry.initialize();
+        if (!ownArena)
+            entry.propData->arena = propData->arena;
+    }
+}
+
+UconfigEntryObject::~UconfigEntryObject()
+{
+    if (propData)
+    {
+        reset();
+        delete propData;
+    }
+    if (ownArena)
+        delete ownArena;
+}
+
+UconfigEntryObject&
+UconfigEntryObject::operator=(const UconfigEntryRef& entry)
+{
+    setReference(entry.refData);
+    return *this;
+}
+
+UconfigEntryObject&
+UconfigEntryObject::operator=(const UconfigEntryObject& entry)
+{
+    setReference(entry.refData);
+    return *this;
+}
+
+UconfigEntryObject&
+UconfigEntryObject::operator=(UconfigEntryObject&& entry) noexcept
+{
+    if (&entry == this)
+        return *this;
+    if (!entry.propData)
+    {
+        setReference(entry.refData);
+        return *this;
+    }
+
+    // Exchange the data, then let ENTRY drop what this object used to own
+    UconfigEntry* data = propData;
+    UconfigArena* arena = ownArena;
+    refData = entry.refData;
+    propData = entry.propData;
+    ownArena = entry.ownArena;
+    entry.refData = data;
+    entry.propData = data;
+    entry.ownArena = arena;
+    entry.reset();
+
+    return *this;
+}
+
+void UconfigEntryObject::reset()
+{
+    // Free manually allocated memory before re-initialization,
+    // while keeping the same allocator for the entry
+    UconfigArena* arena = propData ? propData->arena : NULL;
+    if (propData)
+    {
+        if (ownArena)
+        {
+            // The whole tree comes from our own arena: drop it at once
+            ownArena->release();
+        }
+        else
+        {
+            Uconfig_deleteEntryIndex(propData);
+            Uconfig_freeColumns(propData);
+            Uconfig_free(arena, propData->name);
+            if (propData->keys)
+            {
+                for (int i=0; i<propData->keyCount; i++)
+                    UconfigKeyObject::deleteKey(propData->keys[i]);
+                Uconfig_free(arena, propData->keys);
+            }
+            if (propData->subentries)
+            {
+                for (int i=0; i<propData->subentryCount; i++)
+                    deleteEntry(propData->subentries[i]);
+                Uconfig_free(arena, propData->subentries);
+            }
+        }
+        delete propData;
+    }
+
+    initialize();
+    propData->arena = arena;
+}
+
+// Make all nodes subsequently attached to this (empty) entry
+// allocated from the given arena.
+// If OWNING is true, the arena is released together with the entry,
+// and deleted with this object.
+bool UconfigEntryObject::setArena(UconfigArena* arena, bool owning)
+{
+    UconfigEntry& data = *refData;
+    if (arena == data.arena && (!owning || ownArena == arena))
+        return true;
+    if (data.name || data.keyCount > 0 || data.subentryCount > 0 ||
+        data.columns)
+        return false;
+    if (owning && refData != propData)
+        return false;
+
+    // Drop empty lists (and index) allocated by the previous allocator
+    bool indexed = data.index != NULL;
+    Uconfig_deleteEntryIndex(&data);
+    Uconfig_free(data.arena, data.keys);
+    data.keys = NULL;
+    data.keyCapacity = 0;
+    Uconfig_free(data.arena, data.subentries);
+    data.subentries = NULL;
+    data.subentryCapacity = 0;
+
+    if (ownArena && ownArena != arena)
+        delete ownArena;
+    ownArena = owning ? arena : NULL;
+    data.arena = arena;
+    if (indexed)
+        Uconfig_newEntryIndex(&data);
 
     return true;
 }
 
+// Deep copy of an entry and its subentries
+// All nodes of the copy are allocated from ARENA,
+// or from the heap if ARENA is NULL
+// SRC may be filled by the caller, who does not know of the columns:
+// they are not copied.
+// Warning: do not free any allocated resource in the destination!
+bool UconfigEntryObject::copyEntry(UconfigEntry* dest,
+                                   const UconfigEntry* src,
+                                   bool recursive,
+                                   UconfigArena* arena)
+{
+    return Uconfig_copyEntry(dest, src, recursive, arena, false);
+}
+
+// Same as copyEntry(), for entries made by this library,
+// which are copied with their columns
+bool UconfigEntryObject::copyOwnEntry(UconfigEntry* dest,
+                                      const UconfigEntry* src,
+                                      bool recursive,
+                                      UconfigArena* arena)
+{
+    return Uconfig_copyEntry(dest, src, recursive, arena, true);
+}
+
 void UconfigEntryObject::deleteEntry(UconfigEntry* entry)
 {
-    if (entry->name)
-        delete[] entry->name;
+    UconfigArena* arena = entry->arena;
+    if (arena && !arena->isFrozen())
+    {
+        // Nodes from an arena which is still loading are not
+        // freed individually: nothing to do until it is released
+        return;
+    }
+
+    Uconfig_deleteEntryIndex(entry);
+    Uconfig_freeColumns(entry);
+    Uconfig_free(arena, entry->name);
     if (entry->keys)
     {
         for (int i=0; i<entry->keyCount; i++)
             UconfigKeyObject::deleteKey(entry->keys[i]);
-        delete[] entry->keys;
+        Uconfig_free(arena, entry->keys);
     }
     if (entry->subentries)
     {
         for (int i=0; i<entry->subentryCount; i++)
             deleteEntry(entry->subentries[i]);
-        delete[] entry->subentries;
+        Uconfig_free(arena, entry->subentries);
     }
-    delete entry;
+    Uconfig_freeEntryNode(entry);
 }
 
 void UconfigEntryObject::initialize()
 {
-    refData = NULL;
-
     propData = new UconfigEntry;
+    refData = propData;
     propData->name = NULL;
     propData->nameSize = 0;
     propData->type = 0;
     propData->keyCount = 0;
+    propData->keyCapacity = 0;
     propData->keys = NULL;
     propData->subentryCount = 0;
+    propData->subentryCapacity = 0;
     propData->subentries = NULL;
     propData->parentEntry = NULL;
+    propData->arena = NULL;
+    propData->index = NULL;
+    propData->columns = NULL;
 }
 
+// Refer to another entry, or to our own data if REFERENCE is NULL
 void UconfigEntryObject::setReference(UconfigEntry *reference)
 {
-    refData = reference;
-    if (!refData && !propData)
-        propData = new UconfigEntry;
+    if (reference)
+        refData = reference;
+    else if (propData)
+        refData = propData;
+    else
+        initialize();
+}
+
+// Allocate COUNT objects of type T from ARENA,
+// or from the heap if ARENA is NULL
+template <typename T>
+T* Uconfig_allocate(UconfigArena* arena, int count)
+{
+    if (arena)
+        return static_cast<T*>(arena->allocate(sizeof(T) * count));
+    else
+        return new T[count];
+}
+
+// Free objects allocated by Uconfig_allocate()
+template <typename T>
+void Uconfig_free(UconfigArena* arena, T* data)
+{
+    if (!data)
+        return;
+    if (arena)
+        arena->deallocate(data);
+    else
+        delete[] data;
+}
+
+UconfigKey* Uconfig_newKey(UconfigArena* arena)
+{
+    if (arena)
+        return static_cast<UconfigKey*>(arena->allocate(sizeof(UconfigKey)));
+    else
+        return new UconfigKey;
+}
+
+UconfigEntry* Uconfig_newEntry(UconfigArena* arena)
+{
+    if (arena)
+        return static_cast<UconfigEntry*>(
+                                arena->allocate(sizeof(UconfigEntry)));
+    else
+        return new UconfigEntry;
+}
+
+// Copy a name of SIZE bytes for a node allocated from ARENA
+// The name is shared with other nodes of the arena if possible;
+// shared names are never written, and are freed along with the arena
+char* Uconfig_copyName(UconfigArena* arena, const char* name, int size)
+{
+    const char* sharedName = arena ? arena->shareName(name, size) : NULL;
+    if (sharedName)
+        return const_cast<char*>(sharedName);
+
+    char* copy = Uconfig_allocate<char>(arena, size);
+    memcpy(copy, name, size);
+    return copy;
+}
+
+// Same as Uconfig_copyName(), for the name of KEY:
+// a short name is stored inside the key instead
+char* Uconfig_copyKeyName(UconfigKey* key, const char* name, int size)
+{
+    if (size <= UCONFIG_KEY_NAME_INLINE_SIZE)
+    {
+        memcpy(key->inlineName, name, size);
+        return key->inlineName;
+    }
+    return Uconfig_copyName(key->arena, name, size);
+}
+
+// Storage for a value of SIZE bytes: inside KEY if it is short enough,
+// otherwise from the allocator of KEY
+char* Uconfig_allocateKeyValue(UconfigKey* key, int size)
+{
+    if (size <= UCONFIG_KEY_VALUE_INLINE_SIZE)
+        return key->inlineValue.chars;
+    return Uconfig_allocate<char>(key->arena, size);
+}
+
+void Uconfig_freeKeyName(UconfigKey* key)
+{
+    if (key->name != key->inlineName)
+        Uconfig_free(key->arena, key->name);
+}
+
+void Uconfig_freeKeyValue(UconfigKey* key)
+{
+    if (key->value != key->inlineValue.chars)
+        Uconfig_free(key->arena, key->value);
+}
+
+// Move the content of a key to another node, along with
+// its inline name and value
+void Uconfig_moveKey(UconfigKey* dest, const UconfigKey* src)
+{
+    memcpy(dest, src, sizeof(UconfigKey));
+    if (src->name == src->inlineName)
+        dest->name = dest->inlineName;
+    if (src->value == src->inlineValue.chars)
+        dest->value = dest->inlineValue.chars;
+}
+
+// Free the structure of an entry allocated by Uconfig_newEntry(),
+// regardless of its name, keys and subentries
+void Uconfig_freeEntryNode(UconfigEntry* entry)
+{
+    if (entry->arena)
+        entry->arena->deallocate(entry);
+    else
+        delete entry;
+}
+
+// Deep copy of an entry, with its columns if COLUMNS is true
+static bool Uconfig_copyEntry(UconfigEntry* dest,
+                              const UconfigEntry* src,
+                              bool recursive,
+                              UconfigArena* arena,
+                              bool columns)
+{
+    if (!src || !dest)
+        return false;
+
+    // First do a shallow copy
+    memcpy(dest, src, sizeof(UconfigEntry));
+    dest->parentEntry = NULL;
+    dest->arena = arena;
+    dest->index = NULL;
+    dest->columns = NULL;
+    if (columns)
+        Uconfig_copyColumns(dest, src);
+
+    // Deep copy of the name
+    if (src->name)
+    {
+        dest->name = Uconfig_copyName(arena, src->name, src->nameSize);
+    }
+
+    // Deep copy of keys
+    int i;
+    UconfigKey** newKeys = NULL;
+    if (src->keyCount > 0)
+    {
+        newKeys = Uconfig_allocate<UconfigKey*>(arena, src->keyCount);
+        for (i=0; i<src->keyCount; i++)
+        {
+            newKeys[i] = Uconfig_newKey(arena);
+            UconfigKeyObject::copyKey(newKeys[i], src->keys[i], arena);
+            newKeys[i]->parentEntry = dest;
+        }
+    }
+    dest->keys = newKeys;
+    dest->keyCapacity = src->keyCount;
+
+    if (recursive && src->subentryCount > 0)
+    {
+        // Deep copy of subentries
+        UconfigEntry** newEntries =
+                Uconfig_allocate<UconfigEntry*>(arena, src->subentryCount);
+        for (i=0; i<src->subentryCount; i++)
+        {
+            newEntries[i] = Uconfig_newEntry(arena);
+            Uconfig_copyEntry(newEntries[i], src->subentries[i],
+                              true, arena, columns);
+            newEntries[i]->parentEntry = dest;
+        }
+        dest->subentries = newEntries;
+        dest->subentryCapacity = src->subentryCount;
+    }
+    else
+    {
+        dest->subentries = NULL;
+        dest->subentryCount = 0;
+        dest->subentryCapacity = 0;
+    }
+
+    return true;
+}
+
+// Reallocate the key list of an entry so that it can hold
+// at least COUNT keys; existing keys are kept in place
+bool Uconfig_reserveKeys(UconfigEntry* entry, int count)
+{
+    if (!entry)
+        return false;
+    if (count <= entry->keyCapacity)
+        return true;
+
+    UconfigKey** newKeyList = Uconfig_allocate<UconfigKey*>(entry->arena,
+                                                            count);
+    if (entry->keyCount > 0)
+        memcpy(newKeyList,
+               entry->keys,
+               sizeof(UconfigKey*) * entry->keyCount);
+
+    Uconfig_free(entry->arena, entry->keys);
+    entry->keys = newKeyList;
+    entry->keyCapacity = count;
+
+    return true;
+}
+
+// Same as Uconfig_reserveKeys(), for the subentry list
+bool Uconfig_reserveSubentries(UconfigEntry* entry, int count)
+{
+    if (!entry)
+        return false;
+    if (count <= entry->subentryCapacity)
+        return true;
+
+    UconfigEntry** newEntryList =
+                Uconfig_allocate<UconfigEntry*>(entry->arena, count);
+    if (entry->subentryCount > 0)
+        memcpy(newEntryList,
+               entry->subentries,
+               sizeof(UconfigEntry*) * entry->subentryCount);
+
+    Uconfig_free(entry->arena, entry->subentries);
+    entry->subentries = newEntryList;
+    entry->subentryCapacity = count;
+
+    return true;
 }
 
 // Find a key with given name under a given entry
@@ -794,12 +1789,21 @@ UconfigKey* Uconfig_searchKeyByName(const char* name,
     if (nameSize <= 0)
         nameSize = strlen(name) + 1;
 
+    if (entry->index)
+        return Uconfig_indexSearchKey(entry, name, nameSize);
+
+    // Keys holding the shared copy of the name match by address
+    const char* sharedName = NULL;
+    if (entry->arena && nameSize > UCONFIG_KEY_NAME_INLINE_SIZE)
+        sharedName = entry->arena->sharedName(name, nameSize);
+
     UconfigKey* key = NULL;
     for (int i=0; i<entry->keyCount; i++)
     {
-        if (entry->keys[i]->name &&
-            entry->keys[i]->nameSize == nameSize &&
-            memcmp(entry->keys[i]->name, name, nameSize) == 0)
+        if ((sharedName && entry->keys[i]->name == sharedName) ||
+            (entry->keys[i]->name &&
+             entry->keys[i]->nameSize == nameSize &&
+             memcmp(entry->keys[i]->name, name, nameSize) == 0))
         {
             key = entry->keys[i];
             break;
@@ -821,17 +1825,55 @@ UconfigEntry* Uconfig_searchEntryByName(const char* name,
     if (nameSize <= 0)
         nameSize = strlen(name) + 1;
 
+    // Rows stored by column are matched by the names kept in the columns,
+    // so that only the row found is built
+    if (parent->columns)
+    {
+        const UconfigColumns* columns = parent->columns;
+        int rowCount = Uconfig_columnRowCount(columns);
+        for (int i=0; i<rowCount; i++)
+        {
+            int rowNameSize;
+            const char* rowName =
+                    Uconfig_readColumnRowName(columns, i, &rowNameSize);
+            if (rowName && rowNameSize == nameSize &&
+                memcmp(rowName, name, nameSize) == 0)
+                return Uconfig_columnRow(parent, i);
+        }
+
+        // Rows do not have subentries
+        return NULL;
+    }
+
     // Recursive search of an entry with given name and
     // attached to a specific parent
     if (parent && parent->subentries)
     {
         // See if one of the subentries's name match the search
-        for (int i=0; i<parent->subentryCount; i++)
+        if (parent->index)
+        {
+            UconfigEntry* entry =
+                        Uconfig_indexSearchEntry(parent, name, nameSize);
+            if (entry)
+                return entry;
+        }
+        else
         {
-            if (parent->subentries[i]->name &&
-                parent->subentries[i]->nameSize == nameSize &&
-                memcmp(parent->subentries[i]->name, name, nameSize) == 0)
-                return parent->subentries[i];
+            // Subentries holding the shared copy of the name
+            // match by address
+            const char* sharedName = NULL;
+            if (parent->arena)
+                sharedName = parent->arena->sharedName(name, nameSize);
+
+            UconfigEntry* entry;
+            for (int i=0; i<parent->subentryCount; i++)
+            {
+                entry = parent->subentries[i];
+                if ((sharedName && entry->name == sharedName) ||
+                    (entry->name && entry->nameSize == nameSize &&
+                     memcmp(entry->name, name, nameSize) == 0))
+                    return entry;
+            }
         }
 
         if (!recursive)
@@ -852,3 +1894,108 @@ UconfigEntry* Uconfig_searchEntryByName(const char* name,
     // If still no found, return a NULL pointer
     return NULL;
 }
+
+// Tell if an entry is a row stored by column, built for reading only:
+// these are the only subentries of entries with columns
+bool Uconfig_isColumnRow(const UconfigEntry* entry)
+{
+    return entry && entry->parentEntry && entry->parentEntry->columns;
+}
+
+// Number of rows that can be read as subentries,
+// i.e. all of them except one still being appended
+int Uconfig_columnRowCount(const UconfigColumns* columns)
+{
+    return columns->openRow ? columns->rowCount - 1 : columns->rowCount;
+}
+
+// Entry of a row stored by column, built on first use, then kept along
+// with the columns; return NULL if there is no such row
+UconfigEntry* Uconfig_columnRow(UconfigEntry* entry, int index)
+{
+    UconfigColumns* columns = entry->columns;
+    if (index < 0 || index >= Uconfig_columnRowCount(columns))
+        return NULL;
+
+    UconfigArena* arena = entry->arena;
+    if (index >= columns->rowEntryCount)
+    {
+        // Grow the list of rows geometrically, as they are appended
+        int count = columns->rowEntryCount * 2;
+        if (count < columns->rowCount)
+            count = columns->rowCount;
+        UconfigEntry** rowEntries = Uconfig_allocate<UconfigEntry*>(arena,
+                                                                    count);
+        if (!rowEntries)
+            return NULL;
+        for (int i=0; i<count; i++)
+            rowEntries[i] = i < columns->rowEntryCount ?
+                            columns->rowEntries[i] : NULL;
+        Uconfig_free(arena, columns->rowEntries);
+        columns->rowEntries = rowEntries;
+        columns->rowEntryCount = count;
+    }
+    if (columns->rowEntries[index])
+        return columns->rowEntries[index];
+
+    // Copy the name and the cells of the row, as readRow() does
+    UconfigEntry* row = Uconfig_newEntry(arena);
+    *row = Uconfig_emptyEntry;
+    row->arena = arena;
+    int nameSize;
+    const char* name = Uconfig_readColumnRowName(columns, index, &nameSize);
+    if (name && nameSize > 0)
+    {
+        row->name = Uconfig_copyName(arena, name, nameSize);
+        row->nameSize = nameSize;
+    }
+    row->type = columns->rowType;
+
+    int cellCount = columns->cellCounts[index];
+    if (cellCount > 0)
+    {
+        UconfigKey cell;
+        row->keys = Uconfig_allocate<UconfigKey*>(arena, cellCount);
+        for (int i=0; i<cellCount; i++)
+        {
+            Uconfig_readColumnCell(columns, index, i, &cell);
+            row->keys[i] = Uconfig_newKey(arena);
+            UconfigKeyObject::copyKey(row->keys[i], &cell, arena);
+            row->keys[i]->parentEntry = row;
+        }
+        row->keyCount = cellCount;
+        row->keyCapacity = cellCount;
+    }
+
+    row->parentEntry = entry;
+    columns->rowEntries[index] = row;
+    return row;
+}
+
+// List of all the rows that can be read as subentries, built if needed
+UconfigEntry** Uconfig_columnRows(UconfigEntry* entry, int* count)
+{
+    *count = Uconfig_columnRowCount(entry->columns);
+    for (int i=0; i<*count; i++)
+    {
+        if (!Uconfig_columnRow(entry, i))
+            return NULL;
+    }
+    return entry->columns->rowEntries;
+}
+
+// Drop the columns of an entry, with the rows built from them
+void Uconfig_freeColumns(UconfigEntry* entry)
+{
+    UconfigColumns* columns = entry->columns;
+    if (!columns)
+        return;
+
+    for (int i=0; i<columns->rowEntryCount; i++)
+    {
+        if (columns->rowEntries[i])
+            UconfigEntryObject::deleteEntry(columns->rowEntries[i]);
+    }
+    Uconfig_free(entry->arena, columns->rowEntries);
+    Uconfig_deleteColumns(entry);
+}
@@ -5,22 +5,35 @@
  * This file offers wrapper classes for UconfigKey and UconfigEntry.
  * When destructed, these class will try to free the resource
  * allocated to their properties.
+ * Moving an object (e.g. with std::move()) transfers the nodes it owns
+ * without copying them, and leaves it empty; moving a mere reference
+ * gives another reference to the same node. An object made from
+ * a handle (see below) is a reference as well.
  */
 
+#include <stddef.h>
 #include "uconfigentry.h"
 
 
-class UconfigKeyObject
+class UconfigKeyObject;
+class UconfigEntryRef;
+class UconfigEntryObject;
+
+/*
+ * Handles to a key or an entry: a mere pointer to the node, which is cheap
+ * to copy and never allocates nor frees anything. They offer the same
+ * read and write access to the node as the objects below, and are
+ * returned by all navigation functions (searches, parent, views).
+ * A handle is null if nothing was found: reading it gives an empty node,
+ * and changing it has no effect. A handle is invalidated when its node
+ * is deleted.
+ */
+class UconfigKeyRef
 {
 public:
-    UconfigKeyObject();
-    UconfigKeyObject(UconfigKey* key, bool copy = true);
-    UconfigKeyObject(const UconfigKeyObject& key);
-    ~UconfigKeyObject();
+    explicit UconfigKeyRef(UconfigKey* key = NULL);
 
-    UconfigKeyObject& operator=(const UconfigKeyObject& key);
-
-    void reset();
+    bool isNull() const;
 
     // Key name
     const char* name() const;
@@ -31,39 +44,126 @@ public:
     int type() const;
     void setType(int type);
 
+    // Allocator of the key's name and value
+    UconfigArena* arena() const;
+    bool setArena(UconfigArena* arena);
+
     // Key value
     const char* value() const;
     int valueSize() const;
     void setValue(const char* value, int size);
 
+protected:
+    UconfigKey* refData;
+
+    friend class UconfigKeyObject;
+    friend class UconfigEntryRef;
+};
+
+class UconfigKeyObject : public UconfigKeyRef
+{
+public:
+    UconfigKeyObject();
+    UconfigKeyObject(UconfigKey* key, bool copy = true);
+    UconfigKeyObject(const UconfigKeyRef& key);
+    UconfigKeyObject(const UconfigKeyObject& key);
+    UconfigKeyObject(UconfigKeyObject&& key) noexcept;
+    ~UconfigKeyObject();
+
+    UconfigKeyObject& operator=(const UconfigKeyRef& key);
+    UconfigKeyObject& operator=(const UconfigKeyObject& key);
+    UconfigKeyObject& operator=(UconfigKeyObject&& key) noexcept;
+
+    void reset();
+
     // Helper functions
-    static bool copyKey(UconfigKey* dest, const UconfigKey* src);
+    static bool copyKey(UconfigKey* dest,
+                        const UconfigKey* src,
+                        UconfigArena* arena = NULL);
     static void deleteKey(UconfigKey* key);
 
 protected:
     UconfigKey propData;
-    UconfigKey* refData;
 
     void initialize();
     void setReference(UconfigKey *reference);
+    void moveData(UconfigKeyObject& key);
 
-    friend class UconfigEntryObject;
+    friend class UconfigEntryRef;
 };
 
+/*
+ * Non-allocating views over the keys and subentries of an entry.
+ * Dereferencing an iterator gives a handle to the underlying node,
+ * without copying it; handles can be used in range-for:
+ *     for (UconfigKeyRef key : entry.keyRange())
+ * The views are invalidated by any change to the lists of the entry.
+ */
+class UconfigKeyRange
+{
+public:
+    class Iterator
+    {
+    public:
+        Iterator(UconfigKey** position);
+
+        UconfigKeyRef operator*() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& iterator) const;
+        bool operator!=(const Iterator& iterator) const;
+
+    protected:
+        UconfigKey** position;
+    };
+
+    UconfigKeyRange(UconfigKey** keys, int count);
+
+    Iterator begin() const;
+    Iterator end() const;
+    int size() const;
+    UconfigKeyRef operator[](int index) const;
 
-class UconfigEntryObject
+protected:
+    UconfigKey** keys;
+    int count;
+};
+
+class UconfigEntryRange
 {
 public:
-    UconfigEntryObject();
-    UconfigEntryObject(UconfigEntry* entry,
-                       bool copy = true,
-                       bool subentries = false);
-    UconfigEntryObject(const UconfigEntryObject& entry);
-    ~UconfigEntryObject();
+    class Iterator
+    {
+    public:
+        Iterator(UconfigEntry** position);
 
-    UconfigEntryObject& operator=(const UconfigEntryObject& entry);
+        UconfigEntryRef operator*() const;
+        Iterator& operator++();
+        bool operator==(const Iterator& iterator) const;
+        bool operator!=(const Iterator& iterator) const;
 
-    void reset();
+    protected:
+        UconfigEntry** position;
+    };
+
+    UconfigEntryRange(UconfigEntry** entries, int count);
+
+    Iterator begin() const;
+    Iterator end() const;
+    int size() const;
+    UconfigEntryRef operator[](int index) const;
+
+protected:
+    UconfigEntry** entries;
+    int count;
+};
+
+
+class UconfigEntryRef
+{
+public:
+    explicit UconfigEntryRef(UconfigEntry* entry = NULL);
+
+    bool isNull() const;
 
     // Entry name
     const char* name() const;
@@ -74,52 +174,122 @@ public:
     int type() const;
     void setType(int type);
 
+    // Allocator of the entry's nodes
+    UconfigArena* arena() const;
+
+    // Hash index for searching keys and subentries by name
+    bool nameIndexEnabled() const;
+    void setNameIndexEnabled(bool enabled);
+
+    // Storage of the rows (subentries) of a table by column
+    bool columnarEnabled() const;
+    bool setColumnarEnabled(bool enabled);
+    int rowCount() const;
+    int columnCount() const;
+    int searchColumn(const char* columnName, int nameSize = 0) const;
+    int columnType(int index) const;
+    const long long* integerColumn(int index) const;
+    const double* doubleColumn(int index) const;
+    const bool* boolColumn(int index) const;
+    int exceptionCount(int index) const;
+    const int* exceptionRows(int index) const;
+    bool readRow(int index, UconfigEntryObject& row) const;
+    bool beginRow(const char* name, int nameSize, int type);
+    bool appendCell(const UconfigKeyRef& key);
+    void endRow();
+
     // Entry's keys
     int keyCount() const;
-    UconfigKeyObject* keys();
+    UconfigKeyRef* keys() const;
+    UconfigKeyRange keyRange() const;
 
     bool existKey(const char* keyName, int nameSize = 0) const;
-    UconfigKeyObject searchKey(const char* keyName, int nameSize = 0);
+    UconfigKeyRef searchKey(const char* keyName, int nameSize = 0) const;
 
-    bool addKey(const UconfigKeyObject* newKey);
+    bool reserveKeys(int count);
+    bool addKey(const UconfigKeyRef* newKey);
+    bool addKey(UconfigKeyObject&& newKey);
+    bool appendKey(UconfigKeyObject* newKey);
     bool deleteKey(const char* keyName, int nameSize = 0);
-    bool modifyKey(const UconfigKeyObject* newKey,
+    bool modifyKey(const UconfigKeyRef* newKey,
                    const char* keyName,
                    int nameSize = 0);
 
     // Subentries
     int subentryCount() const;
-    UconfigEntryObject* subentries();
+    UconfigEntryRef* subentries() const;
+    UconfigEntryRange childRange() const;
 
     bool existSubentry(const char* entryName, int nameSize = 0) const;
-    UconfigEntryObject searchSubentry(const char* entryName = NULL,
-                                      const char* parentName = NULL,
-                                      bool recursive = false,
-                                      int entryNameSize = 0,
-                                      int parentNameSize = 0);
+    UconfigEntryRef searchSubentry(const char* entryName = NULL,
+                                   const char* parentName = NULL,
+                                   bool recursive = false,
+                                   int entryNameSize = 0,
+                                   int parentNameSize = 0) const;
 
-    bool addSubentry(const UconfigEntryObject *newEntry);
+    bool reserveSubentries(int count);
+    bool addSubentry(const UconfigEntryRef* newEntry);
+    bool addSubentry(UconfigEntryObject&& newEntry);
     bool appendSubentry(UconfigEntryObject* newEntry);
     bool deleteSubentry(const char* entryName, int nameSize = 0);
-    bool modifySubentry(const UconfigEntryObject* newEntry,
+    bool modifySubentry(const UconfigEntryRef* newEntry,
                         const char* entryName,
                         int nameSize);
+    bool replaceSubentries(int index,
+                           int count,
+                           UconfigEntryObject& source);
 
     // Entry's parent
-    UconfigEntryObject parentEntry();
+    UconfigEntryRef parentEntry() const;
+
+protected:
+    UconfigEntry* refData;
+
+    friend class UconfigEntryObject;
+    friend class UconfigIO;
+};
+
+class UconfigEntryObject : public UconfigEntryRef
+{
+public:
+    UconfigEntryObject();
+    UconfigEntryObject(UconfigEntry* entry,
+                       bool copy = true,
+                       bool subentries = false);
+    UconfigEntryObject(const UconfigEntryRef& entry);
+    UconfigEntryObject(const UconfigEntryObject& entry);
+    UconfigEntryObject(UconfigEntryObject&& entry) noexcept;
+    ~UconfigEntryObject();
+
+    UconfigEntryObject& operator=(const UconfigEntryRef& entry);
+    UconfigEntryObject& operator=(const UconfigEntryObject& entry);
+    UconfigEntryObject& operator=(UconfigEntryObject&& entry) noexcept;
+
+    void reset();
+
+    // Allocator of the entry's nodes
+    bool setArena(UconfigArena* arena, bool owning = false);
 
     // Helper functions
     static bool copyEntry(UconfigEntry* dest,
                            const UconfigEntry* src,
-                           bool recursive = false);
+                           bool recursive = false,
+                           UconfigArena* arena = NULL);
     static void deleteEntry(UconfigEntry* entry);
 
 protected:
     UconfigEntry* propData;
-    UconfigEntry* refData;
+    UconfigArena* ownArena;
+
+    static bool copyOwnEntry(UconfigEntry* dest,
+                             const UconfigEntry* src,
+                             bool recursive = false,
+                             UconfigArena* arena = NULL);
 
     void initialize();
     void setReference(UconfigEntry* reference);
+
+    friend class UconfigEntryRef;
 };
 
 #endif
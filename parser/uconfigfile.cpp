@@ -1,16 +1,64 @@
 #include <string.h>
 #include "uconfigfile.h"
+#include "uconfigarena.h"
 
 
 UconfigFile::UconfigFile()
 {
+    columnarTables = false;
 }
 
 UconfigFile::UconfigFile(const UconfigFile& file) :
     rootEntry(file.rootEntry)
 {
+    columnarTables = file.columnarTables;
 }
 
 UconfigFile::~UconfigFile()
 {
 }
+
+UconfigArena* UconfigFile::arena() const
+{
+    return rootEntry.arena();
+}
+
+// Allocate the entry tree from a dedicated arena, so that parsers build it
+// without per-node heap allocation, and so that it is freed at once.
+// Names repeated across the tree are then stored only once.
+// The current entry tree is dropped when switching the allocator.
+void UconfigFile::setArenaEnabled(bool enabled)
+{
+    if (enabled == (rootEntry.arena() != NULL))
+        return;
+
+    rootEntry.reset();
+    if (enabled)
+        rootEntry.setArena(new UconfigArena, true);
+    else
+        rootEntry.setArena(NULL);
+}
+
+// Called by parsers once the entry tree is loaded:
+// nodes added or edited afterwards are allocated from the heap
+void UconfigFile::freezeArena()
+{
+    UconfigArena* treeArena = rootEntry.arena();
+    if (treeArena)
+        treeArena->freeze();
+}
+
+bool UconfigFile::columnarEnabled() const
+{
+    return columnarTables;
+}
+
+// Let parsers of tables (2D tables and CSV) store the rows by column,
+// with a typed array per column instead of one key per cell.
+// Such rows are still read as subentries, but cannot be changed; see
+// UconfigEntryRef::setColumnarEnabled() to turn them into subentries.
+// Only applies to files read afterwards.
+void UconfigFile::setColumnarEnabled(bool enabled)
+{
+    columnarTables = enabled;
+}
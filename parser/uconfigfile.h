@@ -19,6 +19,18 @@ public:
 
     UconfigEntryObject metadata;
     UconfigEntryObject rootEntry;
+
+    // Allocator of the entry tree
+    UconfigArena* arena() const;
+    void setArenaEnabled(bool enabled);
+    void freezeArena();
+
+    // Storage of the rows of tables by column
+    bool columnarEnabled() const;
+    void setColumnarEnabled(bool enabled);
+
+protected:
+    bool columnarTables;
 };
 
 #endif
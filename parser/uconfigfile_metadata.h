@@ -5,6 +5,7 @@
 #define UCONFIG_METADATA_KEY_FILETYPE   "filetype"
 #define UCONFIG_METADATA_KEY_ROWDELIM   "2d-table/row-delimiter"
 #define UCONFIG_METADATA_KEY_COLDELIM   "2d-table/column-delimiter"
+#define UCONFIG_METADATA_KEY_TYPEEXCEPT "2d-table/type-exceptions"
 
 #define UCONFIG_METADATA_VALUE_RAWFILE  "raw"
 #define UCONFIG_METADATA_VALUE_KEYVAL   "key-value"
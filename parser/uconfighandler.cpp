@@ -0,0 +1,133 @@
+#include <utility>
+#include "uconfighandler.h"
+
+
+UconfigHandler::~UconfigHandler()
+{
+}
+
+UconfigArena* UconfigHandler::arena()
+{
+    return NULL;
+}
+
+void UconfigHandler::onEntryBegin(const char*, int, int)
+{
+}
+
+void UconfigHandler::onKey(UconfigKeyObject&)
+{
+}
+
+void UconfigHandler::onEntryEnd()
+{
+}
+
+
+// Empty the root entry, then fill it with the reported nodes,
+// which are allocated in the same way as the root entry
+UconfigTreeBuilder::UconfigTreeBuilder(UconfigEntryObject& rootEntry)
+{
+    rootEntry.reset();
+    currentEntry = rootEntry;
+    treeArena = rootEntry.arena();
+    level = 0;
+    columnarType = -1;
+    inColumnarRow = false;
+}
+
+// Cells are copied into columns rather than taken over:
+// keys reused by the parser are better kept out of the arena then
+UconfigArena* UconfigTreeBuilder::arena()
+{
+    return columnarType >= 0 ? NULL : treeArena;
+}
+
+void UconfigTreeBuilder::onEntryBegin(const char* name,
+                                      int nameSize,
+                                      int type)
+{
+    if (inColumnarRow)
+        expandColumns();
+    else if (level == 1 && currentEntry.columnarEnabled())
+    {
+        // Rows of a table stored by column
+        if (currentEntry.beginRow(name, nameSize, type))
+        {
+            inColumnarRow = true;
+            level++;
+            return;
+        }
+        currentEntry.setColumnarEnabled(false);
+    }
+
+    UconfigEntryObject subentry;
+    subentry.setArena(treeArena);
+    subentry.setName(name, nameSize);
+    subentry.setType(type);
+
+    // The subentry is moved into the tree, and becomes a reference to it
+    currentEntry.appendSubentry(&subentry);
+    currentEntry = subentry;
+    level++;
+
+    if (level == 1 && type == columnarType)
+        currentEntry.setColumnarEnabled(true);
+}
+
+void UconfigTreeBuilder::onKey(UconfigKeyObject& key)
+{
+    if (inColumnarRow)
+    {
+        if (currentEntry.appendCell(key))
+            return;
+        expandColumns();
+    }
+    currentEntry.addKey(std::move(key));
+}
+
+void UconfigTreeBuilder::onEntryEnd()
+{
+    // Ignore unbalanced events rather than leaving the root entry
+    if (level <= 0)
+        return;
+
+    if (inColumnarRow)
+    {
+        currentEntry.endRow();
+        inColumnarRow = false;
+    }
+    else
+        currentEntry = currentEntry.parentEntry();
+    level--;
+}
+
+// Store the rows of top-level entries of a given type by column,
+// as long as they fit (see UconfigEntryRef::setColumnarEnabled())
+void UconfigTreeBuilder::setColumnarType(int type)
+{
+    columnarType = type;
+}
+
+// Turn the current table back into subentries when a row does not fit
+// in its columns, then go on with that row as a subentry
+void UconfigTreeBuilder::expandColumns()
+{
+    currentEntry.endRow();
+    currentEntry.setColumnarEnabled(false);
+    currentEntry = currentEntry.childRange()[currentEntry.subentryCount() - 1];
+    inColumnarRow = false;
+}
+
+
+UconfigWriter::UconfigWriter(const UconfigSink& sink) :
+    output(sink)
+{
+}
+
+// Pass all the buffered output to the file
+// Return false if any write has failed
+bool UconfigWriter::flush()
+{
+    return output.flush();
+}
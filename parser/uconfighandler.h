@@ -0,0 +1,69 @@
+#ifndef UCONFIGHANDLER_H
+#define UCONFIGHANDLER_H
+
+/*
+ * Receiver of the events emitted by parsers while reading a file.
+ * Entries are reported in document order: onEntryBegin() opens an entry
+ * as a subentry of the currently open one, onKey() appends a key to it,
+ * and onEntryEnd() closes it. The root entry itself is never reported.
+ * A handler may take the key passed to onKey() over (e.g. by moving
+ * it to an entry): parsers reset it after the call anyway.
+ * Building an entry tree is only one of such handlers, so that filters
+ * or converters can process a file without holding it in memory.
+ */
+
+#include "uconfigentryobject.h"
+#include "uconfigoutputbuffer.h"
+
+
+class UconfigHandler
+{
+public:
+    virtual ~UconfigHandler();
+
+    // Allocator that parsers should use for the keys they pass
+    virtual UconfigArena* arena();
+
+    virtual void onEntryBegin(const char* name, int nameSize, int type);
+    virtual void onKey(UconfigKeyObject& key);
+    virtual void onEntryEnd();
+};
+
+class UconfigTreeBuilder : public UconfigHandler
+{
+public:
+    UconfigTreeBuilder(UconfigEntryObject& rootEntry);
+
+    UconfigArena* arena();
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+    void setColumnarType(int type);
+
+protected:
+    UconfigEntryRef currentEntry;
+    UconfigArena* treeArena;
+    int level;
+    int columnarType;
+    bool inColumnarRow;
+
+    void expandColumns();
+};
+
+// Base of the handlers writing the reported nodes to a file in some format
+// Output is buffered: flush() must be called before closing the file,
+// or before reading the block of memory written.
+class UconfigWriter : public UconfigHandler
+{
+public:
+    UconfigWriter(const UconfigSink& sink);
+
+    virtual bool flush();
+
+protected:
+    UconfigOutputBuffer output;
+};
+
+#endif // UCONFIGHANDLER_H
@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <utility>
 #include "uconfigini.h"
 #include "uconfigini_p.h"
 #include "uconfigfile_metadata.h"
+#include "uconfiglineindex.h"
+#include "uconfiglinereader.h"
 #include "utils.h"
 
 #define UCONFIG_IO_INI_DELIMITER_LINE      "\n"
@@ -17,163 +20,315 @@ bool UconfigINI::readUconfig(const char* filename, UconfigFile* config)
     if (!config)
         return false;
 
-    FILE* inputFile = fopen(filename, "rb");
-    if (!inputFile)
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
         return false;
 
-    config->rootEntry.reset();
+    UconfigINIPrivate::readBuffer(data, length, config, filename);
 
-    UconfigEntryObject tempEntry, tempSubentry;
-    UconfigKeyObject tempKey, tempComment;
-    tempEntry.setType(UconfigINI::UnknownEntry);
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
 
-    // Read INI file and parse its content line by line
-    char* buffer;
-    char* entryName;
-    UconfigKeyObject* keyList;
-    long unsigned int readlen, parsedLen;
-    while(!feof(inputFile))
+// Read LENGTH bytes of DATA in place, e.g. a block received from
+// another process
+bool UconfigINI::readUconfig(const char* data,
+                             size_t length,
+                             UconfigFile* config)
+{
+    if (!data || !config)
+        return false;
+
+    UconfigINIPrivate::readBuffer(data, length, config, NULL);
+    return true;
+}
+
+// Report the content of a file to HANDLER instead of building a tree
+// Each section is reported as an entry, with one subentry per line
+bool UconfigINI::parseUconfig(const char* filename, UconfigHandler* handler)
+{
+    if (!handler)
+        return false;
+
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
+
+    UconfigINIPrivate::parseBuffer(data, length, handler);
+
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
+
+bool UconfigINI::parseUconfig(const char* data,
+                              size_t length,
+                              UconfigHandler* handler)
+{
+    if (!data || !handler)
+        return false;
+
+    UconfigINIPrivate::parseBuffer(data, length, handler);
+    return true;
+}
+
+// Update the tree of a file read before with INDEX, parsing again only
+// the sections changed since then (see UconfigLineIndex)
+bool UconfigINI::updateUconfig(const char* filename,
+                               UconfigFile* config,
+                               UconfigLineIndex* index)
+{
+    if (!config || !index)
+        return false;
+
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
+
+    UconfigINIPrivate::updateBuffer(data, length, config, filename, index);
+
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
+
+bool UconfigINI::updateUconfig(const char* data,
+                               size_t length,
+                               UconfigFile* config,
+                               UconfigLineIndex* index)
+{
+    if (!data || !config || !index)
+        return false;
+
+    UconfigINIPrivate::updateBuffer(data, length, config, NULL, index);
+    return true;
+}
+
+bool UconfigINI::writeUconfig(const char* filename, UconfigFile* config)
+{
+    if (!config)
+        return false;
+
+    FILE* outputFile = fopen(filename, "w");
+    if (!outputFile)
+        return false;
+
+    UconfigINIWriter writer(outputFile);
+    walkEntry(config->rootEntry, &writer);
+
+    bool success = writer.flush();
+    fclose(outputFile);
+    return success;
+}
+
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigINI::writeUconfig(char** data,
+                              size_t* length,
+                              UconfigFile* config)
+{
+    if (!data || !length || !config)
+        return false;
+
+    UconfigSink sink(data, length);
+    UconfigINIWriter writer(sink);
+    walkEntry(config->rootEntry, &writer);
+    return writer.flush();
+}
+
+// Build the tree of a block of text in CONFIG, then add its meta-data
+// FILENAME is the file that the block is read from, if any
+void UconfigINIPrivate::readBuffer(const char* data,
+                                   size_t length,
+                                   UconfigFile* config,
+                                   const char* filename)
+{
+    UconfigTreeBuilder builder(config->rootEntry);
+    parseBuffer(data, length, &builder);
+
+    // Add meta-data
+    UconfigKeyObject tempKey;
+    if (filename)
+    {
+        tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+        tempKey.setType(UconfigIO::Chars);
+        tempKey.setValue(filename, strlen(filename) + 1);
+        config->metadata.addKey(std::move(tempKey));
+    }
+    tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
+    tempKey.setType(UconfigIO::Chars);
+    tempKey.setValue(UCONFIG_METADATA_VALUE_INIFILE,
+                     strlen(UCONFIG_METADATA_VALUE_INIFILE) + 1);
+    config->metadata.addKey(std::move(tempKey));
+
+    // Nodes edited from now on are no longer allocated from the arena
+    config->freezeArena();
+}
+
+// Replace the sections of the tree that changed in the new block of text,
+// or build the whole tree again if they cannot be found
+void UconfigINIPrivate::updateBuffer(const char* data,
+                                     size_t length,
+                                     UconfigFile* config,
+                                     const char* filename,
+                                     UconfigLineIndex* index)
+{
+    UconfigLineChange change;
+    std::vector<size_t> offsets;
+    if (index->format() == UconfigConverter::INIFormat &&
+        index->entryCount() == config->rootEntry.subentryCount() &&
+        index->findChange(data, length, true, &change))
     {
-        readlen = 0;
-        buffer = NULL;
-        readlen = getline(&buffer, &readlen, inputFile);
+        const char* range = &data[change.begin];
+        size_t rangeLength = change.end - change.begin;
+        UconfigEntryObject entries;
+        entries.setArena(config->rootEntry.arena());
+        UconfigTreeBuilder builder(entries);
+        parseBuffer(range, rangeLength, &builder);
+        scanEntries(range, rangeLength, offsets);
+        if (index->apply(data, length, change,
+                         config->rootEntry, entries, offsets))
+            return;
+        offsets.clear();
+    }
+
+    // Read the whole content again
+    config->metadata.reset();
+    readBuffer(data, length, config, filename);
+    scanEntries(data, length, offsets);
+    index->assign(data, length, UconfigConverter::INIFormat, offsets);
+}
 
-        // Omit empty (incomplete) lines
-        if (readlen <= 2)
+// Find where each section reported by parseBuffer() begins,
+// including the block of lines preceding the first one
+void UconfigINIPrivate::scanEntries(const char* data,
+                                    size_t length,
+                                    std::vector<size_t>& offsets)
+{
+    UconfigLineReader reader(data, length);
+    bool inEntry = false;
+    const char* buffer;
+    int readlen;
+    while (reader.next(&buffer, &readlen))
+    {
+        if (readlen < 2)
             continue;
+        if ((buffer[0] == '[' && buffer[readlen - 1] == ']') || !inEntry)
+        {
+            offsets.push_back(buffer - data);
+            inEntry = true;
+        }
+    }
+}
 
-        // Get the length of line without line delimiter
-        readlen = Uconfig_findLineDelimiter(buffer);
+// Report the sections of a block of text to HANDLER
+void UconfigINIPrivate::parseBuffer(const char* data,
+                                    size_t length,
+                                    UconfigHandler* handler)
+{
+    UconfigKeyObject tempKey, tempComment;
+    tempKey.setArena(handler->arena());
+    tempComment.setArena(handler->arena());
+    int entryType = UconfigINI::UnknownEntry;
+
+    // Parse the content line by line, in place
+    UconfigLineReader reader(data, length);
+    int lineType;
+    bool hasKey;
+    const char* buffer;
+    char* entryName;
+    int readlen, parsedLen;
+    while (reader.next(&buffer, &readlen))
+    {
+        // Omit empty lines, and lines of a single char
+        if (readlen < 2)
+            continue;
 
         // See if the line opens a new entry
         if (buffer[0] == '[' && buffer[readlen - 1] == ']')
         {
-            if (tempEntry.type() != UconfigINI::UnknownEntry)
+            if (entryType != UconfigINI::UnknownEntry)
             {
-                // Save previous entry
-                config->rootEntry.addSubentry(&tempEntry);
+                // Close previous entry
+                handler->onEntryEnd();
             }
 
-            // Create a new entry
-            tempEntry.reset();
-            tempEntry.setType(UconfigINI::NormalEntry);
-
-            // Set entry's name
+            // Open a new entry with its name
+            entryType = UconfigINI::NormalEntry;
             entryName = new char[readlen - 1];
             Uconfig_strncpy(entryName, &buffer[1], readlen - 2);
-            tempEntry.setName(entryName);
-            delete entryName;
+            handler->onEntryBegin(entryName,
+                                  strlen(entryName) + 1,
+                                  entryType);
+            delete[] entryName;
 
             // See if the title line contains a comment
-            if (UconfigINIPrivate::parseLineComment(buffer, tempKey, readlen))
+            if (parseLineComment(buffer, tempKey, readlen))
             {
-                tempSubentry.setType(UconfigINI::Comment);
-                tempSubentry.addKey(&tempKey);
+                handler->onEntryBegin(NULL, 0, UconfigINI::Comment);
+                handler->onKey(tempKey);
+                handler->onEntryEnd();
+                tempKey.reset();
             }
+            continue;
         }
-        else
-        {
-            // See if the line contains a comment
-            parsedLen = UconfigINIPrivate::parseLineComment(buffer,
-                                                            tempComment,
-                                                            readlen);
-
-            // See if the line contains an expression like KEY=VALUE
-            if (UconfigINIPrivate::parseExpKeyValue(buffer,
-                                                    tempKey,
-                                                    readlen - parsedLen))
-            {
-                tempSubentry.setType(UconfigINI::KeyVal);
-                tempSubentry.addKey(&tempKey);
 
-            }
+        // See if the line contains a comment
+        parsedLen = parseLineComment(buffer, tempComment, readlen);
 
-            if (parsedLen > 0)
-            {
-                tempSubentry.addKey(&tempComment);
-                if (tempSubentry.keyCount() < 2)
-                {
-                    // Standalone comment line
-                    tempSubentry.setType(UconfigINI::Comment);
-                }
-            }
-
-            if (tempSubentry.keyCount() < 1)
-            {
-                // See the whole line as RAW content
-                tempKey.reset();
-                tempKey.setValue(buffer, readlen);
-                tempKey.setType(ValueType::Raw);
-                tempSubentry.addKey(&tempKey);
-                tempSubentry.setType(UconfigINI::Raw);
-            }
+        // See if the line contains an expression like KEY=VALUE
+        hasKey = readlen > parsedLen &&
+                 parseExpKeyValue(buffer, tempKey, readlen - parsedLen);
+        if (hasKey)
+            lineType = UconfigINI::KeyVal;
+        else if (parsedLen > 0)
+        {
+            // Standalone comment line
+            lineType = UconfigINI::Comment;
+        }
+        else
+        {
+            // See the whole line as RAW content
+            tempKey.reset();
+            tempKey.setValue(buffer, readlen);
+            tempKey.setType(UconfigIO::Raw);
+            lineType = UconfigINI::Raw;
         }
 
-        if (tempSubentry.keyCount() > 0)
+        if (entryType == UconfigINI::UnknownEntry)
         {
-            if (tempEntry.type() == UconfigINI::NormalEntry)
-            {
-                // Normal entry, use the name of the first key as its name
-                keyList = tempSubentry.keys();
-                tempSubentry.setName(keyList[0].name());
-                tempEntry.addSubentry(&tempSubentry);
-                delete[] keyList;
-            }
-            else
-            {
-                // Standalone comment entry or raw content block
-                // (at the beginning of the file)
-                tempEntry.addSubentry(&tempSubentry);
-                tempEntry.setType(UconfigINI::CommentEntry);
-            }
-            tempSubentry.reset();
+            // Standalone comment entry or raw content block
+            // (at the beginning of the file)
+            entryType = UconfigINI::CommentEntry;
+            handler->onEntryBegin(NULL, 0, entryType);
         }
 
-        if (buffer)
-            free(buffer);
+        // In a normal entry, use the name of the first key
+        // as the name of the line
+        if (entryType == UconfigINI::NormalEntry && hasKey)
+            handler->onEntryBegin(tempKey.name(),
+                                  tempKey.nameSize(),
+                                  lineType);
+        else
+            handler->onEntryBegin(NULL, 0, lineType);
+        if (lineType != UconfigINI::Comment)
+            handler->onKey(tempKey);
+        if (parsedLen > 0)
+            handler->onKey(tempComment);
+        handler->onEntryEnd();
+        tempKey.reset();
+        tempComment.reset();
     }
 
-    if (tempEntry.type() != UconfigINI::UnknownEntry)
+    if (entryType != UconfigINI::UnknownEntry)
     {
-        // Save the last entry
-        config->rootEntry.addSubentry(&tempEntry);
+        // Close the last entry
+        handler->onEntryEnd();
     }
-
-    // Add meta-data
-    tempKey.reset();
-    tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
-    tempKey.setType(ValueType::Chars);
-    tempKey.setValue(filename, strlen(filename) + 1);
-    config->metadata.addKey(&tempKey);
-    tempKey.reset();
-    tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
-    tempKey.setType(ValueType::Chars);
-    tempKey.setValue(UCONFIG_METADATA_VALUE_INIFILE,
-                     strlen(UCONFIG_METADATA_VALUE_INIFILE) + 1);
-    config->metadata.addKey(&tempKey);
-
-    fclose(inputFile);
-    return true;
-}
-
-bool UconfigINI::writeUconfig(const char* filename, UconfigFile* config)
-{
-    if (!config)
-        return false;
-
-    FILE* outputFile = fopen(filename, "w");
-    if (!outputFile)
-        return false;
-
-    const char* lineDelimiter = UCONFIG_IO_INI_DELIMITER_LINE;
-    const char* commentDelimiter = UCONFIG_IO_INI_DELIMITER_COMMENT;
-    bool success = UconfigINIPrivate::fwriteEntry(outputFile,
-                                                  config->rootEntry,
-                                                  lineDelimiter,
-                                                  commentDelimiter);
-    fclose(outputFile);
-
-    return success;
 }
 
 int UconfigINIPrivate::parseLineComment(const char* expression,
@@ -216,47 +371,42 @@ int UconfigINIPrivate::parseLineComment(const char* expression,
     return 0;
 }
 
-bool UconfigINIPrivate::fwriteEntry(FILE* file,
-                                    UconfigEntryObject& entry,
-                                    const char* lineDelimiter,
-                                    const char* keyValueDelimiter,
-                                    const char* commentDelimiter)
+
+UconfigINIWriter::UconfigINIWriter(const UconfigSink& sink) :
+    UconfigKeyValueWriter(sink,
+                          UCONFIG_IO_INI_DELIMITER_LINE,
+                          UCONFIG_IO_INI_DELIMITER_KEYVAL,
+                          UCONFIG_IO_INI_DELIMITER_COMMENT2)
 {
-    bool success;
-    UconfigEntryObject* entryList = entry.subentries();
-    int lDLength = strlen(lineDelimiter);
-    keyValueDelimiter = UCONFIG_IO_INI_DELIMITER_KEYVAL;
+    lineLevel = 2;
+    sectionType = UconfigINI::UnknownEntry;
+}
 
-    for (int i=0; i<entry.subentryCount(); i++)
+void UconfigINIWriter::onEntryBegin(const char* name, int nameSize, int type)
+{
+    if (level == 0)
     {
-        if (entryList[i].type() == UconfigINI::NormalEntry)
+        sectionType = type;
+        if (type == UconfigINI::NormalEntry)
         {
             // Write entry header
-            fwrite("[", sizeof(char), 1, file);
-            fwrite(entryList[i].name(),
-                   sizeof(char),
-                   strlen(entryList[i].name()),
-                   file);
-            fwrite("]", sizeof(char), 1, file);
-            fwrite(lineDelimiter, sizeof(char), lDLength, file);
+            output.put('[');
+            output.write(name, Uconfig_nameLength(name, nameSize));
+            output.put(']');
+            output.write(lineDelimiter);
         }
+    }
 
-        success = UconfigKeyValuePrivate::fwriteEntry(file,
-                                                      entryList[i],
-                                                      lineDelimiter,
-                                                      keyValueDelimiter,
-                                                      commentDelimiter);
-        if (!success)
-            break;
+    UconfigKeyValueWriter::onEntryBegin(name, nameSize, type);
+}
 
-        if (entryList[i].type() == UconfigINI::NormalEntry)
-        {
-            // An extra line-break for the INI entry
-            fwrite(lineDelimiter, sizeof(char), lDLength, file);
-        }
+void UconfigINIWriter::onEntryEnd()
+{
+    if (level == 1 && sectionType == UconfigINI::NormalEntry)
+    {
+        // An extra line-break for the INI entry
+        output.write(lineDelimiter);
     }
 
-    if (entryList)
-        delete[] entryList;
-    return success;
+    UconfigKeyValueWriter::onEntryEnd();
 }
@@ -16,8 +16,42 @@ public:
 
     static bool readUconfig(const char* filename,
                             UconfigFile* config);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config);
     static bool writeUconfig(const char* filename,
                              UconfigFile* config);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler);
+
+    static bool updateUconfig(const char* filename,
+                              UconfigFile* config,
+                              UconfigLineIndex* index);
+    static bool updateUconfig(const char* data,
+                              size_t length,
+                              UconfigFile* config,
+                              UconfigLineIndex* index);
+};
+
+// Write the reported sections, then their lines to a file
+// as soon as they arrive
+class UconfigINIWriter : public UconfigKeyValueWriter
+{
+public:
+    UconfigINIWriter(const UconfigSink& sink);
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onEntryEnd();
+
+protected:
+    int sectionType;
 };
 
 #endif // UCONFIGINI_H
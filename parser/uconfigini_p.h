@@ -7,16 +7,25 @@
 class UconfigINIPrivate : public UconfigKeyValuePrivate
 {
 public:
+    static void readBuffer(const char* data,
+                           size_t length,
+                           UconfigFile* config,
+                           const char* filename);
+    static void parseBuffer(const char* data,
+                            size_t length,
+                            UconfigHandler* handler);
+    static void updateBuffer(const char* data,
+                             size_t length,
+                             UconfigFile* config,
+                             const char* filename,
+                             UconfigLineIndex* index);
+    static void scanEntries(const char* data,
+                            size_t length,
+                            std::vector<size_t>& offsets);
     static int parseLineComment(const char* expression,
                                 UconfigKeyObject& key,
                                 int expressionLength = 0,
                                 const char* delimiter = NULL);
-
-    static bool fwriteEntry(FILE* file,
-                            UconfigEntryObject& entry,
-                            const char* lineDelimiter = NULL,
-                            const char* keyValueDelimiter = NULL,
-                            const char* commentDelimiter = NULL);
 };
 
 #endif // UCONFIGINI_P_H
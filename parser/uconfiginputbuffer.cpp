@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "uconfiginputbuffer.h"
+
+#define UCONFIG_INPUT_BUFFER_SIZE   65536
+
+
+UconfigInputBuffer::UconfigInputBuffer(FILE* file)
+{
+    this->file = file;
+    capacity = UCONFIG_INPUT_BUFFER_SIZE;
+    buffer = (char*)(malloc(capacity));
+    begin = 0;
+    end = 0;
+    offset = 0;
+    eof = !buffer;
+    delimited = true;
+}
+
+// Read LENGTH bytes of DATA, which must remain valid (and unchanged)
+// as long as the input is read
+UconfigInputBuffer::UconfigInputBuffer(const char* data, size_t length)
+{
+    file = NULL;
+    buffer = const_cast<char*>(data);
+    capacity = length;
+    begin = 0;
+    end = data ? length : 0;
+    offset = 0;
+    eof = true;
+    delimited = true;
+}
+
+UconfigInputBuffer::~UconfigInputBuffer()
+{
+    if (file)
+        free(buffer);
+}
+
+// Read one byte; return -1 at the end of stream
+int UconfigInputBuffer::get()
+{
+    if (begin >= end && !fill(1))
+        return -1;
+    return (unsigned char)(buffer[begin++]);
+}
+
+// Same as get(), without consuming the byte
+int UconfigInputBuffer::peek()
+{
+    if (begin >= end && !fill(1))
+        return -1;
+    return (unsigned char)(buffer[begin]);
+}
+
+// See if the next LENGTH bytes are the same as STRING,
+// without consuming them
+bool UconfigInputBuffer::peekCmp(const char* string, size_t length)
+{
+    if (!fill(length))
+        return false;
+    return memcmp(&buffer[begin], string, length) == 0;
+}
+
+void UconfigInputBuffer::skip(size_t length)
+{
+    while (length > 0)
+    {
+        if (begin >= end && !fill(1))
+            return;
+
+        size_t available = end - begin;
+        if (available > length)
+            available = length;
+        begin += available;
+        length -= available;
+    }
+}
+
+// Append the bytes up to DELIMITER to CONTENT, and consume them
+// The delimiter itself is also consumed if SKIPDELIMITER is true
+// Return false if the delimiter is not found before the end of stream
+bool UconfigInputBuffer::readUntil(const char* delimiter,
+                                   size_t delimiterLength,
+                                   std::vector<char>& content,
+                                   bool skipDelimiter)
+{
+    while (true)
+    {
+        if (begin >= end && !fill(1))
+            return false;
+
+        // Search for the first char of the delimiter in the window
+        const char* window = &buffer[begin];
+        const char* pos = static_cast<const char*>(
+                            memchr(window, delimiter[0], end - begin));
+        if (!pos)
+        {
+            content.insert(content.end(), window, window + (end - begin));
+            begin = end;
+            continue;
+        }
+        content.insert(content.end(), window, pos);
+        begin += pos - window;
+
+        // Then check the rest of the delimiter
+        if (peekCmp(delimiter, delimiterLength))
+        {
+            if (skipDelimiter)
+                begin += delimiterLength;
+            return true;
+        }
+        content.push_back(buffer[begin++]);
+    }
+}
+
+// Find the next record ending with DELIMITER (or with the stream),
+// and consume it along with the delimiter
+// *RECORD points to the record in the buffer, which remains valid
+// until the next read; the buffer grows to hold records of any length.
+// Return false if there is no record left: a stream ending with
+// a delimiter ends with an empty record.
+bool UconfigInputBuffer::readRecord(const char* delimiter,
+                                    size_t delimiterLength,
+                                    const char** record,
+                                    size_t* recordLength)
+{
+    // Bytes of the window that cannot begin a delimiter
+    size_t searched = 0;
+    while (true)
+    {
+        const char* window = &buffer[begin];
+        size_t windowLength = end - begin;
+        while (delimiterLength > 0 &&
+               searched + delimiterLength <= windowLength)
+        {
+            // Search for the first char of the delimiter,
+            // then check the rest of it
+            const char* pos = static_cast<const char*>(
+                        memchr(&window[searched], delimiter[0],
+                               windowLength - delimiterLength + 1 - searched));
+            if (!pos)
+            {
+                searched = windowLength - delimiterLength + 1;
+                break;
+            }
+            if (memcmp(pos, delimiter, delimiterLength) == 0)
+            {
+                *record = window;
+                *recordLength = pos - window;
+                begin += *recordLength + delimiterLength;
+                delimited = true;
+                return true;
+            }
+            searched = pos - window + 1;
+        }
+
+        if (!fill(windowLength + 1))
+            break;
+    }
+
+    // Last record of the stream
+    if (begin >= end && !delimited)
+        return false;
+    *record = &buffer[begin];
+    *recordLength = end - begin;
+    begin = end;
+    delimited = false;
+    return true;
+}
+
+// Number of bytes consumed since the beginning of stream
+size_t UconfigInputBuffer::position() const
+{
+    return offset + begin;
+}
+
+// Make sure that at least LENGTH unread bytes are in the buffer
+// Return false if the stream ends before
+bool UconfigInputBuffer::fill(size_t length)
+{
+    if (end - begin >= length)
+        return true;
+    if (eof)
+        return false;
+
+    // Move the unread bytes to the beginning of the buffer
+    if (begin > 0)
+    {
+        memmove(buffer, &buffer[begin], end - begin);
+        end -= begin;
+        offset += begin;
+        begin = 0;
+    }
+
+    if (length > capacity)
+    {
+        // Grow by steps, as long records are filled byte by byte
+        size_t newCapacity = capacity * 2;
+        if (newCapacity < length)
+            newCapacity = length;
+        char* newBuffer = (char*)(realloc(buffer, newCapacity));
+        if (!newBuffer)
+            return false;
+        buffer = newBuffer;
+        capacity = newCapacity;
+    }
+
+    while (end < length)
+    {
+        size_t readLength = fread(&buffer[end], 1, capacity - end, file);
+        if (readLength == 0)
+        {
+            eof = true;
+            return false;
+        }
+        end += readLength;
+    }
+    return true;
+}
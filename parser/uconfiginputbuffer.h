@@ -0,0 +1,55 @@
+#ifndef UCONFIGINPUTBUFFER_H
+#define UCONFIGINPUTBUFFER_H
+
+/*
+ * Forward-only reader of a stream, with an internal lookahead window.
+ * Bytes are read from the stream in large blocks and never put back,
+ * so that pipes, FIFOs and the standard input can be parsed as well
+ * as regular files. Records (e.g. rows of a table) can be read
+ * in place, without being copied out of the buffer.
+ * A block of memory can be read as well, in which case it serves
+ * as the buffer itself and is neither copied nor modified.
+ */
+
+#include <stddef.h>
+#include <vector>
+
+
+typedef struct _IO_FILE FILE;
+
+class UconfigInputBuffer
+{
+public:
+    UconfigInputBuffer(FILE* file);
+    UconfigInputBuffer(const char* data, size_t length);
+    ~UconfigInputBuffer();
+
+    int get();
+    int peek();
+    bool peekCmp(const char* string, size_t length);
+    void skip(size_t length);
+    bool readUntil(const char* delimiter,
+                   size_t delimiterLength,
+                   std::vector<char>& content,
+                   bool skipDelimiter = true);
+    bool readRecord(const char* delimiter,
+                    size_t delimiterLength,
+                    const char** record,
+                    size_t* recordLength);
+
+    size_t position() const;
+
+protected:
+    FILE* file;    // NULL if reading from memory
+    char* buffer;
+    size_t capacity;
+    size_t begin;  // Position of the first unread byte in the buffer
+    size_t end;    // Position following the last byte read from the file
+    size_t offset; // Position of the buffer's beginning in the stream
+    bool eof;
+    bool delimited; // The last record read ended with a delimiter
+
+    bool fill(size_t length);
+};
+
+#endif // UCONFIGINPUTBUFFER_H
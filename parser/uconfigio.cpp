@@ -1,19 +1,155 @@
+#include <stdint.h>
 #include <string.h>
-#ifdef WIN32
-#include <shlwapi.h>
-#endif
 #include "uconfigio.h"
+#include "uconfigcolumns.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UCONFIG_IO_X86
+#include <immintrin.h>
+#endif
 
 #define UCONFIG_IO_EXPRESSION_CHAR_STRING   '"'
 #define UCONFIG_IO_EXPRESSION_CHAR_STRING2  '\''
 #define UCONFIG_IO_EXPRESSION_CHAR_DOUBLE   '.'
-#define UCONFIG_IO_EXPRESSION_CHAR_SIGN     '.'
-#define UCONFIG_IO_EXPRESSION_CHAR_SIGN2    '.'
+#define UCONFIG_IO_EXPRESSION_CHAR_SIGN     '+'
+#define UCONFIG_IO_EXPRESSION_CHAR_SIGN2    '-'
+#define UCONFIG_IO_EXPRESSION_CHAR_EXP      'e'
+#define UCONFIG_IO_EXPRESSION_CHAR_EXP2     'E'
 #define UCONFIG_IO_EXPRESSION_BOOL_TRUE     "true"
 #define UCONFIG_IO_EXPRESSION_BOOL_FALSE    "false"
 #define UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN  '0'
 #define UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX  '9'
 
+// Bit that turns an upper case letter into a lower case one
+#define UCONFIG_IO_EXPRESSION_CASE_BIT      0x20
+
+// Classes of chars seen in numbers
+#define UCONFIG_IO_CLASS_OTHER              0
+#define UCONFIG_IO_CLASS_DIGIT              1
+#define UCONFIG_IO_CLASS_SIGN               2
+#define UCONFIG_IO_CLASS_POINT              3
+#define UCONFIG_IO_CLASS_EXPONENT           4
+
+// Longest values whose chars are classified at once, and number of
+// such values classified in a pass
+#define UCONFIG_IO_BLOCK_SIZE               16
+#define UCONFIG_IO_BATCH_SIZE               32
+
+
+// Chars of a value of up to a block, by class (one bit per char)
+struct UconfigIOCharMasks
+{
+    uint16_t digits;
+    uint16_t signs;
+    uint16_t points;
+    uint16_t exponents;
+};
+
+typedef void (*UconfigIOMaskFunction)(
+                            const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                            int count,
+                            UconfigIOCharMasks* masks);
+
+static int currentKernel = -1;
+
+
+static constexpr unsigned char Uconfig_charClass(int c)
+{
+    return c >= UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN &&
+           c <= UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX ? UCONFIG_IO_CLASS_DIGIT :
+           c == UCONFIG_IO_EXPRESSION_CHAR_SIGN ||
+           c == UCONFIG_IO_EXPRESSION_CHAR_SIGN2 ? UCONFIG_IO_CLASS_SIGN :
+           c == UCONFIG_IO_EXPRESSION_CHAR_DOUBLE ? UCONFIG_IO_CLASS_POINT :
+           c == UCONFIG_IO_EXPRESSION_CHAR_EXP ||
+           c == UCONFIG_IO_EXPRESSION_CHAR_EXP2 ? UCONFIG_IO_CLASS_EXPONENT :
+           UCONFIG_IO_CLASS_OTHER;
+}
+
+#define UCONFIG_IO_CLASSES_4(c)     Uconfig_charClass(c), \
+                                    Uconfig_charClass(c + 1), \
+                                    Uconfig_charClass(c + 2), \
+                                    Uconfig_charClass(c + 3)
+#define UCONFIG_IO_CLASSES_16(c)    UCONFIG_IO_CLASSES_4(c), \
+                                    UCONFIG_IO_CLASSES_4(c + 4), \
+                                    UCONFIG_IO_CLASSES_4(c + 8), \
+                                    UCONFIG_IO_CLASSES_4(c + 12)
+#define UCONFIG_IO_CLASSES_64(c)    UCONFIG_IO_CLASSES_16(c), \
+                                    UCONFIG_IO_CLASSES_16(c + 16), \
+                                    UCONFIG_IO_CLASSES_16(c + 32), \
+                                    UCONFIG_IO_CLASSES_16(c + 48)
+
+// Class of each char, indexed by its unsigned value
+static constexpr unsigned char Uconfig_charClasses[256] =
+{
+    UCONFIG_IO_CLASSES_64(0),
+    UCONFIG_IO_CLASSES_64(64),
+    UCONFIG_IO_CLASSES_64(128),
+    UCONFIG_IO_CLASSES_64(192)
+};
+
+static bool Uconfig_matchWord(const char* expression, const char* word);
+static int Uconfig_countDigits(const char* expression, int length);
+static bool Uconfig_classifyWord(const char* expression,
+                                 int length,
+                                 UconfigIO::ValueType* type);
+static UconfigIO::ValueType Uconfig_classifyNumber(const char* expression,
+                                                   int length);
+static UconfigIO::ValueType Uconfig_classifyMasks(
+                                            const UconfigIOCharMasks& masks,
+                                            int length);
+static UconfigIOMaskFunction Uconfig_maskFunction();
+static void Uconfig_classifyBlocks(
+                        UconfigIOMaskFunction maskChars,
+                        const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                        int count,
+                        const UconfigIO::ValueSpan* spans,
+                        const int* indexes,
+                        UconfigIO::ValueType* types);
+
+
+// Report the keys, then the subentries of an entry to a handler,
+// in the same way as a parser does (the entry itself is not reported),
+// so that a tree can be exported by the same handlers as a file
+// Rows stored by column are read from the columns rather than built,
+// as subentries of keys referring to the cells: handlers must not
+// modify them.
+void UconfigIO::walkEntry(const UconfigEntryRef& entry,
+                          UconfigHandler* handler)
+{
+    for (UconfigKeyObject key : entry.keyRange())
+        handler->onKey(key);
+
+    const UconfigColumns* columns =
+                    entry.refData ? entry.refData->columns : NULL;
+    if (columns)
+    {
+        UconfigKey cell;
+        int nameSize;
+        const char* name;
+        for (int i=0; i<columns->rowCount; i++)
+        {
+            name = Uconfig_readColumnRowName(columns, i, &nameSize);
+            handler->onEntryBegin(name, nameSize, columns->rowType);
+            for (int j=0; j<columns->cellCounts[i]; j++)
+            {
+                Uconfig_readColumnCell(columns, i, j, &cell);
+                UconfigKeyObject key(&cell, false);
+                handler->onKey(key);
+            }
+            handler->onEntryEnd();
+        }
+        return;
+    }
+
+    for (UconfigEntryRef subentry : entry.childRange())
+    {
+        handler->onEntryBegin(subentry.name(),
+                              subentry.nameSize(),
+                              subentry.type());
+        walkEntry(subentry, handler);
+        handler->onEntryEnd();
+    }
+}
 
 // Try to guess the type of the value present in the expression,
 // making the assumption that is generally valid among configuration files.
@@ -24,85 +160,370 @@ UconfigIO::guessValueType(const char* expression, int length)
     if (length <= 0)
         length = strlen(expression);
 
-    ValueType valueType = ValueType::Raw;
+    ValueType type;
+    if (Uconfig_classifyWord(expression, length, &type))
+        return type;
+    return Uconfig_classifyNumber(expression, length);
+}
+
+// Guess the types of COUNT values at once, e.g. those of a row
+// Values of no char are seen as raw content.
+// Values of up to a block of chars are copied into blocks, whose chars
+// are classified by batches with the kernel selected (see kernel());
+// longer ones are read one by one.
+void UconfigIO::classifyValues(const ValueSpan* spans,
+                               int count,
+                               ValueType* types)
+{
+    char blocks[UCONFIG_IO_BATCH_SIZE][UCONFIG_IO_BLOCK_SIZE];
+    int indexes[UCONFIG_IO_BATCH_SIZE];
+    int blockCount = 0;
+    UconfigIOMaskFunction maskChars = Uconfig_maskFunction();
 
-    if (expression[0] == UCONFIG_IO_EXPRESSION_CHAR_STRING ||
-        expression[0] == UCONFIG_IO_EXPRESSION_CHAR_STRING2 )
+    for (int i=0; i<count; i++)
     {
-        // Possible string value
-        // See if the quote match the other one at the end
-        if (expression[length - 1] == expression[0])
-            valueType = ValueType::Chars;
+        const char* expression = spans[i].value;
+        int length = spans[i].length;
+        if (Uconfig_classifyWord(expression, length, &types[i]))
+            continue;
+        if (length > UCONFIG_IO_BLOCK_SIZE)
+        {
+            types[i] = Uconfig_classifyNumber(expression, length);
+            continue;
+        }
+
+        // Chars beyond the value are of no class
+        memcpy(blocks[blockCount], expression, length);
+        memset(&blocks[blockCount][length], 0,
+               UCONFIG_IO_BLOCK_SIZE - length);
+        indexes[blockCount++] = i;
+        if (blockCount < UCONFIG_IO_BATCH_SIZE)
+            continue;
+
+        Uconfig_classifyBlocks(maskChars, blocks, blockCount,
+                               spans, indexes, types);
+        blockCount = 0;
+    }
+    if (blockCount > 0)
+        Uconfig_classifyBlocks(maskChars, blocks, blockCount,
+                               spans, indexes, types);
+}
+
+UconfigIO::Kernel UconfigIO::kernel()
+{
+    if (currentKernel < 0)
+    {
+        if (isKernelSupported(AVX2Kernel))
+            currentKernel = AVX2Kernel;
+        else if (isKernelSupported(SSE2Kernel))
+            currentKernel = SSE2Kernel;
+        else
+            currentKernel = ScalarKernel;
     }
-#ifdef WIN32
-    else if ((length == strlen(UCONFIG_IO_EXPRESSION_BOOL_TRUE) &&
-              StrStrIA(expression,
-                       UCONFIG_IO_EXPRESSION_BOOL_TRUE) == expression) ||
-             (length == strlen(UCONFIG_IO_EXPRESSION_BOOL_FALSE) &&
-              StrStrIA(expression,
-                       UCONFIG_IO_EXPRESSION_BOOL_FALSE) == expression))
-#else
-    else if ((length == strlen(UCONFIG_IO_EXPRESSION_BOOL_TRUE) &&
-              strcasestr(expression,
-                         UCONFIG_IO_EXPRESSION_BOOL_TRUE) == expression) ||
-             (length == strlen(UCONFIG_IO_EXPRESSION_BOOL_FALSE) &&
-              strcasestr(expression,
-                         UCONFIG_IO_EXPRESSION_BOOL_FALSE) == expression))
+    return Kernel(currentKernel);
+}
+
+bool UconfigIO::setKernel(Kernel kernel)
+{
+    if (!isKernelSupported(kernel))
+        return false;
+
+    currentKernel = kernel;
+    return true;
+}
+
+bool UconfigIO::isKernelSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case ScalarKernel:
+            return true;
+#ifdef UCONFIG_IO_X86
+        case SSE2Kernel:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case AVX2Kernel:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
 #endif
+        default:
+            return false;
+    }
+}
+
+// Compare an expression with a word in lower case, ignoring the case
+// The expression must be as long as the word.
+static bool Uconfig_matchWord(const char* expression, const char* word)
+{
+    for (; *word; expression++, word++)
     {
-        valueType = ValueType::Bool;
+        if ((*expression | UCONFIG_IO_EXPRESSION_CASE_BIT) != *word)
+            return false;
     }
-    else
+    return true;
+}
+
+// Return the number of decimal digits at the beginning of an expression
+static int Uconfig_countDigits(const char* expression, int length)
+{
+    int pos = 0;
+    while (pos < length &&
+           Uconfig_charClasses[(unsigned char)(expression[pos])]
+               == UCONFIG_IO_CLASS_DIGIT)
+        pos++;
+    return pos;
+}
+
+// Find the type of values that are not numbers: strings in quotes,
+// booleans and empty values
+// Return false if the expression may be a number.
+static bool Uconfig_classifyWord(const char* expression,
+                                 int length,
+                                 UconfigIO::ValueType* type)
+{
+    if (length <= 0)
     {
-        // Possible numeric value: check digits one by one
-        bool isNumber = false;
-        bool isDouble = false;
+        *type = UconfigIO::Raw;
+        return true;
+    }
 
-        int pos = 0;
-        while (pos < length)
-        {
-            char tempChar = expression[pos];
-            if (tempChar == UCONFIG_IO_EXPRESSION_CHAR_DOUBLE)
-            {
-                // Possible float/double number
-                isDouble = true;
-            }
-            else if (tempChar >= UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN &&
-                     tempChar <= UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX)
-            {
-                // Possible numeric value
-                isNumber = true;
-            }
-            else if (tempChar == UCONFIG_IO_EXPRESSION_CHAR_SIGN ||
-                     tempChar == UCONFIG_IO_EXPRESSION_CHAR_SIGN2)
-            {
-                // See if there is leading or following digits
-                if (pos != 0 ||
-                    (expression[pos + 1] < UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN &&
-                     expression[pos + 1] > UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX))
-                {
-                    // Invalid format: seen as raw content
-                    break;
-                }
-            }
-            else
-            {
-                // Invalide char: seen as raw content
-                isNumber = false;
-                break;
-            }
+    char firstChar = expression[0];
+    if (firstChar == UCONFIG_IO_EXPRESSION_CHAR_STRING ||
+        firstChar == UCONFIG_IO_EXPRESSION_CHAR_STRING2)
+    {
+        // Possible string value
+        // See if the quote match the other one at the end
+        if (length > 1 && expression[length - 1] == firstChar)
+            *type = UconfigIO::Chars;
+        else
+            *type = UconfigIO::Raw;
+        return true;
+    }
 
+    if ((length == sizeof(UCONFIG_IO_EXPRESSION_BOOL_TRUE) - 1 &&
+         Uconfig_matchWord(expression, UCONFIG_IO_EXPRESSION_BOOL_TRUE)) ||
+        (length == sizeof(UCONFIG_IO_EXPRESSION_BOOL_FALSE) - 1 &&
+         Uconfig_matchWord(expression, UCONFIG_IO_EXPRESSION_BOOL_FALSE)))
+    {
+        *type = UconfigIO::Bool;
+        return true;
+    }
+    return false;
+}
+
+// Read the expression once to find whether it is a number
+static UconfigIO::ValueType Uconfig_classifyNumber(const char* expression,
+                                                   int length)
+{
+    // Possible numeric value: an optional sign, digits with an optional
+    // point, then an optional exponent with its own sign
+    int pos = 0;
+    if (Uconfig_charClasses[(unsigned char)(expression[0])]
+            == UCONFIG_IO_CLASS_SIGN)
+        pos++;
+    int digitCount = Uconfig_countDigits(&expression[pos], length - pos);
+    pos += digitCount;
+
+    bool isDouble = false;
+    if (pos < length && Uconfig_charClasses[(unsigned char)(expression[pos])]
+                            == UCONFIG_IO_CLASS_POINT)
+    {
+        pos++;
+        int fractionCount = Uconfig_countDigits(&expression[pos], length - pos);
+        pos += fractionCount;
+        digitCount += fractionCount;
+        isDouble = true;
+    }
+    if (digitCount == 0)
+        return UconfigIO::Raw;
+
+    if (pos < length && Uconfig_charClasses[(unsigned char)(expression[pos])]
+                            == UCONFIG_IO_CLASS_EXPONENT)
+    {
+        pos++;
+        if (pos < length &&
+            Uconfig_charClasses[(unsigned char)(expression[pos])]
+                == UCONFIG_IO_CLASS_SIGN)
             pos++;
-        }
+        int exponentCount = Uconfig_countDigits(&expression[pos], length - pos);
+        if (exponentCount == 0)
+            return UconfigIO::Raw;
+        pos += exponentCount;
+        isDouble = true;
+    }
 
-        if (isNumber)
-        {
-            if (isDouble)
-                valueType = ValueType::Double;
-            else
-                valueType = ValueType::Integer;
-        }
+    // Any other char makes it raw content
+    if (pos < length)
+        return UconfigIO::Raw;
+    return isDouble ? UconfigIO::Double : UconfigIO::Integer;
+}
+
+// Find the type of a value of up to a block of chars from the classes
+// of its chars, with the same rules as Uconfig_classifyNumber()
+static UconfigIO::ValueType Uconfig_classifyMasks(
+                                            const UconfigIOCharMasks& masks,
+                                            int length)
+{
+    uint32_t valid = (1U << length) - 1;
+    uint32_t digits = masks.digits & valid;
+    uint32_t signs = masks.signs & valid;
+    uint32_t points = masks.points & valid;
+    uint32_t exponents = masks.exponents & valid;
+
+    // Any other char, or a second exponent, makes it raw content
+    if ((digits | signs | points | exponents) != valid ||
+        (exponents & (exponents - 1)) != 0)
+        return UconfigIO::Raw;
+
+    // The part before the exponent: an optional sign, then digits
+    // with an optional point
+    uint32_t mantissa = exponents ? exponents - 1 : valid;
+    if ((signs & mantissa & ~1U) != 0 ||
+        (points & ~mantissa) != 0 ||
+        (points & (points - 1)) != 0 ||
+        (digits & mantissa) == 0)
+        return UconfigIO::Raw;
+    if (!exponents)
+        return points ? UconfigIO::Double : UconfigIO::Integer;
+
+    // The part after the exponent: an optional sign, then digits
+    uint32_t exponent = valid & ~(mantissa | exponents);
+    if ((signs & exponent & ~(exponents << 1)) != 0 ||
+        (digits & exponent) == 0)
+        return UconfigIO::Raw;
+    return UconfigIO::Double;
+}
+
+// Classify the chars of COUNT blocks in a pass, then store the type
+// of each value in TYPES at the index of its span
+static void Uconfig_classifyBlocks(
+                        UconfigIOMaskFunction maskChars,
+                        const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                        int count,
+                        const UconfigIO::ValueSpan* spans,
+                        const int* indexes,
+                        UconfigIO::ValueType* types)
+{
+    UconfigIOCharMasks masks[UCONFIG_IO_BATCH_SIZE];
+    maskChars(blocks, count, masks);
+    for (int i=0; i<count; i++)
+        types[indexes[i]] = Uconfig_classifyMasks(masks[i],
+                                                  spans[indexes[i]].length);
+}
+
+static void Uconfig_maskCharsScalar(const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                                    int count,
+                                    UconfigIOCharMasks* masks)
+{
+    for (int i=0; i<count; i++)
+    {
+        uint16_t classMasks[UCONFIG_IO_CLASS_EXPONENT + 1] = {0};
+        for (int j=0; j<UCONFIG_IO_BLOCK_SIZE; j++)
+            classMasks[Uconfig_charClasses[(unsigned char)(blocks[i][j])]] |=
+                                                        uint16_t(1U << j);
+        masks[i].digits = classMasks[UCONFIG_IO_CLASS_DIGIT];
+        masks[i].signs = classMasks[UCONFIG_IO_CLASS_SIGN];
+        masks[i].points = classMasks[UCONFIG_IO_CLASS_POINT];
+        masks[i].exponents = classMasks[UCONFIG_IO_CLASS_EXPONENT];
     }
+}
+
+#ifdef UCONFIG_IO_X86
+// Digits are the chars whose distance to "0" is at most 9;
+// 'e' and 'E' only differ by bit 0x20
+__attribute__((target("sse2")))
+static inline void Uconfig_maskBlockSSE2(const char* block,
+                                         UconfigIOCharMasks* masks)
+{
+    const __m128i zero = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN);
+    const __m128i nine = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX -
+                                       UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN);
+    const __m128i sign = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_SIGN);
+    const __m128i sign2 = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_SIGN2);
+    const __m128i point = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_DOUBLE);
+    const __m128i exponent = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_EXP);
+    const __m128i caseBit = _mm_set1_epi8(UCONFIG_IO_EXPRESSION_CASE_BIT);
 
-    return valueType;
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    __m128i distance = _mm_sub_epi8(chars, zero);
+    masks->digits = uint16_t(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_max_epu8(distance, nine), nine)));
+    masks->signs = uint16_t(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chars, sign),
+                             _mm_cmpeq_epi8(chars, sign2))));
+    masks->points = uint16_t(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(chars, point)));
+    masks->exponents = uint16_t(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_or_si128(chars, caseBit), exponent)));
+}
+
+__attribute__((target("sse2")))
+static void Uconfig_maskCharsSSE2(const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                                  int count,
+                                  UconfigIOCharMasks* masks)
+{
+    for (int i=0; i<count; i++)
+        Uconfig_maskBlockSSE2(blocks[i], &masks[i]);
+}
+
+// Two blocks are classified at once
+__attribute__((target("avx2")))
+static void Uconfig_maskCharsAVX2(const char (*blocks)[UCONFIG_IO_BLOCK_SIZE],
+                                  int count,
+                                  UconfigIOCharMasks* masks)
+{
+    const __m256i zero = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN);
+    const __m256i nine = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_NUM_MAX -
+                                          UCONFIG_IO_EXPRESSION_CHAR_NUM_MIN);
+    const __m256i sign = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_SIGN);
+    const __m256i sign2 = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_SIGN2);
+    const __m256i point = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_DOUBLE);
+    const __m256i exponent = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CHAR_EXP);
+    const __m256i caseBit = _mm256_set1_epi8(UCONFIG_IO_EXPRESSION_CASE_BIT);
+
+    int i;
+    uint32_t digits, signs, points, exponents;
+    for (i=0; i+1<count; i+=2)
+    {
+        __m256i chars = _mm256_loadu_si256(
+                            reinterpret_cast<const __m256i*>(blocks[i]));
+        __m256i distance = _mm256_sub_epi8(chars, zero);
+        digits = uint32_t(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(_mm256_max_epu8(distance, nine), nine)));
+        signs = uint32_t(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chars, sign),
+                                    _mm256_cmpeq_epi8(chars, sign2))));
+        points = uint32_t(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(chars, point)));
+        exponents = uint32_t(_mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(_mm256_or_si256(chars, caseBit),
+                                      exponent)));
+
+        masks[i].digits = uint16_t(digits);
+        masks[i].signs = uint16_t(signs);
+        masks[i].points = uint16_t(points);
+        masks[i].exponents = uint16_t(exponents);
+        masks[i + 1].digits = uint16_t(digits >> 16);
+        masks[i + 1].signs = uint16_t(signs >> 16);
+        masks[i + 1].points = uint16_t(points >> 16);
+        masks[i + 1].exponents = uint16_t(exponents >> 16);
+    }
+    if (i < count)
+        Uconfig_maskBlockSSE2(blocks[i], &masks[i]);
+}
+#endif // UCONFIG_IO_X86
+
+static UconfigIOMaskFunction Uconfig_maskFunction()
+{
+    switch (UconfigIO::kernel())
+    {
+#ifdef UCONFIG_IO_X86
+        case UconfigIO::AVX2Kernel:
+            return Uconfig_maskCharsAVX2;
+        case UconfigIO::SSE2Kernel:
+            return Uconfig_maskCharsSSE2;
+#endif
+        default:
+            return Uconfig_maskCharsScalar;
+    }
 }
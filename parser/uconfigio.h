@@ -2,6 +2,7 @@
 #define UCONFIGIO_H
 
 #include "uconfigfile.h"
+#include "uconfighandler.h"
 
 
 class UconfigIO
@@ -18,6 +19,21 @@ public:
         List = 128
     };
 
+    // Ways of classifying the chars of values by batches
+    enum Kernel
+    {
+        ScalarKernel = 0,
+        SSE2Kernel = 1,
+        AVX2Kernel = 2
+    };
+
+    // Value of LENGTH chars, not terminated by 0x00
+    struct ValueSpan
+    {
+        const char* value;
+        int length;
+    };
+
     UconfigIO(){}
     ~UconfigIO(){}
 
@@ -25,8 +41,20 @@ public:
                             UconfigFile* config);
     static bool writeUconfig(const char* filename,
                              UconfigFile* config);
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static void walkEntry(const UconfigEntryRef& entry,
+                          UconfigHandler* handler);
 
     static ValueType guessValueType(const char* expression, int length);
+    static void classifyValues(const ValueSpan* spans,
+                               int count,
+                               ValueType* types);
+
+    // Kernel used by classifyValues(); the fastest one supported by default
+    static Kernel kernel();
+    static bool setKernel(Kernel kernel);
+    static bool isKernelSupported(Kernel kernel);
 };
 
 #endif // UCONFIGIO_H
@@ -1,10 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <vector>
+#include <utility>
 #include "uconfigjson.h"
 #include "uconfigjson_p.h"
+#include "uconfigjsonscanner.h"
 #include "uconfigfile_metadata.h"
+#include "uconfignumber.h"
 #include "utils.h"
 
 #define UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN       '{'
@@ -14,6 +16,7 @@
 #define UCONFIG_IO_JSON_CHAR_DEFINITION         ':'
 #define UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT       ','
 #define UCONFIG_IO_JSON_CHAR_STRING             '"'
+#define UCONFIG_IO_JSON_CHAR_ESCAPE             '\\'
 #define UCONFIG_IO_JSON_DELIMITER_NEWLINE       "\n"
 #define UCONFIG_IO_JSON_DELIMITER_DEFINITION    ": "
 
@@ -21,42 +24,84 @@
 #define UCONFIG_IO_JSON_EXPRESSION_BOOL_TRUE    "true"
 
 
+// Only these chars are taken as spaces between JSON tokens
+static inline bool Uconfig_isJSONSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Drop the quotes wrapping a name, if any
+// An empty name is turned into NULL
+static inline void Uconfig_trimJSONName(const char** name, int* length)
+{
+    if (*length > 1 &&
+        (*name)[0] == UCONFIG_IO_JSON_CHAR_STRING &&
+        (*name)[*length - 1] == UCONFIG_IO_JSON_CHAR_STRING)
+    {
+        (*name)++;
+        *length -= 2;
+    }
+    if (*length <= 0)
+        *name = NULL;
+}
+
+
 bool UconfigJSON::readUconfig(const char* filename, UconfigFile* config)
 {
     if (!config)
         return false;
 
-    FILE* inputFile = fopen(filename, "rb");
-    if (!inputFile)
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
         return false;
 
-    bool success = UconfigJSONPrivate::freadEntry(inputFile,
-                                                  config->rootEntry) > 0;
+    bool success = UconfigJSONPrivate::readBuffer(data, length,
+                                                  config, filename);
 
-    if (success)
-    {
-        config->rootEntry.setType(UconfigJSON::ObjectEntry);
+    Uconfig_releaseFile(data, length, mapped);
+    return success;
+}
 
-        // Add meta-data
-        UconfigKeyObject tempKey;
-        /* Basic information */
-        tempKey.reset();
-        tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
-        tempKey.setType(ValueType::Chars);
-        tempKey.setValue(filename, strlen(filename) + 1);
-        config->metadata.addKey(&tempKey);
-        tempKey.reset();
-        tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
-        tempKey.setType(ValueType::Chars);
-        tempKey.setValue(UCONFIG_METADATA_VALUE_JSON,
-                         strlen(UCONFIG_METADATA_VALUE_JSON) + 1);
-        config->metadata.addKey(&tempKey);
-    }
+bool UconfigJSON::readUconfig(const char* data,
+                              size_t length,
+                              UconfigFile* config)
+{
+    if (!data || !config)
+        return false;
+
+    return UconfigJSONPrivate::readBuffer(data, length, config, NULL);
+}
+
+// Report the content of a file to HANDLER instead of building a tree
+bool UconfigJSON::parseUconfig(const char* filename, UconfigHandler* handler)
+{
+    if (!handler)
+        return false;
+
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
+
+    bool success = UconfigJSONPrivate::parseBuffer(data, length, handler);
 
-    fclose(inputFile);
+    Uconfig_releaseFile(data, length, mapped);
     return success;
 }
 
+bool UconfigJSON::parseUconfig(const char* data,
+                               size_t length,
+                               UconfigHandler* handler)
+{
+    if (!data || !handler)
+        return false;
+
+    return UconfigJSONPrivate::parseBuffer(data, length, handler);
+}
+
 bool UconfigJSON::writeUconfig(const char* filename, UconfigFile* config)
 {
     if (!config)
@@ -66,62 +111,38 @@ bool UconfigJSON::writeUconfig(const char* filename, UconfigFile* config)
     if (!outputFile)
         return false;
 
-    bool success = true;
-    int nlDLength = strlen(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
-
     // According to specification, a JSON file must contain either
     // exactly one value or exactly one obejct, or simply be empty.
     // Here, we will output all the values and objects attached to the root.
-    UconfigKeyObject* keyList = config->rootEntry.keys();
-    if (keyList)
-    {
-        for (int i=0; i<config->rootEntry.keyCount(); i++)
-        {
-            if (i > 0)
-                fputc(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT, outputFile);
-
-            success &= UconfigJSONPrivate::fwriteEntry(outputFile,
-                                                       config->rootEntry) > 0;
-            fwrite(UCONFIG_IO_JSON_DELIMITER_NEWLINE,
-                   sizeof(char), nlDLength, outputFile);
-        }
-        delete[] keyList;
-    }
-
-    UconfigEntryObject* entryList = config->rootEntry.subentries();
-    if (entryList)
-    {
-        for (int i=0; i<config->rootEntry.subentryCount(); i++)
-        {
-            if (i > 0)
-                fputc(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT, outputFile);
-
-            success &= UconfigJSONPrivate::fwriteEntry(outputFile,
-                                                       entryList[i]) > 0;
-            fwrite(UCONFIG_IO_JSON_DELIMITER_NEWLINE,
-                   sizeof(char), nlDLength, outputFile);
-        }
-        delete[] entryList;
-    }
+    UconfigJSONWriter writer(outputFile);
+    walkEntry(config->rootEntry, &writer);
 
+    bool success = writer.flush();
     fclose(outputFile);
     return success;
 }
 
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigJSON::writeUconfig(char** data,
+                               size_t* length,
+                               UconfigFile* config)
+{
+    if (!data || !length || !config)
+        return false;
+
+    UconfigSink sink(data, length);
+    UconfigJSONWriter writer(sink);
+    walkEntry(config->rootEntry, &writer);
+    return writer.flush();
+}
+
 // Normally, all value names in JSON must be wrapped in a pair of quotes
 // Here, we also accept strings without quotes as value names
 bool UconfigJSONKey::parseName(const char* expression, int length)
 {
-    if (length > 0 &&
-        expression[0] == UCONFIG_IO_JSON_CHAR_STRING &&
-        expression[length - 1] == UCONFIG_IO_JSON_CHAR_STRING)
-    {
-        setName(&expression[1], length - 2);
-    }
-    else
-    {
-        setName(expression, length);
-    }
+    Uconfig_trimJSONName(&expression, &length);
+    setName(expression, length);
     return true;
 }
 
@@ -130,7 +151,8 @@ bool UconfigJSONKey::parseValue(const char* expression, int length)
     if (!expression)
         return false;
 
-    char* pTail;
+    if (length <= 0)
+        length = strlen(expression);
 
     ValueType valueType = guessValueType(expression, length);
     switch (valueType)
@@ -152,17 +174,20 @@ bool UconfigJSONKey::parseValue(const char* expression, int length)
         case ValueType::Integer:
         {
             // Store the number as an "int"
-            int tempInt = int(strtol(expression, &pTail, 0));
-            if (pTail > expression)
+            long tempLong;
+            if (Uconfig_parseInteger(expression, length, &tempLong) > 0)
+            {
+                int tempInt = int(tempLong);
                 setValue((char*)(&tempInt), sizeof(int));
+            }
             break;
         }
         case ValueType::Float:
         case ValueType::Double:
         {
             // Store the number as a "double"
-            double tempDouble = strtod(expression, &pTail);
-            if (pTail > expression)
+            double tempDouble;
+            if (Uconfig_parseDouble(expression, length, &tempDouble) > 0)
                 setValue((char*)(&tempDouble), sizeof(double));
             break;
         }
@@ -174,21 +199,14 @@ bool UconfigJSONKey::parseValue(const char* expression, int length)
     return true;
 }
 
-int UconfigJSONKey::fwriteName(FILE *file)
+int UconfigJSONKey::writeName(UconfigOutputBuffer& output)
 {
     const UconfigKey& data = refData ? *refData : propData;
-
-    fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
-    fwrite(data.name, sizeof(char), data.nameSize, file);
-    fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
-
-    return data.nameSize + 2;
+    return UconfigJSONPrivate::writeName(output, data.name, data.nameSize);
 }
 
-int UconfigJSONKey::fwriteValue(FILE* file)
+int UconfigJSONKey::writeValue(UconfigOutputBuffer& output)
 {
-    char* buffer = NULL;
-
     int length = 0;
     switch (ValueType(type()))
     {
@@ -198,31 +216,31 @@ int UconfigJSONKey::fwriteValue(FILE* file)
                              UCONFIG_IO_JSON_EXPRESSION_BOOL_TRUE :
                              UCONFIG_IO_JSON_EXPRESSION_BOOL_FALSE;
             length = strlen(boolExp);
-            fwrite(boolExp, length, sizeof(char), file);
+            output.write(boolExp, length);
             break;
         }
         case ValueType::Integer:
-            length = asprintf(&buffer, "%d", *(int*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length = output.writeInteger(*(int*)(value()));
             break;
         case ValueType::Float:
-            length = asprintf(&buffer, "%f", *(float*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length = output.writeFloat(*(float*)(value()));
             break;
         case ValueType::Double:
-            length = asprintf(&buffer, "%f", *(double*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length = output.writeDouble(*(double*)(value()));
             break;
         case ValueType::Chars:
         default:
-            // Wrap string with quotes
-            length = valueSize() + 2;
-            fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
-            fwrite(value(), valueSize(), sizeof(char), file);
-            fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
+        {
+            // Wrap string with quotes, without its ending "\0" if any
+            int size = valueSize();
+            if (ValueType(type()) == ValueType::Chars)
+                size = Uconfig_nameLength(value(), size);
+            length = size + 2;
+            output.put(UCONFIG_IO_JSON_CHAR_STRING);
+            output.write(value(), size);
+            output.put(UCONFIG_IO_JSON_CHAR_STRING);
+        }
     }
-    if (buffer)
-        free(buffer);
 
     return length;
 }
@@ -230,235 +248,453 @@ int UconfigJSONKey::fwriteValue(FILE* file)
 
 bool UconfigJSONEntry::parseName(const char* expression, int length)
 {
-    if (length > 0 &&
-        expression[0] == UCONFIG_IO_JSON_CHAR_STRING &&
-        expression[length - 1] == UCONFIG_IO_JSON_CHAR_STRING)
+    Uconfig_trimJSONName(&expression, &length);
+    setName(expression, length);
+    return true;
+}
+
+
+UconfigJSONWriter::UconfigJSONWriter(const UconfigSink& sink) :
+    UconfigWriter(sink)
+{
+
+    Level root;
+    root.type = UconfigJSON::ObjectEntry;
+    root.elementCount = 0;
+    levels.push_back(root);
+}
+
+void UconfigJSONWriter::onEntryBegin(const char* name,
+                                     int nameSize,
+                                     int type)
+{
+    Level& parent = levels.back();
+    int depth = beginElement();
+
+    // Write the name of the subentry if any and
+    // if we are in an object
+    if (depth > 0 && name && parent.type == UconfigJSON::ObjectEntry)
     {
-        setName(&expression[1], length - 2);
+        UconfigJSONPrivate::writeName(output, name, nameSize);
+        output.write(UCONFIG_IO_JSON_DELIMITER_DEFINITION);
     }
-    else
+
+    // The opening tag
+    switch (type)
     {
-        setName(expression, length);
+        case UconfigJSON::ArrayEntry:
+            output.put(UCONFIG_IO_JSON_CHAR_ARRAY_BEGIN);
+            break;
+        case UconfigJSON::ObjectEntry:
+            output.put(UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN);
+            break;
+        default:;
     }
-    return true;
+
+    Level level;
+    level.type = type;
+    level.elementCount = 0;
+    levels.push_back(level);
+}
+
+void UconfigJSONWriter::onKey(UconfigKeyObject& key)
+{
+    UconfigJSONKey& jsonKey = (UconfigJSONKey&)key;
+    int depth = beginElement();
+
+    // Write the name of the key if any (except at the top level)
+    if (depth > 0 && jsonKey.name())
+    {
+        jsonKey.writeName(output);
+        output.write(UCONFIG_IO_JSON_DELIMITER_DEFINITION);
+    }
+
+    // Write the value of the key
+    jsonKey.writeValue(output);
+
+    if (depth == 0)
+        output.write(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
+}
+
+void UconfigJSONWriter::onEntryEnd()
+{
+    if (levels.size() <= 1)
+        return;
+
+    int type = levels.back().type;
+    levels.pop_back();
+    int depth = levels.size() - 1;
+
+    // The closing tag
+    output.write(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
+    output.writeIndentation(depth);
+    switch (type)
+    {
+        case UconfigJSON::ArrayEntry:
+            output.put(UCONFIG_IO_JSON_CHAR_ARRAY_END);
+            break;
+        case UconfigJSON::ObjectEntry:
+            output.put(UCONFIG_IO_JSON_CHAR_OBJECT_END);
+            break;
+        default:;
+    }
+
+    if (depth == 0)
+        output.write(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
 }
 
-int UconfigJSONEntry::fwriteName(FILE *file)
+// Separate a new element from the previous one in the current entry,
+// and put it on its own line; return the depth of the current entry
+int UconfigJSONWriter::beginElement()
 {
-    const UconfigEntry& data = refData ? *refData : *propData;
+    Level& parent = levels.back();
+    int depth = levels.size() - 1;
+
+    if (parent.elementCount++ > 0)
+        output.put(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT);
+
+    // Elements at the top level are not indented
+    if (depth > 0)
+    {
+        output.write(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
+        output.writeIndentation(depth);
+    }
+    return depth;
+}
+
+
+bool UconfigJSONPrivate::readBuffer(const char* data,
+                                    size_t length,
+                                    UconfigFile* config,
+                                    const char* filename)
+{
+    UconfigTreeBuilder builder(config->rootEntry);
+    bool success = parseBuffer(data, length, &builder);
+
+    if (success)
+    {
+        config->rootEntry.setType(UconfigJSON::ObjectEntry);
+
+        // Add meta-data
+        UconfigKeyObject tempKey;
+        /* Basic information */
+        if (filename)
+        {
+            tempKey.reset();
+            tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+            tempKey.setType(UconfigIO::Chars);
+            tempKey.setValue(filename, strlen(filename) + 1);
+            config->metadata.addKey(std::move(tempKey));
+        }
+        tempKey.reset();
+        tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
+        tempKey.setType(UconfigIO::Chars);
+        tempKey.setValue(UCONFIG_METADATA_VALUE_JSON,
+                         strlen(UCONFIG_METADATA_VALUE_JSON) + 1);
+        config->metadata.addKey(std::move(tempKey));
+    }
 
-    fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
-    fwrite(data.name, sizeof(char), data.nameSize, file);
-    fputc(UCONFIG_IO_JSON_CHAR_STRING, file);
+    // Nodes edited from now on are no longer allocated from the arena
+    config->freezeArena();
 
-    return data.nameSize + 2;
+    return success;
 }
 
+bool UconfigJSONPrivate::parseBuffer(const char* data,
+                                     size_t length,
+                                     UconfigHandler* handler)
+{
+    UconfigJSONScanner scanner(data, length);
+    return parseEntry(scanner, data, data + length, handler) > data;
+}
 
-int UconfigJSONPrivate::freadEntry(FILE* file,
-                                   UconfigEntryObject& entry)
+// Parse the elements of an object or an array starting at DATA,
+// up to its closing bracket or to END, reading chars one by one.
+// Elements are reported to HANDLER as keys and subentries
+// of the entry being parsed.
+// Return the position following the last parsed char
+// This is the reference for the indexed parser below
+const char* UconfigJSONPrivate::parseEntry(const char* data,
+                                           const char* end,
+                                           UconfigHandler* handler)
 {
-    int retValue;
-    int parsedLen = 0;
+    const char* pos = data;
+    const char* elementBegin = NULL;
+    const char* elementEnd = NULL;
+    const char* nameBegin = NULL;
+    const char* nameEnd = NULL;
     bool finished = false;
     bool nextElement = false;
-    bool parsingString = false;
-    char bufferChar;
-    std::vector<char> buffer, elementName;
+    bool hasSubentry = false;
     UconfigJSONKey tempKey;
-    UconfigJSONEntry tempSubentry;
-
-    entry.reset();
+    tempKey.setArena(handler->arena());
     while (true)
     {
-        // Read from file char by char
-        retValue = fgetc(file);
-        if (retValue == -1)
+        if (pos >= end)
         {
-            // EOF
+            // End of buffer
             nextElement = true;
             finished = true;
         }
         else
+        switch (*pos)
         {
-            parsedLen++;
-            bufferChar = char(retValue);
-            if (parsingString)
-            {
-                buffer.push_back(bufferChar);
-                if (bufferChar == UCONFIG_IO_JSON_CHAR_STRING)
-                    parsingString = false;
-            }
-            else
-            switch (bufferChar)
-            {
-                case ' ':
-                case '\t':
-                case '\r':
-                case '\n':
-                    break;
-                case UCONFIG_IO_JSON_CHAR_ARRAY_BEGIN:
-                    retValue = freadEntry(file, tempSubentry);
-                    if (retValue > 0)
-                    {
-                        tempSubentry.setType(UconfigJSON::ArrayEntry);
-                        parsedLen += retValue;
-                    }
-                    break;
-                case UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN:
-                    retValue = freadEntry(file, tempSubentry);
-                    if (retValue > 0)
-                    {
-                        tempSubentry.setType(UconfigJSON::ObjectEntry);
-                        parsedLen += retValue;
-                    }
-                    break;
-                case UCONFIG_IO_JSON_CHAR_ARRAY_END:
-                case UCONFIG_IO_JSON_CHAR_OBJECT_END:
-                    finished = true;
-                case UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT:
-                    nextElement = true;
-                    break;
-                case UCONFIG_IO_JSON_CHAR_DEFINITION:
-                    elementName = buffer;
-                    buffer.clear();
-                    break;
-                case UCONFIG_IO_JSON_CHAR_STRING:
-                    parsingString = true;
-                default:
-                    buffer.push_back(bufferChar);
-            }
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                pos++;
+                break;
+            case UCONFIG_IO_JSON_CHAR_ARRAY_BEGIN:
+                beginEntry(handler, nameBegin, nameEnd,
+                           UconfigJSON::ArrayEntry);
+                pos = parseEntry(pos + 1, end, handler);
+                handler->onEntryEnd();
+                hasSubentry = true;
+                break;
+            case UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN:
+                beginEntry(handler, nameBegin, nameEnd,
+                           UconfigJSON::ObjectEntry);
+                pos = parseEntry(pos + 1, end, handler);
+                handler->onEntryEnd();
+                hasSubentry = true;
+                break;
+            case UCONFIG_IO_JSON_CHAR_ARRAY_END:
+            case UCONFIG_IO_JSON_CHAR_OBJECT_END:
+                finished = true;
+            case UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT:
+                nextElement = true;
+                pos++;
+                break;
+            case UCONFIG_IO_JSON_CHAR_DEFINITION:
+                nameBegin = elementBegin;
+                nameEnd = elementEnd;
+                elementBegin = NULL;
+                elementEnd = NULL;
+                pos++;
+                break;
+            case UCONFIG_IO_JSON_CHAR_STRING:
+                if (!elementBegin)
+                    elementBegin = pos;
+                pos = findStringEnd(pos + 1, end);
+                elementEnd = pos;
+                break;
+            default:
+                if (!elementBegin)
+                    elementBegin = pos;
+                // Take an escaped char as a part of the element
+                if (*pos == UCONFIG_IO_JSON_CHAR_ESCAPE && pos + 1 < end)
+                    pos++;
+                pos++;
+                elementEnd = pos;
         }
 
         if (nextElement)
         {
-            if (tempSubentry.type() == UconfigJSON::UnknownEntry)
-            {
-                // Non object/array value: store it as a key
-                tempKey.parseName(elementName.data(), elementName.size());
-                tempKey.parseValue(buffer.data(), buffer.size());
-                entry.addKey(&tempKey);
-                buffer.clear();
-            }
-            else
-            {
-                tempSubentry.parseName(elementName.data(), elementName.size());
-                entry.appendSubentry(&tempSubentry);
-            }
-
-            tempKey.reset();
-            elementName.clear();
-            tempSubentry.setType(UconfigJSON::UnknownEntry);
-
-            // Reset the flag for next iteration of parsing
+            if (!hasSubentry)
+                appendKey(handler, tempKey,
+                          nameBegin, nameEnd, elementBegin, elementEnd);
+
+            // Reset the state for next iteration of parsing
+            elementBegin = NULL;
+            elementEnd = NULL;
+            nameBegin = NULL;
+            nameEnd = NULL;
+            hasSubentry = false;
             nextElement = false;
         }
         if (finished)
             break;
     }
 
-    return parsedLen;
+    return pos;
 }
 
-bool UconfigJSONPrivate::fwriteEntry(FILE* file,
-                                     UconfigEntryObject& entry,
-                                     int level)
+// Same as above, but jump from one structural char to the next
+// with the help of SCANNER instead of reading every char
+const char* UconfigJSONPrivate::parseEntry(UconfigJSONScanner& scanner,
+                                           const char* data,
+                                           const char* end,
+                                           UconfigHandler* handler)
 {
-    int i;
-    int nlDLength = strlen(UCONFIG_IO_JSON_DELIMITER_NEWLINE);
-    int dDLength = strlen(UCONFIG_IO_JSON_DELIMITER_DEFINITION);
-
-    UconfigJSON::EntryType entryType = UconfigJSON::EntryType(entry.type());
-
-    // The opening tag
-    switch (entryType)
-    {
-        case UconfigJSON::ArrayEntry:
-            fputc(UCONFIG_IO_JSON_CHAR_ARRAY_BEGIN, file);
-            break;
-        case UconfigJSON::ObjectEntry:
-            fputc(UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN, file);
-            break;
-        default:;
-    }
-
-    // First write the values of keys
-    UconfigJSONKey* keyList = (UconfigJSONKey*)(entry.keys());
-    if (keyList)
+    const char* pos = data;
+    const char* structural;
+    const char* tokenBegin;
+    const char* tokenEnd;
+    const char* elementBegin = NULL;
+    const char* elementEnd = NULL;
+    const char* nameBegin = NULL;
+    const char* nameEnd = NULL;
+    bool finished = false;
+    bool nextElement = false;
+    bool hasSubentry = false;
+    UconfigJSONKey tempKey;
+    tempKey.setArena(handler->arena());
+    while (true)
     {
-        for (i=0; i<entry.keyCount(); i++)
+        structural = scanner.next();
+
+        // Chars between two structural chars are part of the element
+        tokenBegin = pos;
+        if (structural)
+            tokenEnd = findTokenEnd(pos, structural);
+        else if (scanner.endsInString())
+            tokenEnd = end;
+        else
+            tokenEnd = findTokenEnd(pos, end);
+        while (tokenBegin < tokenEnd && Uconfig_isJSONSpace(*tokenBegin))
+            tokenBegin++;
+        if (tokenBegin < tokenEnd)
         {
-            if (i > 0)
-                fputc(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT, file);
-
-            fwrite(UCONFIG_IO_JSON_DELIMITER_NEWLINE,
-                   sizeof(char), nlDLength, file);
-            Uconfig_fwriteIndentation(file, level + 1);
-
-            // Write the name of the key if any
-            if (keyList[i].name())
-            {
-                keyList[i].fwriteName(file);
-                fwrite(UCONFIG_IO_JSON_DELIMITER_DEFINITION,
-                       sizeof(char), dDLength, file);
-            }
-
-            // Write the value of the key
-            keyList[i].fwriteValue(file);
+            if (!elementBegin)
+                elementBegin = tokenBegin;
+            elementEnd = tokenEnd;
         }
 
-        delete[] keyList;
-    }
-
-    // Then write subentries as arrays and objects
-    UconfigJSONEntry* subentryList = (UconfigJSONEntry*)(entry.subentries());
-    if (subentryList)
-    {
-        // Add an additional comma between keys and subentries
-        // if necessary
-        if (entry.keyCount() > 0)
-            fputc(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT, file);
+        if (!structural)
+        {
+            // End of buffer
+            pos = end;
+            nextElement = true;
+            finished = true;
+        }
+        else
+        switch (*structural)
+        {
+            case UCONFIG_IO_JSON_CHAR_ARRAY_BEGIN:
+                beginEntry(handler, nameBegin, nameEnd,
+                           UconfigJSON::ArrayEntry);
+                pos = parseEntry(scanner, structural + 1, end, handler);
+                handler->onEntryEnd();
+                hasSubentry = true;
+                break;
+            case UCONFIG_IO_JSON_CHAR_OBJECT_BEGIN:
+                beginEntry(handler, nameBegin, nameEnd,
+                           UconfigJSON::ObjectEntry);
+                pos = parseEntry(scanner, structural + 1, end, handler);
+                handler->onEntryEnd();
+                hasSubentry = true;
+                break;
+            case UCONFIG_IO_JSON_CHAR_ARRAY_END:
+            case UCONFIG_IO_JSON_CHAR_OBJECT_END:
+                finished = true;
+            case UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT:
+                nextElement = true;
+                pos = structural + 1;
+                break;
+            case UCONFIG_IO_JSON_CHAR_DEFINITION:
+                nameBegin = elementBegin;
+                nameEnd = elementEnd;
+                elementBegin = NULL;
+                elementEnd = NULL;
+                pos = structural + 1;
+        }
 
-        for (i=0; i<entry.subentryCount(); i++)
+        if (nextElement)
         {
-            if (i > 0)
-                fputc(UCONFIG_IO_JSON_CHAR_ELEMENT_NEXT, file);
+            if (!hasSubentry)
+                appendKey(handler, tempKey,
+                          nameBegin, nameEnd, elementBegin, elementEnd);
+
+            // Reset the state for next iteration of parsing
+            elementBegin = NULL;
+            elementEnd = NULL;
+            nameBegin = NULL;
+            nameEnd = NULL;
+            hasSubentry = false;
+            nextElement = false;
+        }
+        if (finished)
+            break;
+    }
 
-            fwrite(UCONFIG_IO_JSON_DELIMITER_NEWLINE,
-                   sizeof(char), nlDLength, file);
-            Uconfig_fwriteIndentation(file, level + 1);
+    return pos;
+}
 
-            // Write the name of the subentry if any and
-            // if we are in an object
-            if (subentryList[i].name() &&
-                entry.type() == UconfigJSON::ObjectEntry)
-            {
-                subentryList[i].fwriteName(file);
-                fwrite(UCONFIG_IO_JSON_DELIMITER_DEFINITION,
-                       sizeof(char), dDLength, file);
-            }
+// Report the beginning of an object or an array named by NAMEBEGIN
+void UconfigJSONPrivate::beginEntry(UconfigHandler* handler,
+                                    const char* nameBegin,
+                                    const char* nameEnd,
+                                    int type)
+{
+    int nameLength = nameEnd - nameBegin;
+    Uconfig_trimJSONName(&nameBegin, &nameLength);
+    handler->onEntryBegin(nameBegin, nameLength, type);
+}
 
-            // Write the body of the subentry
-            fwriteEntry(file, subentryList[i], level + 1);
-        }
+// Report a non object/array element as a key
+void UconfigJSONPrivate::appendKey(UconfigHandler* handler,
+                                   UconfigJSONKey& tempKey,
+                                   const char* nameBegin,
+                                   const char* nameEnd,
+                                   const char* elementBegin,
+                                   const char* elementEnd)
+{
+    if (!nameBegin && !elementBegin)
+        return;
+
+    if (nameBegin)
+        tempKey.parseName(nameBegin, nameEnd - nameBegin);
+    if (elementBegin)
+        tempKey.parseValue(elementBegin, elementEnd - elementBegin);
+    handler->onKey(tempKey);
+    tempKey.reset();
+}
 
-        delete[] subentryList;
-    }
+// Find the end of the last token between DATA and END, i.e. the position
+// following its last char that is not a space, unless the space is escaped
+const char* UconfigJSONPrivate::findTokenEnd(const char* data,
+                                             const char* end)
+{
+    const char* pos = end;
+    while (pos > data && Uconfig_isJSONSpace(pos[-1]))
+        pos--;
+    if (pos == end)
+        return end;
+
+    // Count the backslashes preceding the space
+    const char* escape = pos;
+    while (escape > data && escape[-1] == UCONFIG_IO_JSON_CHAR_ESCAPE)
+        escape--;
+    if ((pos - escape) % 2 == 1)
+        pos++;
+    return pos;
+}
 
-    // The closing tag
-    fwrite(UCONFIG_IO_JSON_DELIMITER_NEWLINE,
-           sizeof(char), nlDLength, file);
-    Uconfig_fwriteIndentation(file, level);
-    switch (entryType)
+// Find the end of a string starting at DATA (after the opening quote),
+// skipping escaped quotes
+// Return the position following the closing quote, or END
+const char* UconfigJSONPrivate::findStringEnd(const char* data,
+                                              const char* end)
+{
+    const char* pos = data;
+    while (pos < end)
     {
-        case UconfigJSON::ArrayEntry:
-            fputc(UCONFIG_IO_JSON_CHAR_ARRAY_END, file);
-            break;
-        case UconfigJSON::ObjectEntry:
-            fputc(UCONFIG_IO_JSON_CHAR_OBJECT_END, file);
-            break;
-        default:;
+        pos = static_cast<const char*>(
+                    memchr(pos, UCONFIG_IO_JSON_CHAR_STRING, end - pos));
+        if (!pos)
+            return end;
+
+        // Count the backslashes preceding the quote
+        const char* escape = pos;
+        while (escape > data && escape[-1] == UCONFIG_IO_JSON_CHAR_ESCAPE)
+            escape--;
+        pos++;
+        if ((pos - escape) % 2 == 1)
+            return pos;
     }
+    return end;
+}
 
-    return true;
+int UconfigJSONPrivate::writeName(UconfigOutputBuffer& output,
+                                  const char* name,
+                                  int nameSize)
+{
+    int length = Uconfig_nameLength(name, nameSize);
+
+    output.put(UCONFIG_IO_JSON_CHAR_STRING);
+    output.write(name, length);
+    output.put(UCONFIG_IO_JSON_CHAR_STRING);
+
+    return length + 2;
 }
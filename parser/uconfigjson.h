@@ -1,9 +1,12 @@
 #ifndef UCONFIGJSON_H
 #define UCONFIGJSON_H
 
+#include <vector>
 #include "uconfigio.h"
 
 
+typedef struct _IO_FILE FILE;
+
 class UconfigJSON : public UconfigIO
 {
 public:
@@ -16,8 +19,44 @@ public:
 
     static bool readUconfig(const char* filename,
                             UconfigFile* config);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config);
     static bool writeUconfig(const char* filename,
                              UconfigFile* config);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler);
+};
+
+// Write the reported entries to a file as JSON, as soon as they arrive
+// Elements are written in the order of report, and only the state of
+// the entries being open is kept in memory
+class UconfigJSONWriter : public UconfigWriter
+{
+public:
+    UconfigJSONWriter(const UconfigSink& sink);
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+protected:
+    struct Level
+    {
+        int type;
+        int elementCount;
+    };
+
+    std::vector<Level> levels; // Open entries, beginning with the root
+
+    int beginElement();
 };
 
 #endif // UCONFIGJSON_H
@@ -4,7 +4,7 @@
 #include "uconfigio.h"
 
 
-typedef struct _IO_FILE FILE;
+class UconfigJSONScanner;
 
 class UconfigJSONKey : public UconfigKeyObject, public UconfigIO
 {
@@ -12,26 +12,48 @@ public:
     bool parseName(const char* expression, int length = 0);
     bool parseValue(const char* expression, int length = 0);
 
-    int fwriteName(FILE* file);
-    int fwriteValue(FILE* file);
+    int writeName(UconfigOutputBuffer& output);
+    int writeValue(UconfigOutputBuffer& output);
 };
 
 class UconfigJSONEntry : public UconfigEntryObject
 {
 public:
     bool parseName(const char* expression, int length = 0);
-
-    int fwriteName(FILE* file);
 };
 
 class UconfigJSONPrivate
 {
 public:
-    static int freadEntry(FILE* file,
-                          UconfigEntryObject& entry);
-    static bool fwriteEntry(FILE* file,
-                            UconfigEntryObject& entry,
-                            int level = 0);
+    static bool readBuffer(const char* data,
+                           size_t length,
+                           UconfigFile* config,
+                           const char* filename);
+    static bool parseBuffer(const char* data,
+                            size_t length,
+                            UconfigHandler* handler);
+    static const char* parseEntry(const char* data,
+                                  const char* end,
+                                  UconfigHandler* handler);
+    static const char* parseEntry(UconfigJSONScanner& scanner,
+                                  const char* data,
+                                  const char* end,
+                                  UconfigHandler* handler);
+    static void beginEntry(UconfigHandler* handler,
+                           const char* nameBegin,
+                           const char* nameEnd,
+                           int type);
+    static void appendKey(UconfigHandler* handler,
+                          UconfigJSONKey& tempKey,
+                          const char* nameBegin,
+                          const char* nameEnd,
+                          const char* elementBegin,
+                          const char* elementEnd);
+    static const char* findTokenEnd(const char* data, const char* end);
+    static const char* findStringEnd(const char* data, const char* end);
+    static int writeName(UconfigOutputBuffer& output,
+                         const char* name,
+                         int nameSize);
 };
 
 #endif // UCONFIGJSON_P_H
@@ -0,0 +1,329 @@
+#include <string.h>
+#include "uconfigjsonscanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UCONFIG_JSON_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+#define UCONFIG_JSON_SCANNER_BLOCK_SIZE     64
+#define UCONFIG_JSON_SCANNER_BATCH_SIZE     65536
+#define UCONFIG_JSON_SCANNER_ODD_BITS       0xAAAAAAAAAAAAAAAAULL
+
+
+static int currentKernel = -1;
+
+
+// Turn the bitmasks of a block into positions of structural chars
+// out of strings, and carry the state over to the next block
+static inline uint32_t* Uconfig_indexBlock(UconfigJSONScanState* state,
+                                           uint64_t quotes,
+                                           uint64_t backslashes,
+                                           uint64_t structurals,
+                                           uint32_t offset,
+                                           uint32_t* positions)
+{
+    // A char is escaped if it follows an odd sequence of backslashes:
+    // subtracting the backslashes from their shifted mask (with odd bits
+    // set) carries over each sequence, leaving a bit on its end
+    // only if the sequence starts and ends on bits of different parity
+    uint64_t escaped;
+    if (backslashes)
+    {
+        backslashes &= ~state->escaped;
+        uint64_t codes = (((backslashes << 1) |
+                           UCONFIG_JSON_SCANNER_ODD_BITS) - backslashes) ^
+                         UCONFIG_JSON_SCANNER_ODD_BITS;
+        escaped = codes ^ (backslashes | state->escaped);
+        state->escaped = (codes & backslashes) >> 63;
+    }
+    else
+    {
+        escaped = state->escaped;
+        state->escaped = 0;
+    }
+
+    // Chars from an opening quote up to the closing one (excluded)
+    // are inside a string: compute the prefix XOR of unescaped quotes
+    uint64_t inString = quotes & ~escaped;
+    inString ^= inString << 1;
+    inString ^= inString << 2;
+    inString ^= inString << 4;
+    inString ^= inString << 8;
+    inString ^= inString << 16;
+    inString ^= inString << 32;
+    inString ^= state->inString;
+    state->inString = uint64_t(int64_t(inString) >> 63);
+
+    structurals &= ~(inString | escaped);
+    while (structurals)
+    {
+        *(positions++) = offset + __builtin_ctzll(structurals);
+        structurals &= structurals - 1;
+    }
+    return positions;
+}
+
+static uint32_t* Uconfig_scanScalar(const char* data,
+                                    size_t blockCount,
+                                    UconfigJSONScanState* state,
+                                    uint32_t offset,
+                                    uint32_t* positions)
+{
+    for (size_t i=0; i<blockCount; i++)
+    {
+        uint64_t quotes = 0;
+        uint64_t backslashes = 0;
+        uint64_t structurals = 0;
+        for (int j=0; j<UCONFIG_JSON_SCANNER_BLOCK_SIZE; j++)
+        {
+            uint64_t bit = uint64_t(1) << j;
+            switch (data[j])
+            {
+                case '"':
+                    quotes |= bit;
+                    break;
+                case '\\':
+                    backslashes |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    structurals |= bit;
+                    break;
+                default:;
+            }
+        }
+        positions = Uconfig_indexBlock(state, quotes, backslashes,
+                                       structurals, offset, positions);
+        data += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+        offset += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+    }
+    return positions;
+}
+
+#ifdef UCONFIG_JSON_SCANNER_X86
+// Brackets and braces are matched in pairs: '[' and ']' only differ
+// from '{' and '}' by bit 0x20
+__attribute__((target("sse2")))
+static uint32_t* Uconfig_scanSSE2(const char* data,
+                                  size_t blockCount,
+                                  UconfigJSONScanState* state,
+                                  uint32_t offset,
+                                  uint32_t* positions)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i objectBegin = _mm_set1_epi8('{');
+    const __m128i objectEnd = _mm_set1_epi8('}');
+    const __m128i definition = _mm_set1_epi8(':');
+    const __m128i elementNext = _mm_set1_epi8(',');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+
+    for (size_t i=0; i<blockCount; i++)
+    {
+        uint64_t quotes = 0;
+        uint64_t backslashes = 0;
+        uint64_t structurals = 0;
+        for (int j=0; j<4; j++)
+        {
+            __m128i chars = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(data + j * 16));
+            __m128i folded = _mm_or_si128(chars, caseBit);
+            __m128i structural =
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, objectBegin),
+                                          _mm_cmpeq_epi8(folded, objectEnd)),
+                             _mm_or_si128(_mm_cmpeq_epi8(chars, definition),
+                                          _mm_cmpeq_epi8(chars, elementNext)));
+
+            quotes |= uint64_t(uint16_t(_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(chars, quote)))) << (j * 16);
+            backslashes |= uint64_t(uint16_t(_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(chars, backslash)))) << (j * 16);
+            structurals |= uint64_t(uint16_t(_mm_movemask_epi8(structural)))
+                           << (j * 16);
+        }
+        positions = Uconfig_indexBlock(state, quotes, backslashes,
+                                       structurals, offset, positions);
+        data += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+        offset += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+    }
+    return positions;
+}
+
+__attribute__((target("avx2")))
+static uint32_t* Uconfig_scanAVX2(const char* data,
+                                  size_t blockCount,
+                                  UconfigJSONScanState* state,
+                                  uint32_t offset,
+                                  uint32_t* positions)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i objectBegin = _mm256_set1_epi8('{');
+    const __m256i objectEnd = _mm256_set1_epi8('}');
+    const __m256i definition = _mm256_set1_epi8(':');
+    const __m256i elementNext = _mm256_set1_epi8(',');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+    for (size_t i=0; i<blockCount; i++)
+    {
+        uint64_t quotes = 0;
+        uint64_t backslashes = 0;
+        uint64_t structurals = 0;
+        for (int j=0; j<2; j++)
+        {
+            __m256i chars = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(data + j * 32));
+            __m256i folded = _mm256_or_si256(chars, caseBit);
+            __m256i structural = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(folded, objectBegin),
+                                    _mm256_cmpeq_epi8(folded, objectEnd)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chars, definition),
+                                    _mm256_cmpeq_epi8(chars, elementNext)));
+
+            quotes |= uint64_t(uint32_t(_mm256_movemask_epi8(
+                                _mm256_cmpeq_epi8(chars, quote)))) << (j * 32);
+            backslashes |= uint64_t(uint32_t(_mm256_movemask_epi8(
+                                _mm256_cmpeq_epi8(chars, backslash))))
+                           << (j * 32);
+            structurals |= uint64_t(uint32_t(_mm256_movemask_epi8(structural)))
+                           << (j * 32);
+        }
+        positions = Uconfig_indexBlock(state, quotes, backslashes,
+                                       structurals, offset, positions);
+        data += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+        offset += UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+    }
+    return positions;
+}
+#endif // UCONFIG_JSON_SCANNER_X86
+
+
+UconfigJSONScanner::UconfigJSONScanner(const char* data, size_t length)
+{
+    this->data = data;
+    this->length = length;
+    scannedLength = 0;
+    batchOffset = 0;
+    positions = new uint32_t[UCONFIG_JSON_SCANNER_BATCH_SIZE];
+    positionCount = 0;
+    positionIndex = 0;
+    state.inString = 0;
+    state.escaped = 0;
+
+    switch (kernel())
+    {
+#ifdef UCONFIG_JSON_SCANNER_X86
+        case AVX2Kernel:
+            scan = Uconfig_scanAVX2;
+            break;
+        case SSE2Kernel:
+            scan = Uconfig_scanSSE2;
+            break;
+#endif
+        default:
+            scan = Uconfig_scanScalar;
+    }
+}
+
+UconfigJSONScanner::~UconfigJSONScanner()
+{
+    delete[] positions;
+}
+
+// Return the position of the next structural char out of strings,
+// or NULL if the end of buffer is reached
+const char* UconfigJSONScanner::next()
+{
+    while (positionIndex >= positionCount)
+    {
+        if (!scanBatch())
+            return NULL;
+    }
+    return data + batchOffset + positions[positionIndex++];
+}
+
+// Whether the buffer ends with an unterminated string
+// Only meaningful once next() has returned NULL
+bool UconfigJSONScanner::endsInString() const
+{
+    return state.inString != 0;
+}
+
+UconfigJSONScanner::Kernel UconfigJSONScanner::kernel()
+{
+    if (currentKernel < 0)
+    {
+        if (isKernelSupported(AVX2Kernel))
+            currentKernel = AVX2Kernel;
+        else if (isKernelSupported(SSE2Kernel))
+            currentKernel = SSE2Kernel;
+        else
+            currentKernel = ScalarKernel;
+    }
+    return Kernel(currentKernel);
+}
+
+bool UconfigJSONScanner::setKernel(Kernel kernel)
+{
+    if (!isKernelSupported(kernel))
+        return false;
+
+    currentKernel = kernel;
+    return true;
+}
+
+bool UconfigJSONScanner::isKernelSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case ScalarKernel:
+            return true;
+#ifdef UCONFIG_JSON_SCANNER_X86
+        case SSE2Kernel:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case AVX2Kernel:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+// Classify the next batch of blocks
+// The last block is copied and padded with spaces if it is incomplete
+bool UconfigJSONScanner::scanBatch()
+{
+    if (scannedLength >= length)
+        return false;
+
+    size_t batchSize = length - scannedLength;
+    if (batchSize > UCONFIG_JSON_SCANNER_BATCH_SIZE)
+        batchSize = UCONFIG_JSON_SCANNER_BATCH_SIZE;
+    size_t blockCount = batchSize / UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+    size_t remainder = batchSize % UCONFIG_JSON_SCANNER_BLOCK_SIZE;
+
+    batchOffset = scannedLength;
+    uint32_t* end = scan(data + batchOffset, blockCount,
+                         &state, 0, positions);
+    if (remainder > 0)
+    {
+        char block[UCONFIG_JSON_SCANNER_BLOCK_SIZE];
+        memset(block, ' ', UCONFIG_JSON_SCANNER_BLOCK_SIZE);
+        memcpy(block,
+               data + batchOffset + batchSize - remainder,
+               remainder);
+        end = scan(block, 1, &state, batchSize - remainder, end);
+    }
+
+    scannedLength += batchSize;
+    positionCount = end - positions;
+    positionIndex = 0;
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef UCONFIGJSONSCANNER_H
+#define UCONFIGJSONSCANNER_H
+
+/*
+ * Structural index of a JSON buffer, built in the way of simdjson's
+ * first stage: every block of 64 bytes is classified at once into
+ * bitmasks of quotes, backslashes and structural chars ({ } [ ] : ,).
+ * Escaped chars and the content of strings are then masked out with
+ * a few bitwise operations, and the positions of the remaining
+ * structural chars are handed out one by one to the tree builder.
+ * The classification uses AVX2 or SSE2 if the CPU supports it,
+ * or a plain loop otherwise.
+ * As in the rest of the JSON parser, a backslash escapes the char
+ * following it even out of a string.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+struct UconfigJSONScanState
+{
+    uint64_t inString; // All ones if the last block ended inside a string
+    uint64_t escaped;  // 1 if the next block begins with an escaped char
+};
+
+class UconfigJSONScanner
+{
+public:
+    enum Kernel
+    {
+        ScalarKernel = 0,
+        SSE2Kernel = 1,
+        AVX2Kernel = 2
+    };
+
+    UconfigJSONScanner(const char* data, size_t length);
+    ~UconfigJSONScanner();
+
+    const char* next();
+    bool endsInString() const;
+
+    // Kernel used by new scanners; the fastest one supported by default
+    static Kernel kernel();
+    static bool setKernel(Kernel kernel);
+    static bool isKernelSupported(Kernel kernel);
+
+protected:
+    typedef uint32_t* (*ScanFunction)(const char* data,
+                                      size_t blockCount,
+                                      UconfigJSONScanState* state,
+                                      uint32_t offset,
+                                      uint32_t* positions);
+
+    const char* data;
+    size_t length;
+    size_t scannedLength;
+    size_t batchOffset;  // Offset of the batch being handed out
+    uint32_t* positions; // Structural chars of the batch, from batchOffset
+    int positionCount;
+    int positionIndex;
+    UconfigJSONScanState state;
+    ScanFunction scan;
+
+    bool scanBatch();
+};
+
+#endif // UCONFIGJSONSCANNER_H
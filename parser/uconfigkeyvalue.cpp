@@ -1,122 +1,130 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <utility>
 #include "uconfigkeyvalue.h"
 #include "uconfigkeyvalue_p.h"
 #include "uconfigfile_metadata.h"
+#include "uconfiglineindex.h"
+#include "uconfiglinereader.h"
+#include "uconfignumber.h"
 #include "utils.h"
 
 #define UCONFIG_IO_KEYVALUE_DELIMITER_LINE      "\n"
 #define UCONFIG_IO_KEYVALUE_DELIMITER_KEYVAL    "="
 #define UCONFIG_IO_KEYVALUE_DELIMITER_COMMENT   "#"
 
+// Longest names and string values of keys copied without allocation
+#define UCONFIG_IO_KEYVALUE_NAME_BUFFER         256
+
+
+// Set the value of a key to a string of LENGTH chars,
+// terminated by "\0" as when set from a string
+static void Uconfig_setStringValue(UconfigKeyObject& key,
+                                   const char* value,
+                                   int length)
+{
+    char valueBuffer[UCONFIG_IO_KEYVALUE_NAME_BUFFER];
+    char* buffer = length < UCONFIG_IO_KEYVALUE_NAME_BUFFER ?
+                   valueBuffer : new char[length + 1];
+    Uconfig_strncpy(buffer, value, length);
+    key.setValue(buffer, length + 1);
+    if (buffer != valueBuffer)
+        delete[] buffer;
+}
+
 bool UconfigKeyValue::readUconfig(const char* filename, UconfigFile* config)
 {
     if (!config)
         return false;
 
-    FILE* inputFile = fopen(filename, "rb");
-    if (!inputFile)
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
         return false;
 
-    config->rootEntry.reset();
+    UconfigKeyValuePrivate::readBuffer(data, length, config, filename);
 
-    UconfigKeyObject tempKey, tempComment;
-    UconfigEntryObject tempSubentry;
-    UconfigEntryObject& rootEntry = config->rootEntry;
-    rootEntry.setType(UconfigKeyValue::UnknownEntry);
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
 
-    // Read a file and parse its content line by line
-    // As there is no pre-defined hierachy, all lines
-    // are seen as subentries of a single root entry
-    char* buffer;
-    long unsigned int readlen, parsedLen;
-    while(!feof(inputFile))
-    {
-        readlen = 0;
-        buffer = NULL;
-        readlen = getline(&buffer, &readlen, inputFile);
+// Read LENGTH bytes of DATA in place, e.g. a block received from
+// another process
+bool UconfigKeyValue::readUconfig(const char* data,
+                                  size_t length,
+                                  UconfigFile* config)
+{
+    if (!data || !config)
+        return false;
 
-        // Omit empty (incomplete) lines
-        readlen = Uconfig_findLineDelimiter(buffer);
-        if (readlen < 1)
-            continue;
+    UconfigKeyValuePrivate::readBuffer(data, length, config, NULL);
+    return true;
+}
 
-        // See if the line contains a comment
-        // By definition, a comment section must appear after
-        // the KEY=VALUE section. However, we need to extract first
-        // the comment before being able to determine the length of
-        // the KEY=VALUE section. Thus we keep the extract comment and
-        // append it to the subentry later.
-        parsedLen = UconfigKeyValuePrivate::parseLineComment(buffer,
-                                                             tempComment,
-                                                             readlen);
+// Report the content of a file to HANDLER instead of building a tree
+// Each line is reported as an entry, with its name taken from its key
+bool UconfigKeyValue::parseUconfig(const char* filename,
+                                   UconfigHandler* handler)
+{
+    if (!handler)
+        return false;
 
-        // See if the line contains an expression like KEY=VALUE
-        if (UconfigKeyValuePrivate::parseExpKeyValue(buffer,
-                                                     tempKey,
-                                                     readlen - parsedLen))
-        {
-            tempSubentry.setType(UconfigKeyValue::KeyVal);
-            tempSubentry.addKey(&tempKey);
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
 
-            if (!tempSubentry.name())
-            {
-                // Use the name of the first key as this subentry's name
-                tempSubentry.setName(tempKey.name());
-            }
-        }
+    UconfigKeyValuePrivate::parseBuffer(data, length, handler);
 
-        // Append the comment section, and change the type of
-        // the subentry if it is the only section within that line
-        if (parsedLen > 0)
-        {
-            tempSubentry.addKey(&tempComment);
-            if (tempSubentry.keyCount() < 2)
-            {
-                // Standalone comment line
-                tempSubentry.setType(UconfigKeyValue::Comment);
-            }
-        }
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
 
-        if (tempSubentry.keyCount() < 1)
-        {
-            // See the whole line as RAW content
-            tempKey.reset();
-            tempKey.setValue(buffer, readlen);
-            tempKey.setType(ValueType::Raw);
-            tempSubentry.addKey(&tempKey);
-            tempSubentry.setType(UconfigKeyValue::Raw);
-        }
+bool UconfigKeyValue::parseUconfig(const char* data,
+                                   size_t length,
+                                   UconfigHandler* handler)
+{
+    if (!data || !handler)
+        return false;
 
-        // Append the subentry to the root entry
-        if (rootEntry.type() == UconfigKeyValue::UnknownEntry)
-        {
-            rootEntry.reset();
-            rootEntry.setType(UconfigKeyValue::NormalEntry);
-        }
-        rootEntry.addSubentry(&tempSubentry);
-        tempSubentry.reset();
+    UconfigKeyValuePrivate::parseBuffer(data, length, handler);
+    return true;
+}
 
-        if (buffer)
-            free(buffer);
-    }
+// Update the tree of a file read before with INDEX, parsing again only
+// the lines changed since then; the tree is read as a whole if INDEX
+// is empty (see UconfigLineIndex)
+bool UconfigKeyValue::updateUconfig(const char* filename,
+                                    UconfigFile* config,
+                                    UconfigLineIndex* index)
+{
+    if (!config || !index)
+        return false;
 
-    // Add meta-data
-    /* Basic information */
-    tempKey.reset();
-    tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
-    tempKey.setType(ValueType::Chars);
-    tempKey.setValue(filename, strlen(filename) + 1);
-    config->metadata.addKey(&tempKey);
-    tempKey.reset();
-    tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
-    tempKey.setType(ValueType::Chars);
-    tempKey.setValue(UCONFIG_METADATA_VALUE_INIFILE,
-                     strlen(UCONFIG_METADATA_VALUE_INIFILE) + 1);
-    config->metadata.addKey(&tempKey);
+    size_t length;
+    bool mapped;
+    const char* data = Uconfig_loadFile(filename, &length, &mapped);
+    if (!data)
+        return false;
+
+    UconfigKeyValuePrivate::updateBuffer(data, length, config, filename, index);
+
+    Uconfig_releaseFile(data, length, mapped);
+    return true;
+}
+
+bool UconfigKeyValue::updateUconfig(const char* data,
+                                    size_t length,
+                                    UconfigFile* config,
+                                    UconfigLineIndex* index)
+{
+    if (!data || !config || !index)
+        return false;
 
-    fclose(inputFile);
+    UconfigKeyValuePrivate::updateBuffer(data, length, config, NULL, index);
     return true;
 }
 
@@ -129,12 +137,186 @@ bool UconfigKeyValue::writeUconfig(const char* filename, UconfigFile* config)
     if (!outputFile)
         return false;
 
-    bool success = UconfigKeyValuePrivate::fwriteEntry(outputFile,
-                                                       config->rootEntry);
+    UconfigKeyValueWriter writer(outputFile);
+    walkEntry(config->rootEntry, &writer);
+
+    bool success = writer.flush();
     fclose(outputFile);
     return success;
 }
 
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigKeyValue::writeUconfig(char** data,
+                                   size_t* length,
+                                   UconfigFile* config)
+{
+    if (!data || !length || !config)
+        return false;
+
+    UconfigSink sink(data, length);
+    UconfigKeyValueWriter writer(sink);
+    walkEntry(config->rootEntry, &writer);
+    return writer.flush();
+}
+
+// Build the tree of a block of text in CONFIG, then add its meta-data
+// FILENAME is the file that the block is read from, if any
+void UconfigKeyValuePrivate::readBuffer(const char* data,
+                                        size_t length,
+                                        UconfigFile* config,
+                                        const char* filename)
+{
+    UconfigTreeBuilder builder(config->rootEntry);
+    parseBuffer(data, length, &builder);
+
+    // As there is no pre-defined hierachy, all lines
+    // are seen as subentries of a single root entry
+    if (config->rootEntry.subentryCount() > 0)
+        config->rootEntry.setType(UconfigKeyValue::NormalEntry);
+    else
+        config->rootEntry.setType(UconfigKeyValue::UnknownEntry);
+
+    // Add meta-data
+    /* Basic information */
+    UconfigKeyObject tempKey;
+    if (filename)
+    {
+        tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+        tempKey.setType(UconfigIO::Chars);
+        tempKey.setValue(filename, strlen(filename) + 1);
+        config->metadata.addKey(std::move(tempKey));
+    }
+    tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
+    tempKey.setType(UconfigIO::Chars);
+    tempKey.setValue(UCONFIG_METADATA_VALUE_INIFILE,
+                     strlen(UCONFIG_METADATA_VALUE_INIFILE) + 1);
+    config->metadata.addKey(std::move(tempKey));
+
+    // Nodes edited from now on are no longer allocated from the arena
+    config->freezeArena();
+}
+
+// Report the lines of a block of text to HANDLER
+// Replace the lines of the tree that changed in the new block of text,
+// or build the whole tree again if they cannot be found
+void UconfigKeyValuePrivate::updateBuffer(const char* data,
+                                          size_t length,
+                                          UconfigFile* config,
+                                          const char* filename,
+                                          UconfigLineIndex* index)
+{
+    UconfigLineChange change;
+    std::vector<size_t> offsets;
+    if (index->format() == UconfigConverter::KeyValueFormat &&
+        index->entryCount() == config->rootEntry.subentryCount() &&
+        index->findChange(data, length, true, &change))
+    {
+        const char* range = &data[change.begin];
+        size_t rangeLength = change.end - change.begin;
+        UconfigEntryObject entries;
+        entries.setArena(config->rootEntry.arena());
+        UconfigTreeBuilder builder(entries);
+        parseBuffer(range, rangeLength, &builder);
+        scanEntries(range, rangeLength, offsets);
+        if (index->apply(data, length, change,
+                         config->rootEntry, entries, offsets))
+        {
+            if (config->rootEntry.subentryCount() > 0)
+                config->rootEntry.setType(UconfigKeyValue::NormalEntry);
+            else
+                config->rootEntry.setType(UconfigKeyValue::UnknownEntry);
+            return;
+        }
+        offsets.clear();
+    }
+
+    // Read the whole content again
+    config->metadata.reset();
+    readBuffer(data, length, config, filename);
+    scanEntries(data, length, offsets);
+    index->assign(data, length, UconfigConverter::KeyValueFormat, offsets);
+}
+
+// Find where each line reported by parseBuffer() begins
+void UconfigKeyValuePrivate::scanEntries(const char* data,
+                                         size_t length,
+                                         std::vector<size_t>& offsets)
+{
+    UconfigLineReader reader(data, length);
+    const char* buffer;
+    int readlen;
+    while (reader.next(&buffer, &readlen))
+    {
+        if (readlen >= 1)
+            offsets.push_back(buffer - data);
+    }
+}
+
+void UconfigKeyValuePrivate::parseBuffer(const char* data,
+                                         size_t length,
+                                         UconfigHandler* handler)
+{
+    UconfigKeyObject tempKey, tempComment;
+    tempKey.setArena(handler->arena());
+    tempComment.setArena(handler->arena());
+
+    // Parse the content line by line, in place
+    UconfigLineReader reader(data, length);
+    int lineType;
+    bool hasKey;
+    const char* buffer;
+    int readlen, parsedLen;
+    while (reader.next(&buffer, &readlen))
+    {
+        // Omit empty lines
+        if (readlen < 1)
+            continue;
+
+        // See if the line contains a comment
+        // By definition, a comment section must appear after
+        // the KEY=VALUE section. However, we need to extract first
+        // the comment before being able to determine the length of
+        // the KEY=VALUE section. Thus we keep the extract comment and
+        // report it after the key.
+        parsedLen = parseLineComment(buffer, tempComment, readlen);
+
+        // See if the line contains an expression like KEY=VALUE
+        hasKey = readlen > parsedLen &&
+                 parseExpKeyValue(buffer, tempKey, readlen - parsedLen);
+        if (hasKey)
+            lineType = UconfigKeyValue::KeyVal;
+        else if (parsedLen > 0)
+        {
+            // Standalone comment line
+            lineType = UconfigKeyValue::Comment;
+        }
+        else
+        {
+            // See the whole line as RAW content
+            tempKey.reset();
+            tempKey.setValue(buffer, readlen);
+            tempKey.setType(UconfigIO::Raw);
+            lineType = UconfigKeyValue::Raw;
+        }
+
+        // Use the name of the first key as this line's name
+        if (hasKey)
+            handler->onEntryBegin(tempKey.name(),
+                                  tempKey.nameSize(),
+                                  lineType);
+        else
+            handler->onEntryBegin(NULL, 0, lineType);
+        if (lineType != UconfigKeyValue::Comment)
+            handler->onKey(tempKey);
+        if (parsedLen > 0)
+            handler->onKey(tempComment);
+        handler->onEntryEnd();
+        tempKey.reset();
+        tempComment.reset();
+    }
+}
+
 // Parse an expression string of format "KEY=VALUE"
 // Return the number of chars(bytes) that have been parsed
 int UconfigKeyValuePrivate::parseExpKeyValue(const char* expression,
@@ -148,21 +330,25 @@ int UconfigKeyValuePrivate::parseExpKeyValue(const char* expression,
     if (!delimiter)
         delimiter = UCONFIG_IO_KEYVALUE_DELIMITER_KEYVAL;
 
-    // See if the comment delimiter appears in a right place
-    int pos = Uconfig_strpos(expression, delimiter);
-    if (pos <= 0 || pos >= expressionLength)
+    // See if the key-value delimiter appears in a right place
+    const char* delimiterPos = Uconfig_strnstr(expression, delimiter,
+                                               expressionLength);
+    int pos = delimiterPos ? int(delimiterPos - expression) : -1;
+    if (pos <= 0)
         return 0;
 
     key.reset();
 
-    // Extract key name
-    char* keyName = new char[pos + 1];
+    // Extract key name, terminated by "\0" as when set from a string
+    char nameBuffer[UCONFIG_IO_KEYVALUE_NAME_BUFFER];
+    char* keyName = pos < UCONFIG_IO_KEYVALUE_NAME_BUFFER ?
+                    nameBuffer : new char[pos + 1];
     Uconfig_strncpy(keyName, expression, pos);
-    key.setName(keyName);
-    delete keyName;
+    key.setName(keyName, pos + 1);
+    if (keyName != nameBuffer)
+        delete[] keyName;
 
     // Extract value
-    char* pTail;
     int pos2 = pos + strlen(delimiter);
     using ValueType = UconfigIO::ValueType;
     ValueType valueType = UconfigIO::guessValueType(&expression[pos2],
@@ -171,23 +357,31 @@ int UconfigKeyValuePrivate::parseExpKeyValue(const char* expression,
     {
         case ValueType::Chars:
             // Ignore wrapping quotes when storing
-            key.setValue(&expression[pos2 + 1],
-                         expressionLength - pos2 - sizeof(char) * 2);
+            Uconfig_setStringValue(key, &expression[pos2 + 1],
+                                   expressionLength - pos2 -
+                                   sizeof(char) * 2);
             break;
         case ValueType::Integer:
         {
             // Store the number as an "int"
-            int tempInt = int(strtol(&expression[pos2], &pTail, 0));
-            if (pTail > expression)
+            long tempLong;
+            if (Uconfig_parseInteger(&expression[pos2],
+                                     expressionLength - pos2,
+                                     &tempLong) > 0)
+            {
+                int tempInt = int(tempLong);
                 key.setValue((char*)(&tempInt), sizeof(int));
+            }
             break;
         }
         case ValueType::Float:
         case ValueType::Double:
         {
             // Store the number as a "double"
-            double tempDouble = strtod(&expression[pos2], &pTail);
-            if (pTail > expression)
+            double tempDouble;
+            if (Uconfig_parseDouble(&expression[pos2],
+                                    expressionLength - pos2,
+                                    &tempDouble) > 0)
                 key.setValue((char*)(&tempDouble), sizeof(double));
             break;
         }
@@ -216,7 +410,9 @@ int UconfigKeyValuePrivate::parseLineComment(const char* expression,
         delimiter = UCONFIG_IO_KEYVALUE_DELIMITER_COMMENT;
 
     // See if the comment delimiter appears in a right place
-    int pos = Uconfig_strpos(expression, delimiter);
+    const char* delimiterPos = Uconfig_strnstr(expression, delimiter,
+                                               expressionLength);
+    int pos = delimiterPos ? int(delimiterPos - expression) : -1;
     if (pos < 0 ||
         (pos > 0 && expression[pos - 1] != ' ') ||
         pos >= expressionLength - 1)
@@ -231,15 +427,13 @@ int UconfigKeyValuePrivate::parseLineComment(const char* expression,
     return expressionLength - pos;
 }
 
-bool UconfigKeyValuePrivate::fwriteEntry(FILE* file,
-                                         UconfigEntryObject& entry,
-                                         const char* lineDelimiter,
-                                         const char* keyValueDelimiter,
-                                         const char* commentDelimiter)
-{
-    if (entry.subentryCount() < 1)
-        return true;
 
+UconfigKeyValueWriter::UconfigKeyValueWriter(const UconfigSink& sink,
+                                             const char* lineDelimiter,
+                                             const char* keyValueDelimiter,
+                                             const char* commentDelimiter) :
+    UconfigWriter(sink)
+{
     if (!lineDelimiter)
         lineDelimiter = UCONFIG_IO_KEYVALUE_DELIMITER_LINE;
     if (!keyValueDelimiter)
@@ -247,44 +441,52 @@ bool UconfigKeyValuePrivate::fwriteEntry(FILE* file,
     if (!commentDelimiter)
         commentDelimiter = UCONFIG_IO_KEYVALUE_DELIMITER_COMMENT;
 
-    int i, j;
-    int lDLength = strlen(lineDelimiter);
-    int kvDLength = strlen(keyValueDelimiter);
-    int cDLength = strlen(commentDelimiter);
-    UconfigKeyObject* keyList = NULL;
-    UconfigEntryObject* subentryList = entry.subentries();
+    this->lineDelimiter = lineDelimiter;
+    this->keyValueDelimiter = keyValueDelimiter;
+    this->commentDelimiter = commentDelimiter;
+    lineLevel = 1;
+    level = 0;
+    lineType = UconfigKeyValue::Raw;
+    keyIndex = 0;
+}
 
-    for (i=0; i<entry.subentryCount(); i++)
+void UconfigKeyValueWriter::onEntryBegin(const char*, int, int type)
+{
+    level++;
+    if (level == lineLevel)
     {
-        if (subentryList[i].keyCount() > 0)
-        {
-            keyList = subentryList[i].keys();
-            for (j=0; j<subentryList[i].keyCount(); j++)
-            {
-                if (subentryList[i].type() == UconfigKeyValue::KeyVal &&
-                    keyList[j].name())
-                {
-                    fwrite(keyList[j].name(),
-                           sizeof(char),
-                           strlen(keyList[j].name()),
-                           file);
-                    fwrite(keyValueDelimiter, sizeof(char), kvDLength, file);
-                }
-                else if (subentryList[i].type() == UconfigKeyValue::Comment ||
-                         j >= 1)
-                    fwrite(commentDelimiter, sizeof(char), cDLength, file);
-                fwrite(keyList[j].value(),
-                       sizeof(char),
-                       keyList[j].valueSize(),
-                       file);
-            }
-            delete[] keyList;
-        }
+        lineType = type;
+        keyIndex = 0;
+    }
+}
+
+void UconfigKeyValueWriter::onKey(UconfigKeyObject& key)
+{
+    if (level != lineLevel)
+        return;
 
-        fwrite(lineDelimiter, sizeof(char), lDLength, file);
+    if (lineType == UconfigKeyValue::KeyVal && key.name())
+    {
+        output.write(key.name(),
+                     Uconfig_nameLength(key.name(), key.nameSize()));
+        output.write(keyValueDelimiter);
     }
+    else if (lineType == UconfigKeyValue::Comment || keyIndex >= 1)
+        output.write(commentDelimiter);
+    if (key.type() == UconfigIO::Chars)
+        output.write(key.value(),
+                     Uconfig_nameLength(key.value(), key.valueSize()));
+    else
+        output.write(key.value(), key.valueSize());
+    keyIndex++;
+}
 
-    if (subentryList)
-        delete[] subentryList;
-    return true;
+void UconfigKeyValueWriter::onEntryEnd()
+{
+    if (level <= 0)
+        return;
+
+    if (level == lineLevel)
+        output.write(lineDelimiter);
+    level--;
 }
@@ -4,6 +4,9 @@
 #include "uconfigio.h"
 
 
+typedef struct _IO_FILE FILE;
+class UconfigLineIndex;
+
 class UconfigKeyValue : public UconfigIO
 {
 public:
@@ -22,8 +25,52 @@ public:
 
     static bool readUconfig(const char* filename,
                             UconfigFile* config);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config);
     static bool writeUconfig(const char* filename,
                              UconfigFile* config);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler);
+
+    static bool updateUconfig(const char* filename,
+                              UconfigFile* config,
+                              UconfigLineIndex* index);
+    static bool updateUconfig(const char* data,
+                              size_t length,
+                              UconfigFile* config,
+                              UconfigLineIndex* index);
+};
+
+// Write the reported lines (subentries of the root) to a file
+// as soon as they arrive; deeper entries are ignored
+class UconfigKeyValueWriter : public UconfigWriter
+{
+public:
+    UconfigKeyValueWriter(const UconfigSink& sink,
+                          const char* lineDelimiter = NULL,
+                          const char* keyValueDelimiter = NULL,
+                          const char* commentDelimiter = NULL);
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+
+protected:
+    const char* lineDelimiter;
+    const char* keyValueDelimiter;
+    const char* commentDelimiter;
+    int lineLevel; // Depth of the entries written as lines
+    int level;
+    int lineType;
+    int keyIndex;
 };
 
 #endif // UCONFIGKEYVALUE_H
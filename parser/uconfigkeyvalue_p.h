@@ -1,14 +1,33 @@
 #ifndef UCONFIGKEYVALUE_P_H
 #define UCONFIGKEYVALUE_P_H
 
+#include <stddef.h>
+#include <vector>
 #include "uconfigentryobject.h"
 
 
-typedef struct _IO_FILE FILE;
+class UconfigFile;
+class UconfigHandler;
+class UconfigLineIndex;
 
 class UconfigKeyValuePrivate
 {
 public:
+    static void readBuffer(const char* data,
+                           size_t length,
+                           UconfigFile* config,
+                           const char* filename);
+    static void parseBuffer(const char* data,
+                            size_t length,
+                            UconfigHandler* handler);
+    static void updateBuffer(const char* data,
+                             size_t length,
+                             UconfigFile* config,
+                             const char* filename,
+                             UconfigLineIndex* index);
+    static void scanEntries(const char* data,
+                            size_t length,
+                            std::vector<size_t>& offsets);
     static int parseExpKeyValue(const char* expression,
                                 UconfigKeyObject& key,
                                 int expressionLength = 0,
@@ -17,12 +36,6 @@ public:
                                 UconfigKeyObject& key,
                                 int expressionLength = 0,
                                 const char* delimiter = NULL);
-
-    static bool fwriteEntry(FILE* file,
-                            UconfigEntryObject& entry,
-                            const char* lineDelimiter = NULL,
-                            const char* keyValueDelimiter = NULL,
-                            const char* commentDelimiter = NULL);
 };
 
 #endif // UCONFIGKEYVALUE_P_H
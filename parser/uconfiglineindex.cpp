@@ -0,0 +1,200 @@
+#include <string.h>
+#include <algorithm>
+#include "uconfiglineindex.h"
+#include "uconfigentryobject.h"
+
+// Bytes compared at once when searching for the changed range
+#define UCONFIG_LINE_INDEX_BLOCK_SIZE   4096
+
+
+// Length of the common beginning of two blocks of LENGTH bytes
+static size_t Uconfig_commonPrefix(const char* data1,
+                                   const char* data2,
+                                   size_t length)
+{
+    size_t pos = 0;
+    while (pos + UCONFIG_LINE_INDEX_BLOCK_SIZE <= length &&
+           memcmp(&data1[pos], &data2[pos],
+                  UCONFIG_LINE_INDEX_BLOCK_SIZE) == 0)
+        pos += UCONFIG_LINE_INDEX_BLOCK_SIZE;
+    while (pos < length && data1[pos] == data2[pos])
+        pos++;
+    return pos;
+}
+
+// Length of the common end of two blocks, of no more than LENGTH bytes
+static size_t Uconfig_commonSuffix(const char* end1,
+                                   const char* end2,
+                                   size_t length)
+{
+    size_t count = 0;
+    while (count + UCONFIG_LINE_INDEX_BLOCK_SIZE <= length &&
+           memcmp(end1 - count - UCONFIG_LINE_INDEX_BLOCK_SIZE,
+                  end2 - count - UCONFIG_LINE_INDEX_BLOCK_SIZE,
+                  UCONFIG_LINE_INDEX_BLOCK_SIZE) == 0)
+        count += UCONFIG_LINE_INDEX_BLOCK_SIZE;
+    while (count < length && *(end1 - count - 1) == *(end2 - count - 1))
+        count++;
+    return count;
+}
+
+
+UconfigLineIndex::UconfigLineIndex()
+{
+    contentFormat = UconfigConverter::UnknownFormat;
+    lastParsed = 0;
+}
+
+void UconfigLineIndex::clear()
+{
+    content.clear();
+    offsets.clear();
+    contentFormat = UconfigConverter::UnknownFormat;
+    lastParsed = 0;
+}
+
+bool UconfigLineIndex::isEmpty() const
+{
+    return contentFormat == UconfigConverter::UnknownFormat;
+}
+
+UconfigConverter::Format UconfigLineIndex::format() const
+{
+    return contentFormat;
+}
+
+int UconfigLineIndex::entryCount() const
+{
+    return int(offsets.size());
+}
+
+size_t UconfigLineIndex::entryOffset(int index) const
+{
+    if (index < 0 || index >= int(offsets.size()))
+        return 0;
+    return offsets[index];
+}
+
+// Number of entries parsed by the last read or update
+int UconfigLineIndex::parsedCount() const
+{
+    return lastParsed;
+}
+
+// Find the entries to be parsed again for the new content in DATA
+// If FROMSTART is false, the change must not reach the first entry,
+// i.e. the content preceding it is never parsed again.
+// Return false if the content cannot be updated in part.
+bool UconfigLineIndex::findChange(const char* data,
+                                  size_t length,
+                                  bool fromStart,
+                                  UconfigLineChange* change) const
+{
+    if (!data || !change || isEmpty())
+        return false;
+
+    // Unchanged bytes at both ends of the content
+    const char* oldData = content.data();
+    size_t oldLength = content.size();
+    size_t commonLength = std::min(oldLength, length);
+    size_t prefix = Uconfig_commonPrefix(oldData, data, commonLength);
+    if (prefix == oldLength && prefix == length)
+    {
+        change->firstEntry = 0;
+        change->entryCount = 0;
+        change->begin = 0;
+        change->end = 0;
+        return true;
+    }
+    size_t suffix = Uconfig_commonSuffix(oldData + oldLength,
+                                         data + length,
+                                         commonLength - prefix);
+
+    // Entries lying in the unchanged beginning with their delimiter,
+    // i.e. those followed by another entry in it
+    int count = int(offsets.size());
+    int prefixCount = 0;
+    if (count > 0)
+    {
+        prefixCount = int(std::upper_bound(offsets.begin() + 1,
+                                           offsets.end(),
+                                           prefix) - offsets.begin()) - 1;
+        if (prefixCount == count - 1 && prefix >= oldLength)
+            prefixCount = count;
+    }
+
+    // Parse from the last of them, whose beginning is sure to be
+    // a boundary of entries in the new content
+    if (prefixCount > 0)
+    {
+        change->firstEntry = prefixCount - 1;
+        change->begin = offsets[change->firstEntry];
+    }
+    else if (fromStart)
+    {
+        change->firstEntry = 0;
+        change->begin = 0;
+    }
+    else
+        return false;
+
+    // Likewise, keep the entries following the first one beginning
+    // in the unchanged end
+    int suffixEntry = int(std::lower_bound(offsets.begin(), offsets.end(),
+                                           oldLength - suffix) -
+                          offsets.begin());
+    int lastEntry = std::min(suffixEntry + 1, count);
+    change->entryCount = lastEntry - change->firstEntry;
+    if (lastEntry < count)
+        change->end = offsets[lastEntry] + length - oldLength;
+    else
+        change->end = length;
+    return true;
+}
+
+// Replace the entries of CHANGE in CONTAINER with the subentries
+// of ENTRIES, which are parsed from the range of the change and begin
+// at RANGEOFFSETS (counted from the beginning of the range)
+bool UconfigLineIndex::apply(const char* data,
+                             size_t length,
+                             const UconfigLineChange& change,
+                             UconfigEntryRef& container,
+                             UconfigEntryObject& entries,
+                             const std::vector<size_t>& rangeOffsets)
+{
+    int newCount = int(rangeOffsets.size());
+    if (newCount != entries.subentryCount() ||
+        !container.replaceSubentries(change.firstEntry,
+                                     change.entryCount,
+                                     entries))
+        return false;
+
+    // Shift the positions of the entries following the range
+    std::vector<size_t>::iterator first =
+                            offsets.begin() + change.firstEntry;
+    size_t lastIndex = change.firstEntry + change.entryCount;
+    for (size_t i=lastIndex; i<offsets.size(); i++)
+        offsets[i] += length - content.size();
+    if (newCount > change.entryCount)
+        offsets.insert(first, newCount - change.entryCount, 0);
+    else
+        offsets.erase(first, first + change.entryCount - newCount);
+    for (int i=0; i<newCount; i++)
+        offsets[change.firstEntry + i] = change.begin + rangeOffsets[i];
+
+    content.assign(data, data + length);
+    lastParsed = newCount;
+    return true;
+}
+
+// Index the whole content of DATA, whose entries begin at OFFSETS
+void UconfigLineIndex::assign(const char* data,
+                              size_t length,
+                              UconfigConverter::Format format,
+                              const std::vector<size_t>& offsets)
+{
+    content.assign(data, data + length);
+    this->offsets = offsets;
+    contentFormat = format;
+    lastParsed = int(offsets.size());
+}
@@ -0,0 +1,68 @@
+#ifndef UCONFIGLINEINDEX_H
+#define UCONFIGLINEINDEX_H
+
+/*
+ * Index of the entries read from a line-oriented file (key-value, INI or
+ * 2D table), for updating its tree when the file changes without parsing
+ * it again as a whole. It keeps a copy of the content last read, and the
+ * position where each entry of the tree begins.
+ * When the content changes, only the entries overlapping the changed bytes
+ * are parsed again, along with one unchanged entry on each side (so that
+ * entries split or merged by the change are parsed as a whole); they are
+ * then replaced in the tree, and the other entries are kept as they are.
+ * An index is valid as long as its tree is not edited in other ways.
+ */
+
+#include <stddef.h>
+#include <vector>
+#include "uconfigconverter.h"
+
+
+class UconfigEntryRef;
+class UconfigEntryObject;
+
+// Entries of a tree replaced by parsing a range of the new content
+struct UconfigLineChange
+{
+    int firstEntry;
+    int entryCount;
+    size_t begin;
+    size_t end;
+};
+
+class UconfigLineIndex
+{
+public:
+    UconfigLineIndex();
+
+    void clear();
+    bool isEmpty() const;
+
+    UconfigConverter::Format format() const;
+    int entryCount() const;
+    size_t entryOffset(int index) const;
+    int parsedCount() const;
+
+    bool findChange(const char* data,
+                    size_t length,
+                    bool fromStart,
+                    UconfigLineChange* change) const;
+    bool apply(const char* data,
+               size_t length,
+               const UconfigLineChange& change,
+               UconfigEntryRef& container,
+               UconfigEntryObject& entries,
+               const std::vector<size_t>& rangeOffsets);
+    void assign(const char* data,
+                size_t length,
+                UconfigConverter::Format format,
+                const std::vector<size_t>& offsets);
+
+protected:
+    std::vector<char> content;
+    std::vector<size_t> offsets;
+    UconfigConverter::Format contentFormat;
+    int lastParsed;
+};
+
+#endif // UCONFIGLINEINDEX_H
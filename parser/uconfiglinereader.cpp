@@ -0,0 +1,65 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "uconfiglinereader.h"
+
+#define UCONFIG_LINE_CHAR_LF        '\n'
+#define UCONFIG_LINE_CHAR_CR        '\r'
+
+// Chars checked at once for delimiters
+#define UCONFIG_LINE_BLOCK_SIZE     16
+
+
+// Return the position of the first "\n" or "\r" in DATA, or LENGTH
+// if there is none
+static size_t Uconfig_findLineEnd(const char* data, size_t length)
+{
+    size_t pos = 0;
+#ifdef __SSE2__
+    const __m128i lineFeed = _mm_set1_epi8(UCONFIG_LINE_CHAR_LF);
+    const __m128i carriageReturn = _mm_set1_epi8(UCONFIG_LINE_CHAR_CR);
+    while (pos + UCONFIG_LINE_BLOCK_SIZE <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(&data[pos]));
+        int mask = _mm_movemask_epi8(
+                        _mm_or_si128(_mm_cmpeq_epi8(block, lineFeed),
+                                     _mm_cmpeq_epi8(block, carriageReturn)));
+        if (mask)
+            return pos + __builtin_ctz(mask);
+        pos += UCONFIG_LINE_BLOCK_SIZE;
+    }
+#endif
+    while (pos < length &&
+           data[pos] != UCONFIG_LINE_CHAR_LF &&
+           data[pos] != UCONFIG_LINE_CHAR_CR)
+        pos++;
+    return pos;
+}
+
+
+UconfigLineReader::UconfigLineReader(const char* data, size_t length)
+{
+    this->data = data;
+    this->length = data ? length : 0;
+    pos = 0;
+}
+
+// Find the next line; return false at the end of the block
+// A block ending with a delimiter does not end with an empty line.
+bool UconfigLineReader::next(const char** line, int* lineLength)
+{
+    if (pos >= length)
+        return false;
+
+    size_t end = pos + Uconfig_findLineEnd(&data[pos], length - pos);
+    *line = &data[pos];
+    *lineLength = int(end - pos);
+
+    // Skip the delimiter, counting "\r\n" as a single one
+    pos = end + 1;
+    if (end + 1 < length &&
+        data[end] == UCONFIG_LINE_CHAR_CR &&
+        data[end + 1] == UCONFIG_LINE_CHAR_LF)
+        pos++;
+    return true;
+}
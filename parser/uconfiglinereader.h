@@ -0,0 +1,27 @@
+#ifndef UCONFIGLINEREADER_H
+#define UCONFIGLINEREADER_H
+
+/*
+ * Splitter of a block of text (e.g. a mapped file) into lines ending
+ * with "\n", "\r" or "\r\n", in a single scan for both chars.
+ * Lines are returned in place, without their delimiter: they are not
+ * terminated by "\0", and remain valid as long as the block.
+ */
+
+#include <stddef.h>
+
+
+class UconfigLineReader
+{
+public:
+    UconfigLineReader(const char* data, size_t length);
+
+    bool next(const char** line, int* lineLength);
+
+protected:
+    const char* data;
+    size_t length;
+    size_t pos;    // Position of the next line in the block
+};
+
+#endif // UCONFIGLINEREADER_H
@@ -0,0 +1,1002 @@
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#include "uconfignumber.h"
+#include "uconfignumber_p.h"
+
+#define UCONFIG_NUMBER_CHAR_ZERO        '0'
+#define UCONFIG_NUMBER_CHAR_POINT       '.'
+#define UCONFIG_NUMBER_CHAR_PLUS        '+'
+#define UCONFIG_NUMBER_CHAR_MINUS       '-'
+#define UCONFIG_NUMBER_CHAR_EXPONENT    'e'
+#define UCONFIG_NUMBER_CHAR_HEX         'x'
+#define UCONFIG_NUMBER_CHAR_LOWERCASE   0x20
+#define UCONFIG_NUMBER_EXPRESSION_NAN   "nan"
+#define UCONFIG_NUMBER_EXPRESSION_INF   "inf"
+
+// Longest expression copied on the stack before calling strtod()
+#define UCONFIG_NUMBER_EXPRESSION_MAX   128
+
+// Digits always held by a 64-bit integer, and the smallest of them
+#define UCONFIG_NUMBER_DIGITS_MAX       19
+#define UCONFIG_NUMBER_DIGITS_MIN_VALUE 1000000000000000000ULL
+#define UCONFIG_NUMBER_EXPONENT_MAX     100000
+
+// Reals that are computed exactly from their digits with a single
+// multiplication or division (Clinger's fast path)
+#define UCONFIG_NUMBER_EXACT_MANTISSA   (1ULL << 53)
+#define UCONFIG_NUMBER_EXACT_POW10      22
+
+// Layout of doubles and floats
+#define UCONFIG_NUMBER_DOUBLE_MANTISSA  52
+#define UCONFIG_NUMBER_DOUBLE_EXPONENT  11
+#define UCONFIG_NUMBER_DOUBLE_BIAS      1023
+#define UCONFIG_NUMBER_DOUBLE_INFINITY  0x7FF
+#define UCONFIG_NUMBER_FLOAT_MANTISSA   23
+#define UCONFIG_NUMBER_FLOAT_EXPONENT   8
+#define UCONFIG_NUMBER_FLOAT_BIAS       127
+
+// Bits of the tables of powers of five used to write reals
+#define UCONFIG_NUMBER_DOUBLE_INV_BITS  125
+#define UCONFIG_NUMBER_DOUBLE_POW5_BITS 125
+#define UCONFIG_NUMBER_FLOAT_INV_BITS   59
+#define UCONFIG_NUMBER_FLOAT_POW5_BITS  61
+
+// Reals of decimal exponent from -6 to 20 are written without exponent
+#define UCONFIG_NUMBER_FIXED_MIN        -6
+#define UCONFIG_NUMBER_FIXED_MAX        20
+
+// Eight digits are read at once when words are little-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UCONFIG_NUMBER_SWAR
+#endif
+
+// Doubles are computed exactly only without extended precision
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+#define UCONFIG_NUMBER_EXACT_DOUBLE
+#endif
+
+
+static const uint64_t Uconfig_integerPowersOf10[] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+static const double Uconfig_powersOf10[] =
+{
+    1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+    1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22
+};
+
+static const char Uconfig_digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+static uint64_t Uconfig_multiply(uint64_t a, uint64_t b, uint64_t* high);
+static int Uconfig_leadingZeros(uint64_t value);
+static int Uconfig_digitValue(char c);
+#ifdef UCONFIG_NUMBER_SWAR
+static bool Uconfig_isEightDigits(uint64_t chunk);
+static uint32_t Uconfig_eightDigits(uint64_t chunk);
+#endif
+static uint64_t Uconfig_eiselLemire(uint64_t mantissa, int exponent);
+static double Uconfig_strtod(const char* expression, int length);
+static int Uconfig_writeDigits(char* buffer, uint64_t value);
+static int Uconfig_writeSpecial(char* buffer, bool negative, bool isNaN);
+static int Uconfig_writeDecimal(char* buffer,
+                                bool negative,
+                                uint64_t digits,
+                                int exponent);
+static int Uconfig_pow5Bits(int exponent);
+static int Uconfig_log10Pow2(int exponent);
+static int Uconfig_log10Pow5(int exponent);
+static bool Uconfig_isMultipleOfPow5(uint64_t value, int exponent);
+static bool Uconfig_isMultipleOfPow2(uint64_t value, int exponent);
+static uint64_t Uconfig_mulShift64(uint64_t m, const uint64_t* factor, int shift);
+static uint32_t Uconfig_mulShift32(uint32_t m, uint64_t factor, int shift);
+static void Uconfig_shortestDouble(uint64_t bits,
+                                   uint64_t* digits,
+                                   int* exponent);
+static void Uconfig_shortestFloat(uint32_t bits,
+                                  uint32_t* digits,
+                                  int* exponent);
+
+
+int Uconfig_parseDigits(const char* expression,
+                        int length,
+                        uint64_t* value)
+{
+    uint64_t result = 0;
+    int pos = 0;
+#ifdef UCONFIG_NUMBER_SWAR
+    uint64_t chunk;
+    while (length - pos >= 8)
+    {
+        memcpy(&chunk, &expression[pos], sizeof(chunk));
+        if (!Uconfig_isEightDigits(chunk))
+            break;
+        result = result * 100000000 + Uconfig_eightDigits(chunk);
+        pos += 8;
+    }
+#endif
+
+    unsigned int digit;
+    while (pos < length)
+    {
+        digit = (unsigned char)(expression[pos]) - UCONFIG_NUMBER_CHAR_ZERO;
+        if (digit > 9)
+            break;
+        result = result * 10 + digit;
+        pos++;
+    }
+
+    *value = result;
+    return pos;
+}
+
+int Uconfig_parseInteger(const char* expression, int length, long* value)
+{
+    int pos = 0;
+    bool negative = false;
+    if (length > 0 && (expression[0] == UCONFIG_NUMBER_CHAR_PLUS ||
+                       expression[0] == UCONFIG_NUMBER_CHAR_MINUS))
+    {
+        negative = expression[0] == UCONFIG_NUMBER_CHAR_MINUS;
+        pos++;
+    }
+    if (pos >= length || Uconfig_digitValue(expression[pos]) > 9)
+        return 0;
+
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    int digit;
+    if (expression[pos] != UCONFIG_NUMBER_CHAR_ZERO)
+    {
+        // Decimal number: only 20 digits or more can overflow 64 bits
+        int digitCount = Uconfig_parseDigits(&expression[pos], length - pos,
+                                             &magnitude);
+        overflow = digitCount > UCONFIG_NUMBER_DIGITS_MAX;
+        pos += digitCount;
+    }
+    else if (pos + 2 < length &&
+             (expression[pos + 1] | UCONFIG_NUMBER_CHAR_LOWERCASE) ==
+                UCONFIG_NUMBER_CHAR_HEX &&
+             Uconfig_digitValue(expression[pos + 2]) < 16)
+    {
+        // Hexadecimal number
+        pos += 2;
+        while (pos < length &&
+               (digit = Uconfig_digitValue(expression[pos])) < 16)
+        {
+            overflow |= (magnitude >> 60) != 0;
+            magnitude = (magnitude << 4) | uint64_t(digit);
+            pos++;
+        }
+    }
+    else
+    {
+        // Octal number (or a single zero)
+        while (pos < length &&
+               (digit = Uconfig_digitValue(expression[pos])) < 8)
+        {
+            overflow |= (magnitude >> 61) != 0;
+            magnitude = (magnitude << 3) | uint64_t(digit);
+            pos++;
+        }
+    }
+
+    uint64_t limit = negative ? uint64_t(LONG_MAX) + 1 : uint64_t(LONG_MAX);
+    if (overflow || magnitude > limit)
+        magnitude = limit;
+    *value = negative ? long(0 - magnitude) : long(magnitude);
+    return pos;
+}
+
+int Uconfig_parseDouble(const char* expression, int length, double* value)
+{
+    int pos = 0;
+    bool negative = false;
+    if (length > 0 && (expression[0] == UCONFIG_NUMBER_CHAR_PLUS ||
+                       expression[0] == UCONFIG_NUMBER_CHAR_MINUS))
+    {
+        negative = expression[0] == UCONFIG_NUMBER_CHAR_MINUS;
+        pos++;
+    }
+
+    // Digits of the integral part, then of the fractional part,
+    // as a single integer as long as they fit
+    uint64_t mantissa;
+    int integerBegin = pos;
+    pos += Uconfig_parseDigits(&expression[pos], length - pos, &mantissa);
+    int integerEnd = pos;
+    int fractionBegin = pos;
+    int fractionEnd = pos;
+    if (pos < length && expression[pos] == UCONFIG_NUMBER_CHAR_POINT)
+    {
+        uint64_t fraction;
+        fractionBegin = pos + 1;
+        fractionEnd = fractionBegin +
+                      Uconfig_parseDigits(&expression[fractionBegin],
+                                          length - fractionBegin,
+                                          &fraction);
+        if (fractionEnd - fractionBegin <= UCONFIG_NUMBER_DIGITS_MAX)
+            mantissa = mantissa *
+                       Uconfig_integerPowersOf10[fractionEnd - fractionBegin] +
+                       fraction;
+        pos = fractionEnd;
+    }
+    int digitCount = (integerEnd - integerBegin) +
+                     (fractionEnd - fractionBegin);
+    if (digitCount == 0)
+        return 0;
+
+    // An exponent is only read if it has digits
+    int exponent = 0;
+    if (pos < length &&
+        (expression[pos] | UCONFIG_NUMBER_CHAR_LOWERCASE) ==
+            UCONFIG_NUMBER_CHAR_EXPONENT)
+    {
+        int exponentPos = pos + 1;
+        bool negativeExponent = false;
+        if (exponentPos < length &&
+            (expression[exponentPos] == UCONFIG_NUMBER_CHAR_PLUS ||
+             expression[exponentPos] == UCONFIG_NUMBER_CHAR_MINUS))
+        {
+            negativeExponent =
+                        expression[exponentPos] == UCONFIG_NUMBER_CHAR_MINUS;
+            exponentPos++;
+        }
+        if (exponentPos < length &&
+            Uconfig_digitValue(expression[exponentPos]) <= 9)
+        {
+            while (exponentPos < length &&
+                   Uconfig_digitValue(expression[exponentPos]) <= 9)
+            {
+                if (exponent < UCONFIG_NUMBER_EXPONENT_MAX)
+                    exponent = exponent * 10 +
+                               Uconfig_digitValue(expression[exponentPos]);
+                exponentPos++;
+            }
+            if (negativeExponent)
+                exponent = -exponent;
+            pos = exponentPos;
+        }
+    }
+
+    // Keep the first 19 significant digits of longer numbers
+    bool truncated = false;
+    int explicitExponent = exponent;
+    exponent -= fractionEnd - fractionBegin;
+    if (digitCount > UCONFIG_NUMBER_DIGITS_MAX)
+    {
+        // Leading zeros are not significant
+        int p = integerBegin;
+        while (p < fractionEnd &&
+               (expression[p] == UCONFIG_NUMBER_CHAR_ZERO ||
+                expression[p] == UCONFIG_NUMBER_CHAR_POINT))
+        {
+            if (expression[p] == UCONFIG_NUMBER_CHAR_ZERO)
+                digitCount--;
+            p++;
+        }
+        if (digitCount <= UCONFIG_NUMBER_DIGITS_MAX)
+        {
+            // All the digits fit, but not in a single pass
+            mantissa = 0;
+            for (; p < fractionEnd; p++)
+            {
+                if (expression[p] != UCONFIG_NUMBER_CHAR_POINT)
+                    mantissa = mantissa * 10 +
+                               Uconfig_digitValue(expression[p]);
+            }
+        }
+    }
+    if (digitCount > UCONFIG_NUMBER_DIGITS_MAX)
+    {
+        truncated = true;
+        mantissa = 0;
+        int p = integerBegin;
+        while (mantissa < UCONFIG_NUMBER_DIGITS_MIN_VALUE && p < integerEnd)
+            mantissa = mantissa * 10 + Uconfig_digitValue(expression[p++]);
+        if (mantissa >= UCONFIG_NUMBER_DIGITS_MIN_VALUE)
+            exponent = integerEnd - p + explicitExponent;
+        else
+        {
+            p = fractionBegin;
+            while (mantissa < UCONFIG_NUMBER_DIGITS_MIN_VALUE &&
+                   p < fractionEnd)
+                mantissa = mantissa * 10 +
+                           Uconfig_digitValue(expression[p++]);
+            exponent = fractionBegin - p + explicitExponent;
+        }
+    }
+
+#ifdef UCONFIG_NUMBER_EXACT_DOUBLE
+    if (!truncated &&
+        mantissa <= UCONFIG_NUMBER_EXACT_MANTISSA &&
+        exponent >= -UCONFIG_NUMBER_EXACT_POW10 &&
+        exponent <= UCONFIG_NUMBER_EXACT_POW10)
+    {
+        double result = double(mantissa);
+        if (exponent < 0)
+            result /= Uconfig_powersOf10[-exponent];
+        else
+            result *= Uconfig_powersOf10[exponent];
+        *value = negative ? -result : result;
+        return pos;
+    }
+#endif
+
+    // Dropped digits may round the number either way
+    uint64_t bits = Uconfig_eiselLemire(mantissa, exponent);
+    if (truncated && bits != Uconfig_eiselLemire(mantissa + 1, exponent))
+    {
+        *value = Uconfig_strtod(expression, pos);
+        return pos;
+    }
+
+    if (negative)
+        bits |= 1ULL << 63;
+    memcpy(value, &bits, sizeof(double));
+    return pos;
+}
+
+int Uconfig_formatInteger(char* buffer, long value)
+{
+    uint64_t magnitude = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+
+    int length = 0;
+    if (value < 0)
+        buffer[length++] = UCONFIG_NUMBER_CHAR_MINUS;
+    return length + Uconfig_writeDigits(&buffer[length], magnitude);
+}
+
+int Uconfig_formatDouble(char* buffer, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    bool negative = (bits >> 63) != 0;
+    int exponentBits = int(bits >> UCONFIG_NUMBER_DOUBLE_MANTISSA) &
+                       ((1 << UCONFIG_NUMBER_DOUBLE_EXPONENT) - 1);
+    uint64_t mantissaBits = bits &
+                            ((1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA) - 1);
+
+    if (exponentBits == (1 << UCONFIG_NUMBER_DOUBLE_EXPONENT) - 1)
+        return Uconfig_writeSpecial(buffer, negative, mantissaBits != 0);
+    if (exponentBits == 0 && mantissaBits == 0)
+        return Uconfig_writeDecimal(buffer, negative, 0, 0);
+
+    uint64_t digits;
+    int exponent;
+    Uconfig_shortestDouble(bits, &digits, &exponent);
+    return Uconfig_writeDecimal(buffer, negative, digits, exponent);
+}
+
+int Uconfig_formatFloat(char* buffer, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    bool negative = (bits >> 31) != 0;
+    int exponentBits = int(bits >> UCONFIG_NUMBER_FLOAT_MANTISSA) &
+                       ((1 << UCONFIG_NUMBER_FLOAT_EXPONENT) - 1);
+    uint32_t mantissaBits = bits &
+                            ((1U << UCONFIG_NUMBER_FLOAT_MANTISSA) - 1);
+
+    if (exponentBits == (1 << UCONFIG_NUMBER_FLOAT_EXPONENT) - 1)
+        return Uconfig_writeSpecial(buffer, negative, mantissaBits != 0);
+    if (exponentBits == 0 && mantissaBits == 0)
+        return Uconfig_writeDecimal(buffer, negative, 0, 0);
+
+    uint32_t digits;
+    int exponent;
+    Uconfig_shortestFloat(bits, &digits, &exponent);
+    return Uconfig_writeDecimal(buffer, negative, digits, exponent);
+}
+
+
+// Full product of two 64-bit integers: return the low word,
+// and store the high word in *HIGH
+uint64_t Uconfig_multiply(uint64_t a, uint64_t b, uint64_t* high)
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)(a) * b;
+    *high = uint64_t(product >> 64);
+    return uint64_t(product);
+#else
+    uint64_t aLow = a & 0xFFFFFFFF;
+    uint64_t aHigh = a >> 32;
+    uint64_t bLow = b & 0xFFFFFFFF;
+    uint64_t bHigh = b >> 32;
+    uint64_t lowLow = aLow * bLow;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+    *high = aHigh * bHigh + (highLow >> 32) + (middle >> 32);
+    return (middle << 32) | (lowLow & 0xFFFFFFFF);
+#endif
+}
+
+int Uconfig_leadingZeros(uint64_t value)
+{
+#ifdef __GNUC__
+    return __builtin_clzll(value);
+#else
+    int count = 0;
+    while (!(value & (1ULL << 63)))
+    {
+        value <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Value of a decimal or hexadecimal digit; 16 or more for other chars
+int Uconfig_digitValue(char c)
+{
+    unsigned int digit = (unsigned char)(c) - UCONFIG_NUMBER_CHAR_ZERO;
+    if (digit <= 9)
+        return int(digit);
+    digit = ((unsigned char)(c) | UCONFIG_NUMBER_CHAR_LOWERCASE) - 'a';
+    return digit < 6 ? int(digit) + 10 : 16;
+}
+
+#ifdef UCONFIG_NUMBER_SWAR
+// Check the eight chars of a word at once: their high nibble must be 3,
+// and adding 6 to them must not carry into it
+bool Uconfig_isEightDigits(uint64_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+           == 0x3333333333333333ULL;
+}
+
+// Combine eight digits into pairs, then into fours, then into the value
+uint32_t Uconfig_eightDigits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t factor100 = 100 + (1000000ULL << 32);
+    const uint64_t factor1 = 1 + (10000ULL << 32);
+
+    chunk -= 0x3030303030303030ULL;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = ((chunk & mask) * factor100 +
+             ((chunk >> 16) & mask) * factor1) >> 32;
+    return uint32_t(chunk);
+}
+#endif
+
+// Bits of the double nearest to MANTISSA * 10^EXPONENT (without sign),
+// from the product of the mantissa with a truncated power of five
+// The product is always precise enough for a mantissa of 19 digits.
+uint64_t Uconfig_eiselLemire(uint64_t mantissa, int exponent)
+{
+    if (mantissa == 0 || exponent < UCONFIG_NUMBER_POW5_MIN)
+        return 0;
+    if (exponent > UCONFIG_NUMBER_POW5_MAX)
+        return uint64_t(UCONFIG_NUMBER_DOUBLE_INFINITY) <<
+               UCONFIG_NUMBER_DOUBLE_MANTISSA;
+
+    int leadingZeros = Uconfig_leadingZeros(mantissa);
+    mantissa <<= leadingZeros;
+
+    // Only the high word of the product is needed, with 55 exact bits;
+    // the low word of the power is used if the first ones may carry
+    const uint64_t* power =
+                &Uconfig_powersOf5[2 * (exponent - UCONFIG_NUMBER_POW5_MIN)];
+    const uint64_t precisionMask = ~0ULL >> (UCONFIG_NUMBER_DOUBLE_MANTISSA + 3);
+    uint64_t high;
+    uint64_t low = Uconfig_multiply(mantissa, power[0], &high);
+    if ((high & precisionMask) == precisionMask)
+    {
+        uint64_t high2;
+        Uconfig_multiply(mantissa, power[1], &high2);
+        low += high2;
+        if (high2 > low)
+            high++;
+    }
+
+    int upperBit = int(high >> 63);
+    int shift = upperBit + 64 - UCONFIG_NUMBER_DOUBLE_MANTISSA - 3;
+    uint64_t result = high >> shift;
+    int power2 = (((152170 + 65536) * exponent) >> 16) + 63 +
+                 upperBit - leadingZeros + UCONFIG_NUMBER_DOUBLE_BIAS;
+
+    if (power2 <= 0)
+    {
+        // Subnormal number, which may be rounded up to a normal one
+        if (-power2 + 1 >= 64)
+            return 0;
+        result >>= -power2 + 1;
+        result += result & 1;
+        result >>= 1;
+        power2 = result < (1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA) ? 0 : 1;
+        return result | (uint64_t(power2) << UCONFIG_NUMBER_DOUBLE_MANTISSA);
+    }
+
+    // Exactly halfway between two doubles: round to even
+    if (low <= 1 && exponent >= -4 && exponent <= 23 && (result & 3) == 1 &&
+        (result << shift) == high)
+        result &= ~1ULL;
+
+    result += result & 1;
+    result >>= 1;
+    if (result >= (2ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA))
+    {
+        result = 1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA;
+        power2++;
+    }
+    result &= ~(1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA);
+    if (power2 >= UCONFIG_NUMBER_DOUBLE_INFINITY)
+        return uint64_t(UCONFIG_NUMBER_DOUBLE_INFINITY) <<
+               UCONFIG_NUMBER_DOUBLE_MANTISSA;
+    return result | (uint64_t(power2) << UCONFIG_NUMBER_DOUBLE_MANTISSA);
+}
+
+// Read a real with strtod() in the "C" locale, from a copy of LENGTH chars
+double Uconfig_strtod(const char* expression, int length)
+{
+    char buffer[UCONFIG_NUMBER_EXPRESSION_MAX];
+    char* copy = length < UCONFIG_NUMBER_EXPRESSION_MAX ?
+                 buffer : (char*)(malloc(length + 1));
+    if (!copy)
+        return 0;
+    memcpy(copy, expression, length);
+    copy[length] = '\0';
+
+#ifdef WIN32
+    static _locale_t locale = _create_locale(LC_NUMERIC, "C");
+    double result = _strtod_l(copy, NULL, locale);
+#else
+    static locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)(0));
+    double result = strtod_l(copy, NULL, locale);
+#endif
+
+    if (copy != buffer)
+        free(copy);
+    return result;
+}
+
+// Write the decimal digits of VALUE, two at a time
+int Uconfig_writeDigits(char* buffer, uint64_t value)
+{
+    char digits[UCONFIG_NUMBER_DIGITS_MAX + 1];
+    int pos = sizeof(digits);
+    while (value >= 100)
+    {
+        int pair = int(value % 100) * 2;
+        value /= 100;
+        digits[--pos] = Uconfig_digitPairs[pair + 1];
+        digits[--pos] = Uconfig_digitPairs[pair];
+    }
+    if (value >= 10)
+    {
+        digits[--pos] = Uconfig_digitPairs[value * 2 + 1];
+        digits[--pos] = Uconfig_digitPairs[value * 2];
+    }
+    else
+        digits[--pos] = char(UCONFIG_NUMBER_CHAR_ZERO + value);
+
+    int length = int(sizeof(digits)) - pos;
+    memcpy(buffer, &digits[pos], length);
+    return length;
+}
+
+int Uconfig_writeSpecial(char* buffer, bool negative, bool isNaN)
+{
+    int length = 0;
+    if (negative && !isNaN)
+        buffer[length++] = UCONFIG_NUMBER_CHAR_MINUS;
+    const char* expression = isNaN ? UCONFIG_NUMBER_EXPRESSION_NAN :
+                                     UCONFIG_NUMBER_EXPRESSION_INF;
+    memcpy(&buffer[length], expression, strlen(expression));
+    return length + strlen(expression);
+}
+
+// Write DIGITS * 10^EXPONENT, with a point or an exponent in any case,
+// e.g. "15.0", "0.001", "1.5e+21"
+int Uconfig_writeDecimal(char* buffer,
+                         bool negative,
+                         uint64_t digits,
+                         int exponent)
+{
+    char text[UCONFIG_NUMBER_DIGITS_MAX + 1];
+    int count = Uconfig_writeDigits(text, digits);
+    int scientific = count + exponent - 1;
+
+    int length = 0;
+    if (negative)
+        buffer[length++] = UCONFIG_NUMBER_CHAR_MINUS;
+
+    if (scientific < UCONFIG_NUMBER_FIXED_MIN ||
+        scientific > UCONFIG_NUMBER_FIXED_MAX)
+    {
+        buffer[length++] = text[0];
+        if (count > 1)
+        {
+            buffer[length++] = UCONFIG_NUMBER_CHAR_POINT;
+            memcpy(&buffer[length], &text[1], count - 1);
+            length += count - 1;
+        }
+        buffer[length++] = UCONFIG_NUMBER_CHAR_EXPONENT;
+        buffer[length++] = scientific < 0 ? UCONFIG_NUMBER_CHAR_MINUS :
+                                            UCONFIG_NUMBER_CHAR_PLUS;
+        length += Uconfig_writeDigits(&buffer[length],
+                                      scientific < 0 ? -scientific :
+                                                       scientific);
+    }
+    else if (scientific < 0)
+    {
+        buffer[length++] = UCONFIG_NUMBER_CHAR_ZERO;
+        buffer[length++] = UCONFIG_NUMBER_CHAR_POINT;
+        memset(&buffer[length], UCONFIG_NUMBER_CHAR_ZERO, -scientific - 1);
+        length += -scientific - 1;
+        memcpy(&buffer[length], text, count);
+        length += count;
+    }
+    else if (scientific < count - 1)
+    {
+        memcpy(&buffer[length], text, scientific + 1);
+        length += scientific + 1;
+        buffer[length++] = UCONFIG_NUMBER_CHAR_POINT;
+        memcpy(&buffer[length], &text[scientific + 1], count - scientific - 1);
+        length += count - scientific - 1;
+    }
+    else
+    {
+        memcpy(&buffer[length], text, count);
+        length += count;
+        memset(&buffer[length], UCONFIG_NUMBER_CHAR_ZERO, exponent);
+        length += exponent;
+        buffer[length++] = UCONFIG_NUMBER_CHAR_POINT;
+        buffer[length++] = UCONFIG_NUMBER_CHAR_ZERO;
+    }
+    return length;
+}
+
+// Number of bits of 5^EXPONENT (1 for 5^0)
+int Uconfig_pow5Bits(int exponent)
+{
+    return ((exponent * 1217359) >> 19) + 1;
+}
+
+// Floor of log10(2^EXPONENT)
+int Uconfig_log10Pow2(int exponent)
+{
+    return (exponent * 78913) >> 18;
+}
+
+// Floor of log10(5^EXPONENT)
+int Uconfig_log10Pow5(int exponent)
+{
+    return (exponent * 732923) >> 20;
+}
+
+bool Uconfig_isMultipleOfPow5(uint64_t value, int exponent)
+{
+    int count = 0;
+    while (value > 0 && value % 5 == 0)
+    {
+        value /= 5;
+        count++;
+    }
+    return count >= exponent;
+}
+
+bool Uconfig_isMultipleOfPow2(uint64_t value, int exponent)
+{
+    return (value & ((1ULL << exponent) - 1)) == 0;
+}
+
+// Bits of M * FACTOR >> SHIFT, where FACTOR is a 128-bit number
+// given as its (low, high) words, and SHIFT is between 64 and 128
+uint64_t Uconfig_mulShift64(uint64_t m, const uint64_t* factor, int shift)
+{
+    uint64_t high0;
+    uint64_t high1;
+    Uconfig_multiply(m, factor[0], &high0);
+    uint64_t low1 = Uconfig_multiply(m, factor[1], &high1);
+    uint64_t sum = high0 + low1;
+    if (sum < high0)
+        high1++;
+    shift -= 64;
+    return (high1 << (64 - shift)) | (sum >> shift);
+}
+
+uint32_t Uconfig_mulShift32(uint32_t m, uint64_t factor, int shift)
+{
+    uint64_t low = uint64_t(m) * uint32_t(factor);
+    uint64_t high = uint64_t(m) * uint32_t(factor >> 32);
+    return uint32_t(((low >> 32) + high) >> (shift - 32));
+}
+
+// Shortest digits of a finite, non-zero double such that
+// DIGITS * 10^EXPONENT reads back the same double, the nearest to the
+// double being chosen among them (Ryu algorithm, by Ulf Adams)
+void Uconfig_shortestDouble(uint64_t bits, uint64_t* digits, int* exponent)
+{
+    uint64_t mantissaBits = bits &
+                            ((1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA) - 1);
+    int exponentBits = int(bits >> UCONFIG_NUMBER_DOUBLE_MANTISSA) &
+                       ((1 << UCONFIG_NUMBER_DOUBLE_EXPONENT) - 1);
+
+    int e2;
+    uint64_t m2;
+    if (exponentBits == 0)
+    {
+        e2 = 1 - UCONFIG_NUMBER_DOUBLE_BIAS - UCONFIG_NUMBER_DOUBLE_MANTISSA - 2;
+        m2 = mantissaBits;
+    }
+    else
+    {
+        e2 = exponentBits - UCONFIG_NUMBER_DOUBLE_BIAS -
+             UCONFIG_NUMBER_DOUBLE_MANTISSA - 2;
+        m2 = (1ULL << UCONFIG_NUMBER_DOUBLE_MANTISSA) | mantissaBits;
+    }
+    bool acceptBounds = (m2 & 1) == 0;
+
+    // Bounds of the interval of the decimals that read back the double
+    uint64_t mv = 4 * m2;
+    int mmShift = mantissaBits != 0 || exponentBits <= 1;
+
+    // Scale them to a power of ten
+    uint64_t vr, vp, vm;
+    int e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    if (e2 >= 0)
+    {
+        int q = Uconfig_log10Pow2(e2) - (e2 > 3);
+        e10 = q;
+        int k = UCONFIG_NUMBER_DOUBLE_INV_BITS + Uconfig_pow5Bits(q) - 1;
+        int i = -e2 + q + k;
+        const uint64_t* factor = &Uconfig_doubleInversePowersOf5[2 * q];
+        vr = Uconfig_mulShift64(mv, factor, i);
+        vp = Uconfig_mulShift64(mv + 2, factor, i);
+        vm = Uconfig_mulShift64(mv - 1 - mmShift, factor, i);
+        if (q <= 21)
+        {
+            // Only one of mp, mv and mm can be a multiple of 5, if any
+            if (mv % 5 == 0)
+                vrIsTrailingZeros = Uconfig_isMultipleOfPow5(mv, q);
+            else if (acceptBounds)
+                vmIsTrailingZeros =
+                        Uconfig_isMultipleOfPow5(mv - 1 - mmShift, q);
+            else
+                vp -= Uconfig_isMultipleOfPow5(mv + 2, q);
+        }
+    }
+    else
+    {
+        int q = Uconfig_log10Pow5(-e2) - (-e2 > 1);
+        e10 = q + e2;
+        int i = -e2 - q;
+        int k = Uconfig_pow5Bits(i) - UCONFIG_NUMBER_DOUBLE_POW5_BITS;
+        int j = q - k;
+        const uint64_t* factor = &Uconfig_doublePowersOf5[2 * i];
+        vr = Uconfig_mulShift64(mv, factor, j);
+        vp = Uconfig_mulShift64(mv + 2, factor, j);
+        vm = Uconfig_mulShift64(mv - 1 - mmShift, factor, j);
+        if (q <= 1)
+        {
+            // mv = 4 * m2 has at least two trailing zero bits
+            vrIsTrailingZeros = true;
+            if (acceptBounds)
+                vmIsTrailingZeros = mmShift == 1;
+            else
+                vp--;
+        }
+        else if (q < 63)
+            vrIsTrailingZeros = Uconfig_isMultipleOfPow2(mv, q);
+    }
+
+    // Remove the digits shared by both bounds
+    int removed = 0;
+    int lastRemovedDigit = 0;
+    uint64_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros)
+    {
+        while (vp / 10 > vm / 10)
+        {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = int(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = int(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // Round to even if the exact number is .....50..0
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+            lastRemovedDigit = 4;
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) ||
+                       lastRemovedDigit >= 5);
+    }
+    else
+    {
+        bool roundUp = false;
+        if (vp / 100 > vm / 100)
+        {
+            roundUp = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10)
+        {
+            roundUp = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || roundUp);
+    }
+
+    *digits = output;
+    *exponent = e10 + removed;
+}
+
+// Same as Uconfig_shortestDouble() for floats
+void Uconfig_shortestFloat(uint32_t bits, uint32_t* digits, int* exponent)
+{
+    uint32_t mantissaBits = bits & ((1U << UCONFIG_NUMBER_FLOAT_MANTISSA) - 1);
+    int exponentBits = int(bits >> UCONFIG_NUMBER_FLOAT_MANTISSA) &
+                       ((1 << UCONFIG_NUMBER_FLOAT_EXPONENT) - 1);
+
+    int e2;
+    uint32_t m2;
+    if (exponentBits == 0)
+    {
+        e2 = 1 - UCONFIG_NUMBER_FLOAT_BIAS - UCONFIG_NUMBER_FLOAT_MANTISSA - 2;
+        m2 = mantissaBits;
+    }
+    else
+    {
+        e2 = exponentBits - UCONFIG_NUMBER_FLOAT_BIAS -
+             UCONFIG_NUMBER_FLOAT_MANTISSA - 2;
+        m2 = (1U << UCONFIG_NUMBER_FLOAT_MANTISSA) | mantissaBits;
+    }
+    bool acceptBounds = (m2 & 1) == 0;
+
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mmShift = mantissaBits != 0 || exponentBits <= 1;
+    uint32_t mm = 4 * m2 - 1 - mmShift;
+
+    uint32_t vr, vp, vm;
+    int e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    int lastRemovedDigit = 0;
+    if (e2 >= 0)
+    {
+        int q = Uconfig_log10Pow2(e2);
+        e10 = q;
+        int k = UCONFIG_NUMBER_FLOAT_INV_BITS + Uconfig_pow5Bits(q) - 1;
+        int i = -e2 + q + k;
+        uint64_t factor = Uconfig_floatInversePowersOf5[q];
+        vr = Uconfig_mulShift32(mv, factor, i);
+        vp = Uconfig_mulShift32(mp, factor, i);
+        vm = Uconfig_mulShift32(mm, factor, i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            // One removed digit is needed even if no digit is removed below
+            int l = UCONFIG_NUMBER_FLOAT_INV_BITS + Uconfig_pow5Bits(q - 1) - 1;
+            lastRemovedDigit =
+                int(Uconfig_mulShift32(mv, Uconfig_floatInversePowersOf5[q - 1],
+                                       -e2 + q - 1 + l) % 10);
+        }
+        if (q <= 9)
+        {
+            if (mv % 5 == 0)
+                vrIsTrailingZeros = Uconfig_isMultipleOfPow5(mv, q);
+            else if (acceptBounds)
+                vmIsTrailingZeros = Uconfig_isMultipleOfPow5(mm, q);
+            else
+                vp -= Uconfig_isMultipleOfPow5(mp, q);
+        }
+    }
+    else
+    {
+        int q = Uconfig_log10Pow5(-e2);
+        e10 = q + e2;
+        int i = -e2 - q;
+        int k = Uconfig_pow5Bits(i) - UCONFIG_NUMBER_FLOAT_POW5_BITS;
+        int j = q - k;
+        uint64_t factor = Uconfig_floatPowersOf5[i];
+        vr = Uconfig_mulShift32(mv, factor, j);
+        vp = Uconfig_mulShift32(mp, factor, j);
+        vm = Uconfig_mulShift32(mm, factor, j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10)
+        {
+            j = q - 1 - (Uconfig_pow5Bits(i + 1) -
+                         UCONFIG_NUMBER_FLOAT_POW5_BITS);
+            lastRemovedDigit =
+                int(Uconfig_mulShift32(mv, Uconfig_floatPowersOf5[i + 1], j) %
+                    10);
+        }
+        if (q <= 1)
+        {
+            vrIsTrailingZeros = true;
+            if (acceptBounds)
+                vmIsTrailingZeros = mmShift == 1;
+            else
+                vp--;
+        }
+        else if (q < 31)
+            vrIsTrailingZeros = Uconfig_isMultipleOfPow2(mv, q - 1);
+    }
+
+    int removed = 0;
+    uint32_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros)
+    {
+        while (vp / 10 > vm / 10)
+        {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = int(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros)
+        {
+            while (vm % 10 == 0)
+            {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = int(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+            lastRemovedDigit = 4;
+        output = vr + ((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) ||
+                       lastRemovedDigit >= 5);
+    }
+    else
+    {
+        while (vp / 10 > vm / 10)
+        {
+            lastRemovedDigit = int(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || lastRemovedDigit >= 5);
+    }
+
+    *digits = output;
+    *exponent = e10 + removed;
+}
@@ -0,0 +1,50 @@
+#ifndef UCONFIGNUMBER_H
+#define UCONFIGNUMBER_H
+
+/*
+ * Conversion of numbers from and to text, shared by all the parsers
+ * and writers, and independent of the locale.
+ * Numbers are read as strtol() (with base 0) and strtod() read them
+ * in the "C" locale, with eight digits at a time, except hexadecimal
+ * reals, infinities and NaNs, which are not read. Reals are rounded
+ * correctly with the Eisel-Lemire algorithm; the rare numbers that it
+ * cannot decide (with more than 19 significant digits) are passed
+ * to strtod() in the "C" locale.
+ * Reals are written with the shortest digits that read back the same
+ * value (Ryu algorithm), with a point or an exponent in any case.
+ */
+
+#include <stdint.h>
+
+// Longest text written for a number
+#define UCONFIG_NUMBER_LENGTH_MAX       32
+
+
+// Read up to LENGTH decimal digits; return the number of digits read
+// The value wraps around if the digits do not fit in 64 bits.
+extern int Uconfig_parseDigits(const char* expression,
+                               int length,
+                               uint64_t* value);
+
+// Read an integer at the beginning of an expression of LENGTH chars,
+// with an optional sign, in octal if it begins with "0" and in
+// hexadecimal if it begins with "0x"; values out of range are clamped
+// Return the number of chars read, or 0 if there is no number.
+extern int Uconfig_parseInteger(const char* expression,
+                                int length,
+                                long* value);
+
+// Read a real at the beginning of an expression of LENGTH chars,
+// with an optional sign, a point and an exponent
+// Return the number of chars read, or 0 if there is no number.
+extern int Uconfig_parseDouble(const char* expression,
+                               int length,
+                               double* value);
+
+// Write a number into BUFFER, which must hold UCONFIG_NUMBER_LENGTH_MAX
+// chars; no "\0" is appended. Return the number of chars written.
+extern int Uconfig_formatInteger(char* buffer, long value);
+extern int Uconfig_formatDouble(char* buffer, double value);
+extern int Uconfig_formatFloat(char* buffer, float value);
+
+#endif // UCONFIGNUMBER_H
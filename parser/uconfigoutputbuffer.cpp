@@ -0,0 +1,296 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include "uconfigoutputbuffer.h"
+#include "uconfignumber.h"
+
+#define UCONFIG_OUTPUT_BUFFER_SIZE          65536
+#define UCONFIG_OUTPUT_MEMORY_SIZE          4096
+#define UCONFIG_OUTPUT_INDENTATION_CHAR     ' '
+#define UCONFIG_OUTPUT_INDENTATION_LENGTH   4
+
+
+UconfigSink::UconfigSink(FILE* file)
+{
+    this->file = file;
+    data = NULL;
+    length = NULL;
+}
+
+UconfigSink::UconfigSink(char** data, size_t* length)
+{
+    file = NULL;
+    this->data = data;
+    this->length = length;
+}
+
+
+// Data are written into the stream with writev() if VECTORED is true
+// and if the stream has a file descriptor; otherwise, with fwrite()
+// When writing into memory, the buffer itself is the block handed over.
+UconfigOutputBuffer::UconfigOutputBuffer(const UconfigSink& sink,
+                                         bool vectored) :
+    sink(sink)
+{
+    file = sink.file;
+    this->vectored = vectored && file && fileno(file) >= 0;
+    capacity = file ? UCONFIG_OUTPUT_BUFFER_SIZE : UCONFIG_OUTPUT_MEMORY_SIZE;
+    buffer = (char*)(malloc(capacity));
+    end = 0;
+    failed = !buffer || (!file && (!sink.data || !sink.length));
+}
+
+UconfigOutputBuffer::~UconfigOutputBuffer()
+{
+    flush();
+    if (!file && sink.data && sink.length)
+    {
+        // The block belongs to the caller, unless a write has failed
+        if (!failed)
+            return;
+        *sink.data = NULL;
+        *sink.length = 0;
+    }
+    free(buffer);
+}
+
+void UconfigOutputBuffer::put(char c)
+{
+    char* pos = reserve(1);
+    if (pos)
+    {
+        *pos = c;
+        end++;
+    }
+}
+
+void UconfigOutputBuffer::write(const char* data, size_t length)
+{
+    if (length > capacity - end)
+    {
+        // Pass large blocks to the stream along with the buffer
+        if (length >= capacity || !file)
+        {
+            flush(data, length);
+            return;
+        }
+        flush();
+    }
+    if (!buffer || length == 0)
+        return;
+
+    memcpy(&buffer[end], data, length);
+    end += length;
+}
+
+void UconfigOutputBuffer::write(const char* string)
+{
+    write(string, strlen(string));
+}
+
+void UconfigOutputBuffer::writeIndentation(int level)
+{
+    while (level > 0)
+    {
+        char* pos = reserve(UCONFIG_OUTPUT_INDENTATION_LENGTH);
+        if (!pos)
+            return;
+
+        memset(pos, UCONFIG_OUTPUT_INDENTATION_CHAR,
+               UCONFIG_OUTPUT_INDENTATION_LENGTH);
+        end += UCONFIG_OUTPUT_INDENTATION_LENGTH;
+        level--;
+    }
+}
+
+int UconfigOutputBuffer::writeInteger(long value)
+{
+    char* pos = reserve(UCONFIG_NUMBER_LENGTH_MAX);
+    if (!pos)
+        return 0;
+
+    int length = Uconfig_formatInteger(pos, value);
+    end += length;
+    return length;
+}
+
+int UconfigOutputBuffer::writeFloat(float value)
+{
+    char* pos = reserve(UCONFIG_NUMBER_LENGTH_MAX);
+    if (!pos)
+        return 0;
+
+    int length = Uconfig_formatFloat(pos, value);
+    end += length;
+    return length;
+}
+
+int UconfigOutputBuffer::writeDouble(double value)
+{
+    char* pos = reserve(UCONFIG_NUMBER_LENGTH_MAX);
+    if (!pos)
+        return 0;
+
+    int length = Uconfig_formatDouble(pos, value);
+    end += length;
+    return length;
+}
+
+// Pass the content of the buffer to the stream,
+// or hand the block of memory over
+// Return false if any write has failed so far
+bool UconfigOutputBuffer::flush()
+{
+    return flush(NULL, 0);
+}
+
+bool UconfigOutputBuffer::error() const
+{
+    return failed;
+}
+
+const char* UconfigOutputBuffer::data() const
+{
+    return buffer;
+}
+
+size_t UconfigOutputBuffer::size() const
+{
+    return end;
+}
+
+// Move the bytes written from TAIL on to POSITION,
+// shifting the bytes in between to the end
+void UconfigOutputBuffer::moveTail(size_t tail, size_t position)
+{
+    if (!buffer || position >= tail || tail >= end)
+        return;
+    std::rotate(buffer + position, buffer + tail, buffer + end);
+}
+
+void UconfigOutputBuffer::clear()
+{
+    end = 0;
+}
+
+// Pass the content of the buffer, then LENGTH bytes of DATA to the stream
+bool UconfigOutputBuffer::flush(const char* data, size_t length)
+{
+    // Data are dropped once a write has failed
+    if (failed)
+    {
+        end = 0;
+        return false;
+    }
+    if (!file)
+        return append(data, length);
+    if (end == 0 && length == 0)
+        return true;
+
+    if (vectored)
+    {
+        // Keep the order of the bytes already buffered by the stream
+        fflush(file);
+
+        struct iovec blocks[2];
+        blocks[0].iov_base = buffer;
+        blocks[0].iov_len = end;
+        blocks[1].iov_base = const_cast<char*>(data);
+        blocks[1].iov_len = length;
+
+        int first = 0;
+        while (first < 2)
+        {
+            ssize_t written = writev(fileno(file), &blocks[first], 2 - first);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                failed = true;
+                break;
+            }
+
+            // Skip the blocks that have been written completely
+            while (first < 2 && size_t(written) >= blocks[first].iov_len)
+            {
+                written -= blocks[first].iov_len;
+                first++;
+            }
+            if (first < 2)
+            {
+                blocks[first].iov_base = (char*)(blocks[first].iov_base) +
+                                         written;
+                blocks[first].iov_len -= written;
+            }
+        }
+    }
+    else
+    {
+        if (fwrite(buffer, sizeof(char), end, file) < end)
+            failed = true;
+        else if (length > 0 &&
+                 fwrite(data, sizeof(char), length, file) < length)
+            failed = true;
+    }
+
+    end = 0;
+    return !failed;
+}
+
+// Append LENGTH bytes of DATA to the block of memory, then store
+// its position and its length in the sink
+bool UconfigOutputBuffer::append(const char* data, size_t length)
+{
+    if (!grow(length))
+        return false;
+
+    if (length > 0)
+        memcpy(&buffer[end], data, length);
+    end += length;
+    buffer[end] = '\0';
+
+    *sink.data = buffer;
+    *sink.length = end;
+    return true;
+}
+
+// Make the block of memory hold LENGTH more bytes and a final "\0"
+bool UconfigOutputBuffer::grow(size_t length)
+{
+    if (capacity - end > length)
+        return true;
+
+    size_t newCapacity = capacity * 2;
+    if (newCapacity <= end + length)
+        newCapacity = end + length + 1;
+    char* newBuffer = (char*)(realloc(buffer, newCapacity));
+    if (!newBuffer)
+    {
+        failed = true;
+        return false;
+    }
+    buffer = newBuffer;
+    capacity = newCapacity;
+    return true;
+}
+
+// Make sure that at least LENGTH bytes are free at the end of the buffer,
+// and return their position (NULL if it cannot be done)
+char* UconfigOutputBuffer::reserve(size_t length)
+{
+    if (capacity - end < length)
+    {
+        // Streams are drained, while blocks of memory grow
+        if (file)
+            flush();
+        else
+            grow(length);
+    }
+    if (!buffer || capacity - end < length)
+        return NULL;
+    return &buffer[end];
+}
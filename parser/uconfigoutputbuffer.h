@@ -0,0 +1,72 @@
+#ifndef UCONFIGOUTPUTBUFFER_H
+#define UCONFIGOUTPUTBUFFER_H
+
+/*
+ * Writer of a stream, with an internal buffer of large size.
+ * Small writes (brackets, quotes, delimiters, numbers) are gathered
+ * in memory and passed to the stream in large blocks. In vectored mode,
+ * the stream is written directly with writev(), so that a large block
+ * of data is written along with the buffer in a single system call.
+ * Output can also go to a block of memory instead of a stream: the buffer
+ * then grows as needed and is handed over to the caller.
+ */
+
+#include <stddef.h>
+
+
+typedef struct _IO_FILE FILE;
+
+// Destination of the written bytes: either a stream, or a block of memory
+// allocated with malloc(), which is stored in *DATA and must be freed
+// by the caller with free(). The block is followed by a "\0" that is not
+// counted in *LENGTH.
+struct UconfigSink
+{
+    UconfigSink(FILE* file);
+    UconfigSink(char** data, size_t* length);
+
+    FILE* file;
+    char** data;
+    size_t* length;
+};
+
+class UconfigOutputBuffer
+{
+public:
+    UconfigOutputBuffer(const UconfigSink& sink, bool vectored = false);
+    ~UconfigOutputBuffer();
+
+    void put(char c);
+    void write(const char* data, size_t length);
+    void write(const char* string);
+    void writeIndentation(int level);
+    int writeInteger(long value);
+    int writeFloat(float value);
+    int writeDouble(double value);
+
+    bool flush();
+    bool error() const;
+
+    // Bytes written into memory so far; they can be moved or dropped
+    // as long as the block has not been handed over
+    const char* data() const;
+    size_t size() const;
+    void moveTail(size_t tail, size_t position);
+    void clear();
+
+protected:
+    UconfigSink sink;
+    FILE* file;    // NULL if writing into memory
+    char* buffer;
+    size_t capacity;
+    size_t end;    // Position following the last byte in the buffer
+    bool vectored;
+    bool failed;
+
+    bool flush(const char* data, size_t length);
+    bool append(const char* data, size_t length);
+    bool grow(size_t length);
+    char* reserve(size_t length);
+};
+
+#endif // UCONFIGOUTPUTBUFFER_H
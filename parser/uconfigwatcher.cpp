@@ -0,0 +1,409 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <utility>
+#include "uconfigwatcher.h"
+#include "uconfigfile_metadata.h"
+#include "uconfigio.h"
+
+// Changes of the files in a watched directory that make them read again
+#define UCONFIG_WATCHER_EVENTS      (IN_MODIFY | IN_CLOSE_WRITE | \
+                                     IN_CREATE | IN_MOVED_TO)
+
+// Longest delay of a file changed again and again, in debounce delays
+#define UCONFIG_WATCHER_DELAY_MAX   10
+
+#define UCONFIG_WATCHER_BUFFER_SIZE (64 * (sizeof(struct inotify_event) + \
+                                           NAME_MAX + 1))
+
+// Size of the blocks by which files are read
+#define UCONFIG_WATCHER_READ_SIZE   65536
+
+
+// Read the whole content of the file open as FD into BUFFER
+// Files are not mapped, as they may be truncated by their writer
+// while being read (which would raise SIGBUS on the mapped pages).
+static bool Uconfig_readWholeFile(int fd,
+                                  size_t sizeHint,
+                                  std::vector<char>& buffer)
+{
+    size_t length = 0;
+    ssize_t readLength;
+    buffer.resize(std::max(sizeHint + 1, size_t(UCONFIG_WATCHER_READ_SIZE)));
+    while (true)
+    {
+        if (length == buffer.size())
+            buffer.resize(length * 2);
+        readLength = read(fd, &buffer[length], buffer.size() - length);
+        if (readLength < 0 && errno == EINTR)
+            continue;
+        if (readLength < 0)
+            return false;
+        if (readLength == 0)
+            break;
+        length += size_t(readLength);
+    }
+    buffer.resize(length);
+    return true;
+}
+
+
+UconfigWatcher::UconfigWatcher(int debounceDelay)
+{
+    this->debounceDelay = debounceDelay > 0 ? debounceDelay : 0;
+    inotifyFd = -1;
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+    reloads = 0;
+    failures = 0;
+}
+
+UconfigWatcher::~UconfigWatcher()
+{
+    stop();
+    for (size_t i=0; i<files.size(); i++)
+        deleteFile(files[i]);
+}
+
+// Watch a file, whose format is guessed from its name if not given
+// The file is read at once; it must exist.
+bool UconfigWatcher::addFile(const char* filename,
+                             UconfigConverter::Format format)
+{
+    if (!filename || isRunning() || searchFile(filename))
+        return false;
+    if (format == UconfigConverter::UnknownFormat)
+        format = UconfigConverter::guessFormat(filename);
+    if (format == UconfigConverter::UnknownFormat)
+        return false;
+
+    // Watch the real directory of the file, as it may be a link
+    char* path = realpath(filename, NULL);
+    if (!path)
+        return false;
+    char* separator = strrchr(path, '/');
+    if (!separator || separator[1] == '\0')
+    {
+        free(path);
+        return false;
+    }
+
+    WatchedFile* file = new WatchedFile;
+    size_t directoryLength = separator > path ? separator - path : 1;
+    file->filename = new char[strlen(filename) + 1];
+    strcpy(file->filename, filename);
+    file->directory = new char[directoryLength + 1];
+    memcpy(file->directory, path, directoryLength);
+    file->directory[directoryLength] = '\0';
+    file->name = new char[strlen(separator + 1) + 1];
+    strcpy(file->name, separator + 1);
+    free(path);
+    file->watch = -1;
+    file->format = format;
+    file->pending = false;
+
+    if (!readFile(file))
+    {
+        deleteFile(file);
+        return false;
+    }
+    files.push_back(file);
+    return true;
+}
+
+bool UconfigWatcher::removeFile(const char* filename)
+{
+    WatchedFile* file = searchFile(filename);
+    if (!file || isRunning())
+        return false;
+
+    for (size_t i=0; i<files.size(); i++)
+    {
+        if (files[i] == file)
+        {
+            files.erase(files.begin() + i);
+            break;
+        }
+    }
+    deleteFile(file);
+    return true;
+}
+
+int UconfigWatcher::fileCount() const
+{
+    return int(files.size());
+}
+
+// Watch the files on a thread of the watcher until stop() is called
+// Files changed since they were last read are read again at once.
+bool UconfigWatcher::start()
+{
+    if (isRunning())
+        return false;
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+        return false;
+    if (pipe2(wakeFds, O_CLOEXEC) != 0)
+    {
+        closeWatches();
+        return false;
+    }
+
+    TimePoint now = std::chrono::steady_clock::now();
+    for (size_t i=0; i<files.size(); i++)
+    {
+        WatchedFile* file = files[i];
+        file->watch = inotify_add_watch(inotifyFd, file->directory,
+                                        UCONFIG_WATCHER_EVENTS);
+        if (file->watch < 0)
+        {
+            closeWatches();
+            return false;
+        }
+
+        // Catch the changes made while the file was not watched
+        struct stat fileStat;
+        file->pending = false;
+        if (stat(file->filename, &fileStat) == 0 &&
+            (fileStat.st_size != file->size ||
+             fileStat.st_mtim.tv_sec != file->modified.tv_sec ||
+             fileStat.st_mtim.tv_nsec != file->modified.tv_nsec))
+        {
+            file->pending = true;
+            file->firstChange = now;
+            file->deadline = now;
+        }
+    }
+
+    thread = std::thread(&UconfigWatcher::run, this);
+    return true;
+}
+
+void UconfigWatcher::stop()
+{
+    if (!isRunning())
+        return;
+
+    char signal = 0;
+    while (write(wakeFds[1], &signal, 1) < 0 && errno == EINTR);
+    thread.join();
+    closeWatches();
+}
+
+bool UconfigWatcher::isRunning() const
+{
+    return thread.joinable();
+}
+
+// Latest tree read from a file, or an empty pointer if the file
+// is not watched
+// This can be called from any thread, even while the file is read.
+std::shared_ptr<const UconfigFile>
+UconfigWatcher::config(const char* filename) const
+{
+    WatchedFile* file = searchFile(filename);
+    if (!file)
+        return std::shared_ptr<const UconfigFile>();
+    return std::atomic_load(&file->config);
+}
+
+// Number of times that files were read again after a change
+unsigned long UconfigWatcher::reloadCount() const
+{
+    return reloads;
+}
+
+// Number of times that files could not be read after a change
+unsigned long UconfigWatcher::failureCount() const
+{
+    return failures;
+}
+
+UconfigWatcher::WatchedFile*
+UconfigWatcher::searchFile(const char* filename) const
+{
+    if (!filename)
+        return NULL;
+    for (size_t i=0; i<files.size(); i++)
+    {
+        if (strcmp(files[i]->filename, filename) == 0)
+            return files[i];
+    }
+    return NULL;
+}
+
+// Read a file into a new tree, then publish the tree
+bool UconfigWatcher::readFile(WatchedFile* file)
+{
+    int fd = open(file->filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    // Take the time of modification before reading, so that a change
+    // made meanwhile is seen as such
+    struct stat fileStat;
+    std::vector<char> buffer;
+    bool success = fstat(fd, &fileStat) == 0 &&
+                   Uconfig_readWholeFile(fd, size_t(fileStat.st_size),
+                                         buffer);
+    close(fd);
+    if (!success)
+        return false;
+
+    std::shared_ptr<UconfigFile> config = std::make_shared<UconfigFile>();
+    if (!UconfigConverter::readUconfig(buffer.data(), buffer.size(),
+                                       file->format, config.get()))
+        return false;
+
+    // Keep the name of the file, as if it was read directly
+    UconfigKeyObject nameKey;
+    nameKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+    nameKey.setType(UconfigIO::Chars);
+    nameKey.setValue(file->filename, strlen(file->filename) + 1);
+    config->metadata.addKey(std::move(nameKey));
+
+    file->modified = fileStat.st_mtim;
+    file->size = fileStat.st_size;
+    std::atomic_store(&file->config,
+                      std::shared_ptr<const UconfigFile>(std::move(config)));
+    return true;
+}
+
+void UconfigWatcher::deleteFile(WatchedFile* file)
+{
+    delete[] file->filename;
+    delete[] file->directory;
+    delete[] file->name;
+    delete file;
+}
+
+void UconfigWatcher::closeWatches()
+{
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+    if (wakeFds[0] >= 0)
+        close(wakeFds[0]);
+    if (wakeFds[1] >= 0)
+        close(wakeFds[1]);
+    inotifyFd = -1;
+    wakeFds[0] = -1;
+    wakeFds[1] = -1;
+    for (size_t i=0; i<files.size(); i++)
+        files[i]->watch = -1;
+}
+
+// Wait for changes, then read the files once their delay has passed
+void UconfigWatcher::run()
+{
+    std::vector<char> buffer(UCONFIG_WATCHER_BUFFER_SIZE);
+    struct pollfd pollFds[2];
+    pollFds[0].fd = inotifyFd;
+    pollFds[0].events = POLLIN;
+    pollFds[1].fd = wakeFds[0];
+    pollFds[1].events = POLLIN;
+    while (true)
+    {
+        pollFds[0].revents = 0;
+        pollFds[1].revents = 0;
+        if (poll(pollFds, 2, nextTimeout()) < 0 && errno != EINTR)
+            break;
+        if (pollFds[1].revents)
+            break;
+        if (pollFds[0].revents & POLLIN)
+            readChanges(buffer.data(), buffer.size());
+
+        TimePoint now = std::chrono::steady_clock::now();
+        for (size_t i=0; i<files.size(); i++)
+        {
+            WatchedFile* file = files[i];
+            if (!file->pending || file->deadline > now)
+                continue;
+
+            file->pending = false;
+            if (readFile(file))
+                reloads++;
+            else
+                failures++;
+        }
+    }
+}
+
+// Mark the files concerned by the pending events of inotify
+void UconfigWatcher::readChanges(char* buffer, size_t size)
+{
+    TimePoint now = std::chrono::steady_clock::now();
+    ssize_t readSize;
+    while ((readSize = read(inotifyFd, buffer, size)) > 0)
+    {
+        const char* pos = buffer;
+        while (pos < buffer + readSize)
+        {
+            const struct inotify_event* event =
+                            reinterpret_cast<const struct inotify_event*>(pos);
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were lost: read all files again
+                for (size_t i=0; i<files.size(); i++)
+                    markChanged(files[i], now);
+            }
+            else if (event->len > 0)
+            {
+                for (size_t i=0; i<files.size(); i++)
+                {
+                    if (files[i]->watch == event->wd &&
+                        strcmp(files[i]->name, event->name) == 0)
+                        markChanged(files[i], now);
+                }
+            }
+            pos += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+// Put off the reading of a changed file until it has not changed
+// for a while, but no longer than a few delays in all
+void UconfigWatcher::markChanged(WatchedFile* file, TimePoint now)
+{
+    if (!file->pending)
+    {
+        file->pending = true;
+        file->firstChange = now;
+    }
+    file->deadline = std::min(now + std::chrono::milliseconds(debounceDelay),
+                              file->firstChange +
+                                    std::chrono::milliseconds(
+                                        debounceDelay *
+                                        UCONFIG_WATCHER_DELAY_MAX));
+}
+
+// Time to wait for the next file to be read, in ms; -1 if none is due
+int UconfigWatcher::nextTimeout() const
+{
+    bool pending = false;
+    TimePoint deadline;
+    for (size_t i=0; i<files.size(); i++)
+    {
+        if (files[i]->pending && (!pending || files[i]->deadline < deadline))
+        {
+            deadline = files[i]->deadline;
+            pending = true;
+        }
+    }
+    if (!pending)
+        return -1;
+
+    std::chrono::steady_clock::duration delay =
+                            deadline - std::chrono::steady_clock::now();
+    if (delay <= std::chrono::steady_clock::duration::zero())
+        return 0;
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(delay)
+                                                            .count()) + 1;
+}
@@ -0,0 +1,90 @@
+#ifndef UCONFIGWATCHER_H
+#define UCONFIGWATCHER_H
+
+/*
+ * Watcher of configuration files, for long-running processes that must
+ * follow changes to their files instead of reading them again and again.
+ * Files are watched with inotify through their directory, so that files
+ * replaced by renaming are followed as well. Bursts of changes to a file
+ * are gathered (debounced), then the file is read again on the thread
+ * of the watcher into a new tree, which is published at once.
+ * Readers get the latest complete tree without waiting for any reading,
+ * and never a partial one. Trees are shared, and remain valid as long as
+ * they are held; they must not be changed. If a file cannot be read,
+ * its previous tree is kept.
+ */
+
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "uconfigconverter.h"
+#include "uconfigfile.h"
+
+
+#define UCONFIG_WATCHER_DEBOUNCE    100  // Delay after a change, in ms
+
+
+class UconfigWatcher
+{
+public:
+    UconfigWatcher(int debounceDelay = UCONFIG_WATCHER_DEBOUNCE);
+    UconfigWatcher(const UconfigWatcher&) = delete;
+    ~UconfigWatcher();
+
+    UconfigWatcher& operator=(const UconfigWatcher&) = delete;
+
+    // Files are added and removed while the watcher is stopped
+    bool addFile(const char* filename,
+                 UconfigConverter::Format format =
+                                    UconfigConverter::UnknownFormat);
+    bool removeFile(const char* filename);
+    int fileCount() const;
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+
+    std::shared_ptr<const UconfigFile> config(const char* filename) const;
+    unsigned long reloadCount() const;
+    unsigned long failureCount() const;
+
+protected:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    struct WatchedFile
+    {
+        char* filename;
+        char* directory;    // Real directory watched
+        char* name;         // and name of the file in it
+        int watch;          // Watch descriptor of the directory
+        UconfigConverter::Format format;
+        std::shared_ptr<const UconfigFile> config;
+        struct timespec modified; // Time and size of the file last read
+        long long size;
+        bool pending;       // Changed, and waiting for the delay to pass
+        TimePoint firstChange;
+        TimePoint deadline;
+    };
+
+    std::vector<WatchedFile*> files;
+    int debounceDelay;
+    int inotifyFd;
+    int wakeFds[2];     // Pipe waking the thread up to stop it
+    std::thread thread;
+    std::atomic<unsigned long> reloads;
+    std::atomic<unsigned long> failures;
+
+    WatchedFile* searchFile(const char* filename) const;
+    static void deleteFile(WatchedFile* file);
+    bool readFile(WatchedFile* file);
+    void closeWatches();
+    void run();
+    void readChanges(char* buffer, size_t size);
+    void markChanged(WatchedFile* file, TimePoint now);
+    int nextTimeout() const;
+};
+
+#endif // UCONFIGWATCHER_H
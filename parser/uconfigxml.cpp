@@ -1,10 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <utility>
 #include <vector>
 #include "uconfigxml.h"
 #include "uconfigxml_p.h"
+#include "uconfiginputbuffer.h"
 #include "uconfigfile_metadata.h"
+#include "uconfignumber.h"
 #include "utils.h"
 
 // Chars: for stream parsing only
@@ -32,7 +35,8 @@
 #define UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN  "<!DOCTYPE "
 #define UCONFIG_IO_XML_DELIMITER_DOCTYPE_END    ">"
 
-#define UCONFIG_IO_XML_BUFFER_MAX               1024
+// Bytes of content held by the writer before a late key
+#define UCONFIG_IO_XML_HOLD_SIZE_MAX            1048576
 
 
 
@@ -57,35 +61,91 @@ bool UconfigXML::readUconfig(const char* filename,
     if (!inputFile)
         return false;
 
-    bool success = UconfigXMLPrivate::freadEntry(inputFile,
-                                                 config->rootEntry,
-                                                 false,
-                                                 skipBlankTextNode) > 0;
+    UconfigInputBuffer input(inputFile);
+    bool success = UconfigXMLPrivate::readInput(input, config,
+                                                filename, skipBlankTextNode);
 
-    if (success)
-    {
-        config->rootEntry.setType(UconfigXML::NormalEntry);
+    fclose(inputFile);
+    return success;
+}
 
-        // Add meta-data
-        UconfigKeyObject tempKey;
-        /* Basic information */
-        tempKey.reset();
-        tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
-        tempKey.setType(ValueType::Chars);
-        tempKey.setValue(filename, strlen(filename) + 1);
-        config->metadata.addKey(&tempKey);
-        tempKey.reset();
-        tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
-        tempKey.setType(ValueType::Chars);
-        tempKey.setValue(UCONFIG_METADATA_VALUE_XML,
-                         strlen(UCONFIG_METADATA_VALUE_XML) + 1);
-        config->metadata.addKey(&tempKey);
-    }
+// Read from an opened stream, which does not need to be seekable
+// (e.g. the standard input or a pipe)
+bool UconfigXML::freadUconfig(FILE* file,
+                              UconfigFile* config,
+                              bool skipBlankTextNode)
+{
+    if (!file || !config)
+        return false;
+
+    UconfigInputBuffer input(file);
+    return UconfigXMLPrivate::readInput(input, config,
+                                        NULL, skipBlankTextNode);
+}
+
+// Read LENGTH bytes of DATA in place, e.g. a block received from
+// another process
+bool UconfigXML::readUconfig(const char* data,
+                             size_t length,
+                             UconfigFile* config,
+                             bool skipBlankTextNode)
+{
+    if (!data || !config)
+        return false;
+
+    UconfigInputBuffer input(data, length);
+    return UconfigXMLPrivate::readInput(input, config,
+                                        NULL, skipBlankTextNode);
+}
+
+// Report the content of a file to HANDLER instead of building a tree
+bool UconfigXML::parseUconfig(const char* filename, UconfigHandler* handler)
+{
+    return parseUconfig(filename, handler, false);
+}
+
+bool UconfigXML::parseUconfig(const char* filename,
+                              UconfigHandler* handler,
+                              bool skipBlankTextNode)
+{
+    if (!handler)
+        return false;
+
+    FILE* inputFile = fopen(filename, "rb");
+    if (!inputFile)
+        return false;
+
+    UconfigInputBuffer input(inputFile);
+    bool success = UconfigXMLPrivate::parseInput(input, handler,
+                                                 skipBlankTextNode);
 
     fclose(inputFile);
     return success;
 }
 
+bool UconfigXML::fparseUconfig(FILE* file,
+                               UconfigHandler* handler,
+                               bool skipBlankTextNode)
+{
+    if (!file || !handler)
+        return false;
+
+    UconfigInputBuffer input(file);
+    return UconfigXMLPrivate::parseInput(input, handler, skipBlankTextNode);
+}
+
+bool UconfigXML::parseUconfig(const char* data,
+                              size_t length,
+                              UconfigHandler* handler,
+                              bool skipBlankTextNode)
+{
+    if (!data || !handler)
+        return false;
+
+    UconfigInputBuffer input(data, length);
+    return UconfigXMLPrivate::parseInput(input, handler, skipBlankTextNode);
+}
+
 bool UconfigXML::writeUconfig(const char* filename,
                               UconfigFile* config,
                               bool forceQuotingValue)
@@ -97,23 +157,30 @@ bool UconfigXML::writeUconfig(const char* filename,
     if (!outputFile)
         return false;
 
-    bool success = true;
-    if (config->rootEntry.subentryCount() > 0)
-    {
-        UconfigEntryObject* entryList = config->rootEntry.subentries();
-        for (int i=0; i<config->rootEntry.subentryCount(); i++)
-        {
-            success &=
-                UconfigXMLPrivate::fwriteEntry(outputFile, entryList[i],
-                                               0, forceQuotingValue) > 0;
-        }
-        delete[] entryList;
-    }
+    UconfigXMLWriter writer(outputFile, forceQuotingValue);
+    walkEntry(config->rootEntry, &writer);
 
+    bool success = writer.flush();
     fclose(outputFile);
     return success;
 }
 
+// Write into a block of memory, which is stored in *DATA and must be
+// freed with free(); *DATA is set to NULL if the writing fails
+bool UconfigXML::writeUconfig(char** data,
+                              size_t* length,
+                              UconfigFile* config,
+                              bool forceQuotingValue)
+{
+    if (!data || !length || !config)
+        return false;
+
+    UconfigSink sink(data, length);
+    UconfigXMLWriter writer(sink, forceQuotingValue);
+    walkEntry(config->rootEntry, &writer);
+    return writer.flush();
+}
+
 
 // Parse the value of an attribute from a given expression.
 // Normally, all values are wrapped in a pair of quotes and
@@ -125,7 +192,8 @@ bool UconfigXMLKey::parseValue(const char* expression, int length)
     if (!expression)
         return false;
 
-    char* pTail;
+    if (length <= 0)
+        length = strlen(expression);
 
     ValueType valueType = guessValueType(expression, length);
     switch (valueType)
@@ -139,17 +207,20 @@ bool UconfigXMLKey::parseValue(const char* expression, int length)
         case ValueType::Integer:
         {
             // Store the number as an "int"
-            int tempInt = int(strtol(expression, &pTail, 0));
-            if (pTail > expression)
+            long tempLong;
+            if (Uconfig_parseInteger(expression, length, &tempLong) > 0)
+            {
+                int tempInt = int(tempLong);
                 setValue((char*)(&tempInt), sizeof(int));
+            }
             break;
         }
         case ValueType::Float:
         case ValueType::Double:
         {
             // Store the number as a "double"
-            double tempDouble = strtod(expression, &pTail);
-            if (pTail > expression)
+            double tempDouble;
+            if (Uconfig_parseDouble(expression, length, &tempDouble) > 0)
                 setValue((char*)(&tempDouble), sizeof(double));
             break;
         }
@@ -161,10 +232,10 @@ bool UconfigXMLKey::parseValue(const char* expression, int length)
     return true;
 }
 
-int UconfigXMLKey::fwriteValue(FILE* file, bool forceWrappingQuotes)
+int UconfigXMLKey::writeValue(UconfigOutputBuffer& output,
+                              bool forceWrappingQuotes)
 {
     int length = 0;
-    char buffer[UCONFIG_IO_XML_BUFFER_MAX];
 
     if (ValueType(type()) == ValueType::Chars)
         forceWrappingQuotes = true;
@@ -172,34 +243,38 @@ int UconfigXMLKey::fwriteValue(FILE* file, bool forceWrappingQuotes)
     if (forceWrappingQuotes)
     {
         // Put an opening quote if required
-        fputc(UCONFIG_IO_XML_CHAR_STRING, file);
+        output.put(UCONFIG_IO_XML_CHAR_STRING);
         length++;
     }
 
     switch (ValueType(type()))
     {
         case ValueType::Integer:
-            length = snprintf(buffer, UCONFIG_IO_XML_BUFFER_MAX, "%d", *(int*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length += output.writeInteger(*(int*)(value()));
             break;
         case ValueType::Float:
-            length = snprintf(buffer, UCONFIG_IO_XML_BUFFER_MAX, "%f", *(float*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length += output.writeFloat(*(float*)(value()));
             break;
         case ValueType::Double:
-            length = snprintf(buffer, UCONFIG_IO_XML_BUFFER_MAX, "%f", *(double*)(value()));
-            fwrite(buffer, length, sizeof(char), file);
+            length += output.writeDouble(*(double*)(value()));
             break;
         case ValueType::Chars:
+        {
+            // Without the ending "\0" if any
+            int size = Uconfig_nameLength(value(), valueSize());
+            length += size;
+            output.write(value(), size);
+            break;
+        }
         default:
-            length = valueSize();
-            fwrite(value(), length, sizeof(char), file);
+            length += valueSize();
+            output.write(value(), valueSize());
     }
 
     if (forceWrappingQuotes)
     {
         // Put a closing quote if required
-        fputc(UCONFIG_IO_XML_CHAR_STRING, file);
+        output.put(UCONFIG_IO_XML_CHAR_STRING);
         length++;
     }
 
@@ -207,172 +282,469 @@ int UconfigXMLKey::fwriteValue(FILE* file, bool forceWrappingQuotes)
 }
 
 
-int UconfigXMLPrivate::freadEntry(FILE* file,
-                                  UconfigEntryObject& entry,
-                                  bool inTag,
+
+UconfigXMLWriter::UconfigXMLWriter(const UconfigSink& sink,
+                                   bool forceQuotingValue) :
+    UconfigWriter(sink)
+{
+    this->forceQuotingValue = forceQuotingValue;
+    skipLevel = 0;
+    holdLevel = -1;
+    heldData = NULL;
+    heldLength = 0;
+    held = new UconfigOutputBuffer(UconfigSink(&heldData, &heldLength));
+}
+
+UconfigXMLWriter::~UconfigXMLWriter()
+{
+    // The held block is handed over when the buffer is deleted
+    delete held;
+    free(heldData);
+}
+
+void UconfigXMLWriter::onEntryBegin(const char* name, int nameSize, int type)
+{
+    if (skipLevel > 0)
+    {
+        skipLevel++;
+        return;
+    }
+
+    if (!levels.empty())
+    {
+        Level& parent = levels.back();
+        if (parent.type != UconfigXML::NormalEntry)
+        {
+            // Only elements can have children
+            skipLevel++;
+            return;
+        }
+        if (!parent.hasChild)
+        {
+            // Keep the opening tag of the parent open before its first
+            // child: the following content is held until the parent ends
+            parent.hasChild = true;
+            if (holdLevel < 0)
+                holdLevel = levels.size() - 1;
+            else
+            {
+                held->write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+                parent.tagEnd = held->size() - 1;
+            }
+        }
+    }
+
+    Level level;
+    level.type = type;
+    level.keyCount = 0;
+    level.hasChild = false;
+    level.tagWritten = false;
+    level.tagEnd = 0;
+    level.nameOffset = names.size();
+    level.nameLength = Uconfig_nameLength(name, nameSize);
+
+    UconfigOutputBuffer& out = target();
+    switch (UconfigXML::EntryType(type))
+    {
+        case UconfigXML::NormalEntry:
+            // Write the opening tag of the entry,
+            // and keep its name for the closing tag
+            out.write(UCONFIG_IO_XML_DELIMITER_TAG_BEGINOPEN);
+            out.write(name, level.nameLength);
+            names.insert(names.end(), name, name + level.nameLength);
+            break;
+        case UconfigXML::DoctypeEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN);
+            break;
+        case UconfigXML::XMLDeclEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_XML_BEGIN);
+            break;
+        case UconfigXML::CommentEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_COMMENT_BEGIN);
+            break;
+        case UconfigXML::CDATAEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_CDATA_BEGIN);
+            break;
+        case UconfigXML::TextEntry:
+            break;
+        default:
+            // Unknown entries are ignored along with their children
+            skipLevel++;
+            return;
+    }
+    levels.push_back(level);
+
+    if (held->size() > UCONFIG_IO_XML_HOLD_SIZE_MAX)
+        release();
+}
+
+void UconfigXMLWriter::onKey(UconfigKeyObject& key)
+{
+    // Keys of the root entry are not written
+    if (skipLevel > 0 || levels.empty())
+        return;
+
+    UconfigXMLKey& xmlKey = (UconfigXMLKey&)key;
+    Level& level = levels.back();
+    UconfigOutputBuffer* out = &target();
+    size_t tail = held->size();
+
+    bool valueOnly = true;
+    bool forceQuoting = false;
+    bool childElement = false;
+    bool inserted = false;
+    if (level.type == UconfigXML::NormalEntry)
+    {
+        if (!level.hasChild)
+        {
+            out->write(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE);
+            valueOnly = false;
+            forceQuoting = forceQuotingValue;
+        }
+        else if (level.tagWritten)
+        {
+            // Keys following a child cannot go to a tag already
+            // written out: write them as elements (or text if unnamed)
+            childElement = xmlKey.name() != NULL;
+        }
+        else
+        {
+            // Keys following a child go to the opening tag, which is either
+            // the last thing written out, or held before the child
+            inserted = int(levels.size()) - 1 != holdLevel;
+            if (!inserted)
+                out = &output;
+            out->write(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE);
+            valueOnly = false;
+            forceQuoting = forceQuotingValue;
+        }
+    }
+    else
+    {
+        if (level.keyCount > 0)
+            out->write(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE);
+        if (level.type == UconfigXML::XMLDeclEntry)
+        {
+            valueOnly = false;
+            forceQuoting = forceQuotingValue;
+        }
+    }
+    level.keyCount++;
+
+    int nameLength = xmlKey.name() ?
+                     Uconfig_nameLength(xmlKey.name(), xmlKey.nameSize()) : 0;
+    if (childElement)
+    {
+        out->write(UCONFIG_IO_XML_DELIMITER_TAG_BEGINOPEN);
+        out->write(xmlKey.name(), nameLength);
+        out->write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+    }
+
+    // Write the name of the attribute if any
+    if (xmlKey.name() && !valueOnly)
+    {
+        out->write(xmlKey.name(), nameLength);
+        out->write(UCONFIG_IO_XML_DELIMITER_KEYVAL);
+    }
+
+    // Write the value of the attribute
+    xmlKey.writeValue(*out, forceQuoting);
+
+    if (childElement)
+    {
+        out->write(UCONFIG_IO_XML_DELIMITER_TAG_BEGINCLOSE);
+        out->write(xmlKey.name(), nameLength);
+        out->write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+    }
+    if (inserted)
+    {
+        held->moveTail(tail, level.tagEnd);
+        level.tagEnd += held->size() - tail;
+    }
+
+    if (held->size() > UCONFIG_IO_XML_HOLD_SIZE_MAX)
+        release();
+}
+
+void UconfigXMLWriter::onEntryEnd()
+{
+    if (skipLevel > 0)
+    {
+        skipLevel--;
+        return;
+    }
+    if (levels.empty())
+        return;
+
+    Level level = levels.back();
+    levels.pop_back();
+    if (int(levels.size()) == holdLevel)
+    {
+        // Write out the complete opening tag, then the held content
+        holdLevel = -1;
+        output.write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+        output.write(held->data(), held->size());
+        held->clear();
+    }
+
+    UconfigOutputBuffer& out = target();
+    switch (UconfigXML::EntryType(level.type))
+    {
+        case UconfigXML::NormalEntry:
+            if (level.hasChild)
+            {
+                // Write the closing tag of the entry
+                out.write(UCONFIG_IO_XML_DELIMITER_TAG_BEGINCLOSE);
+                out.write(&names[level.nameOffset], level.nameLength);
+                out.write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+            }
+            else
+            {
+                // Use self-closing tag
+                out.write(UCONFIG_IO_XML_DELIMITER_TAG_ENDSELF);
+            }
+            names.resize(level.nameOffset);
+            break;
+        case UconfigXML::DoctypeEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_DOCTYPE_END);
+            break;
+        case UconfigXML::XMLDeclEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_XML_END);
+            break;
+        case UconfigXML::CommentEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_COMMENT_END);
+            break;
+        case UconfigXML::CDATAEntry:
+            out.write(UCONFIG_IO_XML_DELIMITER_CDATA_END);
+            break;
+        default:;
+    }
+
+    if (held->size() > UCONFIG_IO_XML_HOLD_SIZE_MAX)
+        release();
+}
+
+// Write out what is held, e.g. for unbalanced entries
+bool UconfigXMLWriter::flush()
+{
+    release();
+    return UconfigWriter::flush() && !held->error();
+}
+
+// Where the content of the current entry goes
+UconfigOutputBuffer& UconfigXMLWriter::target()
+{
+    return holdLevel >= 0 ? *held : output;
+}
+
+// Write out the held content, closing the opening tags kept open
+void UconfigXMLWriter::release()
+{
+    if (holdLevel < 0)
+        return;
+
+    output.write(UCONFIG_IO_XML_DELIMITER_TAG_END);
+    output.write(held->data(), held->size());
+    held->clear();
+    for (size_t i=holdLevel; i<levels.size(); i++)
+    {
+        if (levels[i].hasChild)
+            levels[i].tagWritten = true;
+    }
+    holdLevel = -1;
+}
+
+
+bool UconfigXMLPrivate::readInput(UconfigInputBuffer& input,
+                                  UconfigFile* config,
+                                  const char* filename,
                                   bool skipBlankTextNode)
+{
+    UconfigTreeBuilder builder(config->rootEntry);
+    bool success = parseInput(input, &builder, skipBlankTextNode);
+
+    if (success)
+    {
+        config->rootEntry.setType(UconfigXML::NormalEntry);
+
+        // Add meta-data
+        UconfigKeyObject tempKey;
+        /* Basic information */
+        if (filename)
+        {
+            tempKey.reset();
+            tempKey.setName(UCONFIG_METADATA_KEY_FILENAME);
+            tempKey.setType(ValueType::Chars);
+            tempKey.setValue(filename, strlen(filename) + 1);
+            config->metadata.addKey(std::move(tempKey));
+        }
+        tempKey.reset();
+        tempKey.setName(UCONFIG_METADATA_KEY_FILETYPE);
+        tempKey.setType(ValueType::Chars);
+        tempKey.setValue(UCONFIG_METADATA_VALUE_XML,
+                         strlen(UCONFIG_METADATA_VALUE_XML) + 1);
+        config->metadata.addKey(std::move(tempKey));
+    }
+
+    // Nodes edited from now on are no longer allocated from the arena
+    config->freezeArena();
+
+    return success;
+}
+
+bool UconfigXMLPrivate::parseInput(UconfigInputBuffer& input,
+                                   UconfigHandler* handler,
+                                   bool skipBlankTextNode)
+{
+    return parseEntry(input, handler, false, skipBlankTextNode) > 0;
+}
+
+// Report an element whose name is not parsed yet, if not done already
+static inline void Uconfig_beginXMLEntry(UconfigHandler* handler,
+                                         bool& begun,
+                                         const char* name = NULL,
+                                         int nameSize = 0)
+{
+    if (!begun)
+    {
+        handler->onEntryBegin(name, nameSize, UconfigXML::NormalEntry);
+        begun = true;
+    }
+}
+
+// Parse the content of an entry from INPUT, up to its closing tag,
+// and report it to HANDLER
+// If INTAG is true, the opening tag (following "<") is parsed first,
+// and the entry itself is reported as a new element;
+// otherwise its content is reported to the currently open entry
+// Return the number of bytes consumed
+size_t UconfigXMLPrivate::parseEntry(UconfigInputBuffer& input,
+                                     UconfigHandler* handler,
+                                     bool inTag,
+                                     bool skipBlankTextNode)
 {
     int retValue;
-    int parsedLen = 0;
+    size_t beginPosition = input.position();
+    bool element = inTag;
+    bool begun = !element;
+    bool named = false;
     bool nextKey = false;
     bool preOpening = false;
     bool preClosing = false;
     bool closing = false;
-    bool parsingString = false;
     char bufferChar;
-    char lastStringDelimitor = '\0';
     std::vector<char> buffer, keyName;
     UconfigXMLKey tempKey;
-    UconfigEntryObject tempSubentry;
-
-    entry.reset();
+    tempKey.setArena(handler->arena());
     while (true)
     {
-        // Read from file char by char
-        retValue = fgetc(file);
-        if (retValue == -1)
-        {
-            // EOF
-            break;
-        }
-
-        parsedLen++;
-        bufferChar = char(retValue);
-        if (parsingString)
+        if (!inTag)
         {
-            buffer.push_back(bufferChar);
-            if (bufferChar == lastStringDelimitor)
+            // Parsing text entry, up to the next tag
+            if (!input.readUntil(UCONFIG_IO_XML_DELIMITER_TAG_BEGINOPEN,
+                                 1, buffer))
             {
-                // Quit string parsing mode
-                parsingString = false;
+                // EOF
+                break;
             }
+            preOpening = true;
         }
-        else if (!inTag)
+        else
         {
-            if (bufferChar == UCONFIG_IO_XML_CHAR_TAG_BEGIN)
+            retValue = input.get();
+            if (retValue == -1)
             {
-                // Both opening and closing tag are possible
-                // We need to read one more char to determine
-                preOpening = true;
+                // EOF
+                break;
             }
-            else
+
+            bufferChar = char(retValue);
+            switch (bufferChar)
             {
-                // Parsing text entry
-                buffer.push_back(bufferChar);
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                    // White spaces: possible delimitors for attributes
+                    nextKey = true;
+                    break;
+                case UCONFIG_IO_XML_CHAR_STRING:
+                case UCONFIG_IO_XML_CHAR_STRING2:
+                    // Read the whole string, with its quotes
+                    buffer.push_back(bufferChar);
+                    if (input.readUntil(&bufferChar, 1, buffer))
+                        buffer.push_back(bufferChar);
+                    break;
+                case UCONFIG_IO_XML_CHAR_TAG_BEGIN:
+                    preOpening = true;
+                    break;
+                case UCONFIG_IO_XML_CHAR_TAG_END:
+                    nextKey = true;
+                    preClosing = true;
+                    break;
+                case UCONFIG_IO_XML_CHAR_TAG_MID:
+                    nextKey = true;
+                    closing = true;
+                    break;
+                case UCONFIG_IO_XML_CHAR_KEY_DEFINITION:
+                    keyName = buffer;
+                    buffer.clear();
+                    break;
+                default:
+                    buffer.push_back(bufferChar);
             }
         }
-        else
-        switch (bufferChar)
-        {
-            case ' ':
-            case '\t':
-            case '\r':
-            case '\n':
-                // White spaces: possible delimitors for attributes
-                nextKey = true;
-                break;
-            case UCONFIG_IO_XML_CHAR_STRING:
-            case UCONFIG_IO_XML_CHAR_STRING2:
-                // Enter string parsing mode
-                parsingString = true;
-                lastStringDelimitor = bufferChar;
-                buffer.push_back(bufferChar);
-                break;
-            case UCONFIG_IO_XML_CHAR_TAG_BEGIN:
-                preOpening = true;
-                break;
-            case UCONFIG_IO_XML_CHAR_TAG_END:
-                nextKey = true;
-                preClosing = true;
-                break;
-            case UCONFIG_IO_XML_CHAR_TAG_MID:
-                nextKey = true;
-                closing = true;
-                break;
-            case UCONFIG_IO_XML_CHAR_KEY_DEFINITION:
-                keyName = buffer;
-                buffer.clear();
-                break;
-            default:
-                buffer.push_back(bufferChar);
-        }
 
         if (preOpening)
         {
             preOpening = false;
 
-            // Store previous read chars (if any) as a text entry
+            // Report previous read chars (if any) as a text entry
+            Uconfig_beginXMLEntry(handler, begun);
             if (buffer.size() > 0)
             {
                 if (!skipBlankTextNode ||
                     !Uconfig_isspace(buffer.data(), buffer.size()))
                 {
-                    tempKey.setName(NULL);
+                    handler->onEntryBegin(NULL, 0, UconfigXML::TextEntry);
                     tempKey.setType(ValueType::Raw);
                     tempKey.setValue(buffer.data(), buffer.size());
-                    tempSubentry.reset();
-                    tempSubentry.setType(UconfigXML::TextEntry);
-                    tempSubentry.addKey(&tempKey);
-                    entry.appendSubentry(&tempSubentry);
+                    handler->onKey(tempKey);
+                    tempKey.reset();
+                    handler->onEntryEnd();
                 }
                 buffer.clear();
             }
 
             // Determine the tag's nature from its left part
-            fseek(file, -1, SEEK_CUR);
-            parsedLen--;
-
-            retValue = parseComment(file, tempSubentry);
-            if (retValue <= 0)
-                retValue = parseCDATA(file, tempSubentry);
-            if (retValue <= 0)
-                retValue = parseXMLDelcaration(file, tempSubentry);
-            if (retValue <= 0)
-                retValue = parseDoctype(file, tempSubentry);
-
-            if (retValue <= 0)
+            // (sections are reported as soon as they are recognized)
+            if (!parseComment(input, handler) &&
+                !parseCDATA(input, handler) &&
+                !parseXMLDelcaration(input, handler) &&
+                !parseDoctype(input, handler))
             {
                 // Normal element
-                // Try to read one more char to determine its nature
-                fseek(file, 1, SEEK_CUR);
-                parsedLen++;
-
-                retValue = fgetc(file);
+                // Look at one more char to determine its nature
+                retValue = input.peek();
                 if (retValue == -1)
                 {
                     // EOF
                     break;
                 }
-                parsedLen++;
-                bufferChar = char(retValue);
 
-                if (bufferChar == UCONFIG_IO_XML_CHAR_TAG_MID)
+                if (char(retValue) == UCONFIG_IO_XML_CHAR_TAG_MID)
                 {
                     // Closing tag of an element
+                    input.skip(1);
                     inTag = true;
                     closing = true;
                 }
                 else
                 {
                     // Subentry: parse it recursively
-                    fseek(file, -1, SEEK_CUR);
-                    parsedLen--;
-
-                    retValue = freadEntry(file, tempSubentry,
-                                          true, skipBlankTextNode);
-                    if (retValue > 0)
-                    {
-                        tempSubentry.setType(UconfigXML::NormalEntry);
-                        entry.appendSubentry(&tempSubentry);
-                        parsedLen += retValue;
-                    }
+                    parseEntry(input, handler, true, skipBlankTextNode);
                 }
             }
-            else
-            {
-                entry.appendSubentry(&tempSubentry);
-                parsedLen += retValue;
-            }
         }
 
         if (nextKey)
@@ -382,9 +754,11 @@ int UconfigXMLPrivate::freadEntry(FILE* file,
             if (buffer.size() > 0)
             {
                 // Deal with element names, attribute names and values
-                if (!entry.name())
+                if (!named)
                 {
-                    entry.setName(buffer.data(), buffer.size());
+                    Uconfig_beginXMLEntry(handler, begun,
+                                          buffer.data(), buffer.size());
+                    named = true;
                 }
                 else if (keyName.size() == 0)
                 {
@@ -392,9 +766,12 @@ int UconfigXMLPrivate::freadEntry(FILE* file,
                 }
                 else
                 {
-                    tempKey.parseValue(buffer.data(), buffer.size());
+                    // Terminate the value for number conversions
+                    buffer.push_back('\0');
+                    tempKey.parseValue(buffer.data(), buffer.size() - 1);
                     tempKey.setName(keyName.data(), keyName.size());
-                    entry.addKey(&tempKey);
+                    handler->onKey(tempKey);
+                    tempKey.reset();
                     keyName.clear();
                 }
 
@@ -408,184 +785,20 @@ int UconfigXMLPrivate::freadEntry(FILE* file,
             inTag = false;
 
             // Deal with the right part of opening/closing tags
+            // The name in the closing tag is not checked against
+            // that in the opening tag: unmatched tags are ignored
             if (closing)
-            {
-                if (buffer.size() > 0)
-                {
-                    // Extra syntax check for non self-closing tags:
-                    // See if the name in the closing tag matches
-                    // that in the opening tag
-                    if (strncmp(entry.name(),
-                                buffer.data(),
-                                entry.nameSize()) != 0)
-                    {
-                        // Tags not matching; ignored
-                        // Further error information should be printed
-                    }
-                }
                 break;
-            }
         }
     }
 
-    return parsedLen;
-}
-
-bool UconfigXMLPrivate::fwriteEntry(FILE* file,
-                                    UconfigEntryObject& entry,
-                                    int level,
-                                    bool forceQuotingValue)
-{
-    switch (UconfigXML::EntryType(entry.type()))
+    // Report the end of an element, even if it is incomplete
+    if (element)
     {
-        case UconfigXML::NormalEntry:
-        {
-            // First write the opening tag of the entry
-            fwrite(UCONFIG_IO_XML_DELIMITER_TAG_BEGINOPEN,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_TAG_BEGINOPEN),
-                   file);
-            fwrite(entry.name(), sizeof(char), entry.nameSize(), file);
-
-            // Then write the attributes (keys)
-            if (entry.keyCount() > 0)
-            {
-                fwrite(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE,
-                       sizeof(char),
-                       strlen(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE),
-                       file);
-                fwriteEntryKeys(file, entry, false, forceQuotingValue);
-            }
-
-            // Then write subentries (if any)
-            UconfigEntryObject* subentryList = entry.subentries();
-            if (subentryList)
-            {
-                fwrite(UCONFIG_IO_XML_DELIMITER_TAG_END,
-                       sizeof(char),
-                       strlen(UCONFIG_IO_XML_DELIMITER_TAG_END),
-                       file);
-
-                for (int i=0; i<entry.subentryCount(); i++)
-                    fwriteEntry(file, subentryList[i],
-                                level + 1, forceQuotingValue);
-
-                // Finally write the closing tag of the entry
-                fwrite(UCONFIG_IO_XML_DELIMITER_TAG_BEGINCLOSE,
-                       sizeof(char),
-                       strlen(UCONFIG_IO_XML_DELIMITER_TAG_BEGINCLOSE),
-                       file);
-                fwrite(entry.name(),
-                       sizeof(char),
-                       entry.nameSize(),
-                       file);
-                fwrite(UCONFIG_IO_XML_DELIMITER_TAG_END,
-                       sizeof(char),
-                       strlen(UCONFIG_IO_XML_DELIMITER_TAG_END),
-                       file);
-
-                delete[] subentryList;
-            }
-            else
-            {
-                // Use self-closing tag
-                fwrite(UCONFIG_IO_XML_DELIMITER_TAG_ENDSELF,
-                       sizeof(char),
-                       strlen(UCONFIG_IO_XML_DELIMITER_TAG_ENDSELF),
-                       file);
-            }
-            break;
-        }
-        case UconfigXML::DoctypeEntry:
-            fwrite(UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN),
-                   file);
-            fwriteEntryKeys(file, entry, true);
-            fwrite(UCONFIG_IO_XML_DELIMITER_DOCTYPE_END,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_DOCTYPE_END),
-                   file);
-            break;
-        case UconfigXML::XMLDeclEntry:
-            fwrite(UCONFIG_IO_XML_DELIMITER_XML_BEGIN,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_XML_BEGIN),
-                   file);
-            fwriteEntryKeys(file, entry, false, forceQuotingValue);
-            fwrite(UCONFIG_IO_XML_DELIMITER_XML_END,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_XML_END),
-                   file);
-            break;
-        case UconfigXML::CommentEntry:
-            fwrite(UCONFIG_IO_XML_DELIMITER_COMMENT_BEGIN,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_COMMENT_BEGIN),
-                   file);
-            fwriteEntryKeys(file, entry, true);
-            fwrite(UCONFIG_IO_XML_DELIMITER_COMMENT_END,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_COMMENT_END),
-                   file);
-            break;
-        case UconfigXML::CDATAEntry:
-            fwrite(UCONFIG_IO_XML_DELIMITER_CDATA_BEGIN,
-                   sizeof(char),
-                   strlen(UCONFIG_IO_XML_DELIMITER_CDATA_BEGIN),
-                   file);
-            fwriteEntryKeys(file, entry, true);
-            fwrite(UCONFIG_IO_XML_DELIMITER_CDATA_END,
-                sizeof(char),
-                strlen(UCONFIG_IO_XML_DELIMITER_CDATA_END),
-                file);
-            break;
-        case UconfigXML::TextEntry:
-            fwriteEntryKeys(file, entry, true);
-            break;
-        default:;
+        Uconfig_beginXMLEntry(handler, begun);
+        handler->onEntryEnd();
     }
-
-    return true;
-}
-
-bool UconfigXMLPrivate::fwriteEntryKeys(FILE* file,
-                                        UconfigEntryObject& entry,
-                                        bool valueOnly,
-                                        bool forceQuotingValue)
-{
-    UconfigXMLKey* keyList = (UconfigXMLKey*)(entry.keys());
-    if (!keyList)
-        return false;
-
-    const int kvDLength = strlen(UCONFIG_IO_XML_DELIMITER_KEYVAL);
-    const int aDLength = strlen(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE);
-
-    for (int i=0; i<entry.keyCount(); i++)
-    {
-        if (i > 0)
-        {
-            fwrite(UCONFIG_IO_XML_DELIMITER_ATTRIBUTE,
-                       sizeof(char), aDLength, file);
-        }
-
-        // Write the name of the attribute if any
-        if (keyList[i].name() && !valueOnly)
-        {
-            fwrite(keyList[i].name(),
-                   sizeof(char),
-                   keyList[i].nameSize(),
-                   file);
-            fwrite(UCONFIG_IO_XML_DELIMITER_KEYVAL,
-                   sizeof(char), kvDLength, file);
-        }
-
-        // Write the value of the attribute
-        keyList[i].fwriteValue(file, forceQuotingValue);
-    }
-
-    delete[] keyList;
-    return true;
+    return input.position() - beginPosition;
 }
 
 // Parse an attribute expression of format "NAME=VALUE"
@@ -677,223 +890,161 @@ int UconfigXMLPrivate::parseTagAttribute(const char* expression,
     return pos2 + 1;
 }
 
-// Try to parse a comment section from the current reading position
-// of the file, with a constraint of maximum parsing length.
-// Any parsed comment is stored as a key attached to the entry.
-int UconfigXMLPrivate::parseComment(FILE* file,
-                                    UconfigEntryObject& entry,
-                                    int maxLength)
+// Try to parse a section such as a comment from INPUT, right after
+// the opening "<" of a tag. The section is recognized by BEGIN
+// (without the "<"), and its content is read up to END.
+// The section is reported to HANDLER as a new entry of type TYPE,
+// which is left open for the keys parsed from the content
+// Return the number of bytes consumed, or 0 if the section is not found
+int UconfigXMLPrivate::parseSection(UconfigInputBuffer& input,
+                                    UconfigHandler* handler,
+                                    int type,
+                                    const char* begin,
+                                    const char* end,
+                                    std::vector<char>& content)
 {
-    if (!file)
+    int beginLength = strlen(begin) - 1;
+    if (!input.peekCmp(&begin[1], beginLength))
         return 0;
 
-    // Check the opening part of the comment section
-    int readLength = Uconfig_fpeekCmp(file,
-                                      UCONFIG_IO_XML_DELIMITER_COMMENT_BEGIN,
-                                      0);
-    if (readLength == 0 || (maxLength > 0  && readLength > maxLength))
+    size_t beginPosition = input.position();
+    input.skip(beginLength);
+    handler->onEntryBegin(NULL, 0, type);
+
+    // Find the closing part of the section
+    // If it is missing, the section is incomplete:
+    // we shall report this error in the future
+    content.clear();
+    input.readUntil(end, strlen(end), content);
+
+    return input.position() - beginPosition;
+}
+
+// Try to parse a comment section at the current reading position.
+// Any parsed comment is reported as a key attached to the entry.
+int UconfigXMLPrivate::parseComment(UconfigInputBuffer& input,
+                                    UconfigHandler* handler)
+{
+    std::vector<char> content;
+    int readLength = parseSection(input, handler,
+                                  UconfigXML::CommentEntry,
+                                  UCONFIG_IO_XML_DELIMITER_COMMENT_BEGIN,
+                                  UCONFIG_IO_XML_DELIMITER_COMMENT_END,
+                                  content);
+    if (readLength <= 0)
         return 0;
 
-    fseek(file, readLength, SEEK_CUR);
-    entry.reset();
-    entry.setType(UconfigXML::CommentEntry);
-
-    // Find the closing part of the comment section
-    char* buffer = NULL;
-    int contentLength = maxLength > 0 ? maxLength - readLength : 0;
-    contentLength = Uconfig_getdelim(&buffer,
-                                     &contentLength,
-                                     UCONFIG_IO_XML_DELIMITER_COMMENT_END,
-                                     file);
-    if (contentLength > 0)
+    if (content.size() > 0)
     {
         // Extract the comment
         UconfigKeyObject key;
+        key.setArena(handler->arena());
         key.setType(ValueType::Raw);
-        key.setValue(buffer, contentLength);
-        entry.addKey(&key);
-        readLength += contentLength;
-    }
-    if (buffer)
-        free(buffer);
-
-    // Checking the closing part of the comment section,
-    // even we have already searched for it in utils_getdelim().
-
-    if (Uconfig_fpeekCmp(file,
-                         UCONFIG_IO_XML_DELIMITER_COMMENT_END,
-                         -strlen(UCONFIG_IO_XML_DELIMITER_COMMENT_END)) < 0)
-    {
-        // Valid closing part
-        readLength += strlen(UCONFIG_IO_XML_DELIMITER_COMMENT_END);
-    }
-    else
-    {
-        // Premature ending: the comment section is incomplete
-        // We shall report this error in the future
+        key.setValue(content.data(), content.size());
+        handler->onKey(key);
     }
+    handler->onEntryEnd();
 
     return readLength;
 }
 
-// Try to parse a CDATA section from the file.
+// Try to parse a CDATA section at the current reading position.
 // Similar to the function UconfigXMLPrivate::parseComment().
-// See its comment for detailed explanation
-int UconfigXMLPrivate::parseCDATA(FILE* file,
-                                  UconfigEntryObject& entry,
-                                  int maxLength)
+int UconfigXMLPrivate::parseCDATA(UconfigInputBuffer& input,
+                                  UconfigHandler* handler)
 {
-    if (!file)
+    std::vector<char> content;
+    int readLength = parseSection(input, handler,
+                                  UconfigXML::CDATAEntry,
+                                  UCONFIG_IO_XML_DELIMITER_CDATA_BEGIN,
+                                  UCONFIG_IO_XML_DELIMITER_CDATA_END,
+                                  content);
+    if (readLength <= 0)
         return 0;
 
-    int readLength = Uconfig_fpeekCmp(file,
-                                      UCONFIG_IO_XML_DELIMITER_CDATA_BEGIN,
-                                      0);
-    if (readLength == 0 || (maxLength > 0  && readLength > maxLength))
-        return 0;
-
-    fseek(file, readLength, SEEK_CUR);
-    entry.reset();
-    entry.setType(UconfigXML::CDATAEntry);
-
-    char* buffer = NULL;
-    int contentLength = maxLength > 0 ? maxLength - readLength : 0;
-    contentLength = Uconfig_getdelim(&buffer,
-                                     &contentLength,
-                                     UCONFIG_IO_XML_DELIMITER_CDATA_END,
-                                     file);
-    if (contentLength > 0)
+    if (content.size() > 0)
     {
         UconfigKeyObject key;
+        key.setArena(handler->arena());
         key.setType(ValueType::Raw);
-        key.setValue(buffer, contentLength);
-        entry.addKey(&key);
-        readLength += contentLength;
+        key.setValue(content.data(), content.size());
+        handler->onKey(key);
     }
-    if (buffer)
-        free(buffer);
-
-    if (Uconfig_fpeekCmp(file,
-                         UCONFIG_IO_XML_DELIMITER_CDATA_END,
-                         -strlen(UCONFIG_IO_XML_DELIMITER_CDATA_END)) < 0)
-        readLength += strlen(UCONFIG_IO_XML_DELIMITER_CDATA_END);
+    handler->onEntryEnd();
 
     return readLength;
 }
 
-// Try to parse a XML declaration section from the file.
-// Similar to the function UconfigXMLPrivate::parseComment().
-int UconfigXMLPrivate::parseXMLDelcaration(FILE* file,
-                                           UconfigEntryObject& entry,
-                                           int maxLength)
+// Try to parse a XML declaration section at the current reading position.
+// Its attributes are reported as keys attached to the entry.
+int UconfigXMLPrivate::parseXMLDelcaration(UconfigInputBuffer& input,
+                                           UconfigHandler* handler)
 {
-    if (!file)
-        return 0;
-
-    int readLength = Uconfig_fpeekCmp(file,
-                                      UCONFIG_IO_XML_DELIMITER_XML_BEGIN,
-                                      0);
-    if (readLength == 0 || (maxLength > 0  && readLength > maxLength))
+    std::vector<char> content;
+    int readLength = parseSection(input, handler,
+                                  UconfigXML::XMLDeclEntry,
+                                  UCONFIG_IO_XML_DELIMITER_XML_BEGIN,
+                                  UCONFIG_IO_XML_DELIMITER_XML_END,
+                                  content);
+    if (readLength <= 0)
         return 0;
 
-    fseek(file, readLength, SEEK_CUR);
-    entry.reset();
-    entry.setType(UconfigXML::XMLDeclEntry);
-
-    char* buffer = NULL;
-    int contentLength = maxLength > 0 ? maxLength - readLength : 0;
-    contentLength = Uconfig_getdelim(&buffer,
-                                     &contentLength,
-                                     UCONFIG_IO_XML_DELIMITER_XML_END,
-                                     file);
-    if (contentLength > 0)
-    {
-        // Try to parse attributes in the tag one by one
-        int pos = 0;
-        int attributeLength;
-        UconfigKeyObject key;
-        while (pos < contentLength)
-        {
-            attributeLength = parseTagAttribute(&buffer[pos],
-                                                key,
-                                                contentLength - pos);
-            if (attributeLength > 0)
-            {
-                entry.addKey(&key);
-                pos += attributeLength;
-            }
-            else
-                break;
-        }
-
-        readLength += contentLength;
-    }
-    if (buffer)
-        free(buffer);
-
-    if (Uconfig_fpeekCmp(file,
-                         UCONFIG_IO_XML_DELIMITER_XML_END,
-                         -strlen(UCONFIG_IO_XML_DELIMITER_XML_END)) < 0)
-        readLength += strlen(UCONFIG_IO_XML_DELIMITER_XML_END);
+    parseSectionAttributes(content, handler, true);
+    handler->onEntryEnd();
 
     return readLength;
 }
 
-// Try to parse a DOCTYPE section from the file.
-// Similar to the function UconfigXMLPrivate::parseXMLDelcaration().
-// See its comment for detailed explanation
-int UconfigXMLPrivate::parseDoctype(FILE* file,
-                                    UconfigEntryObject& entry,
-                                    int maxLength)
+// Try to parse a DOCTYPE section at the current reading position.
+// Similar to the function UconfigXMLPrivate::parseXMLDelcaration(),
+// except that attributes may come without names.
+int UconfigXMLPrivate::parseDoctype(UconfigInputBuffer& input,
+                                    UconfigHandler* handler)
 {
-    if (!file)
+    std::vector<char> content;
+    int readLength = parseSection(input, handler,
+                                  UconfigXML::DoctypeEntry,
+                                  UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN,
+                                  UCONFIG_IO_XML_DELIMITER_DOCTYPE_END,
+                                  content);
+    if (readLength <= 0)
         return 0;
 
-    int readLength = Uconfig_fpeekCmp(file,
-                                      UCONFIG_IO_XML_DELIMITER_DOCTYPE_BEGIN,
-                                      0);
-    if (readLength == 0 || (maxLength > 0  && readLength > maxLength))
-        return 0;
+    parseSectionAttributes(content, handler, false);
+    handler->onEntryEnd();
 
-    fseek(file, readLength, SEEK_CUR);
-    entry.reset();
-    entry.setType(UconfigXML::DoctypeEntry);
-
-    char* buffer = NULL;
-    int contentLength = maxLength > 0 ? maxLength - readLength : 0;
-    contentLength = Uconfig_getdelim(&buffer,
-                                     &contentLength,
-                                     UCONFIG_IO_XML_DELIMITER_DOCTYPE_END,
-                                     file);
-    if (contentLength > 0)
+    return readLength;
+}
+
+// Try to parse attributes in the content of a section one by one
+void UconfigXMLPrivate::parseSectionAttributes(std::vector<char>& content,
+                                               UconfigHandler* handler,
+                                               bool complete)
+{
+    int contentLength = content.size();
+    if (contentLength <= 0)
+        return;
+
+    // Attributes are searched for as strings
+    content.push_back('\0');
+
+    int pos = 0;
+    int attributeLength;
+    UconfigKeyObject key;
+    key.setArena(handler->arena());
+    while (pos < contentLength)
     {
-        int pos = 0;
-        int attributeLength;
-        UconfigKeyObject key;
-        while (pos < contentLength)
+        attributeLength = parseTagAttribute(&content[pos],
+                                            key,
+                                            contentLength - pos,
+                                            complete);
+        if (attributeLength > 0)
         {
-            attributeLength = parseTagAttribute(&buffer[pos],
-                                                key,
-                                                contentLength - pos,
-                                                false);
-            if (attributeLength > 0)
-            {
-                entry.addKey(&key);
-                pos += attributeLength;
-            }
-            else
-                break;
+            handler->onKey(key);
+            key.reset();
+            pos += attributeLength;
         }
-
-        readLength += contentLength;
+        else
+            break;
     }
-    if (buffer)
-        free(buffer);
-
-    if (Uconfig_fpeekCmp(file,
-                         UCONFIG_IO_XML_DELIMITER_DOCTYPE_END,
-                         -strlen(UCONFIG_IO_XML_DELIMITER_DOCTYPE_END)) < 0)
-        readLength += strlen(UCONFIG_IO_XML_DELIMITER_DOCTYPE_END);
-
-    return readLength;
 }
@@ -1,9 +1,12 @@
 #ifndef UCONFIGXML_H
 #define UCONFIGXML_H
 
+#include <vector>
 #include "uconfigio.h"
 
 
+typedef struct _IO_FILE FILE;
+
 class UconfigXML : public UconfigIO
 {
 public:
@@ -26,9 +29,77 @@ public:
     static bool readUconfig(const char* filename,
                             UconfigFile* config,
                             bool skipBlankTextNode);
+    static bool freadUconfig(FILE* file,
+                             UconfigFile* config,
+                             bool skipBlankTextNode = false);
+    static bool readUconfig(const char* data,
+                            size_t length,
+                            UconfigFile* config,
+                            bool skipBlankTextNode = false);
     static bool writeUconfig(const char* filename,
                              UconfigFile* config,
                              bool forceQuotingValue);
+    static bool writeUconfig(char** data,
+                             size_t* length,
+                             UconfigFile* config,
+                             bool forceQuotingValue = false);
+
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler);
+    static bool parseUconfig(const char* filename,
+                             UconfigHandler* handler,
+                             bool skipBlankTextNode);
+    static bool fparseUconfig(FILE* file,
+                              UconfigHandler* handler,
+                              bool skipBlankTextNode = false);
+    static bool parseUconfig(const char* data,
+                             size_t length,
+                             UconfigHandler* handler,
+                             bool skipBlankTextNode = false);
+};
+
+// Write the reported entries to a file as XML, as soon as they arrive
+// Only the names of the open elements are kept in memory, along with
+// the content of an element from its first child on: keys reported after
+// that child (e.g. members of a JSON object) still go to its opening tag.
+// Past a bound (1 MiB), that content is written out, and later keys
+// are written as child elements instead. Children of other sections
+// are ignored.
+class UconfigXMLWriter : public UconfigWriter
+{
+public:
+    UconfigXMLWriter(const UconfigSink& sink,
+                     bool forceQuotingValue = false);
+    ~UconfigXMLWriter();
+
+    void onEntryBegin(const char* name, int nameSize, int type);
+    void onKey(UconfigKeyObject& key);
+    void onEntryEnd();
+    bool flush();
+
+protected:
+    struct Level
+    {
+        int type;
+        int keyCount;
+        bool hasChild;
+        bool tagWritten; // The opening tag has been closed and written out
+        size_t tagEnd;   // Position of the end of the opening tag in held
+        size_t nameOffset;
+        int nameLength;
+    };
+
+    bool forceQuotingValue;
+    std::vector<Level> levels; // Open entries, without the root
+    std::vector<char> names;   // Names of the open entries
+    int skipLevel;             // Depth of nesting in an ignored entry
+    int holdLevel;             // First entry whose content is held, or -1
+    UconfigOutputBuffer* held; // Content of that entry, in memory
+    char* heldData;
+    size_t heldLength;
+
+    UconfigOutputBuffer& target();
+    void release();
 };
 
 #endif // UCONFIGXML_H
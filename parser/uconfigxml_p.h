@@ -1,8 +1,10 @@
 #ifndef UCONFIGXML_P_H
 #define UCONFIGXML_P_H
 
+#include <vector>
 #include "uconfigio.h"
 
+class UconfigInputBuffer;
 typedef UconfigIO::ValueType ValueType;
 
 class UconfigXMLKey : public UconfigKeyObject, public UconfigIO
@@ -10,7 +12,8 @@ class UconfigXMLKey : public UconfigKeyObject, public UconfigIO
 public:
     bool parseValue(const char* expression, int length = 0);
 
-    int fwriteValue(FILE* file, bool forceWrappingQuotes = true);
+    int writeValue(UconfigOutputBuffer& output,
+                   bool forceWrappingQuotes = true);
 };
 
 class UconfigXMLPrivate
@@ -18,34 +21,38 @@ class UconfigXMLPrivate
 public:
     static ValueType getValueType(const char* value, int length);
 
-    static int freadEntry(FILE* file,
-                          UconfigEntryObject& entry,
-                          bool inTag = false,
-                          bool skipBlankTextNode = true);
-    static bool fwriteEntry(FILE* file,
-                            UconfigEntryObject& entry,
-                            int level = 0,
-                            bool forceQuotingValue = false);
-    static bool fwriteEntryKeys(FILE* file,
-                                UconfigEntryObject& entry,
-                                bool valueOnly = false,
-                                bool forceQuotingValue = false);
+    static bool readInput(UconfigInputBuffer& input,
+                          UconfigFile* config,
+                          const char* filename,
+                          bool skipBlankTextNode);
+    static bool parseInput(UconfigInputBuffer& input,
+                           UconfigHandler* handler,
+                           bool skipBlankTextNode);
+    static size_t parseEntry(UconfigInputBuffer& input,
+                             UconfigHandler* handler,
+                             bool inTag = false,
+                             bool skipBlankTextNode = true);
 
     static int parseTagAttribute(const char* expression,
                                  UconfigKeyObject& key,
                                  int expressionLength = 0,
                                  bool complete = true);
-    static int parseComment(FILE *file,
-                            UconfigEntryObject& entry,
-                            int maxLength = 0);
-    static int parseCDATA(FILE* file,
-                          UconfigEntryObject& entry,
-                          int maxLength = 0);
-    static int parseXMLDelcaration(FILE* file,
-                                   UconfigEntryObject& entry,
-                                   int maxLength = 0);
-    static int parseDoctype(FILE* file,
-                            UconfigEntryObject& entry,
-                            int maxLength = 0);
+    static int parseSection(UconfigInputBuffer& input,
+                            UconfigHandler* handler,
+                            int type,
+                            const char* begin,
+                            const char* end,
+                            std::vector<char>& content);
+    static void parseSectionAttributes(std::vector<char>& content,
+                                       UconfigHandler* handler,
+                                       bool complete);
+    static int parseComment(UconfigInputBuffer& input,
+                            UconfigHandler* handler);
+    static int parseCDATA(UconfigInputBuffer& input,
+                          UconfigHandler* handler);
+    static int parseXMLDelcaration(UconfigInputBuffer& input,
+                                   UconfigHandler* handler);
+    static int parseDoctype(UconfigInputBuffer& input,
+                            UconfigHandler* handler);
 };
 #endif // UCONFIGXML_P_H
@@ -1,15 +1,25 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "utils.h"
 
-#define UCONFIG_UTILS_LINEDELIMITER_UNIX    "\n"
-#define UCONFIG_UTILS_LINEDELIMITER_OSX     "\r"
-#define UCONFIG_UTILS_LINEDELIMITER_WIN     "\r\n"
 #define UCONFIG_UTILS_INDENTATION_SPACE     "    "
 #define UCONFIG_UTILS_INDENTATION_TAB       "   "
 
-#define UCONFIG_UTILS_FILE_BUFFER_MAX   1024
+#define UCONFIG_UTILS_READ_BUFFER_SIZE      65536
+
+// Smaller files are read faster than they are mapped
+#define UCONFIG_UTILS_MAP_SIZE_MIN          65536
+
+#define UCONFIG_UTILS_HASH_PRIME1           0x9E3779B185EBCA87ULL
+#define UCONFIG_UTILS_HASH_PRIME2           0xC2B2AE3D27D4EB4FULL
+#define UCONFIG_UTILS_HASH_PRIME3           0x165667B19E3779F9ULL
+#define UCONFIG_UTILS_HASH_PRIME4           0x85EBCA77C2B2AE63ULL
+#define UCONFIG_UTILS_HASH_PRIME5           0x27D4EB2F165667C5ULL
 
 
 int Uconfig_strpos(const char* haystack, const char* needle)
@@ -21,33 +31,25 @@ int Uconfig_strpos(const char* haystack, const char* needle)
         return -1;
 }
 
-int Uconfig_findLineDelimiter(const char* str)
-{
-    const char* search = UCONFIG_UTILS_LINEDELIMITER_UNIX;
-    int pos = Uconfig_strpos(str, search);
-    if (pos >= 0)
-        return pos;
-
-    search = UCONFIG_UTILS_LINEDELIMITER_OSX;
-    pos = Uconfig_strpos(str, search);
-    if (pos >= 0)
-        return pos;
-
-    search = UCONFIG_UTILS_LINEDELIMITER_WIN;
-    pos = Uconfig_strpos(str, search);
-    if (pos >= 0)
-        return pos;
-
-    return -1;
-}
-
 char* Uconfig_strnstr(const char* haystack, const char* needle, int length)
 {
-    const char* pos = strstr(haystack, needle);
-    if (pos - haystack + strlen(needle) <= length)
-        return (char*)(pos);
-    else
-        return NULL;
+    int needleLength = strlen(needle);
+    if (needleLength == 0)
+        return (char*)(haystack);
+
+    // Search for the first char of the needle, then check the rest of it
+    const char* pos = haystack;
+    const char* last = haystack + length - needleLength;
+    while (pos <= last)
+    {
+        pos = (const char*)(memchr(pos, needle[0], last - pos + 1));
+        if (!pos)
+            break;
+        if (memcmp(pos, needle, needleLength) == 0)
+            return (char*)(pos);
+        pos++;
+    }
+    return NULL;
 }
 
 bool Uconfig_isspace(const char* str, int length)
@@ -70,115 +72,6 @@ char* Uconfig_strncpy (char* dest, const char* src, int count)
     return strncpy(dest, src, count);
 }
 
-int Uconfig_getdelim(char** lineptr, int* n,
-                     const char* delimiter, FILE* stream)
-{
-    int bufferSize;
-
-    // See if the size limit is valid
-    if (n != NULL && *n > 0)
-        bufferSize = *n;
-    else
-        bufferSize = UCONFIG_UTILS_FILE_BUFFER_MAX;
-
-    // Reallocating memory for the buffer
-    if (*lineptr == NULL)
-    {
-        *lineptr = (char*)(malloc(bufferSize));
-        if (*lineptr == NULL)
-            return -1;
-    }
-
-    char* p1 = *lineptr;
-    char* p2 = *lineptr + bufferSize;
-    char* newBuffer;
-    int newBufferSize;
-    int allocationFailed = false;
-
-    long readLength;
-    const long delimiterLength = strlen(delimiter);
-    const long seekLength = UCONFIG_UTILS_FILE_BUFFER_MAX + delimiterLength;
-    char* buffer = (char*)(malloc(seekLength * sizeof(char)));
-    char* pos;
-
-    while (true)
-    {
-        readLength = fread(buffer, 1, seekLength, stream);
-        if (readLength <= 0)
-            break;
-
-        pos = Uconfig_strnstr(buffer, delimiter, readLength);
-        if (pos)
-        {
-            // See if we need to increase the size of the buffer
-            if (p1 + (pos - buffer) + 1 >= p2)
-            {
-                if (n != NULL && *n > 0)
-                {
-                    // Size limited by caller; stop reading
-                    Uconfig_strncpy(p1, buffer, p2 - p1 - 1);
-                    p1 = p2;
-                    break;
-                }
-
-                newBufferSize = bufferSize * 2;
-                newBuffer = (char*)(realloc(*lineptr, newBufferSize));
-                if (newBuffer == NULL)
-                {
-                    allocationFailed = true;
-                    break;
-                }
-                p1 += newBuffer - *lineptr;
-                p2 = newBuffer + newBufferSize;
-                *lineptr = newBuffer;
-                bufferSize = newBufferSize;
-            }
-            Uconfig_strncpy(p1, buffer, pos - buffer);
-            p1 += pos - buffer;
-            fseek(stream, pos - buffer + delimiterLength - readLength,
-                  SEEK_CUR);
-            break;
-        }
-
-        if (feof(stream))
-            break;
-
-        // See if we need to increase the size of the buffer
-        if (p1 + readLength - delimiterLength + 1 >= p2)
-        {
-            if (n != NULL && *n > 0)
-            {
-                // Size limited by caller; stop reading
-                Uconfig_strncpy(p1, buffer, p2 - p1 - 1);
-                p1 = p2;
-                break;
-            }
-
-            newBufferSize = bufferSize * 2;
-            newBuffer = (char*)(realloc(*lineptr, newBufferSize));
-            if (newBuffer == NULL)
-            {
-                readLength = 0;
-                break;
-            }
-            p1 += newBuffer - *lineptr;
-            p2 = newBuffer + newBufferSize;
-            *lineptr = newBuffer;
-            bufferSize = newBufferSize;
-        }
-        Uconfig_strncpy(p1, buffer, readLength - delimiterLength);
-        p1 += readLength - delimiterLength;
-        fseek(stream, -delimiterLength, SEEK_CUR);
-
-    }
-    free(buffer);
-
-    if (allocationFailed)
-        return -1;
-    else
-        return p1 - *lineptr;
-}
-
 int Uconfig_fpeek(FILE* stream, char* buffer, int n)
 {
     int readLength;
@@ -244,6 +137,107 @@ int Uconfig_fpeekCmp(FILE *stream, const char* string, int n)
     return readLength;
 }
 
+int Uconfig_nameLength(const char* name, int nameSize)
+{
+    if (!name)
+        return 0;
+    if (nameSize <= 0)
+        return strlen(name);
+    return strnlen(name, nameSize);
+}
+
+unsigned int Uconfig_hashName(const char* name, int nameSize)
+{
+    unsigned int hash = 2166136261U;
+    for (int i=0; i<nameSize; i++)
+    {
+        hash ^= (unsigned char)(name[i]);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static inline uint64_t Uconfig_rotateLeft(uint64_t value, int count)
+{
+    return (value << count) | (value >> (64 - count));
+}
+
+static inline uint64_t Uconfig_hashRound(uint64_t hash, const char* data)
+{
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    hash += word * UCONFIG_UTILS_HASH_PRIME2;
+    return Uconfig_rotateLeft(hash, 31) * UCONFIG_UTILS_HASH_PRIME1;
+}
+
+static inline uint64_t Uconfig_hashMerge(uint64_t hash, uint64_t lane)
+{
+    lane *= UCONFIG_UTILS_HASH_PRIME2;
+    lane = Uconfig_rotateLeft(lane, 31) * UCONFIG_UTILS_HASH_PRIME1;
+    hash ^= lane;
+    return hash * UCONFIG_UTILS_HASH_PRIME1 + UCONFIG_UTILS_HASH_PRIME4;
+}
+
+uint64_t Uconfig_hashContent(const char* data, size_t length)
+{
+    const char* end = data + length;
+    uint64_t hash;
+
+    // Four lanes of 8 bytes each, for blocks of 32 bytes
+    if (length >= 32)
+    {
+        uint64_t lanes[4] = {UCONFIG_UTILS_HASH_PRIME1 +
+                                UCONFIG_UTILS_HASH_PRIME2,
+                             UCONFIG_UTILS_HASH_PRIME2,
+                             0,
+                             0 - UCONFIG_UTILS_HASH_PRIME1};
+        for (; end - data >= 32; data += 32)
+        {
+            for (int i=0; i<4; i++)
+                lanes[i] = Uconfig_hashRound(lanes[i], data + i * 8);
+        }
+
+        hash = Uconfig_rotateLeft(lanes[0], 1) +
+               Uconfig_rotateLeft(lanes[1], 7) +
+               Uconfig_rotateLeft(lanes[2], 12) +
+               Uconfig_rotateLeft(lanes[3], 18);
+        for (int i=0; i<4; i++)
+            hash = Uconfig_hashMerge(hash, lanes[i]);
+    }
+    else
+        hash = UCONFIG_UTILS_HASH_PRIME5;
+    hash += length;
+
+    // Remaining bytes
+    for (; end - data >= 8; data += 8)
+    {
+        hash ^= Uconfig_hashRound(0, data);
+        hash = Uconfig_rotateLeft(hash, 27) * UCONFIG_UTILS_HASH_PRIME1 +
+               UCONFIG_UTILS_HASH_PRIME4;
+    }
+    if (end - data >= 4)
+    {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        hash ^= word * UCONFIG_UTILS_HASH_PRIME1;
+        hash = Uconfig_rotateLeft(hash, 23) * UCONFIG_UTILS_HASH_PRIME2 +
+               UCONFIG_UTILS_HASH_PRIME3;
+        data += 4;
+    }
+    for (; data < end; data++)
+    {
+        hash ^= (unsigned char)(*data) * UCONFIG_UTILS_HASH_PRIME5;
+        hash = Uconfig_rotateLeft(hash, 11) * UCONFIG_UTILS_HASH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= UCONFIG_UTILS_HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= UCONFIG_UTILS_HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
 int Uconfig_fwriteIndentation(FILE* __restrict stream,
                               int level,
                               bool usingTabs)
@@ -263,3 +257,96 @@ int Uconfig_fwriteIndentation(FILE* __restrict stream,
 
     return charCount;
 }
+
+const char* Uconfig_mapFile(const char* filename, size_t* length)
+{
+    *length = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+
+    // The file is normally parsed from the beginning to the end
+    madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+
+    *length = fileStat.st_size;
+    return static_cast<const char*>(data);
+}
+
+void Uconfig_unmapFile(const char* data, size_t length)
+{
+    if (data)
+        munmap(const_cast<char*>(data), length);
+}
+
+const char* Uconfig_loadFile(const char* filename,
+                             size_t* length,
+                             bool* mapped)
+{
+    *length = 0;
+    *mapped = false;
+
+    struct stat fileStat;
+    if (stat(filename, &fileStat) != 0 ||
+        fileStat.st_size >= UCONFIG_UTILS_MAP_SIZE_MIN)
+    {
+        const char* data = Uconfig_mapFile(filename, length);
+        *mapped = data != NULL;
+        if (data)
+            return data;
+    }
+
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+        return NULL;
+
+    // Read the file by blocks of growing size
+    size_t capacity = UCONFIG_UTILS_READ_BUFFER_SIZE;
+    char* buffer = (char*)(malloc(capacity));
+    size_t readLength;
+    while (buffer)
+    {
+        readLength = fread(&buffer[*length], 1, capacity - *length, file);
+        *length += readLength;
+        if (readLength == 0)
+            break;
+        if (*length == capacity)
+        {
+            capacity *= 2;
+            char* newBuffer = (char*)(realloc(buffer, capacity));
+            if (!newBuffer)
+                free(buffer);
+            buffer = newBuffer;
+        }
+    }
+    if (ferror(file))
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+    fclose(file);
+
+    if (!buffer)
+        *length = 0;
+    return buffer;
+}
+
+void Uconfig_releaseFile(const char* data, size_t length, bool mapped)
+{
+    if (mapped)
+        Uconfig_unmapFile(data, length);
+    else
+        free(const_cast<char*>(data));
+}
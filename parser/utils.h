@@ -1,6 +1,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct _IO_FILE FILE;
 
@@ -9,11 +11,7 @@ typedef struct _IO_FILE FILE;
 // Find the position of the first occurance of a substring in string
 extern int Uconfig_strpos(const char* haystack, const char* needle);
 
-// Find the position of the first occurance of a line delimitor
-// (\n, \r or \r\n) in a string
-extern int Uconfig_findLineDelimiter(const char* str);
-
-// Like strstr, but search up to LENGTH bytes
+// Like strstr, but search up to LENGTH bytes, which may include "\0"
 extern char* Uconfig_strnstr(const char* haystack,
                              const char* needle,
                              int length);
@@ -24,15 +22,6 @@ extern bool Uconfig_isspace(const char* str, int length = 1);
 // Like strncpy, with a "\0" appended to the destination
 extern char* Uconfig_strncpy (char* dest, const char* src, int count);
 
-// Like getdelim, read up to (and including) a DELIMITER
-// from STREAM into *LINEPTR. The DELIMITER can be a multi-char string.
-// If *N > 0, the maximum length of string read from STREAM is *N;
-// otherwise, its length is unlimited (except by the file size).
-extern int Uconfig_getdelim(char** __restrict lineptr,
-                            int* __restrict n,
-                            const char* __restrict delimiter,
-                            FILE* __restrict stream);
-
 // Read N chars from STREAM, the go back to where we were
 // before the read
 extern int Uconfig_fpeek(FILE* stream, char* buffer, int n = 1);
@@ -45,10 +34,39 @@ extern int Uconfig_freadCmp(FILE* stream, const char* string, int n = 0);
 // Like Uconfig_freadCmp, but go back to where we were before the read
 extern int Uconfig_fpeekCmp(FILE* stream, const char* string, int n = 0);
 
+// Length of a name of NAMESIZE bytes, without the terminating "\0"
+// that is counted in NAMESIZE when the name is set from a C string
+extern int Uconfig_nameLength(const char* name, int nameSize);
+
+// FNV-1a hash of a name of NAMESIZE bytes
+extern unsigned int Uconfig_hashName(const char* name, int nameSize);
+
+// XXH64 hash (with a seed of 0) of a block of LENGTH bytes, e.g. the
+// content of a file; words are read in the byte order of the machine
+extern uint64_t Uconfig_hashContent(const char* data, size_t length);
+
 // Write multiple spaces (0x20) or tabs (0x09) as indentation of text
 extern int Uconfig_fwriteIndentation(FILE* stream,
                                      int level,
                                      bool usingTabs = false);
 
+// Map a whole file into memory for reading, and store its size in *LENGTH
+// Return NULL if the file cannot be mapped (e.g. if it is empty)
+extern const char* Uconfig_mapFile(const char* filename, size_t* length);
+
+// Unmap a file mapped by Uconfig_mapFile()
+extern void Uconfig_unmapFile(const char* data, size_t length);
+
+// Load a whole file for reading: map it into memory if possible, or read
+// it into memory otherwise (e.g. if it is empty or if it is a pipe)
+// Return NULL if the file cannot be read; *MAPPED tells which way it was
+// loaded, for Uconfig_releaseFile()
+extern const char* Uconfig_loadFile(const char* filename,
+                                    size_t* length,
+                                    bool* mapped);
+
+// Release a file loaded by Uconfig_loadFile()
+extern void Uconfig_releaseFile(const char* data, size_t length, bool mapped);
+
 
 #endif // UTILS_H
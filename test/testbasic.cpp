@@ -1,9 +1,67 @@
 #include <cstring>
 #include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <clocale>
+#include <cmath>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "parser/uconfigio.h"
+#include "parser/uconfigarena.h"
+#include "parser/uconfiginputbuffer.h"
+#include "parser/uconfiglinereader.h"
+#include "parser/uconfigoutputbuffer.h"
+#include "parser/uconfignumber.h"
+#include "parser/uconfigini.h"
+#include "parser/uconfigcsv.h"
+#include "parser/uconfigjson.h"
 
 
+// Number of calls to the global operator new since program start
+static std::atomic<long> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    void* block = malloc(size > 0 ? size : 1);
+    if (!block)
+        throw std::bad_alloc();
+    return block;
+}
+
+void* operator new[](size_t size)
+{
+    allocationCount++;
+    void* block = malloc(size > 0 ? size : 1);
+    if (!block)
+        throw std::bad_alloc();
+    return block;
+}
+
+void operator delete(void* block) noexcept
+{
+    free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+    operator delete(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+    operator delete[](block);
+}
+
 bool testEntry()
 {
     const char* name1 = "TestEntry";
@@ -38,12 +96,12 @@ bool testEntry()
     bool success = true;
     success &= e1.name != e2.name();
     success &= strcmp(e1.name, e2.name()) == 0;
-    UconfigKeyObject* newKeys = e2.keys();
+    UconfigKeyRef* newKeys = e2.keys();
     success &= e1.keys[0]->name != newKeys[0].name();
     success &= strcmp(e1.keys[0]->name, newKeys[0].name()) == 0;
     success &= e1.keys[1]->value != newKeys[1].value();
     success &= memcmp(e1.keys[1]->value, newKeys[1].value(), 32) == 0;
-    UconfigKeyObject* newKeys2 = e3.keys();
+    UconfigKeyRef* newKeys2 = e3.keys();
     success &= newKeys2[1].value() != newKeys[1].value();
     success &= memcmp(newKeys2[1].value(), newKeys[1].value(), 32) == 0;
 
@@ -60,7 +118,7 @@ bool testGuessValueType()
     const char* sampleDouble = "269.78274";
     const char* sampleBool = "FaLsE";
     const char* sampleRaw1 = "\"633401'";
-    const char* sampleRaw2 = "633.401E23";
+    const char* sampleRaw2 = "633.401E23G";
     const char* sampleRaw3 = "633401False";
 
     bool success = true;
@@ -79,6 +137,960 @@ bool testGuessValueType()
     success &= UconfigIO::guessValueType(sampleRaw3, strlen(sampleRaw3))
                     == ValueType::Raw;
 
+    // Numbers with signs and exponents, and long values
+    // read by blocks of chars
+    struct
+    {
+        const char* value;
+        ValueType type;
+    } samples[] =
+    {
+        {"-3", ValueType::Integer},
+        {"+42", ValueType::Integer},
+        {"633.401E23", ValueType::Double},
+        {"-1.5e-3", ValueType::Double},
+        {"2E+8", ValueType::Double},
+        {".5", ValueType::Double},
+        {"5.", ValueType::Double},
+        {"1e", ValueType::Raw},
+        {"1e+", ValueType::Raw},
+        {".", ValueType::Raw},
+        {"-", ValueType::Raw},
+        {"-.e1", ValueType::Raw},
+        {"1.2.3", ValueType::Raw},
+        {"1-2", ValueType::Raw},
+        {"0x1F", ValueType::Raw},
+        {"\"", ValueType::Raw},
+        {"''", ValueType::Chars},
+        {"TRUE", ValueType::Bool},
+        {"true ", ValueType::Raw},
+        {"tru", ValueType::Raw},
+        {"12345678901234567890123456789012345", ValueType::Integer},
+        {"-12345678901234567890123456789012.345e-67", ValueType::Double},
+        {"12345678901234567890123456789012345x", ValueType::Raw},
+        {"1234567890123456x7890123456789012345", ValueType::Raw},
+        {"1234567890.1234567890123456789012345", ValueType::Double},
+        {"1234567890.12345678901234567.89012345", ValueType::Raw}
+    };
+    const int sampleCount = sizeof(samples) / sizeof(samples[0]);
+
+    UconfigIO::ValueSpan spans[sampleCount];
+    ValueType types[sampleCount];
+    for (int i=0; i<sampleCount; i++)
+    {
+        spans[i].value = samples[i].value;
+        spans[i].length = strlen(samples[i].value);
+        success &= UconfigIO::guessValueType(spans[i].value, spans[i].length)
+                        == samples[i].type;
+    }
+    UconfigIO::classifyValues(spans, sampleCount, types);
+    for (int i=0; i<sampleCount; i++)
+        success &= types[i] == samples[i].type;
+
+    // Only LENGTH chars are read
+    spans[0].value = "2.5e3xyz";
+    spans[0].length = 5;
+    spans[1].value = "false";
+    spans[1].length = 0;
+    UconfigIO::classifyValues(spans, 2, types);
+    success &= types[0] == ValueType::Double && types[1] == ValueType::Raw;
+
+    // Every kernel classifies random values as they are one by one
+    const char randomChars[] = "0123456789+-.eEx\"'";
+    const int randomCount = 1000;
+    std::vector<std::string> values(randomCount);
+    std::vector<UconfigIO::ValueSpan> randomSpans(randomCount);
+    std::vector<ValueType> randomTypes(randomCount);
+    srand(18);
+    for (int i=0; i<randomCount; i++)
+    {
+        int length = rand() % 20;
+        for (int j=0; j<length; j++)
+            values[i].push_back(j > 0 && rand() % 2 ?
+                                    '0' + rand() % 10 :
+                                    randomChars[rand() %
+                                                (sizeof(randomChars) - 1)]);
+        randomSpans[i].value = values[i].c_str();
+        randomSpans[i].length = length;
+    }
+    UconfigIO::Kernel defaultKernel = UconfigIO::kernel();
+    for (int i=UconfigIO::ScalarKernel; i<=UconfigIO::AVX2Kernel; i++)
+    {
+        if (!UconfigIO::setKernel(UconfigIO::Kernel(i)))
+            continue;
+
+        UconfigIO::classifyValues(randomSpans.data(), randomCount,
+                                  randomTypes.data());
+        for (int j=0; j<randomCount; j++)
+            success &= randomTypes[j] ==
+                       UconfigIO::guessValueType(randomSpans[j].value,
+                                                 randomSpans[j].length);
+    }
+    UconfigIO::setKernel(defaultKernel);
+
+    return success;
+}
+
+// Compare two entries and their subentries recursively
+bool compareEntries(const UconfigEntryRef& entry1,
+                    const UconfigEntryRef& entry2)
+{
+    if (entry1.type() != entry2.type() ||
+        entry1.nameSize() != entry2.nameSize() ||
+        entry1.keyCount() != entry2.keyCount() ||
+        entry1.subentryCount() != entry2.subentryCount())
+        return false;
+    if (entry1.nameSize() > 0 &&
+        memcmp(entry1.name(), entry2.name(), entry1.nameSize()) != 0)
+        return false;
+
+    int i;
+    bool success = true;
+    UconfigKeyRange keyList1 = entry1.keyRange();
+    UconfigKeyRange keyList2 = entry2.keyRange();
+    for (i=0; i<keyList1.size() && success; i++)
+    {
+        UconfigKeyRef key1 = keyList1[i];
+        UconfigKeyRef key2 = keyList2[i];
+        success &= key1.type() == key2.type();
+        success &= key1.nameSize() == key2.nameSize();
+        success &= key1.valueSize() == key2.valueSize();
+        if (!success)
+            break;
+        success &= memcmp(key1.name(), key2.name(), key1.nameSize()) == 0;
+        success &= memcmp(key1.value(), key2.value(), key1.valueSize()) == 0;
+    }
+
+    UconfigEntryRange entryList1 = entry1.childRange();
+    UconfigEntryRange entryList2 = entry2.childRange();
+    for (i=0; i<entryList1.size() && success; i++)
+    {
+        success &= compareEntries(entryList1[i], entryList2[i]);
+    }
+
+    return success;
+}
+
+bool testArena()
+{
+    const char* filenameINI = "./SampleConfigs/QMLPlayer.ini";
+    const char* filenameCSV = "./SampleConfigs/population.csv";
+    const char* filenameJSON = "./SampleConfigs/firefox.json";
+
+    UconfigFile heapConfig, arenaConfig;
+    arenaConfig.setArenaEnabled(true);
+    if (!UconfigINI::readUconfig(filenameINI, &heapConfig) ||
+        !UconfigINI::readUconfig(filenameINI, &arenaConfig))
+        return false;
+
+    // The tree must be the same as the one allocated from the heap
+    bool success = true;
+    UconfigArena* arena = arenaConfig.arena();
+    success &= arena != NULL;
+    success &= arena->isFrozen();
+    success &= arena->chunkCount() > 0;
+    success &= compareEntries(heapConfig.rootEntry, arenaConfig.rootEntry);
+
+    // Edit the tree after loading: nodes fall back to the heap
+    size_t usedSize = arena->usedSize();
+    UconfigEntryRef entry = arenaConfig.rootEntry.searchSubentry("capture");
+    entry.setName("capture2");
+    UconfigKeyObject key;
+    key.setName("dir");
+    key.setValue("/tmp", 5);
+    entry.searchSubentry("dir").modifyKey(&key, "dir");
+    success &= arenaConfig.rootEntry.deleteSubentry("decoder");
+    success &= arena->usedSize() == usedSize;
+    success &= strcmp(arenaConfig.rootEntry.searchSubentry("capture2")
+                                 .searchSubentry("dir")
+                                 .searchKey("dir").value(), "/tmp") == 0;
+
+    // Reloading releases the previous tree at once
+    if (!UconfigCSV::readUconfig(filenameCSV, &heapConfig) ||
+        !UconfigCSV::readUconfig(filenameCSV, &arenaConfig))
+        return false;
+    success &= compareEntries(heapConfig.rootEntry, arenaConfig.rootEntry);
+
+    if (!UconfigJSON::readUconfig(filenameJSON, &heapConfig) ||
+        !UconfigJSON::readUconfig(filenameJSON, &arenaConfig))
+        return false;
+    success &= compareEntries(heapConfig.rootEntry, arenaConfig.rootEntry);
+
+    // Copies of an arena-backed tree are independent of the arena
+    UconfigFile copiedConfig;
+    copiedConfig.rootEntry.addSubentry(&arenaConfig.rootEntry);
+    arenaConfig.setArenaEnabled(false);
+    success &= arenaConfig.arena() == NULL;
+    success &= copiedConfig.rootEntry.subentryCount() == 1;
+
+    return success;
+}
+
+bool testSharedName()
+{
+    const char* filenameCSV = "./SampleConfigs/shared.csv";
+    const char* longName = "population_in_thousands";
+    const int longNameSize = strlen(longName);
+
+    FILE* file = fopen(filenameCSV, "w");
+    if (!file)
+        return false;
+    fprintf(file, "region,year,%s\n", longName);
+    for (int i=0; i<100; i++)
+        fprintf(file, "%s,%d,%d.5\n", i % 2 ? "ASIA" : "EUROPE", 1950 + i, i);
+    fclose(file);
+
+    UconfigFile heapConfig, arenaConfig;
+    arenaConfig.setArenaEnabled(true);
+    bool success = UconfigCSV::readUconfig(filenameCSV, &heapConfig) &&
+                   UconfigCSV::readUconfig(filenameCSV, &arenaConfig);
+    remove(filenameCSV);
+    if (!success)
+        return false;
+    success &= compareEntries(heapConfig.rootEntry, arenaConfig.rootEntry);
+
+    // Rows of the same name share their name and their long column names
+    // (names read from CSV files are not terminated by "\0")
+    UconfigEntryRef table = arenaConfig.rootEntry.childRange()[0];
+    UconfigEntryRef row1 = table.childRange()[1];
+    UconfigEntryRef row2 = table.childRange()[2];
+    UconfigEntryRef row3 = table.childRange()[3];
+    success &= row1.name() != NULL && row1.name() == row3.name();
+    success &= row1.name() != row2.name();
+    success &= row1.searchKey(longName, longNameSize).name() != NULL;
+    success &= row1.searchKey(longName, longNameSize).name() ==
+               row3.searchKey(longName, longNameSize).name();
+    success &= arenaConfig.arena()->sharedNameCount() < 10;
+
+    // Not so for trees allocated from the heap
+    UconfigEntryRef heapTable = heapConfig.rootEntry.childRange()[0];
+    success &= heapTable.childRange()[1].name() !=
+               heapTable.childRange()[3].name();
+
+    // Names given from outside are matched by address or by content
+    char name[32];
+    strcpy(name, "ASIA");
+    success &= table.searchSubentry(name, NULL, false, 4).name() ==
+               row2.name();
+    success &= table.searchSubentry("ASIA").isNull();
+
+    // Names set after loading are shared only if they are already known
+    UconfigKeyObject key;
+    key.setName("population_in_millions");
+    key.setValue("2.5", 4);
+    success &= row1.addKey(&key);
+    success &= row1.searchKey("population_in_millions").value() != NULL;
+    row3.setName("ASIA", 4);
+    success &= row3.name() == row2.name();
+    row1.setName("AFRICA");
+    success &= table.searchSubentry("AFRICA").name() == row1.name();
+
+    // Shared names are released along with the tree
+    success &= table.deleteSubentry("EUROPE", 6);
+    success &= table.deleteSubentry("ASIA", 4);
+    arenaConfig.rootEntry.reset();
+    success &= arenaConfig.arena()->sharedNameCount() == 0;
+
+    return success;
+}
+
+bool testRange()
+{
+    const char* filenameJSON = "./SampleConfigs/firefox.json";
+    const char* filenameOutput = "./SampleConfigs/firefox.range.json";
+
+    UconfigFile config;
+    if (!UconfigJSON::readUconfig(filenameJSON, &config))
+        return false;
+
+    // Ranges see the same nodes as the counters
+    bool success = true;
+    int count = 0;
+    for (UconfigEntryObject subentry : config.rootEntry.childRange())
+    {
+        success &= subentry.keyRange().size() == subentry.keyCount();
+        count++;
+    }
+    success &= count == config.rootEntry.subentryCount();
+    success &= config.rootEntry.keyRange().size() ==
+               config.rootEntry.keyCount();
+
+    // A full export does not allocate any wrapper: only the writer keeps
+    // the open entries, so that more nodes need no more allocations
+    long oldCount = allocationCount;
+    success &= UconfigJSON::writeUconfig(filenameOutput, &config);
+    long exportCount = allocationCount - oldCount;
+
+    UconfigKeyObject key;
+    key.setName("extra");
+    key.setType(UconfigJSON::Chars);
+    key.setValue("value", 6);
+    for (int i=0; i<100; i++)
+        config.rootEntry.addKey(&key);
+
+    oldCount = allocationCount;
+    success &= UconfigJSON::writeUconfig(filenameOutput, &config);
+    success &= allocationCount - oldCount == exportCount;
+    remove(filenameOutput);
+
+    return success;
+}
+
+// Check that searching ENTRY by name gives the same nodes as REFERENCE
+// for names "name0" to "nameN"
+static bool compareSearches(UconfigEntryObject& entry,
+                            UconfigEntryObject& reference,
+                            int count)
+{
+    char name[16];
+    for (int i=0; i<=count; i++)
+    {
+        sprintf(name, "name%d", i);
+        UconfigKeyObject key1 = entry.searchKey(name);
+        UconfigKeyObject key2 = reference.searchKey(name);
+        if (entry.existKey(name) != reference.existKey(name) ||
+            (key1.value() == NULL) != (key2.value() == NULL))
+            return false;
+        if (key1.value() && strcmp(key1.value(), key2.value()) != 0)
+            return false;
+
+        UconfigEntryObject subentry1 = entry.searchSubentry(name);
+        UconfigEntryObject subentry2 = reference.searchSubentry(name);
+        if (entry.existSubentry(name) != reference.existSubentry(name) ||
+            subentry1.type() != subentry2.type())
+            return false;
+    }
+    return true;
+}
+
+bool testNameIndex()
+{
+    const int count = 1000;
+
+    // Keys and subentries named "name0" to "name999", with duplicates
+    // distinguished by their value or type
+    char name[16], value[16];
+    UconfigKeyObject key;
+    UconfigEntryObject subentry;
+    UconfigEntryObject indexed, scanned;
+    for (int i=0; i<count; i++)
+    {
+        sprintf(name, "name%d", i % (count / 2));
+        sprintf(value, "%d", i);
+        key.setName(name);
+        key.setValue(value, strlen(value) + 1);
+        indexed.addKey(&key);
+        scanned.addKey(&key);
+
+        subentry.setName(name);
+        subentry.setType(i);
+        indexed.addSubentry(&subentry);
+        scanned.addSubentry(&subentry);
+    }
+
+    bool success = true;
+    indexed.setNameIndexEnabled(true);
+    success &= indexed.nameIndexEnabled() && !scanned.nameIndexEnabled();
+    success &= compareSearches(indexed, scanned, count);
+
+    // Appending nodes after the index is built
+    for (int i=count; i<count * 2; i++)
+    {
+        sprintf(name, "name%d", i);
+        key.setName(name);
+        indexed.addKey(&key);
+        scanned.addKey(&key);
+        subentry.setName(name);
+        indexed.addSubentry(&subentry);
+        scanned.addSubentry(&subentry);
+    }
+    success &= compareSearches(indexed, scanned, count * 2);
+
+    // Deleting the first of duplicated nodes reveals the second one
+    indexed.deleteKey("name1");
+    scanned.deleteKey("name1");
+    indexed.deleteSubentry("name2");
+    scanned.deleteSubentry("name2");
+    success &= indexed.searchKey("name1").value() != NULL;
+    success &= indexed.searchSubentry("name2").type() == count / 2 + 2;
+
+    // Modifying and renaming nodes
+    key.setName("renamed1");
+    indexed.modifyKey(&key, "name3");
+    scanned.modifyKey(&key, "name3");
+    indexed.searchKey("name4").setName("name3");
+    scanned.searchKey("name4").setName("name3");
+    indexed.searchSubentry("name5").setName("renamed2");
+    scanned.searchSubentry("name5").setName("renamed2");
+    success &= compareSearches(indexed, scanned, count * 2);
+    success &= indexed.existKey("renamed1") &&
+               indexed.existSubentry("renamed2");
+
+    indexed.setNameIndexEnabled(false);
+    success &= !indexed.nameIndexEnabled();
+    success &= compareSearches(indexed, scanned, count * 2);
+
+    return success;
+}
+
+// Count the keys and entries of a tree, including its root
+static int countNodes(const UconfigEntryRef& entry)
+{
+    int count = 1 + entry.keyCount();
+    for (UconfigEntryRef subentry : entry.childRange())
+        count += countNodes(subentry);
+    return count;
+}
+
+bool testMove()
+{
+    const int count = 100;
+    const char* filenameCSV = "./SampleConfigs/population.csv";
+
+    UconfigEntryObject entry;
+    entry.reserveKeys(2);
+    entry.reserveSubentries(2);
+
+    const char* value = "a value too long to be stored in the key";
+    UconfigKeyObject key;
+    key.setName("name");
+    key.setType(UconfigIO::Chars);
+    key.setValue(value, strlen(value) + 1);
+
+    // A moved key only needs a new node; a copied key also needs
+    // a new value (short names are stored in the node)
+    bool success = true;
+    long oldCount = allocationCount;
+    success &= entry.addKey(&key);
+    success &= allocationCount - oldCount == 2;
+    oldCount = allocationCount;
+    success &= entry.addKey(std::move(key));
+    success &= allocationCount - oldCount == 1;
+    success &= key.name() == NULL && key.value() == NULL;
+    success &= entry.keyCount() == 2 &&
+               strcmp(entry.keyRange()[1].value(), value) == 0;
+
+    // A moved entry keeps all its nodes; only an empty entry is left
+    UconfigEntryObject subentry;
+    subentry.setName("subentry");
+    for (int i=0; i<count; i++)
+        subentry.addKey(&key);
+    oldCount = allocationCount;
+    success &= entry.addSubentry(std::move(subentry));
+    success &= allocationCount - oldCount == 1;
+    success &= subentry.name() == NULL && subentry.keyCount() == 0;
+    success &= entry.searchSubentry("subentry").keyCount() == count;
+
+    // Moving a reference gives another reference to the same node
+    UconfigEntryObject reference(entry.searchSubentry("subentry"));
+    reference.setType(1);
+    success &= entry.childRange()[0].type() == 1;
+
+    // Moving an owning object transfers its nodes
+    UconfigEntryObject owner(std::move(entry));
+    success &= entry.subentryCount() == 0 && owner.subentryCount() == 1;
+    entry = std::move(owner);
+    success &= entry.subentryCount() == 1 && owner.subentryCount() == 0;
+
+    // Containers move their objects when they grow, rather than copy them
+    success &= std::is_nothrow_move_constructible<UconfigKeyObject>::value;
+    success &= std::is_nothrow_move_constructible<UconfigEntryObject>::value;
+    success &= std::is_nothrow_move_assignable<UconfigEntryObject>::value;
+    std::vector<UconfigEntryObject> entries(1);
+    entries[0].setName("entry");
+    entries[0].addKey(&key);
+    const char* name = entries[0].name();
+    entries.resize(count);
+    success &= entries[0].name() == name && entries[0].keyCount() == 1;
+
+    // Parsers pass their nodes to the tree without copying them:
+    // each node takes at most a name, a value and the node itself
+    UconfigFile config;
+    oldCount = allocationCount;
+    success &= UconfigCSV::readUconfig(filenameCSV, &config);
+    success &= allocationCount - oldCount <=
+               3 * countNodes(config.rootEntry) + count;
+
+    return success;
+}
+
+bool testKeyStorage()
+{
+    const char* longName = "a name longer than the inline storage";
+    const char* longValue = "a value longer than the inline storage";
+    int intValue = 42;
+    double doubleValue = 0.1;
+
+    // Short names and values, including numbers, need no allocation
+    bool success = true;
+    UconfigKeyObject key;
+    long oldCount = allocationCount;
+    key.setName("short name");
+    key.setType(UconfigIO::Integer);
+    key.setValue((char*)(&intValue), sizeof(int));
+    success &= allocationCount == oldCount;
+    success &= strcmp(key.name(), "short name") == 0;
+    success &= *((int*)(key.value())) == 42;
+
+    key.setName(longName);
+    key.setValue(longValue, strlen(longValue) + 1);
+    success &= allocationCount - oldCount == 2;
+    success &= strcmp(key.name(), longName) == 0;
+    success &= strcmp(key.value(), longValue) == 0;
+
+    // Inline data follow the key when it is moved or copied
+    UconfigEntryObject entry;
+    std::vector<UconfigKeyObject> keys(1);
+    keys[0].setName("key");
+    keys[0].setType(UconfigIO::Double);
+    keys[0].setValue((char*)(&doubleValue), sizeof(double));
+    keys.resize(100);
+    success &= strcmp(keys[0].name(), "key") == 0;
+    success &= *((double*)(keys[0].value())) == 0.1;
+    entry.addKey(&keys[0]);
+    entry.addKey(std::move(keys[0]));
+    entry.addKey(std::move(key));
+    UconfigEntryObject copy(entry);
+    for (int i=0; i<2; i++)
+    {
+        UconfigKeyRef copiedKey = copy.keyRange()[i];
+        success &= copiedKey.value() != entry.keyRange()[i].value();
+        success &= strcmp(copiedKey.name(), "key") == 0;
+        success &= *((double*)(copiedKey.value())) == 0.1;
+    }
+    success &= strcmp(copy.keyRange()[2].value(), longValue) == 0;
+
+    // Values can go back and forth between the node and the allocator
+    UconfigKeyRef editedKey = copy.keyRange()[2];
+    editedKey.setValue("short", 6);
+    success &= strcmp(editedKey.value(), "short") == 0;
+    editedKey.setName("key");
+    success &= copy.searchKey("key").value() == copy.keyRange()[0].value();
+    success &= !copy.keyRange()[2].isNull();
+
+    // Structures built by the caller only need the fields they always had
+    UconfigKey rawKey;
+    UconfigKey* rawKeys[1] = {&rawKey};
+    UconfigEntry rawEntry;
+    memset(&rawKey, 0xbe, sizeof(rawKey));
+    memset(&rawEntry, 0xbe, sizeof(rawEntry));
+    rawKey.name = (char*)("key");
+    rawKey.nameSize = 4;
+    rawKey.valueType = 0;
+    rawKey.value = (char*)(longValue);
+    rawKey.valueSize = strlen(longValue) + 1;
+    rawEntry.name = (char*)("entry");
+    rawEntry.nameSize = 6;
+    rawEntry.type = 0;
+    rawEntry.keyCount = 1;
+    rawEntry.keys = rawKeys;
+    rawEntry.subentryCount = 0;
+    rawEntry.subentries = NULL;
+    rawEntry.parentEntry = NULL;
+    UconfigEntryObject rawCopy(&rawEntry);
+    success &= strcmp(rawCopy.name(), "entry") == 0;
+    success &= strcmp(rawCopy.searchKey("key").value(), longValue) == 0;
+    success &= rawCopy.searchKey("key").value() != longValue;
+
+    return success;
+}
+
+// Walk a tree through handles, going down to each node and back up
+static int walkNodes(const UconfigEntryRef& entry)
+{
+    int count = 1;
+    for (UconfigKeyRef key : entry.keyRange())
+        count += entry.searchKey(key.name(), key.nameSize()).isNull() ? 0 : 1;
+    for (UconfigEntryRef subentry : entry.childRange())
+    {
+        UconfigEntryRef found = entry.searchSubentry(subentry.name(), NULL,
+                                                     false,
+                                                     subentry.nameSize());
+        if (found.parentEntry().name() == entry.name())
+            count += walkNodes(subentry);
+    }
+    return count;
+}
+
+bool testEntryRef()
+{
+    const char* filename = "./SampleConfigs/QMLPlayer.ini";
+
+    UconfigFile config;
+    if (!UconfigINI::readUconfig(filename, &config))
+        return false;
+
+    // Handles are plain pointers: navigation does not allocate anything
+    bool success = true;
+    success &= std::is_trivially_copyable<UconfigEntryRef>::value;
+    success &= std::is_trivially_copyable<UconfigKeyRef>::value;
+    long oldCount = allocationCount;
+    int nodeCount = walkNodes(config.rootEntry);
+    UconfigEntryRef dir = config.rootEntry.searchSubentry("dir", NULL, true);
+    UconfigKeyRef key = dir.searchKey("dir");
+    UconfigEntryObject parent = dir.parentEntry();
+    success &= allocationCount == oldCount;
+    success &= nodeCount == countNodes(config.rootEntry);
+    success &= parent.name() != NULL && strcmp(parent.name(), "capture") == 0;
+
+    // Changes made through handles go to the tree
+    key.setValue("/tmp", 5);
+    dir.setType(1);
+    success &= strcmp(config.rootEntry.searchSubentry("capture")
+                                      .searchSubentry("dir")
+                                      .searchKey("dir").value(), "/tmp") == 0;
+    success &= config.rootEntry.searchSubentry("dir", NULL, true).type() == 1;
+
+    // Null handles read as empty nodes, and ignore changes
+    UconfigEntryRef missing = config.rootEntry.searchSubentry("missing");
+    success &= missing.isNull() && missing.name() == NULL;
+    success &= missing.keyCount() == 0 && missing.subentryCount() == 0;
+    success &= missing.searchKey("dir").isNull();
+    success &= missing.parentEntry().isNull();
+    success &= config.rootEntry.parentEntry().isNull();
+    missing.setName("missing");
+    success &= !missing.addKey(&key);
+    success &= !config.rootEntry.existSubentry("missing");
+
+    // The list of handles is the only allocation for listing subentries
+    oldCount = allocationCount;
+    UconfigEntryRef* entryList = config.rootEntry.subentries();
+    success &= allocationCount - oldCount == 1;
+    success &= entryList[0].parentEntry().name() == config.rootEntry.name();
+    delete[] entryList;
+
+    return success;
+}
+
+// Write numbers and a large block through a buffer, then read them back
+// from the file or from the block of memory written
+static bool testOutputBuffer(bool vectored, bool inMemory)
+{
+    const double doubles[] = {0.0, -0.0, 3.5, 2536274.721, 0.1, 1.0 / 3,
+                              -1E300, 6.02214076E23, 5E-324, 123456789.0};
+    const char* expected = "-9223372036854775807 0 42 -1.0 "
+                           "3.5 0.1 100.0 0.33333334 ";
+    const char* expectedDoubles = "0.0\n-0.0\n3.5\n2536274.721\n0.1\n"
+                                  "0.3333333333333333\n";
+    const int blockSize = 200000;
+
+    FILE* file = NULL;
+    char* data = NULL;
+    size_t dataLength = 0;
+    if (!inMemory)
+    {
+        file = tmpfile();
+        if (!file)
+            return false;
+    }
+
+    char* block = new char[blockSize];
+    memset(block, 'x', blockSize);
+
+    UconfigOutputBuffer* output;
+    if (inMemory)
+        output = new UconfigOutputBuffer(UconfigSink(&data, &dataLength));
+    else
+        output = new UconfigOutputBuffer(file, vectored);
+    output->writeInteger(-9223372036854775807L);
+    output->put(' ');
+    output->writeInteger(0);
+    output->put(' ');
+    output->writeInteger(42);
+    output->put(' ');
+    output->writeDouble(-1.0);
+    output->put(' ');
+    output->writeFloat(3.5f);
+    output->put(' ');
+    output->writeFloat(0.1f);
+    output->put(' ');
+    output->writeFloat(100.0f);
+    output->put(' ');
+    output->writeFloat(1.0f / 3);
+    output->put(' ');
+    for (unsigned int i=0; i<sizeof(doubles) / sizeof(double); i++)
+    {
+        output->writeDouble(doubles[i]);
+        output->put('\n');
+    }
+    output->write(block, blockSize);
+    output->writeIndentation(2);
+    bool success = output->flush();
+    delete output;
+
+    // Check the content of the file, or of the block of memory
+    // (which ends with "\0" as well)
+    long length;
+    char* content;
+    if (inMemory)
+    {
+        if (!data)
+        {
+            delete[] block;
+            return false;
+        }
+        length = dataLength;
+        content = data;
+        success &= content[length] == '\0';
+    }
+    else
+    {
+        length = ftell(file);
+        content = new char[length + 1];
+        rewind(file);
+        success &= long(fread(content, 1, length, file)) == length;
+        content[length] = '\0';
+        fclose(file);
+    }
+
+    success &= strncmp(content, expected, strlen(expected)) == 0;
+    char* pos = &content[strlen(expected)];
+    success &= strncmp(pos, expectedDoubles, strlen(expectedDoubles)) == 0;
+    for (unsigned int i=0; i<sizeof(doubles) / sizeof(double); i++)
+    {
+        char* end = strchr(pos, '\n');
+        success &= end != NULL;
+        if (!end)
+            break;
+
+        // Always read back as the same value, and as a floating number
+        success &= strtod(pos, NULL) == doubles[i];
+        success &= memchr(pos, '.', end - pos) != NULL ||
+                   memchr(pos, 'e', end - pos) != NULL;
+        pos = end + 1;
+    }
+    success &= long(pos - content) + blockSize + 8 == length;
+    success &= memcmp(pos, block, blockSize) == 0;
+    success &= strcmp(&pos[blockSize], "        ") == 0;
+
+    if (inMemory)
+        free(content);
+    else
+        delete[] content;
+    delete[] block;
+    return success;
+}
+
+bool testOutputBuffer()
+{
+    return testOutputBuffer(false, false) && testOutputBuffer(true, false) &&
+           testOutputBuffer(false, true);
+}
+
+// Split a stream (or a block of memory) into records by a delimiter,
+// then compare them with the records written into it
+static bool testInputBuffer(const char* delimiter,
+                            bool endWithDelimiter,
+                            bool fromMemory = false)
+{
+    const int delimiterLength = strlen(delimiter);
+    std::vector<std::string> records;
+    records.push_back("");
+    records.push_back("a,b,c");
+    records.push_back("\r\r: no delimiter :\r");
+    records.push_back(std::string("with\0zero", 9));
+    records.push_back("");
+
+    // Records larger than the buffer, and delimiters across its end
+    records.push_back(std::string(200000, 'x'));
+    records.push_back(std::string(65536 - 4 - delimiterLength, 'y'));
+    records.push_back("z");
+    if (endWithDelimiter)
+        records.push_back("");
+
+    std::string content;
+    for (unsigned int i=0; i<records.size(); i++)
+    {
+        if (i > 0)
+            content.append(delimiter, delimiterLength);
+        content.append(records[i]);
+    }
+
+    FILE* file = NULL;
+    if (!fromMemory)
+    {
+        file = tmpfile();
+        if (!file)
+            return false;
+        fwrite(content.data(), 1, content.size(), file);
+        rewind(file);
+    }
+
+    bool success = true;
+    UconfigInputBuffer* input;
+    if (fromMemory)
+        input = new UconfigInputBuffer(content.data(), content.size());
+    else
+        input = new UconfigInputBuffer(file);
+    const char* record;
+    size_t recordLength;
+    for (unsigned int i=0; i<records.size(); i++)
+    {
+        success &= input->readRecord(delimiter, delimiterLength,
+                                     &record, &recordLength);
+        success &= recordLength == records[i].size() &&
+                   memcmp(record, records[i].data(), recordLength) == 0;
+
+        // Records of a block of memory are read in place
+        if (fromMemory)
+            success &= record >= content.data() &&
+                       record + recordLength <=
+                           content.data() + content.size();
+    }
+    success &= !input->readRecord(delimiter, delimiterLength,
+                                  &record, &recordLength);
+    delete input;
+
+    if (file)
+        fclose(file);
+    return success;
+}
+
+bool testInputBuffer()
+{
+    return testInputBuffer("\n", true) && testInputBuffer("\n", false) &&
+           testInputBuffer("\r\n", true) && testInputBuffer("::", false) &&
+           testInputBuffer("\r\n", true, true) &&
+           testInputBuffer("::", false, true);
+}
+
+// Split a text with all kinds of line delimiters, inside and across
+// the blocks of chars scanned at once
+bool testLineReader()
+{
+    std::string text = "first\nsecond\r\nthird\rfourth\n\r\n\n";
+    std::vector<std::string> lines = {"first", "second", "third", "fourth",
+                                      "", "", std::string(40, 'x'),
+                                      std::string(15, 'y'), "z"};
+    text += lines[6] + "\r\n" + lines[7] + "\r\n" + lines[8];
+
+    bool success = true;
+    UconfigLineReader reader(text.data(), text.size());
+    const char* line;
+    int lineLength;
+    for (unsigned int i=0; i<lines.size(); i++)
+    {
+        success &= reader.next(&line, &lineLength);
+        success &= lineLength == int(lines[i].size()) &&
+                   memcmp(line, lines[i].data(), lineLength) == 0;
+    }
+    success &= !reader.next(&line, &lineLength);
+
+    // No empty line after the last delimiter
+    UconfigLineReader reader2("a\r\n", 3);
+    success &= reader2.next(&line, &lineLength) && lineLength == 1;
+    success &= !reader2.next(&line, &lineLength);
+    UconfigLineReader reader3(NULL, 0);
+    success &= !reader3.next(&line, &lineLength);
+
+    return success;
+}
+
+// Random 64-bit word made of several calls to rand()
+static uint64_t randomBits()
+{
+    return (uint64_t(rand()) << 62) ^ (uint64_t(rand()) << 31) ^
+           uint64_t(rand());
+}
+
+bool testNumber()
+{
+    const int sampleCount = 1000000;
+    const char* reals[] =
+    {
+        "0.1", "-0", "1e-400", "1e400", "2.2250738585072011e-308",
+        "4.9406564584124654e-324", "1.7976931348623157e308",
+        "9007199254740993", "9007199254740993.000000000000000000001",
+        "0.000000000000000000000000000123456789012345678901234567890",
+        "123456789012345678901234567890e-10", ".5", "5.", "-2.5E+3",
+        "1.5e", "1.5ex", "12abc"
+    };
+    const char* integers[] =
+    {
+        "0", "42", "-42", "+7", "007", "08", "0x1F", "0X", "-0x8000",
+        "99999999999999999999", "-99999999999999999999", "12abc"
+    };
+
+    // Same value and length as strtod() and strtol() in the "C" locale
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(reals) / sizeof(char*); i++)
+    {
+        char* end;
+        double expected = strtod(reals[i], &end);
+        double value;
+        int length = Uconfig_parseDouble(reals[i], strlen(reals[i]), &value);
+        success &= length == end - reals[i];
+        success &= memcmp(&value, &expected, sizeof(double)) == 0;
+    }
+    for (unsigned int i=0; i<sizeof(integers) / sizeof(char*); i++)
+    {
+        char* end;
+        long expected = strtol(integers[i], &end, 0);
+        long value;
+        int length = Uconfig_parseInteger(integers[i], strlen(integers[i]),
+                                          &value);
+        success &= length == end - integers[i] && value == expected;
+    }
+
+    // Random doubles and floats are written with their shortest digits,
+    // and read back exactly
+    char buffer[UCONFIG_NUMBER_LENGTH_MAX + 1];
+    char expected[UCONFIG_NUMBER_LENGTH_MAX + 1];
+    srand(1);
+    for (int i=0; i<sampleCount && success; i++)
+    {
+        uint64_t bits = randomBits();
+        double number;
+        memcpy(&number, &bits, sizeof(double));
+        if (std::isnan(number))
+            continue;
+
+        int length = Uconfig_formatDouble(buffer, number);
+        buffer[length] = '\0';
+        double value;
+        success &= Uconfig_parseDouble(buffer, length, &value) == length;
+        success &= memcmp(&value, &number, sizeof(double)) == 0;
+        success &= strtod(buffer, NULL) == number;
+
+        // No shorter expression reads back the same value
+        int digits = 0;
+        int significantDigits = 0;
+        for (int j=0; j<length && buffer[j] != 'e'; j++)
+        {
+            if (buffer[j] < '0' || buffer[j] > '9' ||
+                (digits == 0 && buffer[j] == '0'))
+                continue;
+            digits++;
+            if (buffer[j] != '0')
+                significantDigits = digits;
+        }
+        if (significantDigits > 1 && !std::isinf(number))
+        {
+            snprintf(expected, sizeof(expected), "%.*e",
+                     significantDigits - 2, number);
+            success &= strtod(expected, NULL) != number;
+        }
+
+        float smallNumber;
+        uint32_t smallBits = uint32_t(bits);
+        memcpy(&smallNumber, &smallBits, sizeof(float));
+        if (std::isnan(smallNumber))
+            continue;
+        length = Uconfig_formatFloat(buffer, smallNumber);
+        buffer[length] = '\0';
+        success &= strtof(buffer, NULL) == smallNumber;
+    }
+
+    // Other locales do not change the decimal point
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8"))
+    {
+        double value;
+        success &= Uconfig_parseDouble("2.5", 3, &value) == 3 && value == 2.5;
+        int length = Uconfig_formatDouble(buffer, 2.5);
+        success &= length == 3 && memcmp(buffer, "2.5", 3) == 0;
+        setlocale(LC_NUMERIC, "C");
+    }
+
     return success;
 }
 
@@ -93,4 +1105,59 @@ void testBasic()
         printf("testGuessValueType() passed.\n");
     else
         printf("testGuessValueType() failed!\n");
+
+    if (testArena())
+        printf("testArena() passed.\n");
+    else
+        printf("testArena() failed!\n");
+
+    if (testSharedName())
+        printf("testSharedName() passed.\n");
+    else
+        printf("testSharedName() failed!\n");
+
+    if (testRange())
+        printf("testRange() passed.\n");
+    else
+        printf("testRange() failed!\n");
+
+    if (testNameIndex())
+        printf("testNameIndex() passed.\n");
+    else
+        printf("testNameIndex() failed!\n");
+
+    if (testOutputBuffer())
+        printf("testOutputBuffer() passed.\n");
+    else
+        printf("testOutputBuffer() failed!\n");
+
+    if (testInputBuffer())
+        printf("testInputBuffer() passed.\n");
+    else
+        printf("testInputBuffer() failed!\n");
+
+    if (testLineReader())
+        printf("testLineReader() passed.\n");
+    else
+        printf("testLineReader() failed!\n");
+
+    if (testNumber())
+        printf("testNumber() passed.\n");
+    else
+        printf("testNumber() failed!\n");
+
+    if (testKeyStorage())
+        printf("testKeyStorage() passed.\n");
+    else
+        printf("testKeyStorage() failed!\n");
+
+    if (testEntryRef())
+        printf("testEntryRef() passed.\n");
+    else
+        printf("testEntryRef() failed!\n");
+
+    if (testMove())
+        printf("testMove() passed.\n");
+    else
+        printf("testMove() failed!\n");
 }
@@ -0,0 +1,1214 @@
+/*
+ * Benchmarks of Uconfig parser
+ * Only built into the test sequence when UCONFIG_BENCHMARK is defined,
+ * e.g. by running "qmake CONFIG+=benchmark".
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <utility>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "parser/uconfig2dtable.h"
+#include "parser/uconfigbinary.h"
+#include "parser/uconfigcache.h"
+#include "parser/uconfigcsv.h"
+#include "parser/uconfigini.h"
+#include "parser/uconfigio.h"
+#include "parser/uconfigconverter.h"
+#include "parser/uconfigkeyvalue.h"
+#include "parser/uconfiglineindex.h"
+#include "parser/uconfignumber.h"
+#include "parser/uconfigjson.h"
+#include "parser/uconfigjsonscanner.h"
+#include "parser/uconfigxml.h"
+#include "parser/utils.h"
+
+#define UCONFIG_BENCHMARK_TABLE_FILE    "./SampleConfigs/benchmark.table"
+#define UCONFIG_BENCHMARK_TABLE_COLUMNS 4
+#define UCONFIG_BENCHMARK_JSON_FILE     "./SampleConfigs/benchmark.json"
+#define UCONFIG_BENCHMARK_JSON_SIZE     (100 * 1024 * 1024)
+#define UCONFIG_BENCHMARK_XML_FILE      "./SampleConfigs/benchmark.xml"
+#define UCONFIG_BENCHMARK_XML_SIZE      (200 * 1024 * 1024)
+#define UCONFIG_BENCHMARK_OUTPUT_FILE   "./SampleConfigs/benchmark.out"
+#define UCONFIG_BENCHMARK_KEYVALUE_FILE "./SampleConfigs/benchmark.conf"
+#define UCONFIG_BENCHMARK_SERVICES_FILE "./SampleConfigs/benchmark.services"
+#define UCONFIG_BENCHMARK_CSV_SOURCE    "./SampleConfigs/population.csv"
+#define UCONFIG_BENCHMARK_CSV_FILE      "./SampleConfigs/benchmark.csv"
+#define UCONFIG_BENCHMARK_SNAPSHOT_FILE "./SampleConfigs/benchmark.snapshot"
+#define UCONFIG_BENCHMARK_CACHE_DIR     "./SampleConfigs/benchmark.cache"
+
+
+static double benchmarkSeconds(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double> elapsed =
+                            std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Peak resident set size of the process so far, in KB
+static long benchmarkPeakMemory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Resident set size of the process, in KB
+// Free memory kept by the allocator is given back to the system first
+static long benchmarkMemory()
+{
+    malloc_trim(0);
+
+    long pages = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file)
+    {
+        if (fscanf(file, "%*d %ld", &pages) != 1)
+            pages = 0;
+        fclose(file);
+    }
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Size of a file in bytes
+static long benchmarkFileSize(const char* filename)
+{
+    FILE* file = fopen(filename, "r");
+    if (!file)
+        return 0;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Write a space-separated table of ROWS rows into FILENAME
+static bool generateTable(const char* filename, int rows, int columns)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    for (int i=0; i<rows; i++)
+    {
+        fprintf(file, "row%d", i);
+        for (int j=1; j<columns; j++)
+            fprintf(file, " %d", i * columns + j);
+        fputc('\n', file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Write an array of objects of about SIZE bytes into FILENAME
+static bool generateJSON(const char* filename, long size)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fputs("[\n", file);
+    for (long i=0; ftell(file) < size; i++)
+    {
+        fprintf(file,
+                "%s    {\n"
+                "        \"id\": %ld,\n"
+                "        \"name\": \"item%ld\",\n"
+                "        \"enabled\": %s,\n"
+                "        \"ratio\": %ld.25,\n"
+                "        \"tags\": [\"alpha\", \"beta\", \"gamma\"],\n"
+                "        \"owner\": {\"uid\": %ld, \"home\": "
+                "\"/home/user%ld\"}\n"
+                "    }",
+                i > 0 ? ",\n" : "",
+                i, i, i % 2 ? "true" : "false", i, i % 1000, i % 1000);
+    }
+    fputs("\n]\n", file);
+
+    fclose(file);
+    return true;
+}
+
+// Write a list of elements of about SIZE bytes into FILENAME
+static bool generateXML(const char* filename, long size)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    fputs("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<items>\n", file);
+    for (long i=0; ftell(file) < size; i++)
+    {
+        fprintf(file,
+                "  <!-- Item %ld -->\n"
+                "  <item id=\"%ld\" name=\"item%ld\" enabled=\"%s\">\n"
+                "    <owner uid=\"%ld\" home=\"/home/user%ld\"/>\n"
+                "    <description>Description of item %ld</description>\n"
+                "    <data><![CDATA[<raw value=\"%ld\"/>]]></data>\n"
+                "  </item>\n",
+                i, i, i, i % 2 ? "true" : "false",
+                i % 1000, i % 1000, i, i);
+    }
+    fputs("</items>\n", file);
+
+    fclose(file);
+    return true;
+}
+
+// Write LINES lines of KEY=VALUE pairs into FILENAME
+static bool generateKeyValue(const char* filename, int lines)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    for (int i=0; i<lines; i++)
+        fprintf(file, "key%d=%d.5\n", i, i);
+
+    fclose(file);
+    return true;
+}
+
+// Write LINES lines like those of /etc/services into FILENAME,
+// with a comment line every ten lines
+static bool generateServices(const char* filename, int lines)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    for (int i=0; i<lines; i++)
+    {
+        if (i % 10 == 0)
+            fprintf(file, "# Services from %d to %d\n", i, i + 9);
+        else
+            fprintf(file, "service%d\t\t%d/%s\t\talias%d\t# Service %d\n",
+                    i, i % 65536, i % 2 ? "tcp" : "udp", i, i);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Write a table of integers and reals; if MIXED is true, the second row
+// holds words instead, so that no column has a single type
+static bool generateNumericTable(const char* filename, int rows, bool mixed)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+
+    for (int i=0; i<rows; i++)
+    {
+        if (mixed && i == 1)
+            fputs("x x x x\n", file);
+        else
+            fprintf(file, "%d %d.%02d %d %d.5\n", i, i, i % 100, i * 7, i);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Write the rows of population.csv into FILENAME over and over
+// until there are ROWS rows, under a given HEADER line
+static bool generateCSV(const char* filename, int rows, const char* header)
+{
+    FILE* source = fopen(UCONFIG_BENCHMARK_CSV_SOURCE, "r");
+    if (!source)
+        return false;
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        fclose(source);
+        return false;
+    }
+
+    char line[256];
+    fprintf(file, "%s\n", header);
+    for (int i=0; i<rows; )
+    {
+        // Skip the header of the source at each pass
+        rewind(source);
+        if (!fgets(line, sizeof(line), source))
+            break;
+        while (i < rows && fgets(line, sizeof(line), source))
+        {
+            // The last line of the source may not end with a newline
+            fputs(line, file);
+            if (!strchr(line, '\n'))
+                fputc('\n', file);
+            i++;
+        }
+    }
+
+    fclose(file);
+    fclose(source);
+    return true;
+}
+
+// Load tables of growing size; the time per row should stay constant
+bool benchmarkTableLoad()
+{
+    const int rowCounts[] = {10000, 100000, 1000000};
+    const char* filename = UCONFIG_BENCHMARK_TABLE_FILE;
+
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(rowCounts) / sizeof(int); i++)
+    {
+        if (!generateTable(filename,
+                           rowCounts[i],
+                           UCONFIG_BENCHMARK_TABLE_COLUMNS))
+            return false;
+
+        UconfigFile config;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= Uconfig2DTable::readUconfig(filename, &config);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkTableLoad(): %7d rows in %8.3f s "
+               "(%.1f ns/row)\n",
+               rowCounts[i], seconds, seconds * 1E9 / rowCounts[i]);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Parse tables of the same number of cells with rows of growing length,
+// without building a tree; the time per cell should stay constant
+bool benchmarkTableRows()
+{
+    const int cellCount = 2000000;
+    const int columnCounts[] = {10, 1000, 100000};
+    const char* filename = UCONFIG_BENCHMARK_TABLE_FILE;
+
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(columnCounts) / sizeof(int); i++)
+    {
+        if (!generateTable(filename,
+                           cellCount / columnCounts[i],
+                           columnCounts[i]))
+            return false;
+
+        UconfigHandler handler;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= Uconfig2DTable::parseUconfig(filename, &handler);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkTableRows(): %6d cells per row in %8.3f s "
+               "(%.1f ns/cell)\n",
+               columnCounts[i], seconds, seconds * 1E9 / cellCount);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Parse a table whose columns have a single type, which is inferred from
+// its first rows, and a table whose cells have their type guessed
+// one by one
+bool benchmarkTableTypes()
+{
+    const int rowCount = 1000000;
+    const char* filename = UCONFIG_BENCHMARK_TABLE_FILE;
+
+    bool success = true;
+    for (int mixed=0; mixed<2; mixed++)
+    {
+        if (!generateNumericTable(filename, rowCount, mixed != 0))
+            return false;
+
+        UconfigHandler handler;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= Uconfig2DTable::parseUconfig(filename, &handler);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkTableTypes(): %-8s %8.3f s (%.1f ns/row)\n",
+               mixed ? "guessed" : "inferred",
+               seconds, seconds * 1E9 / rowCount);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Load and release the same table with and without an arena
+bool benchmarkArena()
+{
+    const int rowCount = 1000000;
+    const char* filename = UCONFIG_BENCHMARK_TABLE_FILE;
+
+    if (!generateTable(filename, rowCount, UCONFIG_BENCHMARK_TABLE_COLUMNS))
+        return false;
+
+    bool success = true;
+    for (int useArena=0; useArena<2; useArena++)
+    {
+        UconfigFile config;
+        config.setArenaEnabled(useArena != 0);
+
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= Uconfig2DTable::readUconfig(filename, &config);
+        double loadSeconds = benchmarkSeconds(start);
+
+        start = std::chrono::steady_clock::now();
+        config.rootEntry.reset();
+        double releaseSeconds = benchmarkSeconds(start);
+
+        printf("benchmarkArena(): %-5s load %8.3f s, release %8.3f s\n",
+               useArena ? "arena" : "heap", loadSeconds, releaseSeconds);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Memory taken by keys with short names and typical values
+bool benchmarkKeyMemory()
+{
+    const int keyCount = 1000000;
+    const int intValue = 42;
+    const double doubleValue = 0.5;
+    const bool boolValue = true;
+
+    char name[16];
+    long oldMemory = benchmarkMemory();
+    UconfigEntryObject entry;
+    UconfigKeyObject key;
+    for (int i=0; i<keyCount; i++)
+    {
+        sprintf(name, "key%d", i);
+        key.setName(name);
+        switch (i % 4)
+        {
+            case 0:
+                key.setType(UconfigIO::Integer);
+                key.setValue((const char*)(&intValue), sizeof(int));
+                break;
+            case 1:
+                key.setType(UconfigIO::Double);
+                key.setValue((const char*)(&doubleValue), sizeof(double));
+                break;
+            case 2:
+                key.setType(UconfigIO::Bool);
+                key.setValue((const char*)(&boolValue), sizeof(bool));
+                break;
+            default:
+                key.setType(UconfigIO::Chars);
+                key.setValue("enabled", 8);
+        }
+        entry.addKey(std::move(key));
+    }
+    long memory = benchmarkMemory() - oldMemory;
+
+    printf("benchmarkKeyMemory(): %d keys, RSS %8.1f MB per million keys\n",
+           entry.keyCount(), memory * 1E6 / keyCount / 1024);
+
+    return entry.keyCount() == keyCount;
+}
+
+// Load population.csv scaled up to a million rows, with column names
+// of the source and with longer ones, from the heap and from an arena
+// (where repeated names are stored once)
+bool benchmarkCSVLoad()
+{
+    const int rowCount = 1000000;
+    const char* headers[] =
+    {
+        "region,year,population",
+        "region_of_the_world,year_of_the_estimate,population_in_thousands"
+    };
+    const char* filename = UCONFIG_BENCHMARK_CSV_FILE;
+
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(headers) / sizeof(char*); i++)
+    {
+        if (!generateCSV(filename, rowCount, headers[i]))
+            return false;
+
+        for (int useArena=0; useArena<2; useArena++)
+        {
+            long oldMemory = benchmarkMemory();
+            UconfigFile config;
+            config.setArenaEnabled(useArena != 0);
+
+            std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+            success &= UconfigCSV::readUconfig(filename, &config);
+            double seconds = benchmarkSeconds(start);
+            long memory = benchmarkMemory() - oldMemory;
+
+            printf("benchmarkCSVLoad(): %-5s names, %-5s load %8.3f s, "
+                   "RSS %8.1f MB\n",
+                   i > 0 ? "long" : "short", useArena ? "arena" : "heap",
+                   seconds, memory / 1024.0);
+        }
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Load population.csv scaled up to a million rows into an arena,
+// as one entry per row and by column, then sum up the population
+bool benchmarkColumnarLoad()
+{
+    const int rowCount = 1000000;
+    const char* filename = UCONFIG_BENCHMARK_CSV_FILE;
+    if (!generateCSV(filename, rowCount, "region,year,population"))
+        return false;
+
+    bool success = true;
+    for (int useColumns=0; useColumns<2; useColumns++)
+    {
+        long oldMemory = benchmarkMemory();
+        UconfigFile config;
+        config.setArenaEnabled(true);
+        config.setColumnarEnabled(useColumns != 0);
+
+        std::chrono::steady_clock::time_point start =
+                                        std::chrono::steady_clock::now();
+        success &= UconfigCSV::readUconfig(filename, &config);
+        double loadSeconds = benchmarkSeconds(start);
+        long memory = benchmarkMemory() - oldMemory;
+
+        double sum = 0;
+        UconfigEntryRef table = config.rootEntry.childRange()[0];
+        start = std::chrono::steady_clock::now();
+        if (useColumns)
+        {
+            const double* values = table.doubleColumn(2);
+            success &= values != NULL;
+            for (int i=1; values && i<table.rowCount(); i++)
+                sum += values[i];
+        }
+        else
+        {
+            UconfigEntryRange rows = table.childRange();
+            for (int i=1; i<rows.size(); i++)
+            {
+                UconfigKeyRef value = rows[i].keyRange()[2];
+                if (value.valueSize() == sizeof(double))
+                    sum += *(const double*)(value.value());
+            }
+        }
+        double scanSeconds = benchmarkSeconds(start);
+        success &= sum > 0;
+
+        printf("benchmarkColumnarLoad(): %-7s load %8.3f s, RSS %8.1f MB, "
+               "scan %8.3f ms\n",
+               useColumns ? "columns" : "rows",
+               loadSeconds, memory / 1024.0, scanSeconds * 1000);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Read and write numbers with the C library and with the number codec
+bool benchmarkNumber()
+{
+    const int numberCount = 1000000;
+    const int textSize = 32;
+
+    // Reals of various magnitudes written with 17 digits, and integers
+    char* texts = new char[numberCount * textSize];
+    char* integerTexts = new char[numberCount * textSize];
+    double* numbers = new double[numberCount];
+    srand(1);
+    for (int i=0; i<numberCount; i++)
+    {
+        numbers[i] = double(rand()) / RAND_MAX * pow(10, rand() % 40 - 20);
+        snprintf(&texts[i * textSize], textSize, "%.17g", numbers[i]);
+        snprintf(&integerTexts[i * textSize], textSize, "%ld",
+                 long(rand()) * rand());
+    }
+
+    bool success = true;
+    char buffer[UCONFIG_NUMBER_LENGTH_MAX];
+    for (int useCodec=0; useCodec<2; useCodec++)
+    {
+        const char* name = useCodec ? "codec" : "libc";
+        double sum = 0;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        for (int i=0; i<numberCount; i++)
+        {
+            const char* text = &texts[i * textSize];
+            double value;
+            if (useCodec)
+                Uconfig_parseDouble(text, strlen(text), &value);
+            else
+                value = strtod(text, NULL);
+            sum += value;
+        }
+        double seconds = benchmarkSeconds(start);
+        printf("benchmarkNumber(): parse reals    %-5s %8.1f ns/number\n",
+               name, seconds * 1E9 / numberCount);
+
+        long integerSum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i=0; i<numberCount; i++)
+        {
+            const char* text = &integerTexts[i * textSize];
+            long value;
+            if (useCodec)
+                Uconfig_parseInteger(text, strlen(text), &value);
+            else
+                value = strtol(text, NULL, 10);
+            integerSum += value;
+        }
+        seconds = benchmarkSeconds(start);
+        printf("benchmarkNumber(): parse integers %-5s %8.1f ns/number\n",
+               name, seconds * 1E9 / numberCount);
+
+        // Shortest expressions that read back the same value
+        long length = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i=0; i<numberCount; i++)
+        {
+            if (useCodec)
+            {
+                length += Uconfig_formatDouble(buffer, numbers[i]);
+                continue;
+            }
+            for (int digits=15; digits<=17; digits++)
+            {
+                int size = snprintf(buffer, sizeof(buffer), "%.*g",
+                                    digits, numbers[i]);
+                if (strtod(buffer, NULL) == numbers[i])
+                {
+                    length += size;
+                    break;
+                }
+            }
+        }
+        seconds = benchmarkSeconds(start);
+        printf("benchmarkNumber(): write reals    %-5s %8.1f ns/number "
+               "(%.1f chars)\n",
+               name, seconds * 1E9 / numberCount, double(length) / numberCount);
+        success &= sum > 0 && integerSum != 0;
+    }
+
+    delete[] texts;
+    delete[] integerTexts;
+    delete[] numbers;
+    return success;
+}
+
+// Guess the types of short and long values, one by one and by rows
+bool benchmarkValueTypes()
+{
+    typedef UconfigIO::ValueType ValueType;
+    const int valueCount = 4000;
+    const int repeatCount = 250;
+    const int rowSize = 8;
+    const int textSize = 64;
+
+    char* texts = new char[valueCount * textSize];
+    UconfigIO::ValueSpan* spans = new UconfigIO::ValueSpan[valueCount];
+    ValueType* types = new ValueType[valueCount];
+
+    bool success = true;
+    srand(1);
+    for (int useLongValues=0; useLongValues<2; useLongValues++)
+    {
+        // Values of each type in turn, with up to 60 chars for long values
+        for (int i=0; i<valueCount; i++)
+        {
+            char* text = &texts[i * textSize];
+            int digits = useLongValues ? 20 + rand() % 40 : 1 + rand() % 8;
+            switch (i % 5)
+            {
+                case 0:
+                    snprintf(text, textSize, "%.*ld", digits, long(rand()));
+                    break;
+                case 1:
+                    snprintf(text, textSize, "-%.*f", digits,
+                             double(rand()) / RAND_MAX);
+                    break;
+                case 2:
+                    strcpy(text, rand() % 2 ? "true" : "False");
+                    break;
+                case 3:
+                    snprintf(text, textSize, "\"%.*d\"", digits, rand());
+                    break;
+                default:
+                    snprintf(text, textSize, "%.*dx", digits, rand());
+            }
+            spans[i].value = text;
+            spans[i].length = strlen(text);
+        }
+
+        for (int byRow=0; byRow<2; byRow++)
+        {
+            std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+            for (int j=0; j<repeatCount; j++)
+            {
+                if (byRow)
+                {
+                    for (int i=0; i<valueCount; i+=rowSize)
+                        UconfigIO::classifyValues(&spans[i], rowSize,
+                                                  &types[i]);
+                }
+                else
+                {
+                    for (int i=0; i<valueCount; i++)
+                        types[i] = UconfigIO::guessValueType(spans[i].value,
+                                                             spans[i].length);
+                }
+            }
+            double seconds = benchmarkSeconds(start);
+            printf("benchmarkValueTypes(): %s values, %s %6.1f ns/value\n",
+                   useLongValues ? "long " : "short",
+                   byRow ? "by row    " : "one by one",
+                   seconds * 1E9 / valueCount / repeatCount);
+
+            const ValueType expectedTypes[] = {ValueType::Integer,
+                                               ValueType::Double,
+                                               ValueType::Bool,
+                                               ValueType::Chars,
+                                               ValueType::Raw};
+            for (int i=0; i<valueCount; i++)
+                success &= types[i] == expectedTypes[i % 5];
+        }
+    }
+
+    delete[] texts;
+    delete[] spans;
+    delete[] types;
+    return success;
+}
+
+// Parse a file of a million lines as key-value pairs and as INI,
+// without building a tree
+bool benchmarkLineParsers()
+{
+    const int lineCount = 1000000;
+    const char* filename = UCONFIG_BENCHMARK_SERVICES_FILE;
+    if (!generateServices(filename, lineCount))
+        return false;
+
+    bool success = true;
+    for (int useINI=0; useINI<2; useINI++)
+    {
+        UconfigHandler handler;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        if (useINI)
+            success &= UconfigINI::parseUconfig(filename, &handler);
+        else
+            success &= UconfigKeyValue::parseUconfig(filename, &handler);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkLineParsers(): %-6s %d lines in %8.3f s "
+               "(%.1f ns/line)\n",
+               useINI ? "ini" : "keyval", lineCount, seconds,
+               seconds * 1E9 / lineCount);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Look up keys by name in entries of growing size,
+// with a linear scan and with the hash index
+bool benchmarkNameLookup()
+{
+    const int childCounts[] = {10, 1000, 100000};
+    const int lookupCount = 10000;
+
+    char name[16];
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(childCounts) / sizeof(int); i++)
+    {
+        int childCount = childCounts[i];
+        UconfigEntryObject entry;
+        UconfigKeyObject key;
+        for (int j=0; j<childCount; j++)
+        {
+            sprintf(name, "key%d", j);
+            key.setName(name);
+            entry.addKey(&key);
+        }
+
+        for (int useIndex=0; useIndex<2; useIndex++)
+        {
+            entry.setNameIndexEnabled(useIndex != 0);
+
+            int found = 0;
+            std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+            for (int j=0; j<lookupCount; j++)
+            {
+                sprintf(name, "key%d", int(j * 7919L % childCount));
+                found += entry.existKey(name);
+            }
+            double seconds = benchmarkSeconds(start);
+            success &= found == lookupCount;
+
+            printf("benchmarkNameLookup(): %6d keys, %-5s %10.1f ns/lookup\n",
+                   childCount, useIndex ? "index" : "scan",
+                   seconds * 1E9 / lookupCount);
+        }
+    }
+
+    return success;
+}
+
+// Load a large JSON file, with and without an arena
+bool benchmarkJSONLoad()
+{
+    const char* filename = UCONFIG_BENCHMARK_JSON_FILE;
+    if (!generateJSON(filename, UCONFIG_BENCHMARK_JSON_SIZE))
+        return false;
+
+    bool success = true;
+    for (int useArena=0; useArena<2; useArena++)
+    {
+        UconfigFile config;
+        config.setArenaEnabled(useArena != 0);
+
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= UconfigJSON::readUconfig(filename, &config);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkJSONLoad(): %-5s %d MB in %8.3f s (%.1f MB/s)\n",
+               useArena ? "arena" : "heap",
+               UCONFIG_BENCHMARK_JSON_SIZE / 1048576, seconds,
+               UCONFIG_BENCHMARK_JSON_SIZE / 1048576 / seconds);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Index the structural chars of a large JSON file with each kernel
+bool benchmarkJSONScan()
+{
+    const char* filename = UCONFIG_BENCHMARK_JSON_FILE;
+    const char* kernelNames[] = {"scalar", "sse2", "avx2"};
+    if (!generateJSON(filename, UCONFIG_BENCHMARK_JSON_SIZE))
+        return false;
+
+    size_t length;
+    const char* data = Uconfig_mapFile(filename, &length);
+    if (!data)
+        return false;
+
+    bool success = true;
+    long expectedCount = -1;
+    UconfigJSONScanner::Kernel defaultKernel = UconfigJSONScanner::kernel();
+    for (int i=UconfigJSONScanner::ScalarKernel;
+         i<=UconfigJSONScanner::AVX2Kernel; i++)
+    {
+        if (!UconfigJSONScanner::setKernel(UconfigJSONScanner::Kernel(i)))
+            continue;
+
+        long count = 0;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        UconfigJSONScanner scanner(data, length);
+        while (scanner.next())
+            count++;
+        double seconds = benchmarkSeconds(start);
+
+        if (expectedCount < 0)
+            expectedCount = count;
+        success &= count == expectedCount;
+
+        printf("benchmarkJSONScan(): %-6s %d MB in %8.3f s (%.1f MB/s)\n",
+               kernelNames[i], UCONFIG_BENCHMARK_JSON_SIZE / 1048576,
+               seconds, UCONFIG_BENCHMARK_JSON_SIZE / 1048576 / seconds);
+    }
+    UconfigJSONScanner::setKernel(defaultKernel);
+
+    Uconfig_unmapFile(data, length);
+    remove(filename);
+    return success;
+}
+
+// Load a large XML file, from the file itself and through a pipe
+bool benchmarkXMLLoad()
+{
+    const char* filename = UCONFIG_BENCHMARK_XML_FILE;
+    const char* command = "cat " UCONFIG_BENCHMARK_XML_FILE;
+    if (!generateXML(filename, UCONFIG_BENCHMARK_XML_SIZE))
+        return false;
+
+    bool success = true;
+    for (int usePipe=0; usePipe<2; usePipe++)
+    {
+        UconfigFile config;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        if (usePipe)
+        {
+            FILE* pipe = popen(command, "r");
+            if (!pipe)
+                return false;
+            success &= UconfigXML::freadUconfig(pipe, &config);
+            pclose(pipe);
+        }
+        else
+            success &= UconfigXML::readUconfig(filename, &config);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkXMLLoad(): %-5s %d MB in %8.3f s (%.1f MB/s)\n",
+               usePipe ? "pipe" : "file",
+               UCONFIG_BENCHMARK_XML_SIZE / 1048576, seconds,
+               UCONFIG_BENCHMARK_XML_SIZE / 1048576 / seconds);
+    }
+
+    remove(filename);
+    return success;
+}
+
+// Convert a large XML file to JSON in a single pass, then through a tree
+// Run first, as the peak memory of the process can only grow
+bool benchmarkConversion()
+{
+    const char* filename = UCONFIG_BENCHMARK_XML_FILE;
+    const char* outputFilename = UCONFIG_BENCHMARK_OUTPUT_FILE;
+    if (!generateXML(filename, UCONFIG_BENCHMARK_XML_SIZE))
+        return false;
+
+    bool success = true;
+    for (int useTree=0; useTree<2; useTree++)
+    {
+        long peakMemory = benchmarkPeakMemory();
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        if (useTree)
+        {
+            UconfigFile config;
+            success &= UconfigXML::readUconfig(filename, &config);
+            success &= UconfigJSON::writeUconfig(outputFilename, &config);
+        }
+        else
+        {
+            success &= UconfigConverter::convert(
+                                            filename, outputFilename,
+                                            UconfigConverter::XMLFormat,
+                                            UconfigConverter::JSONFormat);
+        }
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkConversion(): %-6s %d MB in %8.3f s, "
+               "peak memory +%ld MB\n",
+               useTree ? "tree" : "stream",
+               UCONFIG_BENCHMARK_XML_SIZE / 1048576, seconds,
+               (benchmarkPeakMemory() - peakMemory) / 1024);
+    }
+
+    remove(outputFilename);
+    remove(filename);
+    return success;
+}
+
+// Export a large tree of each format back to the same format
+bool benchmarkExport()
+{
+    const char* formatNames[] = {"keyval", "table", "json", "xml"};
+    const char* filenames[] = {UCONFIG_BENCHMARK_KEYVALUE_FILE,
+                               UCONFIG_BENCHMARK_TABLE_FILE,
+                               UCONFIG_BENCHMARK_JSON_FILE,
+                               UCONFIG_BENCHMARK_XML_FILE};
+    const char* outputFilename = UCONFIG_BENCHMARK_OUTPUT_FILE;
+    const int rowCount = 2000000;
+
+    bool success = generateKeyValue(filenames[0], rowCount) &&
+                   generateTable(filenames[1], rowCount,
+                                 UCONFIG_BENCHMARK_TABLE_COLUMNS) &&
+                   generateJSON(filenames[2], UCONFIG_BENCHMARK_JSON_SIZE) &&
+                   generateXML(filenames[3], UCONFIG_BENCHMARK_JSON_SIZE);
+
+    for (int i=0; success && i<4; i++)
+    {
+        UconfigFile config;
+        switch (i)
+        {
+            case 0:
+                success &= UconfigKeyValue::readUconfig(filenames[i],
+                                                        &config);
+                break;
+            case 1:
+                success &= Uconfig2DTable::readUconfig(filenames[i],
+                                                       &config);
+                break;
+            case 2:
+                success &= UconfigJSON::readUconfig(filenames[i], &config);
+                break;
+            default:
+                success &= UconfigXML::readUconfig(filenames[i], &config);
+        }
+
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        switch (i)
+        {
+            case 0:
+                success &= UconfigKeyValue::writeUconfig(outputFilename,
+                                                         &config);
+                break;
+            case 1:
+                success &= Uconfig2DTable::writeUconfig(outputFilename,
+                                                        &config);
+                break;
+            case 2:
+                success &= UconfigJSON::writeUconfig(outputFilename,
+                                                     &config);
+                break;
+            default:
+                success &= UconfigXML::writeUconfig(outputFilename, &config);
+        }
+        double seconds = benchmarkSeconds(start);
+        double size = benchmarkFileSize(outputFilename) / 1048576.0;
+
+        printf("benchmarkExport(): %-6s %6.1f MB in %8.3f s (%.1f MB/s)\n",
+               formatNames[i], size, seconds, size / seconds);
+    }
+
+    for (int i=0; i<4; i++)
+        remove(filenames[i]);
+    remove(outputFilename);
+    return success;
+}
+
+// Load a large JSON file, then a snapshot of it: in place through a view,
+// and back into a tree
+bool benchmarkSnapshotLoad()
+{
+    const char* filename = UCONFIG_BENCHMARK_JSON_FILE;
+    const char* snapshotFilename = UCONFIG_BENCHMARK_SNAPSHOT_FILE;
+    if (!generateJSON(filename, UCONFIG_BENCHMARK_JSON_SIZE))
+        return false;
+
+    UconfigFile config;
+    std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+    bool success = UconfigJSON::readUconfig(filename, &config);
+    double jsonSeconds = benchmarkSeconds(start);
+
+    start = std::chrono::steady_clock::now();
+    success &= UconfigBinary::writeUconfig(snapshotFilename, &config);
+    double writeSeconds = benchmarkSeconds(start);
+
+    // Opening a view only checks the header
+    UconfigBinaryView view;
+    start = std::chrono::steady_clock::now();
+    success &= view.open(snapshotFilename);
+    int count = view.rootEntry().subentryCount();
+    double viewSeconds = benchmarkSeconds(start);
+    view.close();
+
+    UconfigFile snapshotConfig;
+    snapshotConfig.setArenaEnabled(true);
+    start = std::chrono::steady_clock::now();
+    success &= UconfigBinary::readUconfig(snapshotFilename, &snapshotConfig);
+    double readSeconds = benchmarkSeconds(start);
+    success &= snapshotConfig.rootEntry.subentryCount() == count;
+
+    printf("benchmarkSnapshotLoad(): json %8.3f s, snapshot written "
+           "in %8.3f s (%.1f MB)\n",
+           jsonSeconds, writeSeconds,
+           benchmarkFileSize(snapshotFilename) / 1048576.0);
+    printf("benchmarkSnapshotLoad(): view %8.6f s, tree %8.3f s\n",
+           viewSeconds, readSeconds);
+
+    remove(filename);
+    remove(snapshotFilename);
+    return success;
+}
+
+// Load small files again and again, then a large one, with and without
+// a cache of parsed files
+bool benchmarkCacheLoad()
+{
+    const char* smallFilenames[] = {"./SampleConfigs/QMLPlayer.ini",
+                                    "./SampleConfigs/config.xml"};
+    const char* filename = UCONFIG_BENCHMARK_JSON_FILE;
+    const int loadCount = 2000;
+
+    UconfigCache cache(UCONFIG_BENCHMARK_CACHE_DIR);
+    bool success = true;
+    for (int i=0; i<2; i++)
+    {
+        UconfigConverter::Format format =
+                    UconfigConverter::guessFormat(smallFilenames[i]);
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        for (int j=0; j<loadCount; j++)
+        {
+            UconfigFile config;
+            success &= UconfigConverter::readUconfig(smallFilenames[i],
+                                                     format,
+                                                     &config);
+        }
+        double coldSeconds = benchmarkSeconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int j=0; j<loadCount; j++)
+        {
+            UconfigFile config;
+            success &= cache.readUconfig(smallFilenames[i], &config, format);
+        }
+        double warmSeconds = benchmarkSeconds(start);
+
+        printf("benchmarkCacheLoad(): %-14s parsed %7.1f us, "
+               "cached %7.1f us\n",
+               strrchr(smallFilenames[i], '/') + 1,
+               coldSeconds * 1e6 / loadCount,
+               warmSeconds * 1e6 / loadCount);
+        cache.remove(smallFilenames[i]);
+    }
+
+    if (!generateJSON(filename, UCONFIG_BENCHMARK_JSON_SIZE))
+        return false;
+    for (int i=0; i<2; i++)
+    {
+        UconfigFile config;
+        config.setArenaEnabled(true);
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        success &= cache.readUconfig(filename, &config);
+        double seconds = benchmarkSeconds(start);
+
+        printf("benchmarkCacheLoad(): %-4s %d MB in %8.3f s\n",
+               i == 0 ? "cold" : "warm",
+               UCONFIG_BENCHMARK_JSON_SIZE / 1048576, seconds);
+    }
+    success &= cache.hitCount() == loadCount * 2 - 2 + 1;
+
+    cache.remove(filename);
+    remove(filename);
+    rmdir(UCONFIG_BENCHMARK_CACHE_DIR);
+    return success;
+}
+
+// Change a line in the middle of large files again and again: updating
+// their trees should take a time independent of the file size
+bool benchmarkIncremental()
+{
+    const int lineCount = 500000;
+    const int editCount = 100;
+    const char* filenames[] = {UCONFIG_BENCHMARK_KEYVALUE_FILE,
+                               UCONFIG_BENCHMARK_TABLE_FILE};
+    if (!generateKeyValue(filenames[0], lineCount) ||
+        !generateNumericTable(filenames[1], lineCount, false))
+        return false;
+
+    bool success = true;
+    for (int i=0; i<2; i++)
+    {
+        size_t length;
+        const char* data = Uconfig_mapFile(filenames[i], &length);
+        if (!data)
+            return false;
+        std::string content(data, length);
+        Uconfig_unmapFile(data, length);
+
+        UconfigFile config;
+        UconfigLineIndex index;
+        std::chrono::steady_clock::time_point start =
+                                            std::chrono::steady_clock::now();
+        if (i == 0)
+            success &= UconfigKeyValue::updateUconfig(content.data(),
+                                                      content.size(),
+                                                      &config, &index);
+        else
+            success &= Uconfig2DTable::updateUconfig(content.data(),
+                                                     content.size(),
+                                                     &config, &index);
+        double fullSeconds = benchmarkSeconds(start);
+
+        double updateSeconds = 0;
+        int parsedCount = 0;
+        for (int j=0; j<editCount; j++)
+        {
+            size_t pos = index.entryOffset(index.entryCount() / 2 + j) + 1;
+            content[pos] = content[pos] == '1' ? '2' : '1';
+
+            start = std::chrono::steady_clock::now();
+            if (i == 0)
+                success &= UconfigKeyValue::updateUconfig(content.data(),
+                                                          content.size(),
+                                                          &config, &index);
+            else
+                success &= Uconfig2DTable::updateUconfig(content.data(),
+                                                         content.size(),
+                                                         &config, &index);
+            updateSeconds += benchmarkSeconds(start);
+            parsedCount += index.parsedCount();
+        }
+        updateSeconds /= editCount;
+        success &= parsedCount <= editCount * 3;
+
+        printf("benchmarkIncremental(): %-6s %d lines: full %8.3f s, "
+               "update %8.3f ms (%.0fx)\n",
+               i == 0 ? "keyval" : "table", lineCount,
+               fullSeconds, updateSeconds * 1E3,
+               fullSeconds / updateSeconds);
+        remove(filenames[i]);
+    }
+
+    return success;
+}
+
+void testBenchmark()
+{
+    if (!benchmarkConversion())
+        printf("benchmarkConversion() failed!\n");
+    if (!benchmarkTableLoad())
+        printf("benchmarkTableLoad() failed!\n");
+    if (!benchmarkTableRows())
+        printf("benchmarkTableRows() failed!\n");
+    if (!benchmarkTableTypes())
+        printf("benchmarkTableTypes() failed!\n");
+    if (!benchmarkArena())
+        printf("benchmarkArena() failed!\n");
+    if (!benchmarkKeyMemory())
+        printf("benchmarkKeyMemory() failed!\n");
+    if (!benchmarkCSVLoad())
+        printf("benchmarkCSVLoad() failed!\n");
+    if (!benchmarkColumnarLoad())
+        printf("benchmarkColumnarLoad() failed!\n");
+    if (!benchmarkNumber())
+        printf("benchmarkNumber() failed!\n");
+    if (!benchmarkLineParsers())
+        printf("benchmarkLineParsers() failed!\n");
+    if (!benchmarkValueTypes())
+        printf("benchmarkValueTypes() failed!\n");
+    if (!benchmarkNameLookup())
+        printf("benchmarkNameLookup() failed!\n");
+    if (!benchmarkJSONLoad())
+        printf("benchmarkJSONLoad() failed!\n");
+    if (!benchmarkJSONScan())
+        printf("benchmarkJSONScan() failed!\n");
+    if (!benchmarkXMLLoad())
+        printf("benchmarkXMLLoad() failed!\n");
+    if (!benchmarkExport())
+        printf("benchmarkExport() failed!\n");
+    if (!benchmarkSnapshotLoad())
+        printf("benchmarkSnapshotLoad() failed!\n");
+    if (!benchmarkCacheLoad())
+        printf("benchmarkCacheLoad() failed!\n");
+    if (!benchmarkIncremental())
+        printf("benchmarkIncremental() failed!\n");
+}
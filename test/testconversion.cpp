@@ -1,9 +1,12 @@
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "parser/uconfigini.h"
 #include "parser/uconfigcsv.h"
 #include "parser/uconfigjson.h"
 #include "parser/uconfigxml.h"
+#include "parser/uconfigconverter.h"
 
 
 bool testKeyValue2INI()
@@ -39,10 +42,10 @@ bool testINI2KeyValue()
     // Adjust the hierarchy of data to simple KEY=VALUE pattern
     // by extract all subentries into the root entry
     UconfigFile newConfig;
-    UconfigEntryObject* entryList = config.rootEntry.subentries();
+    UconfigEntryRef* entryList = config.rootEntry.subentries();
     for (int i=0; i<config.rootEntry.subentryCount(); i++)
     {
-        UconfigEntryObject* subentryList = entryList[i].subentries();
+        UconfigEntryRef* subentryList = entryList[i].subentries();
         for (int j=0; j<entryList[i].subentryCount(); j++)
             newConfig.rootEntry.addSubentry(&subentryList[j]);
         if (subentryList)
@@ -84,7 +87,7 @@ bool testJSON2INI()
         return false;
 
     // Give the outer element a name
-    UconfigEntryObject* entryList = config.rootEntry.subentries();
+    UconfigEntryRef* entryList = config.rootEntry.subentries();
     entryList[0].setName(rootElementName);
     delete[] entryList;
 
@@ -124,7 +127,7 @@ bool testJSON2XML()
         return false;
 
     // Give the outer element a name
-    UconfigEntryObject* entryList = config.rootEntry.subentries();
+    UconfigEntryRef* entryList = config.rootEntry.subentries();
     entryList[0].setName(rootElementName);
     delete[] entryList;
 
@@ -144,7 +147,7 @@ bool testXML2JSON()
     // Adjust the hierarchy of data to JSON syntax
     // by removing all prologue sections
     int entryCount = config.rootEntry.subentryCount();
-    UconfigEntryObject* entryList = config.rootEntry.subentries();
+    UconfigEntryRef* entryList = config.rootEntry.subentries();
     for (int i=0; i<entryCount; i++)
     {
         if (entryList[i].type() != UconfigXML::NormalEntry)
@@ -159,6 +162,125 @@ bool testXML2JSON()
     return UconfigJSON::writeUconfig(outputFileName, &config);
 }
 
+// Compare the content of two files byte by byte
+static bool compareFiles(const char* filename1, const char* filename2)
+{
+    FILE* file1 = fopen(filename1, "rb");
+    FILE* file2 = fopen(filename2, "rb");
+
+    bool same = file1 && file2;
+    while (same)
+    {
+        int c = fgetc(file1);
+        same = c == fgetc(file2);
+        if (c == EOF)
+            break;
+    }
+
+    if (file1)
+        fclose(file1);
+    if (file2)
+        fclose(file2);
+    return same;
+}
+
+bool testStreamConversion()
+{
+    typedef UconfigConverter Converter;
+    const char* streamFileName = "./SampleConfigs/stream.out";
+
+    // Conversions through a tree, then their sources and outputs
+    bool (*const conversions[])() =
+        {testKeyValue2INI, testINI2KeyValue, testINI2JSON, testJSON2INI,
+         testCSV2JSON, testJSON2XML, testXML2JSON};
+    const char* filenames[] =
+        {"./SampleConfigs/grub", "./SampleConfigs/QMLPlayer.ini",
+         "./SampleConfigs/QMLPlayer.ini", "./SampleConfigs/firefox.json",
+         "./SampleConfigs/population.csv", "./SampleConfigs/firefox.json",
+         "./SampleConfigs/config.xml"};
+    const char* outputFileNames[] =
+        {"./SampleConfigs/grub.ini", "./SampleConfigs/QMLPlayer.ini.txt",
+         "./SampleConfigs/QMLPlayer.ini.json",
+         "./SampleConfigs/firefox.json.ini",
+         "./SampleConfigs/population.csv.json",
+         "./SampleConfigs/firefox.json.xml",
+         "./SampleConfigs/config.xml.json"};
+    const Converter::Format formats[][2] =
+        {{Converter::KeyValueFormat, Converter::INIFormat},
+         {Converter::INIFormat, Converter::KeyValueFormat},
+         {Converter::INIFormat, Converter::JSONFormat},
+         {Converter::JSONFormat, Converter::INIFormat},
+         {Converter::CSVFormat, Converter::JSONFormat},
+         {Converter::JSONFormat, Converter::XMLFormat},
+         {Converter::XMLFormat, Converter::JSONFormat}};
+
+    // Converting a file in a single pass gives the same result
+    // as loading it, adjusting the tree, then exporting the tree
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(filenames) / sizeof(char*); i++)
+    {
+        if (!conversions[i]() ||
+            !Converter::convert(filenames[i], streamFileName,
+                                formats[i][0], formats[i][1]) ||
+            !compareFiles(outputFileNames[i], streamFileName))
+        {
+            printf("testStreamConversion(): failed with %s\n",
+                   outputFileNames[i]);
+            success = false;
+        }
+    }
+    remove(streamFileName);
+
+    // Keys following a child still go to the opening tag of an element,
+    // unless the content of the element is too large to be held
+    char* data = NULL;
+    size_t length = 0;
+    UconfigKeyObject key;
+    key.setName("late");
+    key.setType(UconfigXML::Raw);
+    key.setValue("3", 1);
+    UconfigXMLWriter* writer = new UconfigXMLWriter(UconfigSink(&data,
+                                                                &length));
+    writer->onEntryBegin("a", 2, UconfigXML::NormalEntry);
+    writer->onEntryBegin("b", 2, UconfigXML::NormalEntry);
+    writer->onEntryBegin("c", 2, UconfigXML::NormalEntry);
+    writer->onEntryEnd();
+    writer->onKey(key);
+    writer->onEntryEnd();
+    writer->onKey(key);
+    writer->onEntryEnd();
+    success &= writer->flush();
+    delete writer;
+    success &= data && strcmp(data, "<a late=3><b late=3><c/></b></a>") == 0;
+    free(data);
+
+    data = NULL;
+    writer = new UconfigXMLWriter(UconfigSink(&data, &length));
+    writer->onEntryBegin("a", 2, UconfigXML::NormalEntry);
+    for (int i=0; i<300000; i++)
+    {
+        writer->onEntryBegin("c", 2, UconfigXML::NormalEntry);
+        writer->onEntryEnd();
+    }
+    writer->onKey(key);
+    writer->onEntryEnd();
+    success &= writer->flush();
+    delete writer;
+    success &= data && length == 3 + 300000 * 4 + 14 + 4;
+    success &= data && strncmp(data, "<a><c/>", 7) == 0 &&
+               strcmp(data + length - 18, "<late>3</late></a>") == 0;
+    free(data);
+
+    // Formats are guessed from file extensions
+    success &= Converter::guessFormat(outputFileNames[2]) ==
+               Converter::JSONFormat;
+    success &= Converter::guessFormat(filenames[0]) ==
+               Converter::UnknownFormat;
+    success &= Converter::getFormat("XML") == Converter::XMLFormat;
+
+    return success;
+}
+
 void testConversion()
 {
     if (testKeyValue2INI())
@@ -195,4 +317,9 @@ void testConversion()
         printf("testXML2JSON() passed.\n");
     else
         printf("testXML2JSON() failed!\n");
+
+    if (testStreamConversion())
+        printf("testStreamConversion() passed.\n");
+    else
+        printf("testStreamConversion() failed!\n");
 }
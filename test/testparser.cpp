@@ -1,11 +1,80 @@
 #include <cstring>
 #include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "parser/uconfigfile_metadata.h"
+#include "parser/uconfigbinary.h"
+#include "parser/uconfigcache.h"
 #include "parser/uconfigini.h"
+#include "parser/uconfiglineindex.h"
+#include "parser/uconfigwatcher.h"
 #include "parser/uconfigcsv.h"
 #include "parser/uconfigjson.h"
 #include "parser/uconfigxml.h"
+#include "parser/uconfigjson_p.h"
+#include "parser/uconfigjsonscanner.h"
+#include "parser/utils.h"
+
+#define UCONFIG_TEST_JSON_FUZZ_CHARS    "{}[]:,\"\\ \n\tab1.-e"
+#define UCONFIG_TEST_JSON_FUZZ_COUNT    2000
+#define UCONFIG_TEST_EDIT_CHARS         "\n\r[]=#; ,ab1."
+#define UCONFIG_TEST_EDIT_COUNT         500
+
+
+bool compareEntries(const UconfigEntryRef& entry1,
+                    const UconfigEntryRef& entry2);
+
+
+// Count the reported nodes without keeping any of them
+class UconfigCountingHandler : public UconfigHandler
+{
+public:
+    int entryCount;
+    int keyCount;
+    int level;
+    bool balanced;
+
+    UconfigCountingHandler()
+    {
+        entryCount = 0;
+        keyCount = 0;
+        level = 0;
+        balanced = true;
+    }
+
+    void onEntryBegin(const char*, int, int)
+    {
+        entryCount++;
+        level++;
+    }
+    void onKey(UconfigKeyObject&)
+    {
+        keyCount++;
+    }
+    void onEntryEnd()
+    {
+        balanced &= --level >= 0;
+    }
+};
+
+static void countNodes(const UconfigEntryRef& entry,
+                       int& entryCount,
+                       int& keyCount)
+{
+    keyCount += entry.keyCount();
+    for (UconfigEntryRef subentry : entry.childRange())
+    {
+        entryCount++;
+        countNodes(subentry, entryCount, keyCount);
+    }
+}
 
 
 bool testParserKeyValue()
@@ -24,7 +93,7 @@ bool testParserKeyValue()
     success &=
         config.rootEntry.searchSubentry("GRUB_GFXMODE").keyCount() == 2;
 
-    UconfigKeyObject* keyList = config.rootEntry.searchSubentry("GRUB_THEME").keys();
+    UconfigKeyRef* keyList = config.rootEntry.searchSubentry("GRUB_THEME").keys();
     success &= strcmp(keyList[0].value(),
                       "/boot/grub/themes/deepin/theme.txt") == 0;
     delete[] keyList;
@@ -50,13 +119,14 @@ bool testParserINI()
     success &=
         config.rootEntry.searchSubentry("avfilterAudio").subentryCount() == 2;
 
-    UconfigKeyObject* keyList = config.rootEntry.searchSubentry("capture")
+    UconfigKeyRef* keyList = config.rootEntry.searchSubentry("capture")
                                       .searchSubentry("dir").keys();
-    success &= strcmp(keyList[0].value(), "/home/user") == 0;
+    success &= keyList[0].valueSize() == 10 &&
+               memcmp(keyList[0].value(), "/home/user", 10) == 0;
     delete[] keyList;
 
 
-    UconfigEntryObject* entryList = config.rootEntry.searchSubentry("decoder")
+    UconfigEntryRef* entryList = config.rootEntry.searchSubentry("decoder")
                                           .subentries();
     keyList = entryList[0].keys();
     success &= strcmp(keyList[0].name(), "video\\priority") == 0;
@@ -114,6 +184,232 @@ bool testParserCSV()
     return success;
 }
 
+bool testParserCSVColumnar()
+{
+    const char* filename = "./SampleConfigs/population.csv";
+    const char* rowFileName = "./SampleConfigs/population.rows.csv";
+    const char* columnFileName = "./SampleConfigs/population.columns.csv";
+    const char* raggedFileName = "./SampleConfigs/ragged.csv";
+
+    UconfigFile rowConfig;
+    UconfigFile columnConfig;
+    columnConfig.setArenaEnabled(true);
+    columnConfig.setColumnarEnabled(true);
+    if (!UconfigCSV::readUconfig(filename, &rowConfig) ||
+        !UconfigCSV::readUconfig(filename, &columnConfig))
+        return false;
+
+    bool success = true;
+    UconfigEntryRef rows = rowConfig.rootEntry.childRange()[0];
+    UconfigEntryRef table = columnConfig.rootEntry.childRange()[0];
+    success &= table.columnarEnabled();
+    success &= table.rowCount() == 67 &&
+               table.rowCount() == rows.subentryCount();
+    success &= table.columnCount() == 3;
+
+    // Rows read back as the subentries of a table read without columns
+    UconfigEntryObject row;
+    for (int i=0; i<table.rowCount() && success; i++)
+    {
+        success &= table.readRow(i, row);
+        success &= compareEntries(row, rows.childRange()[i]);
+    }
+
+    // Rows are still seen as subentries, but cannot be changed
+    UconfigEntryRef* rowList = table.subentries();
+    success &= table.subentryCount() == 67 && rowList != NULL;
+    success &= compareEntries(table, rows);
+    success &= compareEntries(columnConfig.rootEntry, rowConfig.rootEntry);
+    UconfigEntryRef found = table.searchSubentry("WORLD", NULL, false, 5);
+    success &= !found.isNull() && found.name() == rowList[1].name();
+    success &= found.name() == table.childRange()[1].name();
+    success &= found.parentEntry().name() == table.name();
+    success &= table.existSubentry("WORLD", 5) &&
+               !table.existSubentry("Mars", 4);
+    success &= columnConfig.rootEntry.searchSubentry("WORLD", NULL, true, 5)
+                                     .name() == found.name();
+    UconfigKeyRef year = found.searchKey("year", 4);
+    found.setName("Mars");
+    year.setValue("0", 2);
+    success &= !found.addKey(&year);
+    success &= !table.addSubentry(&found);
+    success &= !table.deleteSubentry("WORLD", 5);
+    success &= found.nameSize() == 5 && memcmp(found.name(), "WORLD", 5) == 0;
+    success &= *((const int*)(year.value())) == 1950;
+    success &= compareEntries(table, rows);
+    delete[] rowList;
+
+    // Numbers are stored as arrays, after the header row
+    int yearColumn = table.searchColumn("year", 4);
+    int populationColumn = table.searchColumn("population", 10);
+    success &= yearColumn == 1 && populationColumn == 2;
+    success &= table.columnType(yearColumn) == UconfigCSV::Integer;
+    const long long* years = table.integerColumn(yearColumn);
+    const double* populations = table.doubleColumn(populationColumn);
+    // The last row has no delimiter after it
+    success &= years && years[1] == 1950 && years[66] == 2015;
+    success &= populations && populations[1] == 2536274.721;
+    success &= !table.integerColumn(populationColumn) &&
+               !table.boolColumn(yearColumn);
+
+    // Writing from the columns gives the same file as from the rows
+    success &= UconfigCSV::writeUconfig(rowFileName, &rowConfig);
+    success &= UconfigCSV::writeUconfig(columnFileName, &columnConfig);
+    FILE* rowFile = fopen(rowFileName, "r");
+    FILE* columnFile = fopen(columnFileName, "r");
+    if (rowFile && columnFile)
+    {
+        char rowBuffer[4096] = {};
+        char columnBuffer[4096] = {};
+        size_t rowLength = fread(rowBuffer, 1, sizeof(rowBuffer), rowFile);
+        size_t columnLength = fread(columnBuffer, 1, sizeof(columnBuffer),
+                                    columnFile);
+        success &= rowLength > 0 && rowLength == columnLength &&
+                   memcmp(rowBuffer, columnBuffer, rowLength) == 0;
+        success &= strncmp(rowBuffer, "region,year,population\n"
+                                      "WORLD,1950,2536274.721\n", 46) == 0;
+    }
+    else
+        success = false;
+    if (rowFile)
+        fclose(rowFile);
+    if (columnFile)
+        fclose(columnFile);
+
+    // Copies keep the columns; expanded tables are plain subentries again
+    UconfigEntryObject tableCopy;
+    tableCopy.addSubentry(&table);
+    success &= tableCopy.childRange()[0].rowCount() == 67;
+    success &= table.setColumnarEnabled(false);
+    success &= !table.columnarEnabled() && table.rowCount() == 0;
+    success &= compareEntries(table, rows);
+    success &= tableCopy.childRange()[0].setColumnarEnabled(false);
+    success &= compareEntries(tableCopy.childRange()[0], rows);
+
+    // Cells of different types, and rows of different lengths
+    FILE* raggedFile = fopen(raggedFileName, "w");
+    if (!raggedFile)
+        return false;
+    fputs("a,b,c\n1,2,3\n4,x\n5,6,7,8\n", raggedFile);
+    fclose(raggedFile);
+
+    UconfigFile raggedRows;
+    UconfigFile raggedColumns;
+    raggedColumns.setColumnarEnabled(true);
+    success &= UconfigCSV::readUconfig(raggedFileName, &raggedRows);
+    success &= UconfigCSV::readUconfig(raggedFileName, &raggedColumns);
+    rows = raggedRows.rootEntry.childRange()[0];
+    table = raggedColumns.rootEntry.childRange()[0];
+    success &= table.rowCount() == 4 && table.columnCount() == 4;
+    success &= table.columnType(1) == UconfigCSV::Integer;
+    success &= table.integerColumn(1) && table.integerColumn(1)[2] == 0;
+    success &= table.exceptionCount(1) == 1 &&
+               table.exceptionRows(1)[0] == 2;
+    success &= table.integerColumn(2) && table.integerColumn(2)[2] == 0;
+    success &= table.integerColumn(3) && table.integerColumn(3)[3] == 8;
+    for (int i=0; i<table.rowCount() && success; i++)
+    {
+        success &= table.readRow(i, row);
+        success &= compareEntries(row, rows.childRange()[i]);
+    }
+
+    // Rows that do not fit in columns are refused
+    UconfigKeyObject key;
+    key.setName("z");
+    key.setValue("z", 2);
+    success &= table.beginRow(NULL, 0, UconfigCSV::Row);
+    success &= !table.appendCell(key);
+    table.endRow();
+    success &= !table.beginRow(NULL, 0, UconfigCSV::Raw);
+    success &= table.rowCount() == 5;
+
+    // Tables are read as subentries again from the first one that does not
+    // fit, e.g. a "line" without any delimiter
+    raggedFile = fopen(raggedFileName, "a");
+    if (!raggedFile)
+        return false;
+    fputs("9\n", raggedFile);
+    fclose(raggedFile);
+    success &= UconfigCSV::readUconfig(raggedFileName, &raggedRows);
+    success &= UconfigCSV::readUconfig(raggedFileName, &raggedColumns);
+    table = raggedColumns.rootEntry.childRange()[0];
+    success &= !table.columnarEnabled();
+    success &= compareEntries(raggedColumns.rootEntry, raggedRows.rootEntry);
+
+    UconfigEntryObject nested;
+    UconfigEntryObject subentry;
+    subentry.addSubentry(&row);
+    nested.addSubentry(&subentry);
+    success &= !nested.setColumnarEnabled(true);
+    success &= !nested.columnarEnabled() && nested.subentryCount() == 1;
+
+    return success;
+}
+
+bool testParser2DTableTypes()
+{
+    const char* filename = "./SampleConfigs/types.txt";
+    const char* lines[] =
+    {
+        "07,-3,12.50,NA",
+        "123456789012,1.25e3,0.1,x",
+        "2,.5,12345678901234567890.5,\"y\"",
+        "3,5.,0.000000000000000000001,true",
+        "1999,2.5,9007199254740993.0,4"
+    };
+    const int lineCount = sizeof(lines) / sizeof(lines[0]);
+    const int sampleCount = 20;
+
+    // Rows of plain numbers, then cells that do not fit their columns
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+    for (int i=0; i<sampleCount; i++)
+        fprintf(file, "%d,%d.5,%d.25,%d\n", i, i, i, i);
+    for (int i=0; i<lineCount; i++)
+        fprintf(file, "%s\n", lines[i]);
+    fclose(file);
+
+    UconfigFile config;
+    if (!Uconfig2DTable::readUconfig(filename, &config, "\n", ","))
+        return false;
+
+    // Cells are read as if their type was guessed one by one
+    bool success = true;
+    UconfigEntryRef table = config.rootEntry.childRange()[0];
+    success &= table.subentryCount() == sampleCount + lineCount;
+    for (int i=0; i<lineCount && success; i++)
+    {
+        UconfigEntryObject row;
+        Uconfig2DTable::parseValues(lines[i], row, strlen(lines[i]), ",");
+        success &= compareEntries(row, table.childRange()[sampleCount + i]);
+    }
+
+    // Cells whose type differs from that of the sampled rows are recorded
+    UconfigKeyRef record =
+            config.metadata.searchKey(UCONFIG_METADATA_KEY_TYPEEXCEPT);
+    const int* cells = (const int*)(record.value());
+    int cellCount = record.valueSize() / int(sizeof(int) * 2);
+    int expectedCount = 0;
+    UconfigEntryRef sample = table.childRange()[1];
+    for (int i=0; i<lineCount && success; i++)
+    {
+        UconfigEntryRef row = table.childRange()[sampleCount + i];
+        for (int j=0; j<row.keyCount(); j++)
+        {
+            if (row.keyRange()[j].type() == sample.keyRange()[j].type())
+                continue;
+            success &= expectedCount < cellCount &&
+                       cells[expectedCount * 2] == sampleCount + i &&
+                       cells[expectedCount * 2 + 1] == j;
+            expectedCount++;
+        }
+    }
+    success &= expectedCount > 0 && cellCount == expectedCount;
+
+    return success;
+}
+
 bool testParserJSON()
 {
     const char* filename = "./SampleConfigs/firefox.json";
@@ -134,7 +430,7 @@ bool testParserJSON()
     success &= config.rootEntry.searchSubentry("Capture", NULL, true, 7)
                      .keyCount() == 1;
 
-    UconfigKeyObject* keyList =
+    UconfigKeyRef* keyList =
             config.rootEntry.searchSubentry("FileList", NULL, true, 8).keys();
     success &=
         strncmp(keyList[4].value(),
@@ -147,13 +443,201 @@ bool testParserJSON()
     return success;
 }
 
+bool testParserJSONBuffer()
+{
+    const char* json = "{\"Name\": \"a \\\"quoted\\\" word\", "
+                       "\"Empty\": [], \"List\": [1, 2.5, true]}";
+
+    UconfigFile config;
+    if (!UconfigJSON::readUconfig(json, strlen(json), &config))
+        return false;
+
+    bool success = true;
+    success &= config.metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME)
+                              .value() == NULL;
+
+    UconfigEntryRef object = config.rootEntry.childRange()[0];
+    success &= object.type() == UconfigJSON::ObjectEntry;
+    success &= object.keyCount() == 1 && object.subentryCount() == 2;
+
+    UconfigKeyRef name = object.searchKey("Name", 4);
+    success &= name.valueSize() == 17 &&
+               strncmp(name.value(), "a \\\"quoted\\\" word", 17) == 0;
+
+    UconfigEntryRef empty = object.searchSubentry("Empty", NULL, false, 5);
+    success &= empty.type() == UconfigJSON::ArrayEntry;
+    success &= empty.keyCount() == 0;
+
+    UconfigEntryRef list = object.searchSubentry("List", NULL, false, 4);
+    success &= list.type() == UconfigJSON::ArrayEntry;
+    success &= list.keyCount() == 3;
+    success &= list.keyRange()[1].type() == UconfigJSON::Double;
+
+    return success;
+}
+
+// Read a JSON file through a pipe, which cannot be mapped
+static bool readJSONPipe(const std::string& content,
+                         UconfigFile* config,
+                         UconfigHandler* handler)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+
+    std::thread writer([&]()
+    {
+        // Fail rather than be killed if the reader gives up
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+        size_t written = 0;
+        ssize_t size;
+        while (written < content.size() &&
+               (size = write(fds[1], content.data() + written,
+                             content.size() - written)) > 0)
+            written += size;
+        close(fds[1]);
+    });
+
+    char filename[32];
+    snprintf(filename, sizeof(filename), "/dev/fd/%d", fds[0]);
+    bool success = config ? UconfigJSON::readUconfig(filename, config) :
+                            UconfigJSON::parseUconfig(filename, handler);
+
+    close(fds[0]);
+    writer.join();
+    return success;
+}
+
+bool testParserJSONPipe()
+{
+    const char* filename = "./SampleConfigs/firefox.json";
+
+    UconfigFile expected;
+    if (!UconfigJSON::readUconfig(filename, &expected))
+        return false;
+
+    FILE* file = fopen(filename, "rb");
+    if (!file)
+        return false;
+    std::string content;
+    char buffer[4096];
+    size_t size;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        content.append(buffer, size);
+    fclose(file);
+
+    bool success = true;
+    UconfigFile config;
+    success &= readJSONPipe(content, &config, NULL);
+    success &= compareEntries(expected.rootEntry, config.rootEntry);
+
+    UconfigEntryObject parsed;
+    UconfigTreeBuilder parsedBuilder(parsed);
+    success &= UconfigJSON::parseUconfig(filename, &parsedBuilder);
+    UconfigEntryObject entry;
+    UconfigTreeBuilder builder(entry);
+    success &= readJSONPipe(content, NULL, &builder);
+    success &= entry.subentryCount() > 0 && compareEntries(parsed, entry);
+
+    return success;
+}
+
+// Parse a buffer char by char and with the structural index built
+// by each supported kernel, then compare the resulting trees
+static bool compareJSONParsers(const std::string& json)
+{
+    const char* data = json.c_str();
+    const char* end = data + json.size();
+
+    UconfigEntryObject expected;
+    UconfigTreeBuilder expectedBuilder(expected);
+    const char* expectedEnd =
+            UconfigJSONPrivate::parseEntry(data, end, &expectedBuilder);
+
+    bool success = true;
+    UconfigJSONScanner::Kernel defaultKernel = UconfigJSONScanner::kernel();
+    for (int i=UconfigJSONScanner::ScalarKernel;
+         i<=UconfigJSONScanner::AVX2Kernel; i++)
+    {
+        if (!UconfigJSONScanner::setKernel(UconfigJSONScanner::Kernel(i)))
+            continue;
+
+        UconfigJSONScanner scanner(data, json.size());
+        UconfigEntryObject entry;
+        UconfigTreeBuilder builder(entry);
+        success &= UconfigJSONPrivate::parseEntry(scanner, data, end,
+                                                  &builder) == expectedEnd;
+        success &= compareEntries(expected, entry);
+    }
+    UconfigJSONScanner::setKernel(defaultKernel);
+
+    return success;
+}
+
+bool testParserJSONIndex()
+{
+    const char* filenames[] = {"./SampleConfigs/QMLPlayer.ini",
+                               "./SampleConfigs/config.xml",
+                               "./SampleConfigs/firefox.json",
+                               "./SampleConfigs/fstab",
+                               "./SampleConfigs/grub",
+                               "./SampleConfigs/population.csv"};
+
+    // Every sample file, whatever its format
+    bool success = true;
+    std::string sample;
+    std::string samples;
+    for (unsigned int i=0; i<sizeof(filenames) / sizeof(char*); i++)
+    {
+        size_t length;
+        const char* data = Uconfig_mapFile(filenames[i], &length);
+        if (!data)
+            return false;
+        sample.assign(data, length);
+        Uconfig_unmapFile(data, length);
+
+        success &= compareJSONParsers(sample);
+        samples.append(sample);
+    }
+
+    // Random strings of JSON chars, and mutations of all the samples
+    // repeated over several batches of the scanner
+    std::string json;
+    const char* chars = UCONFIG_TEST_JSON_FUZZ_CHARS;
+    int charCount = strlen(chars);
+    srand(1);
+    for (int i=0; i<UCONFIG_TEST_JSON_FUZZ_COUNT && success; i++)
+    {
+        json.resize(rand() % 300);
+        for (size_t j=0; j<json.size(); j++)
+            json[j] = chars[rand() % charCount];
+        success &= compareJSONParsers(json);
+    }
+    for (int i=0; i<UCONFIG_TEST_JSON_FUZZ_COUNT / 100 && success; i++)
+    {
+        json.clear();
+        for (int j=0; j<3; j++)
+            json.append(samples);
+        for (int j=0; j<10; j++)
+            json[rand() % json.size()] = chars[rand() % charCount];
+        success &= compareJSONParsers(json);
+    }
+
+    return success;
+}
+
 bool testParserXML()
 {
     const char* filename = "./SampleConfigs/config.xml";
     const char* outputFileName = "./SampleConfigs/config.xml.xml";
 
+    // Skip blank text between tags
     UconfigFile config;
-    if (!UconfigXML::readUconfig(filename, &config))
+    if (!UconfigXML::readUconfig(filename, &config, true))
         return false;
 
     bool success = true;
@@ -161,14 +645,14 @@ bool testParserXML()
         strcmp(config.metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME).value(),
                filename) == 0;
 
-    success &= config.rootEntry.searchSubentry("configBlock", NULL, true)
+    success &= config.rootEntry.searchSubentry("configBlock", NULL, true, 11)
                      .subentryCount() == 2;
 
-    success &= config.rootEntry.searchSubentry("handler", NULL, true)
+    success &= config.rootEntry.searchSubentry("handler", NULL, true, 7)
                      .keyCount() == 3;
 
-    UconfigKeyObject* keyList =
-            config.rootEntry.searchSubentry("contents", NULL, true)
+    UconfigKeyRef* keyList =
+            config.rootEntry.searchSubentry("contents", NULL, true, 8)
                   .subentries()[0].keys();
     success &=
         strncmp(keyList[0].value(),
@@ -184,6 +668,741 @@ bool testParserXML()
     return success;
 }
 
+// Read an XML file through a pipe, which cannot be seeked
+bool testParserXMLStream()
+{
+    const char* filename = "./SampleConfigs/config.xml";
+    const char* command = "cat ./SampleConfigs/config.xml";
+
+    UconfigFile fileConfig, streamConfig;
+    if (!UconfigXML::readUconfig(filename, &fileConfig))
+        return false;
+
+    FILE* pipe = popen(command, "r");
+    if (!pipe)
+        return false;
+    bool success = UconfigXML::freadUconfig(pipe, &streamConfig);
+    pclose(pipe);
+
+    success &= streamConfig.metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME)
+                                    .value() == NULL;
+    success &= compareEntries(fileConfig.rootEntry, streamConfig.rootEntry);
+
+    return success;
+}
+
+// Report every sample file to a handler which only counts the nodes,
+// then to a tree builder, and compare both with the loaded trees
+bool testParserHandler()
+{
+    const char* iniFile = "./SampleConfigs/QMLPlayer.ini";
+    const char* keyValueFile = "./SampleConfigs/grub";
+    const char* tableFile = "./SampleConfigs/fstab";
+    const char* csvFile = "./SampleConfigs/population.csv";
+    const char* jsonFile = "./SampleConfigs/firefox.json";
+    const char* xmlFile = "./SampleConfigs/config.xml";
+
+    UconfigFile configs[6];
+    UconfigCountingHandler counters[6];
+    UconfigEntryObject entries[6];
+    bool success = true;
+    success &= UconfigINI::readUconfig(iniFile, &configs[0]);
+    success &= UconfigINI::parseUconfig(iniFile, &counters[0]);
+    success &= UconfigKeyValue::readUconfig(keyValueFile, &configs[1]);
+    success &= UconfigKeyValue::parseUconfig(keyValueFile, &counters[1]);
+    success &= Uconfig2DTable::readUconfig(tableFile, &configs[2]);
+    success &= Uconfig2DTable::parseUconfig(tableFile, &counters[2]);
+    success &= UconfigCSV::readUconfig(csvFile, &configs[3]);
+    success &= UconfigCSV::parseUconfig(csvFile, &counters[3]);
+    success &= UconfigJSON::readUconfig(jsonFile, &configs[4]);
+    success &= UconfigJSON::parseUconfig(jsonFile, &counters[4]);
+    success &= UconfigXML::readUconfig(xmlFile, &configs[5]);
+    success &= UconfigXML::parseUconfig(xmlFile, &counters[5]);
+    if (!success)
+        return false;
+
+    UconfigTreeBuilder iniBuilder(entries[0]);
+    UconfigTreeBuilder keyValueBuilder(entries[1]);
+    UconfigTreeBuilder tableBuilder(entries[2]);
+    UconfigTreeBuilder csvBuilder(entries[3]);
+    UconfigTreeBuilder jsonBuilder(entries[4]);
+    UconfigTreeBuilder xmlBuilder(entries[5]);
+    UconfigINI::parseUconfig(iniFile, &iniBuilder);
+    UconfigKeyValue::parseUconfig(keyValueFile, &keyValueBuilder);
+    Uconfig2DTable::parseUconfig(tableFile, &tableBuilder);
+    UconfigCSV::parseUconfig(csvFile, &csvBuilder);
+    UconfigJSON::parseUconfig(jsonFile, &jsonBuilder);
+    UconfigXML::parseUconfig(xmlFile, &xmlBuilder);
+
+    for (int i=0; i<6; i++)
+    {
+        int entryCount = 0;
+        int keyCount = 0;
+        countNodes(configs[i].rootEntry, entryCount, keyCount);
+        success &= entryCount > 0;
+        success &= counters[i].entryCount == entryCount;
+        success &= counters[i].keyCount == keyCount;
+        success &= counters[i].balanced && counters[i].level == 0;
+
+        // Only the type of the root entry is left to the tree readers
+        entries[i].setType(configs[i].rootEntry.type());
+        success &= compareEntries(configs[i].rootEntry, entries[i]);
+    }
+
+    // Entries built from events know their parent
+    UconfigEntryRef table = entries[3].childRange()[0];
+    success &= table.childRange()[1].parentEntry().name() == table.name();
+
+    return success;
+}
+
+// Compare the content of a file with a block of memory written
+// in the same way, then free the block
+static bool compareOutput(const char* filename, char* data, size_t length)
+{
+    size_t fileLength;
+    const char* fileData = Uconfig_mapFile(filename, &fileLength);
+    if (!fileData)
+    {
+        free(data);
+        return false;
+    }
+
+    bool success = data != NULL && data[length] == '\0';
+    success &= length == fileLength &&
+               memcmp(data, fileData, length) == 0;
+
+    Uconfig_unmapFile(fileData, fileLength);
+    free(data);
+    return success;
+}
+
+// Read every sample file from a copy of it in memory, and write it
+// back into memory, then compare with the file read and written as usual
+bool testParserBuffer()
+{
+    const char* filenames[] = {"./SampleConfigs/QMLPlayer.ini",
+                               "./SampleConfigs/grub",
+                               "./SampleConfigs/fstab",
+                               "./SampleConfigs/population.csv",
+                               "./SampleConfigs/firefox.json",
+                               "./SampleConfigs/config.xml"};
+    const char* outputFileName = "./SampleConfigs/buffer.txt";
+
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(filenames) / sizeof(char*); i++)
+    {
+        // Copy of the file, as if it was received from another process
+        size_t length;
+        const char* mapped = Uconfig_mapFile(filenames[i], &length);
+        if (!mapped)
+            return false;
+        std::string sample(mapped, length);
+        Uconfig_unmapFile(mapped, length);
+
+        const char* input = sample.data();
+        UconfigFile fileConfig, bufferConfig;
+        UconfigEntryObject entry;
+        UconfigTreeBuilder builder(entry);
+        char* output = NULL;
+        size_t outputLength = 0;
+        switch (i)
+        {
+            case 0:
+                success &= UconfigINI::readUconfig(filenames[i],
+                                                   &fileConfig);
+                success &= UconfigINI::readUconfig(input, length,
+                                                   &bufferConfig);
+                success &= UconfigINI::parseUconfig(input, length, &builder);
+                success &= UconfigINI::writeUconfig(outputFileName,
+                                                    &fileConfig);
+                success &= UconfigINI::writeUconfig(&output, &outputLength,
+                                                    &bufferConfig);
+                break;
+            case 1:
+                success &= UconfigKeyValue::readUconfig(filenames[i],
+                                                        &fileConfig);
+                success &= UconfigKeyValue::readUconfig(input, length,
+                                                        &bufferConfig);
+                success &= UconfigKeyValue::parseUconfig(input, length,
+                                                         &builder);
+                success &= UconfigKeyValue::writeUconfig(outputFileName,
+                                                         &fileConfig);
+                success &= UconfigKeyValue::writeUconfig(&output,
+                                                         &outputLength,
+                                                         &bufferConfig);
+                break;
+            case 2:
+                success &= Uconfig2DTable::readUconfig(filenames[i],
+                                                       &fileConfig);
+                success &= Uconfig2DTable::readUconfig(input, length,
+                                                       &bufferConfig);
+                success &= Uconfig2DTable::parseUconfig(input, length,
+                                                        &builder);
+                success &= Uconfig2DTable::writeUconfig(outputFileName,
+                                                        &fileConfig);
+                success &= Uconfig2DTable::writeUconfig(&output,
+                                                        &outputLength,
+                                                        &bufferConfig);
+                break;
+            case 3:
+                success &= UconfigCSV::readUconfig(filenames[i],
+                                                   &fileConfig);
+                success &= UconfigCSV::readUconfig(input, length,
+                                                   &bufferConfig);
+                success &= UconfigCSV::parseUconfig(input, length, &builder);
+                success &= UconfigCSV::writeUconfig(outputFileName,
+                                                    &fileConfig);
+                success &= UconfigCSV::writeUconfig(&output, &outputLength,
+                                                    &bufferConfig);
+                break;
+            case 4:
+                success &= UconfigJSON::readUconfig(filenames[i],
+                                                    &fileConfig);
+                success &= UconfigJSON::readUconfig(input, length,
+                                                    &bufferConfig);
+                success &= UconfigJSON::parseUconfig(input, length,
+                                                     &builder);
+                success &= UconfigJSON::writeUconfig(outputFileName,
+                                                     &fileConfig);
+                success &= UconfigJSON::writeUconfig(&output, &outputLength,
+                                                     &bufferConfig);
+                break;
+            default:
+                success &= UconfigXML::readUconfig(filenames[i],
+                                                   &fileConfig);
+                success &= UconfigXML::readUconfig(input, length,
+                                                   &bufferConfig);
+                success &= UconfigXML::parseUconfig(input, length, &builder);
+                success &= UconfigXML::writeUconfig(outputFileName,
+                                                    &fileConfig);
+                success &= UconfigXML::writeUconfig(&output, &outputLength,
+                                                    &bufferConfig);
+        }
+
+        success &= bufferConfig.metadata
+                               .searchKey(UCONFIG_METADATA_KEY_FILENAME)
+                               .value() == NULL;
+        success &= compareEntries(fileConfig.rootEntry,
+                                  bufferConfig.rootEntry);
+        entry.setType(bufferConfig.rootEntry.type());
+        success &= compareEntries(bufferConfig.rootEntry, entry);
+        success &= compareOutput(outputFileName, output, outputLength);
+    }
+
+    // Even an empty tree is written into a block, which ends with "\0"
+    UconfigFile emptyConfig;
+    char* output = NULL;
+    size_t outputLength = 1;
+    success &= UconfigKeyValue::writeUconfig(&output, &outputLength,
+                                             &emptyConfig);
+    success &= output != NULL && outputLength == 0 && output[0] == '\0';
+    free(output);
+
+    return success;
+}
+
+// Compare an entry of a tree with the same entry read from a snapshot
+static bool compareSnapshot(const UconfigEntryRef& entry,
+                            const UconfigBinaryEntry& snapshot)
+{
+    if (snapshot.isNull() ||
+        entry.type() != snapshot.type() ||
+        entry.nameSize() != snapshot.nameSize() ||
+        entry.keyCount() != snapshot.keyCount() ||
+        entry.subentryCount() != snapshot.subentryCount())
+        return false;
+    if (entry.nameSize() > 0 &&
+        memcmp(entry.name(), snapshot.name(), entry.nameSize()) != 0)
+        return false;
+
+    int i;
+    bool success = true;
+    UconfigKeyRange keyList = entry.keyRange();
+    for (i=0; i<keyList.size() && success; i++)
+    {
+        UconfigKeyRef key1 = keyList[i];
+        UconfigBinaryKey key2 = snapshot.key(i);
+        success &= key1.type() == key2.type();
+        success &= key1.nameSize() == key2.nameSize();
+        success &= key1.valueSize() == key2.valueSize();
+        if (!success)
+            break;
+        if (key1.nameSize() > 0)
+            success &= memcmp(key1.name(),
+                              key2.name(),
+                              key1.nameSize()) == 0;
+        if (key1.valueSize() > 0)
+            success &= memcmp(key1.value(),
+                              key2.value(),
+                              key1.valueSize()) == 0;
+    }
+
+    UconfigEntryRange entryList = entry.childRange();
+    for (i=0; i<entryList.size() && success; i++)
+    {
+        UconfigBinaryEntry subentry = snapshot.subentry(i);
+        success &= subentry.parentEntry().type() == snapshot.type();
+        success &= compareSnapshot(entryList[i], subentry);
+    }
+
+    return success;
+}
+
+// Write a snapshot of every sample file, read it in place,
+// then turn it back into a tree
+bool testParserBinary()
+{
+    const char* filenames[] = {"./SampleConfigs/QMLPlayer.ini",
+                               "./SampleConfigs/grub",
+                               "./SampleConfigs/population.csv",
+                               "./SampleConfigs/firefox.json",
+                               "./SampleConfigs/config.xml"};
+    const char* snapshotFileName = "./SampleConfigs/snapshot.bin";
+
+    bool success = true;
+    for (unsigned int i=0; i<sizeof(filenames) / sizeof(char*); i++)
+    {
+        UconfigFile config, fileCopy, bufferCopy;
+        switch (i)
+        {
+            case 0:
+                success &= UconfigINI::readUconfig(filenames[i], &config);
+                break;
+            case 1:
+                success &= UconfigKeyValue::readUconfig(filenames[i],
+                                                        &config);
+                break;
+            case 2:
+                success &= UconfigCSV::readUconfig(filenames[i], &config);
+                break;
+            case 3:
+                success &= UconfigJSON::readUconfig(filenames[i], &config);
+                break;
+            default:
+                success &= UconfigXML::readUconfig(filenames[i], &config);
+        }
+
+        char* data = NULL;
+        size_t length = 0;
+        success &= UconfigBinary::writeUconfig(snapshotFileName, &config);
+        success &= UconfigBinary::writeUconfig(&data, &length, &config);
+
+        UconfigBinaryView view;
+        success &= view.open(snapshotFileName);
+        success &= compareSnapshot(config.rootEntry, view.rootEntry());
+        success &= compareSnapshot(config.metadata, view.metadata());
+        view.close();
+
+        success &= UconfigBinary::readUconfig(snapshotFileName, &fileCopy);
+        success &= UconfigBinary::readUconfig(data, length, &bufferCopy);
+        success &= compareEntries(config.rootEntry, fileCopy.rootEntry);
+        success &= compareEntries(config.metadata, fileCopy.metadata);
+        success &= compareEntries(config.rootEntry, bufferCopy.rootEntry);
+
+        // A copy that is not aligned is read as well
+        char* shifted = (char*)malloc(length + 1);
+        memcpy(shifted + 1, data, length);
+        UconfigEntryObject entry;
+        UconfigTreeBuilder builder(entry);
+        success &= UconfigBinary::parseUconfig(shifted + 1, length, &builder);
+        entry.setType(config.rootEntry.type());
+        entry.setName(config.rootEntry.name(), config.rootEntry.nameSize());
+        success &= compareEntries(config.rootEntry, entry);
+        free(shifted);
+
+        success &= compareOutput(snapshotFileName, data, length);
+    }
+
+    // Searches in place
+    UconfigBinaryView view;
+    success &= view.open(snapshotFileName);
+    UconfigBinaryEntry root = view.rootEntry();
+    UconfigBinaryEntry subentry = root.searchSubentry("mconfig", 7);
+    success &= !subentry.isNull();
+    success &= subentry.parentEntry().subentryCount() ==
+               root.subentryCount();
+    success &= root.searchSubentry("nothing").isNull();
+    success &= root.subentry(-1).isNull();
+    success &= root.subentry(root.subentryCount()).isNull();
+    success &= view.metadata()
+                   .searchKey(UCONFIG_METADATA_KEY_FILETYPE)
+                   .valueSize() > 0;
+    view.close();
+
+    // Columnar tables are stored as rows
+    UconfigFile columnarConfig, rowConfig, columnarCopy;
+    columnarConfig.setColumnarEnabled(true);
+    success &= UconfigCSV::readUconfig(filenames[2], &columnarConfig);
+    success &= UconfigCSV::readUconfig(filenames[2], &rowConfig);
+    success &= UconfigBinary::writeUconfig(snapshotFileName,
+                                           &columnarConfig);
+    success &= UconfigBinary::readUconfig(snapshotFileName, &columnarCopy);
+    success &= compareEntries(rowConfig.rootEntry, columnarCopy.rootEntry);
+
+    // Damaged snapshots are refused
+    char* data = NULL;
+    size_t length = 0;
+    UconfigFile damagedConfig;
+    success &= UconfigBinary::writeUconfig(&data, &length, &rowConfig);
+    success &= !view.open(data, length - 1);
+    success &= !view.open(data, sizeof(UconfigBinaryHeader) - 1);
+    success &= !UconfigBinary::readUconfig(data, length / 2, &damagedConfig);
+    data[0] = 'X';
+    success &= !view.open(data, length);
+    data[0] = UCONFIG_BINARY_MAGIC[0];
+    ((UconfigBinaryHeader*)(data))->version++;
+    success &= !view.open(data, length);
+    ((UconfigBinaryHeader*)(data))->version--;
+    ((UconfigBinaryHeader*)(data))->keyOffset += 4;
+    success &= !view.open(data, length);
+    ((UconfigBinaryHeader*)(data))->keyOffset -= 4;
+    ((UconfigBinaryHeader*)(data))->rootEntry = 0xFFFF;
+    success &= !view.open(data, length);
+    ((UconfigBinaryHeader*)(data))->rootEntry = 0;
+    success &= view.open(data, length);
+    view.close();
+    free(data);
+
+    remove(snapshotFileName);
+    return success;
+}
+
+// Write a file with the given content
+static bool writeSample(const char* filename, const std::string& content)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+        return false;
+    bool success = fwrite(content.data(), 1, content.size(), file) ==
+                   content.size();
+    return fclose(file) == 0 && success;
+}
+
+// Load a file through a cache again and again, changing it in between
+bool testParserCache()
+{
+    const char* sourceFileName = "./SampleConfigs/QMLPlayer.ini";
+    const char* filename = "./SampleConfigs/cache.ini";
+    const char* otherFilename = "./SampleConfigs/../SampleConfigs/cache.ini";
+    const char* cacheDirectory = "./SampleConfigs/cache/snapshots";
+
+    // Reference values of XXH64
+    bool success = true;
+    success &= Uconfig_hashContent("", 0) == 0xEF46DB3751D8E999ULL;
+    success &= Uconfig_hashContent("abc", 3) == 0x44BC2CF5AD770999ULL;
+    success &= Uconfig_hashContent("Nobody inspects the spammish repetition",
+                                   39) == 0xFBCEA83C8A378BF1ULL;
+
+    size_t length;
+    const char* data = Uconfig_mapFile(sourceFileName, &length);
+    if (!data)
+        return false;
+    std::string sample(data, length);
+    Uconfig_unmapFile(data, length);
+    success &= writeSample(filename, sample);
+
+    UconfigFile original;
+    success &= UconfigINI::readUconfig(filename, &original);
+
+    // Parsed at first, then loaded from cache
+    UconfigCache cache(cacheDirectory);
+    UconfigFile coldConfig, warmConfig, otherConfig;
+    success &= cache.readUconfig(filename, &coldConfig);
+    success &= cache.hitCount() == 0 && cache.missCount() == 1;
+    success &= cache.readUconfig(filename, &warmConfig);
+    success &= cache.hitCount() == 1 && cache.missCount() == 1;
+    success &= compareEntries(original.rootEntry, coldConfig.rootEntry);
+    success &= compareEntries(original.rootEntry, warmConfig.rootEntry);
+    success &= compareEntries(original.metadata, warmConfig.metadata);
+
+    // The same file through another path
+    success &= cache.readUconfig(otherFilename, &otherConfig);
+    success &= cache.hitCount() == 2;
+    success &= compareEntries(original.rootEntry, otherConfig.rootEntry);
+    success &= strcmp(otherConfig.metadata
+                                 .searchKey(UCONFIG_METADATA_KEY_FILENAME)
+                                 .value(), otherFilename) == 0;
+
+    // Same content with a new time of modification
+    UconfigFile touchedConfig, touchedCopy;
+    success &= utimensat(AT_FDCWD, filename, NULL, 0) == 0;
+    success &= cache.readUconfig(filename, &touchedConfig);
+    success &= cache.readUconfig(filename, &touchedCopy);
+    success &= cache.hitCount() == 4 && cache.missCount() == 1;
+    success &= compareEntries(original.rootEntry, touchedCopy.rootEntry);
+
+    // Content changed without changing the size nor the time
+    struct stat sourceStat;
+    success &= stat(filename, &sourceStat) == 0;
+    std::string changedSample(sample);
+    changedSample[1] = 'g';
+    success &= writeSample(filename, changedSample);
+    struct timespec times[2] = {sourceStat.st_atim, sourceStat.st_mtim};
+    success &= utimensat(AT_FDCWD, filename, times, 0) == 0;
+
+    UconfigFile changedConfig;
+    success &= cache.readUconfig(filename, &changedConfig);
+    success &= cache.hitCount() == 4 && cache.missCount() == 2;
+    success &= changedConfig.rootEntry.searchSubentry("general").nameSize()
+               > 0;
+
+    // Content appended
+    success &= writeSample(filename, sample + "[Added]\nkey=value\n");
+    UconfigFile appendedConfig, appendedCopy;
+    success &= cache.readUconfig(filename, &appendedConfig);
+    success &= cache.readUconfig(filename, &appendedCopy);
+    success &= cache.hitCount() == 5 && cache.missCount() == 3;
+    success &= appendedCopy.rootEntry.subentryCount() ==
+               original.rootEntry.subentryCount() + 1;
+    success &= compareEntries(appendedConfig.rootEntry,
+                              appendedCopy.rootEntry);
+
+    // Snapshot removed, and files of no known format
+    UconfigFile removedConfig, unknownConfig;
+    success &= cache.remove(filename);
+    success &= !cache.remove(filename);
+    success &= cache.readUconfig(filename, &removedConfig);
+    success &= cache.missCount() == 4;
+    success &= !cache.readUconfig("./SampleConfigs/grub", &unknownConfig);
+    success &= cache.readUconfig("./SampleConfigs/grub", &unknownConfig,
+                                 UconfigConverter::KeyValueFormat);
+    cache.resetCounters();
+    success &= cache.hitCount() == 0 && cache.missCount() == 0;
+
+    cache.remove(filename);
+    cache.remove("./SampleConfigs/grub");
+    remove(filename);
+    rmdir(cacheDirectory);
+    rmdir("./SampleConfigs/cache");
+    return success;
+}
+
+// A line-oriented sample, read with the given options
+struct UconfigLineSample
+{
+    UconfigConverter::Format format;
+    const char* filename;
+    const char* columnDelimiter;
+    bool skipEmptyRow;
+};
+
+// Read the content of a sample as a whole, or update its tree with INDEX
+static bool readLineSample(const UconfigLineSample& sample,
+                           const std::string& content,
+                           UconfigFile* config,
+                           UconfigLineIndex* index = NULL)
+{
+    const char* data = content.data();
+    size_t length = content.size();
+    switch (sample.format)
+    {
+        case UconfigConverter::KeyValueFormat:
+            return index ?
+                   UconfigKeyValue::updateUconfig(data, length,
+                                                  config, index) :
+                   UconfigKeyValue::readUconfig(data, length, config);
+        case UconfigConverter::INIFormat:
+            return index ?
+                   UconfigINI::updateUconfig(data, length, config, index) :
+                   UconfigINI::readUconfig(data, length, config);
+        case UconfigConverter::TableFormat:
+            return index ?
+                   Uconfig2DTable::updateUconfig(data, length, config, index,
+                                                 "\n", sample.columnDelimiter,
+                                                 sample.skipEmptyRow) :
+                   Uconfig2DTable::readUconfig(data, length, config,
+                                               "\n", sample.columnDelimiter,
+                                               sample.skipEmptyRow);
+        default:
+            return false;
+    }
+}
+
+// Change line-oriented files at random, and compare their updated trees
+// with those read from the whole content
+bool testParserIncremental()
+{
+    const UconfigLineSample samples[] =
+    {
+        {UconfigConverter::KeyValueFormat, "./SampleConfigs/grub", NULL, true},
+        {UconfigConverter::INIFormat, "./SampleConfigs/QMLPlayer.ini",
+         NULL, true},
+        {UconfigConverter::TableFormat, "./SampleConfigs/population.csv",
+         ",", true},
+        {UconfigConverter::TableFormat, "./SampleConfigs/fstab", " ", false}
+    };
+    const int sampleCount = sizeof(samples) / sizeof(samples[0]);
+    const char editChars[] = UCONFIG_TEST_EDIT_CHARS;
+
+    bool success = true;
+    srand(1);
+    for (int i=0; i<sampleCount && success; i++)
+    {
+        size_t length;
+        const char* data = Uconfig_mapFile(samples[i].filename, &length);
+        if (!data)
+            return false;
+        std::string content(data, length);
+        Uconfig_unmapFile(data, length);
+
+        // Read as a whole at first
+        UconfigFile config;
+        UconfigLineIndex index;
+        success &= readLineSample(samples[i], content, &config, &index);
+        success &= !index.isEmpty() && index.entryCount() > 0;
+        success &= index.parsedCount() == index.entryCount();
+
+        // Nothing to parse for the same content
+        success &= readLineSample(samples[i], content, &config, &index);
+        success &= index.parsedCount() == 0;
+
+        // Only a few entries around a line changed in the middle
+        size_t middle = index.entryOffset(index.entryCount() / 2);
+        content.insert(content.find_first_of("\n", middle) - 1, "1");
+        UconfigFile expected;
+        success &= readLineSample(samples[i], content, &config, &index);
+        success &= readLineSample(samples[i], content, &expected);
+        success &= index.parsedCount() <= 3 &&
+                   index.parsedCount() < index.entryCount();
+        success &= compareEntries(config.rootEntry, expected.rootEntry);
+
+        // Chars replaced, inserted or removed anywhere
+        for (int j=0; j<UCONFIG_TEST_EDIT_COUNT && success; j++)
+        {
+            size_t pos = rand() % (content.size() + 1);
+            char editChar = editChars[rand() % (sizeof(editChars) - 1)];
+            switch (rand() % 4)
+            {
+                case 0:
+                    if (pos < content.size())
+                        content[pos] = editChar;
+                    break;
+                case 1:
+                    content.insert(pos, 1, editChar);
+                    break;
+                case 2:
+                    content.erase(pos, rand() % 8);
+                    break;
+                default:
+                    content.insert(pos, pos % 2 ? "[Line]\n" : "key = 2 x.5\n");
+            }
+
+            UconfigFile editedConfig;
+            success &= readLineSample(samples[i], content, &config, &index);
+            success &= readLineSample(samples[i], content, &editedConfig);
+            success &= compareEntries(config.rootEntry,
+                                      editedConfig.rootEntry);
+        }
+    }
+
+    // Update from a file, keeping its meta-data
+    UconfigFile fileConfig;
+    UconfigLineIndex fileIndex;
+    success &= UconfigINI::updateUconfig("./SampleConfigs/QMLPlayer.ini",
+                                         &fileConfig, &fileIndex);
+    success &= UconfigINI::updateUconfig("./SampleConfigs/QMLPlayer.ini",
+                                         &fileConfig, &fileIndex);
+    success &= fileIndex.parsedCount() == 0;
+    success &= fileConfig.metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME)
+                                  .nameSize() > 0;
+
+    return success;
+}
+
+// Wait for the watcher to read files again COUNT times in all
+static bool waitForReload(const UconfigWatcher& watcher, unsigned long count)
+{
+    for (int i=0; i<500 && watcher.reloadCount() < count; i++)
+        usleep(10000);
+    return watcher.reloadCount() >= count;
+}
+
+// Change a watched file while other threads read its tree
+bool testParserWatcher()
+{
+    const char* filename = "./SampleConfigs/watched.ini";
+    const char* tempFilename = "./SampleConfigs/watched.ini.tmp";
+    const int burstCount = 20;
+    const int debounceDelay = 100;
+
+    bool success = writeSample(filename, "[General]\nkey=1\n");
+    UconfigWatcher watcher(debounceDelay);
+    success &= watcher.addFile(filename);
+    success &= !watcher.addFile(filename);
+    success &= !watcher.addFile("./SampleConfigs/missing.ini");
+    success &= watcher.fileCount() == 1;
+    std::shared_ptr<const UconfigFile> first = watcher.config(filename);
+    success &= first && first->rootEntry.subentryCount() == 1;
+    success &= first &&
+        strcmp(first->metadata.searchKey(UCONFIG_METADATA_KEY_FILENAME).value(),
+               filename) == 0;
+    success &= !watcher.config("./SampleConfigs/missing.ini");
+    if (!success || !watcher.start())
+        return false;
+    success &= watcher.isRunning() && !watcher.addFile(tempFilename);
+
+    // Readers always get a whole tree, with its first section
+    std::atomic<bool> reading(true);
+    std::atomic<bool> complete(true);
+    std::thread reader([&]()
+    {
+        while (reading)
+        {
+            std::shared_ptr<const UconfigFile> config =
+                                                watcher.config(filename);
+            if (!config ||
+                config->rootEntry.searchSubentry("General").isNull())
+                complete = false;
+        }
+    });
+
+    // A burst of writes is read once
+    for (int i=0; i<burstCount; i++)
+    {
+        std::string content("[General]\nkey=1\n[Burst");
+        content.append(std::to_string(i)).append("]\nkey=2\n");
+        success &= writeSample(filename, content);
+    }
+    success &= waitForReload(watcher, 1);
+    usleep(debounceDelay * 3000);
+    success &= watcher.reloadCount() < 3;
+    std::shared_ptr<const UconfigFile> burst = watcher.config(filename);
+    success &= burst->rootEntry.subentryCount() == 2;
+    success &= !burst->rootEntry.searchSubentry("Burst19").isNull();
+
+    // Trees held by readers are kept as they were
+    success &= first->rootEntry.subentryCount() == 1;
+
+    // Files replaced by renaming
+    success &= writeSample(tempFilename,
+                           "[General]\nkey=1\n[Renamed]\nkey=3\n");
+    success &= rename(tempFilename, filename) == 0;
+    success &= waitForReload(watcher, watcher.reloadCount() + 1);
+    success &= !watcher.config(filename)->rootEntry
+                                        .searchSubentry("Renamed").isNull();
+
+    reading = false;
+    reader.join();
+    success &= complete;
+
+    // Changes made while stopped are read when started again
+    watcher.stop();
+    success &= !watcher.isRunning();
+    success &= writeSample(filename, "[General]\nkey=1\n[Restarted]\n");
+    unsigned long reloadCount = watcher.reloadCount();
+    success &= watcher.start();
+    success &= waitForReload(watcher, reloadCount + 1);
+    success &= !watcher.config(filename)->rootEntry
+                                        .searchSubentry("Restarted").isNull();
+    watcher.stop();
+    success &= watcher.failureCount() == 0;
+    success &= watcher.removeFile(filename) && watcher.fileCount() == 0;
+
+    remove(filename);
+    return success;
+}
+
 void testParser()
 {
     if (testParserKeyValue())
@@ -206,13 +1425,73 @@ void testParser()
     else
         printf("testParserCSV() failed!\n");
 
+    if (testParserCSVColumnar())
+        printf("testParserCSVColumnar() passed.\n");
+    else
+        printf("testParserCSVColumnar() failed!\n");
+
+    if (testParser2DTableTypes())
+        printf("testParser2DTableTypes() passed.\n");
+    else
+        printf("testParser2DTableTypes() failed!\n");
+
     if (testParserJSON())
         printf("testParserJSON() passed.\n");
     else
         printf("testParserJSON() failed!\n");
 
+    if (testParserJSONBuffer())
+        printf("testParserJSONBuffer() passed.\n");
+    else
+        printf("testParserJSONBuffer() failed!\n");
+
+    if (testParserJSONPipe())
+        printf("testParserJSONPipe() passed.\n");
+    else
+        printf("testParserJSONPipe() failed!\n");
+
+    if (testParserJSONIndex())
+        printf("testParserJSONIndex() passed.\n");
+    else
+        printf("testParserJSONIndex() failed!\n");
+
     if (testParserXML())
         printf("testParserXML() passed.\n");
     else
         printf("testParserXML() failed!\n");
+
+    if (testParserXMLStream())
+        printf("testParserXMLStream() passed.\n");
+    else
+        printf("testParserXMLStream() failed!\n");
+
+    if (testParserHandler())
+        printf("testParserHandler() passed.\n");
+    else
+        printf("testParserHandler() failed!\n");
+
+    if (testParserBuffer())
+        printf("testParserBuffer() passed.\n");
+    else
+        printf("testParserBuffer() failed!\n");
+
+    if (testParserBinary())
+        printf("testParserBinary() passed.\n");
+    else
+        printf("testParserBinary() failed!\n");
+
+    if (testParserCache())
+        printf("testParserCache() passed.\n");
+    else
+        printf("testParserCache() failed!\n");
+
+    if (testParserIncremental())
+        printf("testParserIncremental() passed.\n");
+    else
+        printf("testParserIncremental() failed!\n");
+
+    if (testParserWatcher())
+        printf("testParserWatcher() passed.\n");
+    else
+        printf("testParserWatcher() failed!\n");
 }